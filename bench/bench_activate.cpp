@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <cryptolens/core.hpp>
+#include <cryptolens/Configuration_Unix.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/LicenseKeyCache.hpp>
+#include <cryptolens/MachineCodeComputer_static.hpp>
+#include <cryptolens/RequestHandler_curl_pool.hpp>
+#include <cryptolens/RequestHandler_hedging.hpp>
+#include <cryptolens/RequestHandler_singleflight.hpp>
+
+#include "fixtures.hpp"
+#include "local_server.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+template<typename Handler>
+struct Configuration_local : public cryptolens::Configuration_Unix<cryptolens::MachineCodeComputer_static> {
+  using RequestHandler = Handler;
+};
+
+template<typename RequestHandler>
+using Cryptolens = cryptolens::basic_Cryptolens<Configuration_local<RequestHandler>>;
+
+template<typename RequestHandler>
+std::unique_ptr<Cryptolens<RequestHandler>>
+make_cryptolens(cryptolens::basic_Error & e, std::string const& url)
+{
+  std::unique_ptr<Cryptolens<RequestHandler>> cryptolens_handle(new Cryptolens<RequestHandler>(e));
+  cryptolens_handle->signature_verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+  cryptolens_handle->signature_verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+  cryptolens_handle->machine_code_computer.set_machine_code(e, cryptolens_bench::MACHINE_CODE);
+  cryptolens_handle->set_base_url(e, url);
+
+  return cryptolens_handle;
+}
+
+// The latency of a call to activate() against a server on the same machine,
+// i.e. excluding the network and the time spent by the Web API. The
+// connection to the server is reused between requests.
+void
+BM_activate(benchmark::State & state)
+{
+  cryptolens_bench::LocalServer server(state.range(0) == 0 ? cryptolens_bench::ACTIVATE_RESPONSE : cryptolens_bench::ACTIVATE_RESPONSE_MANY_MACHINES);
+
+  cryptolens::Error e;
+  std::unique_ptr<Cryptolens<cryptolens::RequestHandler_curl>> cryptolens_handle = make_cryptolens<cryptolens::RequestHandler_curl>(e, server.get_url());
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x = cryptolens_handle->activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    benchmark::DoNotOptimize(x);
+    if (e) { break; }
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); }
+  state.counters["requests"] = server.get_requests();
+}
+
+// The same call answered by LicenseKeyCache. The TTL is chosen such that the
+// SignDate of the fixture is always fresh, i.e. only the first call reaches
+// the server.
+void
+BM_activate_cached(benchmark::State & state)
+{
+  cryptolens_bench::LocalServer server(cryptolens_bench::ACTIVATE_RESPONSE);
+
+  cryptolens::Error e;
+  std::unique_ptr<Cryptolens<cryptolens::RequestHandler_curl_pool>> cryptolens_handle = make_cryptolens<cryptolens::RequestHandler_curl_pool>(e, server.get_url());
+  cryptolens::LicenseKeyCache<Cryptolens<cryptolens::RequestHandler_curl_pool>> cache(e, *cryptolens_handle);
+  cache.set_ttl(e, 100L * 365 * 24 * 3600);
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x = cache.activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    benchmark::DoNotOptimize(x);
+    if (e) { break; }
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); }
+  state.counters["requests"] = server.get_requests();
+}
+
+/*
+ * Throughput of activate() when called from several threads at the same
+ * time, either with one basic_Cryptolens object per thread (each with its own
+ * RequestHandler_curl and public key), or with one object shared by all
+ * threads using RequestHandler_curl_pool.
+ *
+ * All threads use the same server, which is started the first time it is
+ * needed. Thread 0 sets up the shared state before the other threads are
+ * released from the barrier at the start of the benchmark loop, and tears
+ * it down after all threads have left it.
+ */
+
+cryptolens_bench::LocalServer &
+scaling_server()
+{
+  static cryptolens_bench::LocalServer server(cryptolens_bench::ACTIVATE_RESPONSE);
+  return server;
+}
+
+std::unique_ptr<Cryptolens<cryptolens::RequestHandler_curl_pool>> shared_cryptolens;
+std::unique_ptr<Cryptolens<cryptolens::RequestHandler_singleflight<cryptolens::RequestHandler_curl_pool>>> singleflight_cryptolens;
+
+void
+BM_activate_per_thread(benchmark::State & state)
+{
+  cryptolens::Error e;
+  std::unique_ptr<Cryptolens<cryptolens::RequestHandler_curl>> cryptolens_handle = make_cryptolens<cryptolens::RequestHandler_curl>(e, scaling_server().get_url());
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x = cryptolens_handle->activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    benchmark::DoNotOptimize(x);
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); }
+  state.SetItemsProcessed(state.iterations());
+
+}
+
+void
+BM_activate_shared(benchmark::State & state)
+{
+  if (state.thread_index() == 0) {
+    cryptolens::Error e;
+    shared_cryptolens = make_cryptolens<cryptolens::RequestHandler_curl_pool>(e, scaling_server().get_url());
+  }
+
+  cryptolens::Error e;
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x = shared_cryptolens->activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    benchmark::DoNotOptimize(x);
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    shared_cryptolens.reset();
+  }
+}
+
+// As BM_activate_shared, but with identical concurrent requests combined
+// by RequestHandler_singleflight. The requests counter shows how many
+// requests reached the server.
+void
+BM_activate_singleflight(benchmark::State & state)
+{
+  unsigned long requests = scaling_server().get_requests();
+
+  if (state.thread_index() == 0) {
+    cryptolens::Error e;
+    singleflight_cryptolens = make_cryptolens<cryptolens::RequestHandler_singleflight<cryptolens::RequestHandler_curl_pool>>(e, scaling_server().get_url());
+  }
+
+  cryptolens::Error e;
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x = singleflight_cryptolens->activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    benchmark::DoNotOptimize(x);
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    state.counters["requests"] = scaling_server().get_requests() - requests;
+    singleflight_cryptolens.reset();
+  }
+}
+
+/*
+ * Tail latency of activate() with two deployments of the Web API, where
+ * every 50th request to either of them takes 20 ms longer. Without hedging
+ * (argument 0) these requests are as slow as the server, while with hedging
+ * (argument 1) a second request is sent to the other server after the 95th
+ * percentile latency, but at least 1 ms, has passed.
+ */
+void
+BM_activate_hedging(benchmark::State & state)
+{
+  cryptolens_bench::LocalServer server_a(cryptolens_bench::ACTIVATE_RESPONSE);
+  cryptolens_bench::LocalServer server_b(cryptolens_bench::ACTIVATE_RESPONSE);
+  server_a.set_slow_requests(50, 20);
+  server_b.set_slow_requests(50, 20);
+
+  using Handler = cryptolens::RequestHandler_hedging<cryptolens::RequestHandler_curl_pool>;
+
+  cryptolens::Error e;
+  std::unique_ptr<Cryptolens<Handler>> cryptolens_handle = make_cryptolens<Handler>(e, "");
+  cryptolens_handle->request_handler.set_endpoints(e, { server_a.get_url(), server_b.get_url() });
+  cryptolens_handle->request_handler.set_hedging(e, state.range(0) != 0, 1);
+
+  std::vector<double> latencies;
+  for (auto _ : state) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    cryptolens::optional<cryptolens::LicenseKey> x = cryptolens_handle->activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    benchmark::DoNotOptimize(x);
+    if (e) { break; }
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); return; }
+
+  std::sort(latencies.begin(), latencies.end());
+  state.counters["p50_us"] = latencies[latencies.size() / 2];
+  state.counters["p99_us"] = latencies[latencies.size() * 99 / 100];
+  state.counters["hedges"] = cryptolens_handle->request_handler.get_hedges();
+}
+
+// The latency of the first call to activate() made with a new object, with
+// (1) or without (0) a call to warmup() first, which is not included in the
+// time. Against a local server, this is only the time to connect.
+void
+BM_activate_first(benchmark::State & state)
+{
+  cryptolens_bench::LocalServer server(cryptolens_bench::ACTIVATE_RESPONSE);
+
+  cryptolens::Error e;
+  for (auto _ : state) {
+    std::unique_ptr<Cryptolens<cryptolens::RequestHandler_curl>> cryptolens_handle = make_cryptolens<cryptolens::RequestHandler_curl>(e, server.get_url());
+    if (state.range(0) != 0) { cryptolens_handle->warmup(e); }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    cryptolens::optional<cryptolens::LicenseKey> x = cryptolens_handle->activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    benchmark::DoNotOptimize(x);
+    if (e) { break; }
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); return; }
+  state.counters["requests"] = server.get_requests();
+}
+
+// The latency of activate() for a key with many activated machines, with
+// (1) or without (0) compressed responses, either over the loopback interface
+// or over a link of 32 KB/s standing in for a field device on a slow network.
+// bytes_per_request is the size of the response including the headers. The
+// responses are only compressed if the benchmarks are built with zlib.
+void
+BM_activate_compression(benchmark::State & state)
+{
+  cryptolens_bench::LocalServer server(cryptolens_bench::ACTIVATE_RESPONSE_MANY_MACHINES);
+  server.set_bandwidth(state.range(1));
+
+  cryptolens::Error e;
+  std::unique_ptr<Cryptolens<cryptolens::RequestHandler_curl>> cryptolens_handle = make_cryptolens<cryptolens::RequestHandler_curl>(e, server.get_url());
+  cryptolens_handle->request_handler.set_compression(e, state.range(0) != 0);
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x = cryptolens_handle->activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+    benchmark::DoNotOptimize(x);
+    if (e) { break; }
+  }
+
+  if (e) { state.SkipWithError("activate() failed"); return; }
+  state.counters["bytes_per_request"] = (double)server.get_bytes_sent() / server.get_requests();
+}
+
+} // namespace
+
+BENCHMARK(BM_activate)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_activate_cached)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_activate_first)->Arg(0)->Arg(1)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_activate_per_thread)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_activate_shared)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_activate_singleflight)->ThreadRange(1, 16)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_activate_compression)->ArgsProduct({ { 0, 1 }, { 0, 32 * 1024 } })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_activate_hedging)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,76 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <cryptolens/base64.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+
+#include "fixtures.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+// Returns the base64 encoded license (first argument 0) or signature (1)
+// from ACTIVATE_RESPONSE_MANY_MACHINES
+std::string
+base64_input(benchmark::State const& state)
+{
+  cryptolens::Error e;
+  cryptolens::ResponseParser_Streaming parser(e);
+
+  cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, cryptolens_bench::ACTIVATE_RESPONSE_MANY_MACHINES);
+  return state.range(0) == 0 ? x->first : x->second;
+}
+
+void
+BM_b64_pton(benchmark::State & state)
+{
+  std::string input = base64_input(state);
+  std::vector<unsigned char> output(cryptolens::internal::b64_decoded_size_max(input.size()));
+
+  for (auto _ : state) {
+    int n = cryptolens::internal::b64_pton(input.c_str(), output.data(), output.size());
+    benchmark::DoNotOptimize(n);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+void
+BM_b64_decode_into(benchmark::State & state)
+{
+  std::string input = base64_input(state);
+  std::vector<unsigned char> output(cryptolens::internal::b64_decoded_size_max(input.size()));
+
+  for (auto _ : state) {
+    int n = cryptolens::internal::b64_decode_into(input.data(), input.size(), output.data(), output.size());
+    benchmark::DoNotOptimize(n);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+void
+BM_b64_decode(benchmark::State & state)
+{
+  std::string input = base64_input(state);
+
+  for (auto _ : state) {
+    cryptolens::optional<std::vector<unsigned char>> x = cryptolens::internal::b64_decode(input);
+    benchmark::DoNotOptimize(x);
+  }
+
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_b64_pton)->Arg(0)->Arg(1);
+BENCHMARK(BM_b64_decode_into)->Arg(0)->Arg(1);
+BENCHMARK(BM_b64_decode)->Arg(0)->Arg(1);
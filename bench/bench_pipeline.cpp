@@ -0,0 +1,138 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <cryptolens/core.hpp>
+#include <cryptolens/Configuration_Unix.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/MachineCodeComputer_static.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+
+#include "fixtures.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+using Configuration = cryptolens::Configuration_Unix<cryptolens::MachineCodeComputer_static>;
+using Cryptolens = cryptolens::basic_Cryptolens<Configuration>;
+
+// Same as Configuration but with ResponseParser_Streaming
+struct Configuration_Streaming : public Configuration {
+  using ResponseParser = cryptolens::ResponseParser_Streaming;
+};
+
+// Selects the fixture using the first argument of the benchmark
+std::string
+activate_response(benchmark::State const& state)
+{
+  return state.range(0) == 0 ? cryptolens_bench::ACTIVATE_RESPONSE : cryptolens_bench::ACTIVATE_RESPONSE_MANY_MACHINES;
+}
+
+// Returns the license key in the format used by LicenseKey::to_string()
+std::string
+saved_license_key(benchmark::State const& state)
+{
+  cryptolens::Error e;
+  cryptolens::ResponseParser_Streaming parser(e);
+
+  cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, activate_response(state));
+  return "v20180502-" + x->first + "-" + x->second;
+}
+
+template<typename Configuration>
+void
+set_public_key(cryptolens::basic_Error & e, cryptolens::basic_Cryptolens<Configuration> & cryptolens_handle)
+{
+  cryptolens_handle.signature_verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+  cryptolens_handle.signature_verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+}
+
+// Parsing the response, verifying the signature and creating the LicenseKey,
+// i.e. all work done by activate() after the response has been received
+// except for running the validators
+template<typename Configuration>
+void
+BM_handle_activate(benchmark::State & state)
+{
+  cryptolens::Error e;
+  cryptolens::basic_Cryptolens<Configuration> cryptolens_handle(e);
+  set_public_key(e, cryptolens_handle);
+  std::string response = activate_response(state);
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x =
+      cryptolens::handle_activate(e, cryptolens_handle.response_parser, cryptolens_handle.signature_verifier, response);
+    benchmark::DoNotOptimize(x);
+  }
+
+  if (e) { state.SkipWithError("handle_activate() failed"); }
+}
+
+void
+BM_activate_validator(benchmark::State & state)
+{
+  cryptolens::Error e;
+  Cryptolens cryptolens_handle(e);
+  set_public_key(e, cryptolens_handle);
+
+  cryptolens::optional<cryptolens::RawLicenseKey> raw =
+    cryptolens::internal::handle_activate(e, cryptolens_handle.response_parser, cryptolens_handle.signature_verifier, activate_response(state));
+  cryptolens::optional<cryptolens::LicenseKeyInformation> info = cryptolens_handle.response_parser.make_license_key_information(e, raw);
+  std::string key = cryptolens_bench::KEY;
+  std::string machine_code = cryptolens_bench::MACHINE_CODE;
+
+  using Env = cryptolens::internal::ActivateEnvironment;
+  Configuration::ActivateValidator<Env> validator(e);
+
+  for (auto _ : state) {
+    Env env(*info, cryptolens_bench::PRODUCT_ID, key, machine_code, 0, false);
+    validator.validate(e, env);
+  }
+
+  if (e) { state.SkipWithError("validate() failed"); }
+}
+
+template<typename Configuration>
+void
+BM_make_license_key(benchmark::State & state)
+{
+  cryptolens::Error e;
+  cryptolens::basic_Cryptolens<Configuration> cryptolens_handle(e);
+  set_public_key(e, cryptolens_handle);
+  std::string saved = saved_license_key(state);
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKey> x = cryptolens_handle.make_license_key(e, saved);
+    benchmark::DoNotOptimize(x);
+  }
+
+  if (e) { state.SkipWithError("make_license_key() failed"); }
+}
+
+void
+BM_make_license_key_view(benchmark::State & state)
+{
+  cryptolens::Error e;
+  Cryptolens cryptolens_handle(e);
+  set_public_key(e, cryptolens_handle);
+  std::string saved = saved_license_key(state);
+
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKeyView> x = cryptolens_handle.make_license_key_view(e, saved);
+    benchmark::DoNotOptimize(x);
+  }
+
+  if (e) { state.SkipWithError("make_license_key_view() failed"); }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_handle_activate, Configuration)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_handle_activate, Configuration_Streaming)->Arg(0)->Arg(1);
+BENCHMARK(BM_activate_validator)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_make_license_key, Configuration)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_make_license_key, Configuration_Streaming)->Arg(0)->Arg(1);
+BENCHMARK(BM_make_license_key_view)->Arg(0)->Arg(1);
@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <cryptolens/base64.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/FieldsToReturn.hpp>
+#include <cryptolens/ResponseParser_ArduinoJson7.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+
+#ifdef CRYPTOLENS_BENCH_ARDUINOJSON5
+#include <cryptolens/ResponseParser_ArduinoJson5.hpp>
+#endif
+
+#ifdef CRYPTOLENS_BENCH_SIMDJSON
+#include <cryptolens/ResponseParser_simdjson.hpp>
+#endif
+
+#include "fixtures.hpp"
+#include "malloc_counter.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+// ResponseParser_ArduinoJson7 allocating the documents with malloc(), as
+// before the arena was added
+struct ResponseParser_ArduinoJson7_malloc : public cryptolens::ResponseParser_ArduinoJson7 {
+  explicit ResponseParser_ArduinoJson7_malloc(cryptolens::basic_Error & e)
+  : ResponseParser_ArduinoJson7(e)
+  {
+    set_arena_size(e, 0);
+  }
+};
+
+// Reports the average number of calls to malloc() per iteration
+void
+set_mallocs_counter(benchmark::State & state, std::uint64_t mallocs)
+{
+  if (!cryptolens_bench::counting_mallocs()) { return; }
+
+  state.counters["mallocs"] = benchmark::Counter((double)(cryptolens_bench::get_mallocs() - mallocs), benchmark::Counter::kAvgIterations);
+}
+
+// Selects the fixture using the first argument of the benchmark
+std::string
+activate_response(benchmark::State const& state)
+{
+  return state.range(0) == 0 ? cryptolens_bench::ACTIVATE_RESPONSE : cryptolens_bench::ACTIVATE_RESPONSE_MANY_MACHINES;
+}
+
+std::string
+decoded_license(benchmark::State const& state)
+{
+  cryptolens::Error e;
+  cryptolens::ResponseParser_ArduinoJson7 parser(e);
+
+  cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, activate_response(state));
+  cryptolens::optional<std::vector<unsigned char>> license = cryptolens::internal::b64_decode(x->first);
+
+  return std::string(license->begin(), license->end());
+}
+
+template<typename ResponseParser>
+void
+BM_parse_activate_response(benchmark::State & state)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  std::string response = activate_response(state);
+
+  std::uint64_t mallocs = cryptolens_bench::get_mallocs();
+  for (auto _ : state) {
+    cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, response);
+    benchmark::DoNotOptimize(x);
+  }
+
+  set_mallocs_counter(state, mallocs);
+
+  if (e) { state.SkipWithError("parse_activate_response() failed"); }
+  state.SetBytesProcessed(state.iterations() * response.size());
+}
+
+// The second argument of the benchmark gives the fields to skip
+template<typename ResponseParser>
+void
+BM_make_license_key_information(benchmark::State & state)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  std::string license = decoded_license(state);
+  int fields_to_skip = (int)state.range(1);
+
+  std::uint64_t mallocs = cryptolens_bench::get_mallocs();
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::LicenseKeyInformation> x = parser.make_license_key_information_unsafe(e, license, fields_to_skip);
+    benchmark::DoNotOptimize(x);
+  }
+
+  set_mallocs_counter(state, mallocs);
+
+  if (e) { state.SkipWithError("make_license_key_information_unsafe() failed"); }
+  state.SetBytesProcessed(state.iterations() * license.size());
+}
+
+// Only the fields needed to check the expiry date and the features
+int const SKIP = cryptolens::FieldsToReturn::CUSTOMER | cryptolens::FieldsToReturn::ACTIVATED_MACHINES | cryptolens::FieldsToReturn::DATA_OBJECTS;
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_parse_activate_response, cryptolens::ResponseParser_ArduinoJson7)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_parse_activate_response, ResponseParser_ArduinoJson7_malloc)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_parse_activate_response, cryptolens::ResponseParser_Streaming)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_make_license_key_information, cryptolens::ResponseParser_ArduinoJson7)->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 1, SKIP });
+BENCHMARK_TEMPLATE(BM_make_license_key_information, ResponseParser_ArduinoJson7_malloc)->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 1, SKIP });
+BENCHMARK_TEMPLATE(BM_make_license_key_information, cryptolens::ResponseParser_Streaming)->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 1, SKIP });
+
+#ifdef CRYPTOLENS_BENCH_ARDUINOJSON5
+BENCHMARK_TEMPLATE(BM_parse_activate_response, cryptolens::ResponseParser_ArduinoJson5)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_make_license_key_information, cryptolens::ResponseParser_ArduinoJson5)->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 1, SKIP });
+#endif
+
+#ifdef CRYPTOLENS_BENCH_SIMDJSON
+BENCHMARK_TEMPLATE(BM_parse_activate_response, cryptolens::ResponseParser_simdjson)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_make_license_key_information, cryptolens::ResponseParser_simdjson)->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 1, SKIP });
+#endif
@@ -0,0 +1,117 @@
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <cryptolens/base64.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/RawLicenseKey.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+#include <cryptolens/SignatureVerifier_caching.hpp>
+
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+#include <cryptolens/SignatureVerifier_OpenSSL3.hpp>
+#else
+#include <cryptolens/SignatureVerifier_OpenSSL.hpp>
+#endif
+
+#ifdef CRYPTOLENS_BENCH_BEARSSL
+#include <cryptolens/SignatureVerifier_BearSSL.hpp>
+#endif
+
+#include "fixtures.hpp"
+#include "malloc_counter.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+using SignatureVerifier_OpenSSL = cryptolens::SignatureVerifier_OpenSSL3;
+#else
+using SignatureVerifier_OpenSSL = cryptolens::SignatureVerifier_OpenSSL;
+#endif
+
+template<typename SignatureVerifier>
+void
+BM_verify_message(benchmark::State & state)
+{
+  cryptolens::Error e;
+  cryptolens::ResponseParser_Streaming parser(e);
+  SignatureVerifier verifier(e);
+  verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+  verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+
+  cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, cryptolens_bench::ACTIVATE_RESPONSE);
+  cryptolens::optional<std::vector<unsigned char>> license = cryptolens::internal::b64_decode(x->first);
+  std::string const& signature = x->second;
+
+  for (auto _ : state) {
+    bool valid = verifier.verify_message(e, *license, signature);
+    benchmark::DoNotOptimize(valid);
+  }
+
+  if (e) { state.SkipWithError("verify_message() failed"); }
+}
+
+// Measures decoding and verifying a license as done for every response,
+// which uses verify_message_base64() if the verifier has it
+template<typename SignatureVerifier>
+void
+BM_make_raw_license_key(benchmark::State & state)
+{
+  cryptolens::Error e;
+  cryptolens::ResponseParser_Streaming parser(e);
+  SignatureVerifier verifier(e);
+  verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+  verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+
+  cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, cryptolens_bench::ACTIVATE_RESPONSE);
+
+  std::uint64_t mallocs = cryptolens_bench::get_mallocs();
+  for (auto _ : state) {
+    cryptolens::optional<cryptolens::RawLicenseKey> raw = cryptolens::RawLicenseKey::make(e, verifier, x->first, x->second);
+    benchmark::DoNotOptimize(raw);
+  }
+
+  if (cryptolens_bench::counting_mallocs()) {
+    state.counters["mallocs"] = benchmark::Counter((double)(cryptolens_bench::get_mallocs() - mallocs), benchmark::Counter::kAvgIterations);
+  }
+
+  if (e) { state.SkipWithError("RawLicenseKey::make() failed"); }
+}
+
+// Measures setting up a verifier, e.g. as done for every call to a
+// function creating its own basic_Cryptolens object
+template<typename SignatureVerifier>
+void
+BM_set_public_key(benchmark::State & state)
+{
+  cryptolens::Error e;
+
+  for (auto _ : state) {
+    SignatureVerifier verifier(e);
+    verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+    verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+    benchmark::DoNotOptimize(&verifier);
+  }
+
+  if (e) { state.SkipWithError("set_public_key_base64() failed"); }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_verify_message, SignatureVerifier_OpenSSL);
+BENCHMARK_TEMPLATE(BM_verify_message, cryptolens::SignatureVerifier_caching<SignatureVerifier_OpenSSL>);
+BENCHMARK_TEMPLATE(BM_make_raw_license_key, SignatureVerifier_OpenSSL);
+BENCHMARK_TEMPLATE(BM_make_raw_license_key, cryptolens::SignatureVerifier_caching<SignatureVerifier_OpenSSL>);
+BENCHMARK_TEMPLATE(BM_set_public_key, SignatureVerifier_OpenSSL);
+
+#ifdef CRYPTOLENS_BENCH_BEARSSL
+BENCHMARK_TEMPLATE(BM_verify_message, cryptolens::SignatureVerifier_BearSSL);
+BENCHMARK_TEMPLATE(BM_make_raw_license_key, cryptolens::SignatureVerifier_BearSSL);
+BENCHMARK_TEMPLATE(BM_set_public_key, cryptolens::SignatureVerifier_BearSSL);
+#endif
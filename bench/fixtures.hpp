@@ -0,0 +1,252 @@
+#pragma once
+
+// Responses from the Web API recorded for the benchmarks. The license keys
+// are signed with a key pair generated for this purpose, whose public key is
+// given by MODULUS_BASE64 and EXPONENT_BASE64.
+//
+// ACTIVATE_RESPONSE is a typical response to Activate for KEY, activated on
+// the machine MACHINE_CODE, and ACTIVATE_RESPONSE_MANY_MACHINES is the same
+// key with 100 activated machines.
+
+namespace cryptolens_bench {
+
+char const* const MODULUS_BASE64 =
+  "sM267+4yoPTcGaY1hbY4UWFDJIOPutOvwfGqB5/UJopOj9sP/1NvsD7hvsf0hYQ6IkijuoGPITY7BjcDSVnrf/vevcK86pXuljYi"
+  "lZMukxA9GHGeIAn+N+fllToNXt/ATP8meao7HPOkpl4nRbzc0unfCTuTaeaBl4t0MQNWpWPOhiabiPUoA5ePTyNdA+J9TGUrB6Rp"
+  "PD6P2BxEbs5itB/OnlZ/DSCUVUWG1GvmyiTv691LuWXAS382IqGTejsiUACZe0VuPzeT3tT3LfyblHatSEX0pyTpLYYwK4+Me50L"
+  "DW0h7sJUp7zEwJtmswcEEITK+Ji4N3N/mLBODSwovw==";
+
+char const* const EXPONENT_BASE64 =
+  "AQAB";
+
+char const* const KEY = "ICWYD-QLYOS-BXQCA-RZNFE";
+
+int const PRODUCT_ID = 3941;
+
+char const* const MACHINE_CODE =
+  "a4c123b1612dd272d1371c17149d439536b3216fdaeeb975729fae923d5a4fd1";
+
+char const* const ACTIVATE_RESPONSE =
+  "{\"licenseKey\":\"eyJQcm9kdWN0SWQiOjM5NDEsIklEIjoxMDQyLCJLZXkiOiJJQ1dZRC1RTFlPUy1CWFFDQS1SWk5GRSIsIkNyZ"
+  "WF0ZWQiOjE2OTg3OTY4MDAsIkV4cGlyZXMiOjQxMDI0NDQ4MDAsIlBlcmlvZCI6MzY2LCJGMSI6dHJ1ZSwiRjIiOmZhbHNlLCJGM"
+  "yI6dHJ1ZSwiRjQiOmZhbHNlLCJGNSI6ZmFsc2UsIkY2IjpmYWxzZSwiRjciOmZhbHNlLCJGOCI6ZmFsc2UsIk5vdGVzIjoiRW50Z"
+  "XJwcmlzZSBwbGFuIiwiQmxvY2siOmZhbHNlLCJHbG9iYWxJZCI6Mjg0NjEwLCJDdXN0b21lciI6eyJJZCI6NzM0NSwiTmFtZSI6I"
+  "kphbmUgRG9lIiwiRW1haWwiOiJqYW5lQGV4YW1wbGUuY29tIiwiQ29tcGFueU5hbWUiOiJFeGFtcGxlIEx0ZCIsIkNyZWF0ZWQiO"
+  "jE2OTg3OTY4MDB9LCJBY3RpdmF0ZWRNYWNoaW5lcyI6W3siTWlkIjoiYTRjMTIzYjE2MTJkZDI3MmQxMzcxYzE3MTQ5ZDQzOTUzN"
+  "mIzMjE2ZmRhZWViOTc1NzI5ZmFlOTIzZDVhNGZkMSIsIklQIjoiMjAzLjAuMTEzLjEiLCJUaW1lIjoxNzAwMDAwMDAwLCJGcmllb"
+  "mRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0wIn1dLCJUcmlhbEFjdGl2YXRpb24iOmZhbHNlLCJNYXhOb09mTWFjaGluZXMiOjUsIkFsb"
+  "G93ZWRNYWNoaW5lcyI6IiIsIkRhdGFPYmplY3RzIjpbeyJJZCI6MTEsIk5hbWUiOiJ1c2FnZWNvdW50IiwiU3RyaW5nVmFsdWUiO"
+  "iIiLCJJbnRWYWx1ZSI6NDJ9XSwiU2lnbkRhdGUiOjE3MDAwMDY0MDAsIlJlc2VsbGVyIjpudWxsfQ==\",\"signature\":\"n78H8X"
+  "YXh5uipAyBzuhg0ZCLcq8vGeAtidzmj25fjUB0uYeImtOvMvUocloe5CffMZf0PUSE7nsq80GeB5DeakG5TJaNmK+HogBnLV6wVQ"
+  "abe2+iqjLqX44BAZl2Te3XKkRhEoTMNriSR5jDYD4Uwe/IWbb7J99cmMYOJMqNefMuiiNTaYVvvU+wpsotbqpPra71mA5Xiy/N7T"
+  "Iel0KS1ltKEtTvlrxuKj/IbsyQpJq2X2/3k5wTi+GpkRWDK40ZOQoz1GauYlfzrKSDf3qzk2pppnLA22om9Goe9h/kLJk4XdXOhc"
+  "2cFS0gUjKjtSiTH3noOgc77LzaiVlassWV6A==\",\"result\":0,\"message\":\"\"}";
+
+char const* const ACTIVATE_RESPONSE_MANY_MACHINES =
+  "{\"licenseKey\":\"eyJQcm9kdWN0SWQiOjM5NDEsIklEIjoxMDQyLCJLZXkiOiJJQ1dZRC1RTFlPUy1CWFFDQS1SWk5GRSIsIkNyZ"
+  "WF0ZWQiOjE2OTg3OTY4MDAsIkV4cGlyZXMiOjQxMDI0NDQ4MDAsIlBlcmlvZCI6MzY2LCJGMSI6dHJ1ZSwiRjIiOmZhbHNlLCJGM"
+  "yI6dHJ1ZSwiRjQiOmZhbHNlLCJGNSI6ZmFsc2UsIkY2IjpmYWxzZSwiRjciOmZhbHNlLCJGOCI6ZmFsc2UsIk5vdGVzIjoiRW50Z"
+  "XJwcmlzZSBwbGFuIiwiQmxvY2siOmZhbHNlLCJHbG9iYWxJZCI6Mjg0NjEwLCJDdXN0b21lciI6eyJJZCI6NzM0NSwiTmFtZSI6I"
+  "kphbmUgRG9lIiwiRW1haWwiOiJqYW5lQGV4YW1wbGUuY29tIiwiQ29tcGFueU5hbWUiOiJFeGFtcGxlIEx0ZCIsIkNyZWF0ZWQiO"
+  "jE2OTg3OTY4MDB9LCJBY3RpdmF0ZWRNYWNoaW5lcyI6W3siTWlkIjoiYTRjMTIzYjE2MTJkZDI3MmQxMzcxYzE3MTQ5ZDQzOTUzN"
+  "mIzMjE2ZmRhZWViOTc1NzI5ZmFlOTIzZDVhNGZkMSIsIklQIjoiMjAzLjAuMTEzLjEiLCJUaW1lIjoxNzAwMDAwMDAwLCJGcmllb"
+  "mRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0wIn0seyJNaWQiOiIyYWFiZmUyMjhmMjE5ZTljYjBlYjUzZjE2OTQ3Y2NmMjVlYzg0ZDhkY"
+  "mM3NDI1NDc3MGY1ODkwNGRiYTQxZWNjIiwiSVAiOiIyMDMuMC4xMTMuMiIsIlRpbWUiOjE3MDAwMDM2MDAsIkZyaWVuZGx5TmFtZ"
+  "SI6IndvcmtzdGF0aW9uLTEifSx7Ik1pZCI6ImNjM2ZjMTYyNmU1M2ExMzA0M2IwMjZjNDhiYmYzM2ZlZmY5MjQzYThmNTA2YjQwO"
+  "TI4YjViN2E3NjdjNzZmYjAiLCJJUCI6IjIwMy4wLjExMy4zIiwiVGltZSI6MTcwMDAwNzIwMCwiRnJpZW5kbHlOYW1lIjoid29ya"
+  "3N0YXRpb24tMiJ9LHsiTWlkIjoiMDhmODZiZWJiMjczN2Y2YTZmMGZiMjNjNmY1ZGEyY2VjMjU1NDA0ZTRmYjQ0MDAzNGQ2NjA4N"
+  "jk3YThkNDFiZSIsIklQIjoiMjAzLjAuMTEzLjQiLCJUaW1lIjoxNzAwMDEwODAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvb"
+  "i0zIn0seyJNaWQiOiJkNDQwZTUwNDU0ZjMxYWYzMTc2ODEzZTAyZWE2OGVmNzg2ZTRkM2NlYTI3ZDI2OTM0YjQ4NGU3M2NmNTc1Z"
+  "GNhIiwiSVAiOiIyMDMuMC4xMTMuNSIsIlRpbWUiOjE3MDAwMTQ0MDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTQifSx7I"
+  "k1pZCI6ImQ2YmEyYjBhZWUwY2E5MjM3MzI4ODE1ODRkOGM0ZmEyODE1ZDI4MDI4MjcyODNlMGFkODQxNzM1ODE1Njk5NjkiLCJJU"
+  "CI6IjIwMy4wLjExMy42IiwiVGltZSI6MTcwMDAxODAwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNSJ9LHsiTWlkIjoiZ"
+  "TU4YjA4MTAwNmY3ZTNkZmM5NjdhNjRjYjE0MDI4ZDUxMmM5NzkxZTU1OGUwOGJhYTcxOTZiNTBhYzJmODY3MCIsIklQIjoiMjAzL"
+  "jAuMTEzLjciLCJUaW1lIjoxNzAwMDIxNjAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi02In0seyJNaWQiOiIyODI0YzFjM"
+  "Dk5NzI0Y2FmNDk0MWQ0MDcyMDE0YjNjZTEwN2Y4MGUyMjJmODI4NzY3ZWZjMmY5MTYyNGE4OTQwIiwiSVAiOiIyMDMuMC4xMTMuO"
+  "CIsIlRpbWUiOjE3MDAwMjUyMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTcifSx7Ik1pZCI6ImYxZjgzNmY5OWVlZTM2O"
+  "TJmMDllMmU4YzY2MjI0OGI0ODNiN2ZmYzA1MGZlYzk0ZGJjYTNhMGFhYzM2MDk4YjIiLCJJUCI6IjIwMy4wLjExMy45IiwiVGltZ"
+  "SI6MTcwMDAyODgwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tOCJ9LHsiTWlkIjoiY2MyYmQ4MTgzMTk0NzhkYTZiZDBjN"
+  "jIxZGU0OWYxNDVmZGE5OTg4Yzc5ZmMzNTUyNmY3ZWFlZDQ2NzI1YTJhNyIsIklQIjoiMjAzLjAuMTEzLjEwIiwiVGltZSI6MTcwM"
+  "DAzMjQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tOSJ9LHsiTWlkIjoiYjg2MGRjZDZjOGExZjhiNDYyODdjY2VkOTA0M"
+  "WRmZjAyY2VlNzM3NDQzZTIxMDQ3MTk0OGQzMzI5NmM4NzAwOSIsIklQIjoiMjAzLjAuMTEzLjExIiwiVGltZSI6MTcwMDAzNjAwM"
+  "CwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tMTAifSx7Ik1pZCI6ImU4YTdmNzcwZDkxMDZmZDI4N2RiN2YxYWRiYzYwOTI2Z"
+  "jY5NjdlNzg5M2Y1N2ZkMTRjMTYwNGQxMTVjZWEzMjUiLCJJUCI6IjIwMy4wLjExMy4xMiIsIlRpbWUiOjE3MDAwMzk2MDAsIkZya"
+  "WVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTExIn0seyJNaWQiOiJhNjVlMTljYmFlNTMwMjgyYmQzNmNiOWQyMWY2YmU2YWJmMGQ3Y"
+  "zFjMWUyMTg2MmFiOGExOGE4OTAyMDczZmVjIiwiSVAiOiIyMDMuMC4xMTMuMTMiLCJUaW1lIjoxNzAwMDQzMjAwLCJGcmllbmRse"
+  "U5hbWUiOiJ3b3Jrc3RhdGlvbi0xMiJ9LHsiTWlkIjoiOGRmNGY1MDk0N2FhZWIyNmM1N2QyMWZhNWQzMjgyNjNkZmU1NzRkZTczO"
+  "Tk4OGI4ODZlNzU3NzQ5NmEyYzg3NyIsIklQIjoiMjAzLjAuMTEzLjE0IiwiVGltZSI6MTcwMDA0NjgwMCwiRnJpZW5kbHlOYW1lI"
+  "joid29ya3N0YXRpb24tMTMifSx7Ik1pZCI6IjNlMTMwZjdlYjE5NzMxNjYyYjVlODAzYjYxYmE0MTY4MTYwYWRiNTkyNjFmZjJkM"
+  "2M0MjVjOGQ5OWQxOWJkZDAiLCJJUCI6IjIwMy4wLjExMy4xNSIsIlRpbWUiOjE3MDAwNTA0MDAsIkZyaWVuZGx5TmFtZSI6Indvc"
+  "mtzdGF0aW9uLTE0In0seyJNaWQiOiJiNmNjNjBkNWQzMmNiZTU0MDE0YzJiNTRiOTU1MjNjZjY5NDFmYTFjMjU3YzZmNTYxYzVjY"
+  "jM0NzYxMWEzY2U5IiwiSVAiOiIyMDMuMC4xMTMuMTYiLCJUaW1lIjoxNzAwMDU0MDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3Rhd"
+  "Glvbi0xNSJ9LHsiTWlkIjoiZDk3ZGNiZWU1MDBmZTdlZTVmYzMyNGJkYjJlMTE0MmEyMWM0MDIzNjRmOTU3MmI4NWE4ZTQ4ZjY4N"
+  "2FiMTY1YyIsIklQIjoiMjAzLjAuMTEzLjE3IiwiVGltZSI6MTcwMDA1NzYwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tM"
+  "TYifSx7Ik1pZCI6IjU4YWM1ODMxYmUzOGNiOGNiNGJhMmU3NTE5ODlhMDE3NDlkZGIxNGY3MTAxMGI5M2I3ZDk0NmJmNTQwNzRlM"
+  "zIiLCJJUCI6IjIwMy4wLjExMy4xOCIsIlRpbWUiOjE3MDAwNjEyMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTE3In0se"
+  "yJNaWQiOiI0OGM4MDFiZWY3NTAxMTBjNTc1MTMwNjRkNmQ1OTI5MWYwY2RlMmU1NzM4NzEzYTgxOGQ4OTYyMDU4NzY1YTZjIiwiS"
+  "VAiOiIyMDMuMC4xMTMuMTkiLCJUaW1lIjoxNzAwMDY0ODAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0xOCJ9LHsiTWlkI"
+  "joiYTdjZmYwMGQ3OTZjMjU0MTAzMzViNDAwMTQxMjEyYjYyYzM3NjYzMTEyOWYzNDM2OWFhZDgwYjg5MWJhZjkwZCIsIklQIjoiM"
+  "jAzLjAuMTEzLjIwIiwiVGltZSI6MTcwMDA2ODQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tMTkifSx7Ik1pZCI6IjBkM"
+  "2JmMTYyOTVkMDY5MTBiZjNmNWZiODU5NjdmNTMyZjNhYjNjYzJkMGI2OThkNWM3ZTQxYmE0ZWE1ZWU4NzQiLCJJUCI6IjIwMy4wL"
+  "jExMy4yMSIsIlRpbWUiOjE3MDAwNzIwMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTIwIn0seyJNaWQiOiJhZTc2ODk0N"
+  "DdhYjU3YTY4MzUzNmM0NDk5ZDg2MzM4NmNlMTBjZDc5ZTA0OGMwN2RkNzc1M2VkYTgzZDdjNThkIiwiSVAiOiIyMDMuMC4xMTMuM"
+  "jIiLCJUaW1lIjoxNzAwMDc1NjAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0yMSJ9LHsiTWlkIjoiZmUwZDVhMGNmMzE4N"
+  "jU2YjNlNmYwYmFkZTY1YzNiMTg4Y2MxMDJkZGI4Mzc5YzdjZTY1NDI2Zjc0YmRlOTRmYiIsIklQIjoiMjAzLjAuMTEzLjIzIiwiV"
+  "GltZSI6MTcwMDA3OTIwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tMjIifSx7Ik1pZCI6Ijc4YzhkNWYwOGI3OWFmZmQyY"
+  "jQ5YzEyYTRiMDA2Mjk4MzQ3NWViNDZjNTI5NmY2MmUzMzhkNzRmZjFmZTRmN2YiLCJJUCI6IjIwMy4wLjExMy4yNCIsIlRpbWUiO"
+  "jE3MDAwODI4MDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTIzIn0seyJNaWQiOiI1MDVhZWY5ZWJkZDI1YjAwMWEzZmY0M"
+  "TZkNGEzYmFmNjlkYWQ4MTk5YmZjYThiNmYzYTZhOTQyMWNjMWM5MzAxIiwiSVAiOiIyMDMuMC4xMTMuMjUiLCJUaW1lIjoxNzAwM"
+  "Dg2NDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0yNCJ9LHsiTWlkIjoiNmYxYzQyNjFlNTM1MWQzMGI0OTg5NWQxYTBkM"
+  "WYxM2RjZTIwYzRmZDMyZjY0MGQwMDMyNjM0ZjA4N2U1MWI0MiIsIklQIjoiMjAzLjAuMTEzLjI2IiwiVGltZSI6MTcwMDA5MDAwM"
+  "CwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tMjUifSx7Ik1pZCI6IjlmZTgxMTAxMDJjOTk1ZjFhYmVmNTQzYjVkZmNlOGE5O"
+  "DFhMDQ5ZDdjY2M3ZTkwYTg4ZDUxOTQ0OGZiMmZjNjciLCJJUCI6IjIwMy4wLjExMy4yNyIsIlRpbWUiOjE3MDAwOTM2MDAsIkZya"
+  "WVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTI2In0seyJNaWQiOiI5MWNlNjgwY2UyYjI3YzhhZjY2NjYyNTliYmM0NzFmYjNiZTI0Y"
+  "TBiODAzMTZmNjg4ZDNlNDgxYTY1YzIwMTFiIiwiSVAiOiIyMDMuMC4xMTMuMjgiLCJUaW1lIjoxNzAwMDk3MjAwLCJGcmllbmRse"
+  "U5hbWUiOiJ3b3Jrc3RhdGlvbi0yNyJ9LHsiTWlkIjoiZWYyYzMyOGE3MmM1ZTViNzc1MThiMTAxOGYxMzRhMDY5ZTNmYWI4YzNiZ"
+  "mM1ZTc0MGU2MTU3MmI0ZTNjMDJlYSIsIklQIjoiMjAzLjAuMTEzLjI5IiwiVGltZSI6MTcwMDEwMDgwMCwiRnJpZW5kbHlOYW1lI"
+  "joid29ya3N0YXRpb24tMjgifSx7Ik1pZCI6ImE3ZjNiNGE3MTVlNGU0OGRkNzQwODlhNThmM2FlZjM0MTZmOTM4NmJkODc3M2M5Z"
+  "DUxOTQwZWE0ZTA5NWJkMWQiLCJJUCI6IjIwMy4wLjExMy4zMCIsIlRpbWUiOjE3MDAxMDQ0MDAsIkZyaWVuZGx5TmFtZSI6Indvc"
+  "mtzdGF0aW9uLTI5In0seyJNaWQiOiI2ODU0NTc1NjIyZjg1NjQ2OTYwMmQxYmE5ZjIwZGY0ODc1YjE1YjBiZTIzYjdhYzE5M2ZlM"
+  "DQwNzI3NTUzOTgwIiwiSVAiOiIyMDMuMC4xMTMuMzEiLCJUaW1lIjoxNzAwMTA4MDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3Rhd"
+  "Glvbi0zMCJ9LHsiTWlkIjoiMDM2ODBlN2UzYjM1MTgzZWY4MzMzYzQ3NzRlYzUwY2QxYzFiYWM3YWRhYzFhNGI3ZDBiMzUyYWQ2M"
+  "Dc0ZGNlMSIsIklQIjoiMjAzLjAuMTEzLjMyIiwiVGltZSI6MTcwMDExMTYwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tM"
+  "zEifSx7Ik1pZCI6IjExODgxMzgzMGQ3MTkzOWI1MzE4MmU0ZTM0OWQ5ODcyOWU3YzZiZTlmZjkwN2E3NmNjMGI1N2FhZjg5NjkxM"
+  "DUiLCJJUCI6IjIwMy4wLjExMy4zMyIsIlRpbWUiOjE3MDAxMTUyMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTMyIn0se"
+  "yJNaWQiOiIyYmUxY2ViMzc0ZGFiNDY4M2Y4NGQzMGQzZmM0ZDgzY2VlOWI5YmNjYTBmY2U5NTk0ZGM3MmFhN2E2ZDAwMThmIiwiS"
+  "VAiOiIyMDMuMC4xMTMuMzQiLCJUaW1lIjoxNzAwMTE4ODAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0zMyJ9LHsiTWlkI"
+  "joiOTlkZGNlYjFiZTAyNzNkYmM0NmRmY2VhMjViYWIyOTUzOWFkNTk2NmQ1MTNiMWQwMDkwOWMzMDA2NWY4NDZkMyIsIklQIjoiM"
+  "jAzLjAuMTEzLjM1IiwiVGltZSI6MTcwMDEyMjQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tMzQifSx7Ik1pZCI6IjQ1M"
+  "zAzMjVmZWQxMGE0N2I4NTE4MzJiNmVjMDE3YzFlMTc3NzE1NWEwZTlkOGYyN2M3ZDljZjA3MjU1YmM1MDkiLCJJUCI6IjIwMy4wL"
+  "jExMy4zNiIsIlRpbWUiOjE3MDAxMjYwMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTM1In0seyJNaWQiOiJjYjNhY2FjM"
+  "jNkYjdjNmU5YjdkMTgwYTQ3NDI2ODRlZTc1YmI2Y2M2OWY2N2U0OGViN2M2NDMyOGMwNDkwYzI1IiwiSVAiOiIyMDMuMC4xMTMuM"
+  "zciLCJUaW1lIjoxNzAwMTI5NjAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0zNiJ9LHsiTWlkIjoiN2E2MzJiOTYyOTI3O"
+  "TRjOWJjZTQ4NTBiYmQwZTdjYjM1OTM4NzFjMTVkNjk0YzE5NTdmOGRiMDM5MTE3MzFhNiIsIklQIjoiMjAzLjAuMTEzLjM4IiwiV"
+  "GltZSI6MTcwMDEzMzIwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tMzcifSx7Ik1pZCI6ImIyZGM3ODJiZGVhZTE2ZDRmN"
+  "jE4NTU3ODcxNWJiZDI2OTQ0ZmY3NzBlNGI5NDQ3YTNkNTRlYzYzOTBiZjYxMTgiLCJJUCI6IjIwMy4wLjExMy4zOSIsIlRpbWUiO"
+  "jE3MDAxMzY4MDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTM4In0seyJNaWQiOiI5NjM5ZTM1YWVlYjk1MjEwZWYyYTgzZ"
+  "mRmNmEwYjI5ODcyNDAwYzQ5YjU1MzlhYzViYTdiNGI4NzExM2MxNmZkIiwiSVAiOiIyMDMuMC4xMTMuNDAiLCJUaW1lIjoxNzAwM"
+  "TQwNDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi0zOSJ9LHsiTWlkIjoiZjU5MjQ3NTRlYzIxZWY2NmIwMWQ0OTIxZGEyZ"
+  "TA1NWM5MGViNmYyYWVkNGMyMWE5ZGJmNDlhMDY3ZTI0YmRiNyIsIklQIjoiMjAzLjAuMTEzLjQxIiwiVGltZSI6MTcwMDE0NDAwM"
+  "CwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNDAifSx7Ik1pZCI6ImVjODM3NTYzNzgzNjhmN2U3MzJkMmU0MzNlYzU2ZjI0Y"
+  "jFjNzFiMTA2ZTkzNGQyNjNiNWJhMDgzN2JiZjFiM2IiLCJJUCI6IjIwMy4wLjExMy40MiIsIlRpbWUiOjE3MDAxNDc2MDAsIkZya"
+  "WVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTQxIn0seyJNaWQiOiJhMzE3OGI2ZTBlMzBmMzI4NTQ5YzQ4OGUwMGE0ZmYxMTI1Y2Y1Z"
+  "WM3MmJhNjk0MTY1YmVhZWNiYTBhZmE3MDdlIiwiSVAiOiIyMDMuMC4xMTMuNDMiLCJUaW1lIjoxNzAwMTUxMjAwLCJGcmllbmRse"
+  "U5hbWUiOiJ3b3Jrc3RhdGlvbi00MiJ9LHsiTWlkIjoiMTQ0OGM4MjhiNDEzNmQzYjk3NDI5YWI3YmNhMWFhZmI3N2I0NDYwZWNlY"
+  "zk1MjQ5OThhMjYyNTliZWJkMmZhNSIsIklQIjoiMjAzLjAuMTEzLjQ0IiwiVGltZSI6MTcwMDE1NDgwMCwiRnJpZW5kbHlOYW1lI"
+  "joid29ya3N0YXRpb24tNDMifSx7Ik1pZCI6Ijg4MDU4NzA2MWNlNjkzNjcxNDEyMmE0MDY4MGEwNmFhMGZjYTUxZDEyYWZjOGUwM"
+  "GFhMWRhNTIwNDY0MmJiZGIiLCJJUCI6IjIwMy4wLjExMy40NSIsIlRpbWUiOjE3MDAxNTg0MDAsIkZyaWVuZGx5TmFtZSI6Indvc"
+  "mtzdGF0aW9uLTQ0In0seyJNaWQiOiI0YTc4ZjE5ZThiODQ4MGYzYjQ3YzIwNDMxNjU4YjQ1NTBiN2VmNmJjZTZhMDMwMmNiMTdjZ"
+  "GM3MDgwOGQ3N2I2IiwiSVAiOiIyMDMuMC4xMTMuNDYiLCJUaW1lIjoxNzAwMTYyMDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3Rhd"
+  "Glvbi00NSJ9LHsiTWlkIjoiYWQ4OWY2NWY4NDk5MmEwZjc1YWU2MTZiMWU1ZDQ5MDM0MDQ5NGIzNWVjMmRhY2ExNzYwMTQ3ZDMwM"
+  "WEyMzNmNCIsIklQIjoiMjAzLjAuMTEzLjQ3IiwiVGltZSI6MTcwMDE2NTYwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tN"
+  "DYifSx7Ik1pZCI6ImQwNTc0M2JmMmI2NzI4NTA4ODIxNjFkYjgwYTFlOWFkOGNkYWRjNGNjZDQwNzhjNzYzMjExY2FlYWUwZmZhY"
+  "zciLCJJUCI6IjIwMy4wLjExMy40OCIsIlRpbWUiOjE3MDAxNjkyMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTQ3In0se"
+  "yJNaWQiOiJjYjJjOGEyNzg4ZmJmNzQyYjY1Yjc1NGU1MWFjYmQzZDQ4YzNiYjllMjhjOWUzZWY1NDA0YmY3YmFjODA2MDgxIiwiS"
+  "VAiOiIyMDMuMC4xMTMuNDkiLCJUaW1lIjoxNzAwMTcyODAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi00OCJ9LHsiTWlkI"
+  "joiNTk4YTg3OGUyZjI2NGQ5YjFlY2IxOWRkOGI3YzQ2YjI2YTIyZWNjZGYwM2VlZGRmNTJlY2Y0MDc2YzE5YWNlMyIsIklQIjoiM"
+  "jAzLjAuMTEzLjUwIiwiVGltZSI6MTcwMDE3NjQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNDkifSx7Ik1pZCI6IjI3M"
+  "jAzZjI2ZTE2YWYxZDRkMTRhYTYwNTg4MmFjODljZDE5OTdjZDg5NjQxNmJlZjRiYTZlMWEwMmRhMTg3ZTkiLCJJUCI6IjIwMy4wL"
+  "jExMy41MSIsIlRpbWUiOjE3MDAxODAwMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTUwIn0seyJNaWQiOiI2NmVjZTY2M"
+  "TVkMzE0MmY1MDVmNzk2NTQ2M2UzNjIxZDc4ZWQ0MTQxNWU5N2E0OThhNjQ3YzFhYzQ5NzI2ZTQ1IiwiSVAiOiIyMDMuMC4xMTMuN"
+  "TIiLCJUaW1lIjoxNzAwMTgzNjAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi01MSJ9LHsiTWlkIjoiZGFjMzFiMzYyOWZiM"
+  "GYyNmY4OTI2NGY4NzkxMzBiNjQ5MTVhYmVmN2FiNTM5MmUzMzVjZTExMTNkNGRiMmI1YiIsIklQIjoiMjAzLjAuMTEzLjUzIiwiV"
+  "GltZSI6MTcwMDE4NzIwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNTIifSx7Ik1pZCI6IjUyYTBmOTQ4MzM3MzRmODNhZ"
+  "Tc1MThiNjljNjQ3NzMwMzFmNjcyNTQ4MGRjMzkzMjY3NzE3MmEzMTY1OWEyZTUiLCJJUCI6IjIwMy4wLjExMy41NCIsIlRpbWUiO"
+  "jE3MDAxOTA4MDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTUzIn0seyJNaWQiOiIwYWRkMTI3NDU0YjQ2NjdhMjBmMWZhM"
+  "jI2MWJkMmI1ZmY0ODkxZTVkYzkzMjg3NzZlN2YxY2NhY2MyN2FkOTA5IiwiSVAiOiIyMDMuMC4xMTMuNTUiLCJUaW1lIjoxNzAwM"
+  "Tk0NDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi01NCJ9LHsiTWlkIjoiZjAzZmRkOWU0YTYyYmNlMTlhMjg1ZWQ3MzYxY"
+  "zVjOGE0YjU3YmM5ZmE2NWMwMDUzN2U4YjNjNDhkMmFlODliOSIsIklQIjoiMjAzLjAuMTEzLjU2IiwiVGltZSI6MTcwMDE5ODAwM"
+  "CwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNTUifSx7Ik1pZCI6ImMxZmZiMDEzY2U5NGUxYWY0MDg0NjFjNTg3OTBkZDJjZ"
+  "mI4YTVmMWI0NjE1OTU5MTljYjU4OWY2YWVjMzhiY2EiLCJJUCI6IjIwMy4wLjExMy41NyIsIlRpbWUiOjE3MDAyMDE2MDAsIkZya"
+  "WVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTU2In0seyJNaWQiOiJjZjgzNmVkNWExNDhmZDI4Y2JjOTM4ZTAxOWJiODcyM2QzOTU1M"
+  "2NjYWNjZmFiNTRkOTQ2YTJkMjA3ZGM2ODQ0IiwiSVAiOiIyMDMuMC4xMTMuNTgiLCJUaW1lIjoxNzAwMjA1MjAwLCJGcmllbmRse"
+  "U5hbWUiOiJ3b3Jrc3RhdGlvbi01NyJ9LHsiTWlkIjoiNzczOTFjOTRjODI4Njc5M2IyYjAyM2E2MGU0ZTgxZTExZTNmNzlhYTc2N"
+  "jkwNzUwOGRiMjgyM2NjZDcxYmE4MiIsIklQIjoiMjAzLjAuMTEzLjU5IiwiVGltZSI6MTcwMDIwODgwMCwiRnJpZW5kbHlOYW1lI"
+  "joid29ya3N0YXRpb24tNTgifSx7Ik1pZCI6ImY0ZGVlNmE2M2M1OTYyMGU2Njg2OTAwMmI2ZDA4YjVhYjkzMTViZDBlM2EzNGJmZ"
+  "jJhYWY0MzhjNmI4MDY4ZGMiLCJJUCI6IjIwMy4wLjExMy42MCIsIlRpbWUiOjE3MDAyMTI0MDAsIkZyaWVuZGx5TmFtZSI6Indvc"
+  "mtzdGF0aW9uLTU5In0seyJNaWQiOiI1ZDQ0MDM2YzAwMmUxNjJhYWVmNjA3NmJjMzM0NmVlZTIxZjVjN2ZmNDNmYzI3NzBjNzE3M"
+  "zYwMWUxYzc3MWQ4IiwiSVAiOiIyMDMuMC4xMTMuNjEiLCJUaW1lIjoxNzAwMjE2MDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3Rhd"
+  "Glvbi02MCJ9LHsiTWlkIjoiMTRlMGYzMzU0NWEzYzAyMDIyMTllYzA2MDVlNjM2ZDMyYjMyNzMyYjg5OTk0ZmE2MDIyMTM2Y2VkN"
+  "jIwMTA0ZCIsIklQIjoiMjAzLjAuMTEzLjYyIiwiVGltZSI6MTcwMDIxOTYwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tN"
+  "jEifSx7Ik1pZCI6IjE1OWU4NDg5YjBhYzM1ZTVmYTg3MGQwYTdiYTA3YTI1MzFhZGFiMjNlNTYxN2QyNjY5MDhkMzVlNTljN2E4M"
+  "DIiLCJJUCI6IjIwMy4wLjExMy42MyIsIlRpbWUiOjE3MDAyMjMyMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTYyIn0se"
+  "yJNaWQiOiI2ODQyMmM5MjIyMDJiMjQzZjhlNTM4OWNkNWUzZWFhNjBjNzM2YmE4MDYyMjU5ODUxNGYzMWM4MjcxMjkwODRiIiwiS"
+  "VAiOiIyMDMuMC4xMTMuNjQiLCJUaW1lIjoxNzAwMjI2ODAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi02MyJ9LHsiTWlkI"
+  "joiYjU0YjhiYjUzNzU5YzA3NjdjYjdmODAxM2NiNzkwZmVmMzNlZjJjM2ZmNTdkZTEzNjI4YmVmN2ExMjdmNmMzMSIsIklQIjoiM"
+  "jAzLjAuMTEzLjY1IiwiVGltZSI6MTcwMDIzMDQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNjQifSx7Ik1pZCI6ImQxN"
+  "zVhNjMyZjhlZTQyZWEzNjhiMjNmZjg1MDBmMTdmNGI0Y2ExYjU3MGUyZTYxOWU0NjlhNjJjMDUwYmY3MmYiLCJJUCI6IjIwMy4wL"
+  "jExMy42NiIsIlRpbWUiOjE3MDAyMzQwMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTY1In0seyJNaWQiOiJiZjY2NmY2O"
+  "WU4N2ExZDVhZDBiNTcwNDhlZmM0ODczOGQ0NDRhMTU3ZDUyZWQ4NzQ4ZDMxZDMwOTI5NTRkMmM5IiwiSVAiOiIyMDMuMC4xMTMuN"
+  "jciLCJUaW1lIjoxNzAwMjM3NjAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi02NiJ9LHsiTWlkIjoiM2U3ZmI2ZDI4YzU4N"
+  "2RiODIxZjZhMGVmYTVlYTdkMjZkYzQ3YmJjZmI0NzY4MzE0Y2QyZmVhYmJkYTVmMDVjYiIsIklQIjoiMjAzLjAuMTEzLjY4IiwiV"
+  "GltZSI6MTcwMDI0MTIwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNjcifSx7Ik1pZCI6IjM5Njc2Yjk4NTJlMTYwZDgwM"
+  "jA1MjcwNTc1ODcwMDMyMjY0ZmEyYmE5ZGY4YTEyODU4MjIxODRhYWY0NjE0ZGMiLCJJUCI6IjIwMy4wLjExMy42OSIsIlRpbWUiO"
+  "jE3MDAyNDQ4MDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTY4In0seyJNaWQiOiI5MDc5MmYzMjQ2ZWU3MmZkNDA2NjNlN"
+  "zhkYTEwNzA3OTZlNjU2OTg0NTE3ZWE5Y2E5MWEyOTFhNzQ1N2UwNmEzIiwiSVAiOiIyMDMuMC4xMTMuNzAiLCJUaW1lIjoxNzAwM"
+  "jQ4NDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi02OSJ9LHsiTWlkIjoiYmY5MjMyY2RmMjg3ZWFmZGJlYTEzZTI4NDE0M"
+  "mUxOTJhZDI0YzMxMTk0MzJhNWQ1NzVjZGFiMzdlMzI4Y2Y3NSIsIklQIjoiMjAzLjAuMTEzLjcxIiwiVGltZSI6MTcwMDI1MjAwM"
+  "CwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNzAifSx7Ik1pZCI6IjllYzY0NmYzYTcwOGY0YWE1YTZkMTA3YjA4MTFhN2E4Y"
+  "jliYmNjOTM3MGQ3MTU0OThhY2Q5NDdhMWI1YTQxZWEiLCJJUCI6IjIwMy4wLjExMy43MiIsIlRpbWUiOjE3MDAyNTU2MDAsIkZya"
+  "WVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTcxIn0seyJNaWQiOiJmZTZhYjcyMzNhMDA3YjIyZjE2ZWM5ZmM5ZmFiOWIzMmZlZDA3N"
+  "jZiYjMxZWQwNGQyNTliMzcxN2JkNWMyZDZhIiwiSVAiOiIyMDMuMC4xMTMuNzMiLCJUaW1lIjoxNzAwMjU5MjAwLCJGcmllbmRse"
+  "U5hbWUiOiJ3b3Jrc3RhdGlvbi03MiJ9LHsiTWlkIjoiOWE1ZjA0YzU1MDNiMTE2MDZlNDY0NGUwZDQ4ODdkNmUxMjBhNTc4NzU3N"
+  "TYzZTY4ZDFmMGUyMmQ0YWU1NmFkNyIsIklQIjoiMjAzLjAuMTEzLjc0IiwiVGltZSI6MTcwMDI2MjgwMCwiRnJpZW5kbHlOYW1lI"
+  "joid29ya3N0YXRpb24tNzMifSx7Ik1pZCI6IjY3NWRiZDk5NTZlMjQ2YTM5NWRmZWZmOGY2ZjQ1NzJiYzJjM2JkYWJjNGUwMWZiY"
+  "2Q5NTA0YmNhN2E1YzU5MzQiLCJJUCI6IjIwMy4wLjExMy43NSIsIlRpbWUiOjE3MDAyNjY0MDAsIkZyaWVuZGx5TmFtZSI6Indvc"
+  "mtzdGF0aW9uLTc0In0seyJNaWQiOiIwYWZlZjhiMGJhZjNhOGM4MGJjMmIwOGE5ZjVjMDI2NjE0NDk3NzFkODMzNDI0ZDYxZmNkM"
+  "jU0OTEyMTUzMTBhIiwiSVAiOiIyMDMuMC4xMTMuNzYiLCJUaW1lIjoxNzAwMjcwMDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3Rhd"
+  "Glvbi03NSJ9LHsiTWlkIjoiNTNlNTM1NmI2YjNkYWNkOGU3ZjA1NTU0YjFlMWUwZWUwYWM0MTRmNWM1MDBiZDZjZGFmNWFjNjg2M"
+  "GFhOGE1ZiIsIklQIjoiMjAzLjAuMTEzLjc3IiwiVGltZSI6MTcwMDI3MzYwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tN"
+  "zYifSx7Ik1pZCI6IjgyZjE0ZDJkOWQwMjQzYzgzZGU4MmViMzFmOTYyODhiNmQ4ZWFjZjMxNDkxNGJjNzgxZWYwMjIxNmVmMjlhN"
+  "TQiLCJJUCI6IjIwMy4wLjExMy43OCIsIlRpbWUiOjE3MDAyNzcyMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTc3In0se"
+  "yJNaWQiOiIzNThhNTU3Zjc4ODE3NTkyY2U2M2RmYTFjN2VmNjg1M2FjNTRmZmY4YjNmYTVhM2JjMzRmOWFjNWEwYTZlMzllIiwiS"
+  "VAiOiIyMDMuMC4xMTMuNzkiLCJUaW1lIjoxNzAwMjgwODAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi03OCJ9LHsiTWlkI"
+  "joiYmJmNjViNjY5OTcyZDA2MjYzNzM5MzYwODFkMjhhMGRiNTA2NTczNjM4YWNjMDJkMzg0ZGIwMDFkYzViYjRiYiIsIklQIjoiM"
+  "jAzLjAuMTEzLjgwIiwiVGltZSI6MTcwMDI4NDQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tNzkifSx7Ik1pZCI6Ijg0N"
+  "TU0NDMzNTkzZmRlMDE3ZDQ3MDdiNzJmY2RhZjE3MWU3MTU2MjgyYTJhMmQ5MmU3NDU5ZGEzZDUxZjM1MTkiLCJJUCI6IjIwMy4wL"
+  "jExMy44MSIsIlRpbWUiOjE3MDAyODgwMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTgwIn0seyJNaWQiOiIxYTEzNmM1N"
+  "zZkOGUyN2UwN2MzNmQyOWJhNzhhNzFjZGQyNDIyMTY4M2NmODYzZmU5MmY0NDJmZDQwNTEyM2E3IiwiSVAiOiIyMDMuMC4xMTMuO"
+  "DIiLCJUaW1lIjoxNzAwMjkxNjAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi04MSJ9LHsiTWlkIjoiMTc4YjViZDg1ZWU1M"
+  "DQyZDc0ODMzYzI3MDQxYjI5YWU2OTZmYTRiYjc4NDBkZDUxOTgzZWJmN2M5OWMxOGZhNiIsIklQIjoiMjAzLjAuMTEzLjgzIiwiV"
+  "GltZSI6MTcwMDI5NTIwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tODIifSx7Ik1pZCI6ImViOWViMmI2N2Q4YjA4MWFiZ"
+  "DFkOTdhYWYzNWYzYjY4ZjE0YWRlOWQ0YTQ1NWI4MTdhMTUxZGQ2NGIzMzhlYzgiLCJJUCI6IjIwMy4wLjExMy44NCIsIlRpbWUiO"
+  "jE3MDAyOTg4MDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTgzIn0seyJNaWQiOiIwY2M1YzBiM2FhNDE2NjA3OTM2NzdmY"
+  "TMxYTJlMzc2ZTlkYjA3M2FjN2Q3YTdjMTk4ZmZlMDFjZTc1ZmM1MzhlIiwiSVAiOiIyMDMuMC4xMTMuODUiLCJUaW1lIjoxNzAwM"
+  "zAyNDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi04NCJ9LHsiTWlkIjoiMjllNjAyMjI1YjBkZGU5YmI1M2YzYjk2N2NiY"
+  "Tg5MmIzYmE0YTNhNWQwYjdjMDU2ZWJjODc1ZTViMTBjN2FjMSIsIklQIjoiMjAzLjAuMTEzLjg2IiwiVGltZSI6MTcwMDMwNjAwM"
+  "CwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tODUifSx7Ik1pZCI6ImZmNjUyNTU4NDVhOTRmMzQ4OTk2N2VhNGJmZTUxMzIxN"
+  "DgyNTAwN2UyZTc1NmFhMDRhYjIyMDMxNTk4OTI2ZTgiLCJJUCI6IjIwMy4wLjExMy44NyIsIlRpbWUiOjE3MDAzMDk2MDAsIkZya"
+  "WVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTg2In0seyJNaWQiOiIwMTk3OTJmNGNlY2U2Nzg4NzQ5YzE3MzZlYmViZjBiYzY1YmZjN"
+  "TRkNWY2NjdiMzg4YjNmOWM2YWQwOTg0NDU5IiwiSVAiOiIyMDMuMC4xMTMuODgiLCJUaW1lIjoxNzAwMzEzMjAwLCJGcmllbmRse"
+  "U5hbWUiOiJ3b3Jrc3RhdGlvbi04NyJ9LHsiTWlkIjoiM2RlZGQ2MzRkNTRhN2RjODQzNTY1ZjZlZjMwNmUxM2Q2OTc1YmIzZjI1O"
+  "TQ4MzExNjc2Mjg4MjhmNTgwOWU3YiIsIklQIjoiMjAzLjAuMTEzLjg5IiwiVGltZSI6MTcwMDMxNjgwMCwiRnJpZW5kbHlOYW1lI"
+  "joid29ya3N0YXRpb24tODgifSx7Ik1pZCI6IjdkMzcwM2EzZWYwNzZiMWFjZGM3OWQyZWRmODVkZDYxNmU3MzJiZDAwOGY1NmY0O"
+  "WQ2NGMwOTBjZWE3YTI0MTIiLCJJUCI6IjIwMy4wLjExMy45MCIsIlRpbWUiOjE3MDAzMjA0MDAsIkZyaWVuZGx5TmFtZSI6Indvc"
+  "mtzdGF0aW9uLTg5In0seyJNaWQiOiI5MTk5NTMyMjkwYjVjZDMzZTlmZWMzZDdjNmFmY2M4MzFlODY0ZWM4YjQ1ZDQ4NzMwZDIxZ"
+  "TllMjMzYzkwY2I0IiwiSVAiOiIyMDMuMC4xMTMuOTEiLCJUaW1lIjoxNzAwMzI0MDAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3Rhd"
+  "Glvbi05MCJ9LHsiTWlkIjoiZjIwMDQ3MjI2MjQ5ZGU4N2ExM2Q5MTMzZDI2OGY5NWQwOWVhOTgyM2ZhN2IzYTk5YjdkODdkZTg2N"
+  "DQwMjg1YiIsIklQIjoiMjAzLjAuMTEzLjkyIiwiVGltZSI6MTcwMDMyNzYwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tO"
+  "TEifSx7Ik1pZCI6Ijg2Y2U1MzkzNWZkMTZjY2Q2YjljY2M2YzRhZTEyNzI1YjhlZmE5YjU1NTI0NmZhMzQ0N2E5OTI4NmMwZDdjZ"
+  "TAiLCJJUCI6IjIwMy4wLjExMy45MyIsIlRpbWUiOjE3MDAzMzEyMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTkyIn0se"
+  "yJNaWQiOiJlYzAzN2M4NzAzZWQyN2U5NjFiMTMwZjRjNGU4YmM1NjJhZDY5YTFiMzFhODg4ZGVlZWVhMzUzNzQ2NDZmYTZhIiwiS"
+  "VAiOiIyMDMuMC4xMTMuOTQiLCJUaW1lIjoxNzAwMzM0ODAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi05MyJ9LHsiTWlkI"
+  "joiZWYxNTE1ZTIyZTAwZmQyZDc0MWQ3YTlmZGMxMGExZDY3YTAwMzFkZmZiM2NhMGM4ZDJmYzNmM2MzZmQwM2Y5MSIsIklQIjoiM"
+  "jAzLjAuMTEzLjk1IiwiVGltZSI6MTcwMDMzODQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tOTQifSx7Ik1pZCI6ImQ4M"
+  "GY3YmVjMzkxYTk3YzBkZTRmOTE5MDRhMTcwNTg3YzdhNDM3ZWNiNGU1OWIwOGYxMzUwYzJhYTI0YzQ5MTMiLCJJUCI6IjIwMy4wL"
+  "jExMy45NiIsIlRpbWUiOjE3MDAzNDIwMDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTk1In0seyJNaWQiOiJlNGYzNjQ5N"
+  "zAxODM1ZWE0NWFjNGU4ODU0YjQ3MDM2OTA5YTM5ZTVlMzJiYzU1NjIwMmMyNDdlMWRlMzBjYTY3IiwiSVAiOiIyMDMuMC4xMTMuO"
+  "TciLCJUaW1lIjoxNzAwMzQ1NjAwLCJGcmllbmRseU5hbWUiOiJ3b3Jrc3RhdGlvbi05NiJ9LHsiTWlkIjoiZGJlYjRjMjlkOTkzN"
+  "mRhZTk2ZjljMjNlMmVkOGY4YzM3NWQ2MGZjYWMzMmM0OWQ0OWFlZTlmNDU4MGQwOGZiNiIsIklQIjoiMjAzLjAuMTEzLjk4IiwiV"
+  "GltZSI6MTcwMDM0OTIwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tOTcifSx7Ik1pZCI6ImQwZWQ2MjI3OWM2ZGJlZGJjM"
+  "zcyOTNlZGJkNTdkYThjYWZlMWY2MTUxYjkyNjdmOWVkMjEyNTYyYzQ5YjI0YWQiLCJJUCI6IjIwMy4wLjExMy45OSIsIlRpbWUiO"
+  "jE3MDAzNTI4MDAsIkZyaWVuZGx5TmFtZSI6IndvcmtzdGF0aW9uLTk4In0seyJNaWQiOiI3MzEyZmExYzhiZTc4NWU1NWViNGMyN"
+  "jliODczYWM3YTAwZWRiOWY3Nzk2YmZiYzIwMGNhZjZkNmYxZjZhZjA4IiwiSVAiOiIyMDMuMC4xMTMuMTAwIiwiVGltZSI6MTcwM"
+  "DM1NjQwMCwiRnJpZW5kbHlOYW1lIjoid29ya3N0YXRpb24tOTkifV0sIlRyaWFsQWN0aXZhdGlvbiI6ZmFsc2UsIk1heE5vT2ZNY"
+  "WNoaW5lcyI6MTAwLCJBbGxvd2VkTWFjaGluZXMiOiIiLCJEYXRhT2JqZWN0cyI6W3siSWQiOjExLCJOYW1lIjoidXNhZ2Vjb3Vud"
+  "CIsIlN0cmluZ1ZhbHVlIjoiIiwiSW50VmFsdWUiOjQyfV0sIlNpZ25EYXRlIjoxNzAwMDA2NDAwLCJSZXNlbGxlciI6bnVsbH0=\""
+  ",\"signature\":\"T3Ch59vghZ0qTNOXoxILFdbUVz99y8VsU/haUAJFBtXMy5dyfXz+PFUVUoov9jAhPwhEc16L6Y1u5DaGyxf4z0"
+  "tVnu+2PEQFGHbCUW7voY/ZKv9tXkycHll9hX18pTC4SxdeLSWqtf9/pUi1EuCZUWJP9VwSjZxTab7P/0tOaEE4DV9sruACps1oS2"
+  "lCw2RC/7Hy7YZmubvFqUEesMqNCr4SnHNqdQqnMTQ3JSAfKDeLblfOerGFVoPlSGPzfWW60k/jPF4YA0/E2sekvaYhl+Ul5RItJ9"
+  "8OAj++OnxH3xgU6ox3PtnPjgwqoG1S/RLT/qZH8XMnj4dInrpMaP7WqA==\",\"result\":0,\"message\":\"\"}";
+
+} // namespace cryptolens_bench
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifdef CRYPTOLENS_BENCH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "local_server.hpp"
+
+namespace cryptolens_bench {
+
+namespace {
+
+bool
+write_all(int fd, char const* p, std::size_t n)
+{
+  while (n > 0) {
+    ssize_t k = ::send(fd, p, n, MSG_NOSIGNAL);
+    if (k <= 0) { return false; }
+    p += k; n -= k;
+  }
+
+  return true;
+}
+
+// Returns the value of a header, or an empty string if it is not present
+std::string
+header_value(std::string const& headers, char const* name)
+{
+  std::string lower(headers);
+  std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+
+  std::string needle = std::string("\r\n") + name + ":";
+  std::size_t i = lower.find(needle);
+  if (i == std::string::npos) { return ""; }
+
+  i += needle.size();
+  std::size_t j = headers.find("\r\n", i);
+  std::string value = headers.substr(i, j - i);
+  value.erase(0, value.find_first_not_of(" \t"));
+
+  return value;
+}
+
+#ifdef CRYPTOLENS_BENCH_ZLIB
+std::string
+gzip(std::string const& s)
+{
+  z_stream z;
+  std::memset(&z, 0, sizeof(z));
+  // 16 added to the window bits selects the gzip format
+  if (deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) { throw std::runtime_error("deflateInit2() failed"); }
+
+  std::string out(deflateBound(&z, s.size()), '\0');
+  z.next_in = (Bytef *)s.data();
+  z.avail_in = (uInt)s.size();
+  z.next_out = (Bytef *)&out[0];
+  z.avail_out = (uInt)out.size();
+  int r = deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  if (r != Z_STREAM_END) { throw std::runtime_error("deflate() failed"); }
+
+  return out;
+}
+#endif
+
+} // namespace
+
+LocalServer::LocalServer(std::string response, int status)
+: response_(), headers_size_(0), gzip_response_(), url_(), listen_fd_(-1), requests_(0), slow_every_n_(0), slow_delay_ms_(0)
+, bytes_per_second_(0), bytes_sent_(0), stop_(false)
+{
+  // The reason phrase is not used by clients
+  std::string status_line = "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK\r\n" : " Error\r\n");
+
+#ifdef CRYPTOLENS_BENCH_ZLIB
+  std::string compressed = gzip(response);
+  gzip_response_ = status_line + "Content-Type: application/json; charset=utf-8\r\nContent-Encoding: gzip\r\nContent-Length: ";
+  gzip_response_ += std::to_string(compressed.size());
+  gzip_response_ += "\r\n\r\n";
+  gzip_response_ += compressed;
+#endif
+
+  response_ = status_line + "Content-Type: application/json; charset=utf-8\r\nContent-Length: ";
+  response_ += std::to_string(response.size());
+  response_ += "\r\n\r\n";
+  headers_size_ = response_.size();
+  response_ += response;
+
+  listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) { throw std::runtime_error("socket() failed"); }
+
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+
+  socklen_t len = sizeof(addr);
+  if (::bind(listen_fd_, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+      ::listen(listen_fd_, 128) != 0 ||
+      ::getsockname(listen_fd_, (sockaddr *)&addr, &len) != 0)
+  {
+    ::close(listen_fd_);
+    throw std::runtime_error("could not listen on 127.0.0.1");
+  }
+
+  url_ = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+
+  accept_thread_ = std::thread(&LocalServer::accept_loop, this);
+}
+
+LocalServer::~LocalServer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    for (int fd : connections_) { ::shutdown(fd, SHUT_RDWR); }
+  }
+
+  ::shutdown(listen_fd_, SHUT_RDWR);
+  accept_thread_.join();
+  ::close(listen_fd_);
+
+  for (std::thread & t : threads_) { t.join(); }
+  for (int fd : connections_) { ::close(fd); }
+}
+
+void
+LocalServer::accept_loop()
+{
+  for (;;) {
+    int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) { return; }
+
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stop_) { ::close(fd); return; }
+
+    connections_.push_back(fd);
+    threads_.push_back(std::thread(&LocalServer::serve, this, fd));
+  }
+}
+
+void
+LocalServer::serve(int fd)
+{
+  std::string buffer;
+  char chunk[16384];
+
+  for (;;) {
+    std::size_t end;
+    while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+      ssize_t k = ::recv(fd, chunk, sizeof(chunk), 0);
+      if (k <= 0) { return; }
+      buffer.append(chunk, k);
+    }
+
+    std::string headers = buffer.substr(0, end + 2);
+    std::size_t body_size = std::strtoul(header_value(headers, "content-length").c_str(), nullptr, 10);
+
+    if (header_value(headers, "expect") == "100-continue") {
+      static char const CONTINUE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+      if (!write_all(fd, CONTINUE, sizeof(CONTINUE) - 1)) { return; }
+    }
+
+    while (buffer.size() < end + 4 + body_size) {
+      ssize_t k = ::recv(fd, chunk, sizeof(chunk), 0);
+      if (k <= 0) { return; }
+      buffer.append(chunk, k);
+    }
+
+    buffer.erase(0, end + 4 + body_size);
+
+    unsigned long n = ++requests_;
+    unsigned long every_n = slow_every_n_;
+    if (every_n != 0 && n % every_n == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(slow_delay_ms_));
+    }
+
+    std::string const& response = !gzip_response_.empty() && header_value(headers, "accept-encoding").find("gzip") != std::string::npos ? gzip_response_ : response_;
+    std::size_t size = headers.compare(0, 5, "HEAD ") == 0 ? headers_size_ : response.size();
+
+    unsigned long bytes_per_second = bytes_per_second_;
+    if (bytes_per_second != 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(1000000ULL * size / bytes_per_second));
+    }
+
+    bytes_sent_ += size;
+    if (!write_all(fd, response.data(), size)) { return; }
+  }
+}
+
+} // namespace cryptolens_bench
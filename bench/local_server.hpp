@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cryptolens_bench {
+
+// A minimal HTTP/1.1 server listening on 127.0.0.1, standing in for the Web
+// API in the benchmarks. Every request is answered with the same response
+// and HTTP status, and connections are kept alive between requests. If the benchmarks are
+// built with zlib, the response is sent gzip compressed to clients that
+// accept it.
+class LocalServer {
+public:
+  explicit LocalServer(std::string response, int status = 200);
+  LocalServer(LocalServer const&) = delete;
+  void operator=(LocalServer const&) = delete;
+  ~LocalServer();
+
+  // Returns e.g. "http://127.0.0.1:45678", which can be passed as the host
+  // to RequestHandler_curl::post_request().
+  std::string const& get_url() const { return url_; }
+
+  unsigned long get_requests() const { return requests_; }
+
+  // Returns the number of bytes sent in responses, including the headers
+  unsigned long get_bytes_sent() const { return bytes_sent_; }
+
+  // Delays the response to every n-th request by delay_ms milliseconds,
+  // standing in for e.g. a lost packet or a slow server.
+  void set_slow_requests(unsigned long every_n, unsigned long delay_ms) { slow_every_n_ = every_n; slow_delay_ms_ = delay_ms; }
+
+  // Delays each response by the time it takes to send it at the given number
+  // of bytes per second, standing in for a slow network. 0 means no delay.
+  void set_bandwidth(unsigned long bytes_per_second) { bytes_per_second_ = bytes_per_second; }
+
+private:
+  void accept_loop();
+  void serve(int fd);
+
+  std::string response_;
+  std::size_t headers_size_; // Length of the part of response_ sent for a HEAD request
+  std::string gzip_response_; // Empty if the benchmarks are built without zlib
+  std::string url_;
+  int listen_fd_;
+  std::atomic<unsigned long> requests_;
+  std::atomic<unsigned long> slow_every_n_;
+  std::atomic<unsigned long> slow_delay_ms_;
+  std::atomic<unsigned long> bytes_per_second_;
+  std::atomic<unsigned long> bytes_sent_;
+
+  std::mutex mutex_;
+  bool stop_;
+  std::vector<int> connections_;
+  std::vector<std::thread> threads_;
+  std::thread accept_thread_;
+};
+
+} // namespace cryptolens_bench
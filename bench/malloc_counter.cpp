@@ -0,0 +1,65 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+
+#include "malloc_counter.hpp"
+
+namespace cryptolens_bench {
+
+namespace {
+
+std::atomic<std::uint64_t> mallocs(0);
+
+} // namespace
+
+#ifdef __GLIBC__
+
+bool counting_mallocs() { return true; }
+
+#else
+
+bool counting_mallocs() { return false; }
+
+#endif
+
+std::uint64_t get_mallocs() { return mallocs.load(std::memory_order_relaxed); }
+
+} // namespace cryptolens_bench
+
+#ifdef __GLIBC__
+
+// The glibc implementations, which remain available under these names when
+// the functions are replaced
+extern "C" void *__libc_malloc(std::size_t size);
+extern "C" void *__libc_calloc(std::size_t n, std::size_t size);
+extern "C" void *__libc_realloc(void *ptr, std::size_t size);
+extern "C" void __libc_free(void *ptr);
+
+extern "C" void *
+malloc(std::size_t size)
+{
+  cryptolens_bench::mallocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+extern "C" void *
+calloc(std::size_t n, std::size_t size)
+{
+  cryptolens_bench::mallocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(n, size);
+}
+
+extern "C" void *
+realloc(void *ptr, std::size_t size)
+{
+  cryptolens_bench::mallocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void
+free(void *ptr)
+{
+  __libc_free(ptr);
+}
+
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cryptolens_bench {
+
+// Returns the number of calls to malloc(), calloc() and realloc() made by the
+// process so far, including those made by operator new. Counting is only
+// supported with glibc, where these functions are replaced by the benchmark
+// executable, otherwise counting_mallocs() returns false.
+bool counting_mallocs();
+std::uint64_t get_mallocs();
+
+} // namespace cryptolens_bench
@@ -0,0 +1,52 @@
+#pragma once
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+/*
+ * The values used for the fields_to_return argument of e.g.
+ * basic_Cryptolens::activate() and basic_Cryptolens::get_key(). Each value
+ * excludes one field of the license key, and several fields are excluded by
+ * combining the values, e.g. FieldsToReturn::CUSTOMER | FieldsToReturn::NOTES.
+ *
+ * The same values are used when parsing a license key, in order to skip
+ * fields that are not needed, see basic_Cryptolens::make_license_key(). Only
+ * the fields in SKIPPABLE can be skipped, since the other fields are always
+ * required by the response parsers.
+ */
+namespace FieldsToReturn {
+
+int constexpr PRODUCT_ID         = 1 << 0;
+int constexpr ID                 = 1 << 1;
+int constexpr KEY                = 1 << 2;
+int constexpr CREATED            = 1 << 3;
+int constexpr EXPIRES            = 1 << 4;
+int constexpr PERIOD             = 1 << 5;
+int constexpr FEATURES           = 1 << 6; // F1 to F8
+int constexpr NOTES              = 1 << 7;
+int constexpr BLOCK              = 1 << 8;
+int constexpr GLOBAL_ID          = 1 << 9;
+int constexpr CUSTOMER           = 1 << 10;
+int constexpr ACTIVATED_MACHINES = 1 << 11;
+int constexpr TRIAL_ACTIVATION   = 1 << 12;
+int constexpr MAX_NO_OF_MACHINES = 1 << 13;
+int constexpr ALLOWED_MACHINES   = 1 << 14;
+int constexpr DATA_OBJECTS       = 1 << 15;
+int constexpr SIGN_DATE          = 1 << 16;
+
+int constexpr SKIPPABLE =
+    ID | KEY | NOTES | GLOBAL_ID | CUSTOMER | ACTIVATED_MACHINES
+  | MAX_NO_OF_MACHINES | ALLOWED_MACHINES | DATA_OBJECTS;
+
+} // namespace FieldsToReturn
+
+} // namespace v20190401
+
+namespace latest {
+
+namespace FieldsToReturn = ::cryptolens_io::v20190401::FieldsToReturn;
+
+} // namespace latest
+
+} // namespace cryptolens_io
@@ -0,0 +1,517 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic_Cryptolens.hpp"
+#include "basic_Error.hpp"
+#include "Error.hpp"
+#include "LicenseKey.hpp"
+#include "RequestHandler_curl.hpp"
+#include "RequestHandler_curl_multi.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+namespace FloatingLeaseScheduler {}
+
+} // namespace errors
+
+/**
+ * Keeps a large number of floating licenses activated from a single thread.
+ *
+ * A floating activation only lasts for floating_time_interval seconds, see
+ * basic_Cryptolens::activate_floating(), and thus has to be repeated for as
+ * long as the application uses the license. With this class, each such lease
+ * is added once using add_lease(), after which the scheduler repeats the
+ * floating activation at a random point between one half and three quarters
+ * of the way through the interval, such that renewals of leases added at the
+ * same time are spread out. If a renewal fails because the Web API could not
+ * be reached, i.e. with an error that TransientErrors_curl considers
+ * transient, it is retried until the lease expires. The constructor thus
+ * turns on set_report_http_status() on the request handler.
+ *
+ * The renewals are kept in a timer wheel with a resolution of one second and
+ * are sent using the make_async() method of the request handler of the
+ * basic_Cryptolens object, i.e. the configuration has to use
+ * RequestHandler_curl_multi. All outstanding requests are thus driven by the
+ * background thread of the request handler, reusing its connections to the
+ * Web API.
+ *
+ * If a lease cannot be activated, or is lost since the Web API refused to
+ * renew it or since it expired, the callback given to add_lease() is called
+ * with the error and the lease is removed. The callback is called on the
+ * background thread of the request handler and should return quickly. It may
+ * call add_lease() and remove_lease(), but not shutdown().
+ *
+ * shutdown(), which is also called by the destructor, deactivates all
+ * remaining leases at the same time, such that the seats are immediately
+ * available to other machines. It returns once all requests are done and all
+ * callbacks have returned. The basic_Cryptolens object must outlive the
+ * scheduler, and its response parser and signature verifier are used from
+ * the background thread of the request handler.
+ *
+ * Example:
+ *
+ *     FloatingLeaseScheduler<Cryptolens> scheduler(e, cryptolens_handle);
+ *     FloatingLeaseScheduler<Cryptolens>::LeaseId lease =
+ *       scheduler.add_lease(e, token, product_id, key, 300,
+ *         [](FloatingLeaseScheduler<Cryptolens>::LeaseId, basic_Error & e) { STOP_USING_THE_SEAT(); });
+ */
+template<typename Cryptolens>
+class FloatingLeaseScheduler
+{
+public:
+  using LeaseId = std::uint64_t;
+  using LeaseLostCallback = std::function<void(LeaseId, basic_Error &)>;
+
+  FloatingLeaseScheduler(basic_Error & e, Cryptolens & cryptolens)
+  : cryptolens_(cryptolens), leases_(), wheel_(WHEEL_SLOTS), start_(std::chrono::steady_clock::now()), current_tick_(0)
+  , next_id_(1), removed_(0), in_flight_(0), stop_(false), random_(std::random_device()()), thread_()
+  {
+    // Responses from e.g. a load balancer are retried like other transient errors
+    TransientErrors_curl::setup(e, cryptolens_.request_handler);
+
+    try {
+      thread_ = std::thread(&FloatingLeaseScheduler::run, this);
+    } catch (std::system_error const&) {
+      // Reported by add_lease() in the same way as after shutdown()
+      stop_ = true;
+    }
+  }
+  FloatingLeaseScheduler(FloatingLeaseScheduler const&) = delete;
+  FloatingLeaseScheduler(FloatingLeaseScheduler &&) = delete;
+  void operator=(FloatingLeaseScheduler const&) = delete;
+  void operator=(FloatingLeaseScheduler &&) = delete;
+
+  ~FloatingLeaseScheduler()
+  {
+    shutdown();
+  }
+
+  /**
+   * Starts a floating activation of a license key and keeps renewing it until
+   * it is removed or lost. Returns immediately, the license key is available
+   * from get_license_key() once the first activation has succeeded.
+   *
+   * Arguments:
+   *   floating_time_interval - the same value as would be passed to
+   *                            basic_Cryptolens::activate_floating(), in seconds
+   *   on_lost - called if the lease could not be activated or is lost
+   */
+  LeaseId
+  add_lease
+    ( basic_Error & e
+    , std::string token
+    , int product_id
+    , std::string key
+    , long floating_time_interval
+    , LeaseLostCallback on_lost = LeaseLostCallback()
+    , int fields_to_return = 0
+    )
+  {
+    if (e) { return 0; }
+
+    std::string machine_code = cryptolens_.machine_code_computer.get_machine_code(e);
+    if (e) { return 0; }
+
+    Activation activation;
+    activation.token = std::move(token);
+    activation.product_id = product_id;
+    activation.key = std::move(key);
+    activation.machine_code = std::move(machine_code);
+    activation.interval_s = floating_time_interval > 1 ? floating_time_interval : 1;
+    activation.fields_to_return = fields_to_return;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (stop_) {
+        e.set(api::main(), errors::Subsystem::RequestHandler, errors::RequestHandler_curl_multi::SHUTDOWN);
+        return 0;
+      }
+
+      activation.id = next_id_++;
+      Lease & lease = leases_[activation.id];
+      lease.activation = activation;
+      lease.on_lost = std::move(on_lost);
+      lease.expires_tick = current_tick_;
+      lease.due_tick = -1;
+      in_flight_ += 1;
+    }
+
+    send_activate(activation);
+
+    return activation.id;
+  }
+
+  /**
+   * Stops renewing a lease and deactivates it. Does nothing if the lease
+   * has already been lost.
+   *
+   * If an activation of the lease is in flight, the lease is deactivated once
+   * that request is done, since a deactivation that reached the Web API first
+   * would not release the seat. on_lost is not called for a lease that has
+   * been removed.
+   */
+  void
+  remove_lease(LeaseId id)
+  {
+    Activation activation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      typename Leases::iterator it = leases_.find(id);
+      if (it == leases_.end() || it->second.removed) { return; }
+
+      if (it->second.due_tick == -1) {
+        // Deactivated by on_activated()
+        it->second.removed = true;
+        it->second.on_lost = LeaseLostCallback();
+        it->second.license_key = nullopt;
+        removed_ += 1;
+        return;
+      }
+
+      activation = std::move(it->second.activation);
+      leases_.erase(it);
+      in_flight_ += 1;
+    }
+
+    send_deactivate(activation);
+  }
+
+  /**
+   * Returns the license key from the most recent successful activation of
+   * the lease, or an empty optional if there has not been one or if the
+   * lease is no longer held.
+   */
+  optional<LicenseKey>
+  get_license_key(LeaseId id) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    typename Leases::const_iterator it = leases_.find(id);
+    if (it == leases_.end() || it->second.removed) { return nullopt; }
+
+    return it->second.license_key;
+  }
+
+  std::size_t
+  get_lease_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return leases_.size() - removed_;
+  }
+
+  /**
+   * Stops renewing the leases and deactivates all of them at the same time,
+   * returning once all requests are done. Errors when deactivating are
+   * ignored, since such a lease is released by the Web API anyway once its
+   * floating_time_interval has passed.
+   */
+  void
+  shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wakeup_.notify_all();
+
+    if (thread_.joinable()) { thread_.join(); }
+
+    std::vector<Activation> activations;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      // A renewal completing after the deactivation would take the seat again.
+      // Removed leases are deactivated once their renewal is done.
+      idle_.wait(lock, [this]() { return in_flight_ == 0; });
+
+      for (typename Leases::iterator it = leases_.begin(); it != leases_.end(); ++it) {
+        activations.push_back(std::move(it->second.activation));
+      }
+      leases_.clear();
+      in_flight_ += activations.size();
+    }
+
+    for (Activation const& activation : activations) { send_deactivate(activation); }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return in_flight_ == 0; });
+  }
+
+private:
+  static constexpr std::size_t WHEEL_SLOTS = 512;
+
+  using Response = RequestHandler_curl_multi_Response;
+
+  // Everything needed to make the requests for a lease
+  struct Activation {
+    Activation()
+    : id(0), token(), product_id(0), key(), machine_code(), interval_s(0), fields_to_return(0)
+    {}
+
+    LeaseId id;
+    std::string token;
+    int product_id;
+    std::string key;
+    std::string machine_code;
+    long interval_s;
+    int fields_to_return;
+  };
+
+  struct Lease {
+    Lease() : activation(), on_lost(), license_key(), expires_tick(0), due_tick(-1), removed(false) {}
+
+    Activation activation;
+    LeaseLostCallback on_lost;
+
+    optional<LicenseKey> license_key;
+    std::int64_t expires_tick; // The activation is valid before this tick
+    std::int64_t due_tick; // -1 while a request is in flight
+    bool removed; // remove_lease() was called while a request was in flight
+  };
+
+  using Leases = std::unordered_map<LeaseId, Lease>;
+
+  // A lease and the tick it was scheduled for. Entries are not removed from
+  // the wheel when a lease is removed or rescheduled, instead they are
+  // skipped if they no longer match the due_tick of the lease.
+  using Timer = std::pair<LeaseId, std::int64_t>;
+
+  std::int64_t
+  now_tick() const
+  {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+  // Assumes mutex_ is held
+  void
+  schedule(LeaseId id, Lease & lease, std::int64_t due_tick)
+  {
+    // The slot of the current tick has already been processed
+    if (due_tick <= current_tick_) { due_tick = current_tick_ + 1; }
+
+    lease.due_tick = due_tick;
+    wheel_[due_tick % WHEEL_SLOTS].push_back(Timer(id, due_tick));
+  }
+
+  void
+  run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<Activation> due;
+
+    while (!stop_) {
+      std::chrono::steady_clock::time_point next = start_ + std::chrono::seconds(current_tick_ + 1);
+      wakeup_.wait_until(lock, next, [this]() { return stop_; });
+      if (stop_) { break; }
+
+      std::int64_t now = now_tick();
+      while (current_tick_ < now) {
+        current_tick_ += 1;
+
+        std::vector<Timer> & slot = wheel_[current_tick_ % WHEEL_SLOTS];
+        std::vector<Timer> later;
+        for (Timer const& timer : slot) {
+          if (timer.second > current_tick_) { later.push_back(timer); continue; }
+
+          typename Leases::iterator it = leases_.find(timer.first);
+          if (it == leases_.end() || it->second.due_tick != timer.second) { continue; }
+
+          it->second.due_tick = -1;
+          due.push_back(it->second.activation);
+        }
+        slot.swap(later);
+      }
+
+      // The requests are started without holding the lock since the request
+      // handler may call the callback right away
+      in_flight_ += due.size();
+      lock.unlock();
+      for (Activation const& activation : due) { send_activate(activation); }
+      due.clear();
+      lock.lock();
+    }
+  }
+
+  void
+  send_activate(Activation const& activation)
+  {
+    Error e;
+
+    auto request = cryptolens_.request_handler.post_request(e, cryptolens_.get_base_url().c_str(), "/api/key/Activate");
+
+    std::ostringstream product_id_; product_id_ << activation.product_id;
+    std::ostringstream fields_to_return_; fields_to_return_ << activation.fields_to_return;
+    std::ostringstream floating_time_interval_; floating_time_interval_ << activation.interval_s;
+
+    LeaseId id = activation.id;
+    request.add_argument(e, "token"               , activation.token.c_str())
+           .add_argument(e, "ProductId"           , product_id_.str().c_str())
+           .add_argument(e, "Key"                 , activation.key.c_str())
+           .add_argument(e, "Sign"                , "true")
+           .add_argument(e, "MachineCode"         , activation.machine_code.c_str())
+           .add_argument(e, "FieldsToReturn"      , fields_to_return_.str().c_str())
+           .add_argument(e, "SignMethod"          , "1")
+           .add_argument(e, "ModelVersion"        , "3")
+           .add_argument(e, "v"                   , "1")
+           .add_argument(e, "FloatingTimeInterval", floating_time_interval_.str().c_str())
+           .make_async(e, [this, id](Response r) { this->on_activated(id, r); });
+
+    if (e) { on_activated(id, Response(e.get_reason(), e.get_extra(), "")); }
+  }
+
+  // Called on the background thread of the request handler. The request
+  // counts as in flight until this method returns, such that shutdown() does
+  // not return while on_lost is running.
+  void
+  on_activated(LeaseId id, Response const& r)
+  {
+    Error e;
+    optional<LicenseKey> license_key = handle_activate(e, cryptolens_.response_parser, cryptolens_.signature_verifier, r.get(e));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // The lease may have been lost while the request was in flight
+    typename Leases::iterator it = leases_.find(id);
+    if (it == leases_.end()) { request_done(); return; }
+    Lease & lease = it->second;
+
+    if (lease.removed) {
+      // The request stays in flight as the deactivation
+      Activation activation = std::move(lease.activation);
+      leases_.erase(it);
+      removed_ -= 1;
+      lock.unlock();
+
+      send_deactivate(activation);
+      return;
+    }
+
+    if (!e) {
+      Activation const& a = lease.activation;
+      typename internal::ActivateEnvironment env(license_key->get_license_key_information(), a.product_id, a.key, a.machine_code, a.fields_to_return, true);
+      cryptolens_.activate_validator.validate(e, env);
+    }
+
+    std::int64_t now = now_tick();
+
+    if (!e) {
+      lease.license_key = std::move(license_key);
+      lease.expires_tick = now + lease.activation.interval_s;
+
+      std::uniform_int_distribution<long> delay(lease.activation.interval_s / 2, lease.activation.interval_s * 3 / 4);
+      schedule(id, lease, now + delay(random_));
+      request_done();
+      return;
+    }
+
+    // Only retry if the Web API could not be reached. Other errors, e.g. the
+    // Web API or a validator refusing the activation, or a response that
+    // cannot be parsed, would only happen again.
+    bool transient = e.get_subsystem() == errors::Subsystem::RequestHandler && TransientErrors_curl::is_transient(e.get_reason(), e.get_extra());
+    std::int64_t retry_tick = now + (lease.activation.interval_s / 16 > 1 ? lease.activation.interval_s / 16 : 1);
+    if (transient && retry_tick < lease.expires_tick && !stop_) {
+      schedule(id, lease, retry_tick);
+      request_done();
+      return;
+    }
+
+    LeaseLostCallback on_lost = std::move(lease.on_lost);
+    leases_.erase(it);
+    lock.unlock();
+
+    if (on_lost) { on_lost(id, e); }
+
+    lock.lock();
+    request_done();
+  }
+
+  void
+  send_deactivate(Activation const& activation)
+  {
+    Error e;
+
+    auto request = cryptolens_.request_handler.post_request(e, cryptolens_.get_base_url().c_str(), "/api/key/Deactivate");
+
+    std::ostringstream product_id_; product_id_ << activation.product_id;
+
+    request.add_argument(e, "token"       , activation.token.c_str())
+           .add_argument(e, "ProductId"   , product_id_.str().c_str())
+           .add_argument(e, "Key"         , activation.key.c_str())
+           .add_argument(e, "MachineCode" , activation.machine_code.c_str())
+           .add_argument(e, "Floating"    , "true")
+           .add_argument(e, "v"           , "1")
+           .make_async(e, [this](Response r) { this->on_deactivated(r); });
+
+    if (e) { on_deactivated(Response(e.get_reason(), e.get_extra(), "")); }
+  }
+
+  // Called on the background thread of the request handler
+  void
+  on_deactivated(Response const& r)
+  {
+    Error e;
+    cryptolens_.response_parser.parse_deactivate_response(e, r.get(e));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    request_done();
+  }
+
+  // Assumes mutex_ is held
+  void
+  request_done()
+  {
+    in_flight_ -= 1;
+    if (in_flight_ == 0) { idle_.notify_all(); }
+  }
+
+  Cryptolens & cryptolens_;
+
+  mutable std::mutex mutex_; // Guards all members below
+  std::condition_variable wakeup_;
+  std::condition_variable idle_; // Signalled when in_flight_ becomes 0
+  Leases leases_;
+  std::vector<std::vector<Timer>> wheel_;
+  std::chrono::steady_clock::time_point start_; // Tick 0
+  std::int64_t current_tick_; // All slots up to and including this tick have been processed
+  LeaseId next_id_;
+  std::size_t removed_; // Leases in leases_ that have been removed
+  std::size_t in_flight_; // Requests that have been sent and whose callbacks have not returned
+  bool stop_;
+  std::mt19937 random_;
+
+  std::thread thread_;
+};
+
+template<typename Cryptolens>
+constexpr std::size_t FloatingLeaseScheduler<Cryptolens>::WHEEL_SLOTS;
+
+} // namespace v20190401
+
+namespace latest {
+
+template<typename Cryptolens>
+using FloatingLeaseScheduler = ::cryptolens_io::v20190401::FloatingLeaseScheduler<Cryptolens>;
+
+} // namespace latest
+
+} // namespace cryptolens_io
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ParseLimits.hpp"
+#include "StringView.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace internal {
+
+// Minimal pull parser for JSON text which does not allocate any memory.
+//
+// The scanner walks over the text one value at a time. Objects and arrays
+// are entered using enter_object() and enter_array(), after which their
+// members are visited using next_key() and next_element() respectively.
+// Strings are returned as references into the original text together with
+// a flag telling if they contain escape sequences, in which case unescape()
+// has to be used to obtain the actual contents.
+//
+// Any syntax error makes the scanner fail permanently, after which all
+// functions return false or TYPE_INVALID. Only the parts of the text that
+// are actually visited are validated, in particular anything following the
+// first value is ignored.
+//
+// The scanner also fails if objects and arrays are nested more deeply than
+// the maximum depth, or once the deadline given to set_deadline() has
+// passed, in which case exceeded() tells which limit was hit.
+class JsonScanner {
+public:
+  enum Type
+    { TYPE_INVALID
+    , TYPE_OBJECT
+    , TYPE_ARRAY
+    , TYPE_STRING
+    , TYPE_NUMBER
+    , TYPE_TRUE
+    , TYPE_FALSE
+    , TYPE_NULL
+    };
+
+  enum Limit
+    { LIMIT_NONE
+    , LIMIT_DEPTH
+    , LIMIT_ELEMENTS
+    , LIMIT_TIME
+    };
+
+  static int constexpr MAX_DEPTH = 64;
+
+  JsonScanner()
+  : p_(nullptr), end_(nullptr), first_(false), failed_(true)
+  , depth_(0), max_depth_(MAX_DEPTH), deadline_(nullptr), exceeded_(LIMIT_NONE)
+  {}
+  JsonScanner(char const* begin, char const* end)
+  : p_(begin), end_(end), first_(false), failed_(false)
+  , depth_(0), max_depth_(MAX_DEPTH), deadline_(nullptr), exceeded_(LIMIT_NONE)
+  {}
+
+  bool failed() const { return failed_; }
+  char const* position() const { return p_; }
+
+  // Sets how deeply objects and arrays may be nested, counted from where the
+  // scanner started. Values outside 1 to MAX_DEPTH are replaced by MAX_DEPTH.
+  void set_max_depth(int max_depth) { max_depth_ = 0 < max_depth && max_depth < MAX_DEPTH ? max_depth : MAX_DEPTH; }
+
+  // The deadline is checked as the members of objects and arrays are visited,
+  // and may be shared between several scanners. Passing nullptr removes it.
+  void set_deadline(Deadline * deadline) { deadline_ = deadline; }
+
+  // Makes the scanner fail because the caller found that a limit was exceeded.
+  bool exceed(Limit limit);
+
+  // Returns the limit that made the scanner fail, or LIMIT_NONE if it did not
+  // fail or failed because of a syntax error.
+  Limit exceeded() const { return exceeded_; }
+
+  // Returns the type of the next value without consuming it.
+  Type peek();
+
+  // Consumes the '{' starting an object.
+  bool enter_object();
+
+  // Moves to the next member of the object most recently entered, and
+  // consumes its key and the following ':'. Returns false once the closing
+  // '}' has been consumed, or on error.
+  bool next_key(StringView & key, bool & escaped);
+
+  // Consumes the '[' starting an array.
+  bool enter_array();
+
+  // Moves to the next element of the array most recently entered. Returns
+  // false once the closing ']' has been consumed, or on error.
+  bool next_element();
+
+  // Consumes a string. The returned view excludes the quotes and any escape
+  // sequences are left as is.
+  bool read_string(StringView & value, bool & escaped);
+
+  // Consumes a number. is_unsigned is set if the number is an integer
+  // without sign, fraction or exponent which fits in 64 bits, in which case
+  // value holds the number.
+  bool read_number(std::uint64_t & value, bool & is_unsigned);
+
+  // Consumes a number. is_integer is set if the number is an integer without
+  // fraction or exponent which fits in 64 bits, in which case value holds the
+  // number.
+  bool read_int(std::int64_t & value, bool & is_integer);
+
+  // Consumes true or false.
+  bool read_bool(bool & value);
+
+  // Consumes the next value, including any nested values.
+  bool skip_value();
+
+  // Appends the contents of a string returned by read_string() or next_key()
+  // to out, replacing escape sequences with the characters they represent.
+  // The result is never longer than the input.
+  static void unescape(StringView raw, std::string & out);
+
+private:
+  void skip_whitespace();
+  bool fail();
+  bool literal(char const* s, std::size_t n);
+  bool number(std::uint64_t & magnitude, bool & negative, bool & is_integer);
+
+  char const* p_;
+  char const* end_;
+  bool first_; // Set if an object or array was just entered
+  bool failed_;
+  int depth_; // Number of objects and arrays entered but not yet left
+  int max_depth_;
+  Deadline *deadline_;
+  Limit exceeded_;
+};
+
+// FNV-1a hash of an object key. The hash of a string literal can be computed
+// at compile time, which allows dispatching on keys using a switch statement:
+//
+//     switch (json_key(key)) {
+//     case json_key("ProductId"): if (key == "ProductId") { ... } break;
+//     ...
+//     }
+//
+// The key must still be compared since different keys can have the same hash.
+std::uint32_t constexpr JSON_KEY_OFFSET_BASIS = 2166136261u;
+std::uint32_t constexpr JSON_KEY_PRIME = 16777619u;
+
+constexpr std::uint32_t
+json_key(char const* s, std::size_t n, std::uint32_t h)
+{
+  return n == 0 ? h : json_key(s + 1, n - 1, (h ^ (std::uint32_t)(unsigned char)*s) * JSON_KEY_PRIME);
+}
+
+template<std::size_t N>
+constexpr std::uint32_t
+json_key(char const (&s)[N])
+{
+  return json_key(s, N - 1, JSON_KEY_OFFSET_BASIS);
+}
+
+inline std::uint32_t
+json_key(StringView s)
+{
+  std::uint32_t h = JSON_KEY_OFFSET_BASIS;
+  for (char c : s) { h = (h ^ (std::uint32_t)(unsigned char)c) * JSON_KEY_PRIME; }
+  return h;
+}
+
+} // namespace internal
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
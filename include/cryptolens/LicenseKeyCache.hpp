@@ -0,0 +1,558 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "basic_Cryptolens.hpp"
+#include "basic_Error.hpp"
+#include "Error.hpp"
+#include "LicenseKey.hpp"
+#include "sha256.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+namespace LicenseKeyCache {}
+
+} // namespace errors
+
+/**
+ * Wraps a basic_Cryptolens object and remembers the license keys returned by
+ * activate() and get_key(), such that most calls can be answered without
+ * contacting the Web API.
+ *
+ * A license key is served from the cache as long as its SignDate is less
+ * than set_ttl() seconds ago. When a cached license key is returned less
+ * than set_refresh_ahead() seconds before it would become stale, a request
+ * to the Web API is made on a background thread, and the license key is
+ * replaced once the response arrives. Thus, with regular use, the calls
+ * return immediately and the cached license key never becomes stale.
+ * The refreshes are spread out by a random amount of up to the given jitter,
+ * to avoid many clients contacting the Web API at the same moment.
+ *
+ * Once a license key is stale, the call contacts the Web API in the same way
+ * as basic_Cryptolens. If this fails because the Web API could not be reached,
+ * i.e. the error is in the RequestHandler subsystem, the stale license key is
+ * returned instead as long as its SignDate is less than set_ttl() plus
+ * set_grace_period() seconds ago. Other errors, such as the license key
+ * having been blocked, are always returned to the caller.
+ *
+ * If set_directory() is used, the license keys are also saved in that
+ * directory using LicenseKey::to_string(), and are loaded from there the
+ * first time a license key is requested after the program starts. Saved
+ * license keys are checked in the same way as make_license_key() does, and
+ * then using the validators in the configuration of the basic_Cryptolens
+ * object. Errors when reading or writing the files are ignored.
+ *
+ * Entries are identified by all arguments, i.e. the access token, the
+ * product id, the license key string, fields_to_return and, for activate(),
+ * the friendly name. activate() and get_key() use separate entries.
+ *
+ * activate() and get_key() can be called from several threads at the same
+ * time. Only one thread at a time loads or fetches a given entry, and other
+ * threads asking for the same entry wait for it to finish, while requests for
+ * other entries go ahead. No locks are held while the wrapped basic_Cryptolens
+ * object is used. Since refreshes run on a background thread, the wrapped
+ * object must support being used from several threads at the same time, e.g.
+ * by using RequestHandler_curl_pool or RequestHandler_curl_multi. The
+ * destructor waits for any refresh that is in progress.
+ *
+ * Example:
+ *
+ *     LicenseKeyCache<Cryptolens> cache(e, cryptolens_handle);
+ *     cache.set_ttl(e, 24 * 3600);
+ *     cache.set_grace_period(e, 7 * 24 * 3600);
+ *     cache.set_directory(e, "/var/lib/example");
+ *
+ *     optional<LicenseKey> license_key = cache.activate(e, token, product_id, key);
+ */
+template<typename Cryptolens>
+class LicenseKeyCache
+{
+public:
+  LicenseKeyCache(basic_Error & e, Cryptolens & cryptolens)
+  : cryptolens_(cryptolens), directory_(), ttl_s_(3600), refresh_ahead_s_(600), jitter_s_(60), grace_s_(86400)
+  , entries_(), refreshes_(), random_(std::random_device()()), hits_(0), misses_(0)
+  {}
+  LicenseKeyCache(LicenseKeyCache const&) = delete;
+  LicenseKeyCache(LicenseKeyCache &&) = delete;
+  void operator=(LicenseKeyCache const&) = delete;
+  void operator=(LicenseKeyCache &&) = delete;
+
+  ~LicenseKeyCache()
+  {
+    std::vector<std::future<void>> refreshes;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      refreshes.swap(refreshes_);
+    }
+
+    for (std::future<void> & f : refreshes) { f.wait(); }
+  }
+
+  /**
+   * Sets the number of seconds after its SignDate that a license key is
+   * served from the cache. The default is 3600.
+   */
+  void set_ttl(basic_Error & e, long ttl_s)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttl_s_ = ttl_s > 0 ? ttl_s : 0;
+  }
+
+  /**
+   * Sets how many seconds before a cached license key becomes stale that it
+   * is refreshed in the background, and the largest number of seconds that
+   * is randomly added to this. The defaults are 600 and 60 seconds.
+   */
+  void set_refresh_ahead(basic_Error & e, long refresh_ahead_s, long jitter_s)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh_ahead_s_ = refresh_ahead_s > 0 ? refresh_ahead_s : 0;
+    jitter_s_ = jitter_s > 0 ? jitter_s : 0;
+  }
+
+  /**
+   * Sets for how many seconds after a license key has become stale it is
+   * still returned if the Web API cannot be reached. The default is 86400.
+   */
+  void set_grace_period(basic_Error & e, long grace_s)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    grace_s_ = grace_s > 0 ? grace_s : 0;
+  }
+
+  /**
+   * Sets a directory where license keys are saved, such that they survive
+   * restarts of the program. The directory must already exist. By default
+   * license keys are only kept in memory.
+   */
+  void set_directory(basic_Error & e, std::string directory)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = std::move(directory);
+  }
+
+  /**
+   * Same as basic_Cryptolens::activate(), except that the license key may be
+   * returned from the cache.
+   */
+  optional<LicenseKey>
+  activate
+    ( basic_Error & e
+    , std::string token
+    , int product_id
+    , std::string key
+    , int fields_to_return = 0
+    , char const* friendly_name = NULL
+    )
+  {
+    Request request(ACTIVATE, std::move(token), product_id, std::move(key), fields_to_return, friendly_name);
+    return lookup(e, request);
+  }
+
+  /**
+   * Same as basic_Cryptolens::get_key(), except that the license key may be
+   * returned from the cache.
+   */
+  optional<LicenseKey>
+  get_key
+    ( basic_Error & e
+    , std::string token
+    , int product_id
+    , std::string key
+    , int fields_to_return = 0
+    )
+  {
+    Request request(GET_KEY, std::move(token), product_id, std::move(key), fields_to_return, NULL);
+    return lookup(e, request);
+  }
+
+  /**
+   * Returns the number of calls where the license key was returned from the cache
+   * without contacting the Web API.
+   */
+  std::uint64_t get_cache_hits() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+
+  /**
+   * Returns the number of calls where the Web API had to be contacted.
+   */
+  std::uint64_t get_cache_misses() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+  /**
+   * Removes all license keys from memory. Saved license keys are not removed.
+   */
+  void clear_cache()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+  }
+
+private:
+  enum Kind { ACTIVATE, GET_KEY };
+
+  struct Request {
+    Request(Kind kind, std::string token, int product_id, std::string key, int fields_to_return, char const* friendly_name)
+    : kind(kind), token(std::move(token)), product_id(product_id), key(std::move(key)), fields_to_return(fields_to_return)
+    , has_friendly_name(friendly_name != NULL), friendly_name(friendly_name ? friendly_name : "")
+    {}
+
+    Kind kind;
+    std::string token;
+    int product_id;
+    std::string key;
+    int fields_to_return;
+    bool has_friendly_name;
+    std::string friendly_name;
+  };
+
+  using Id = std::tuple<int, std::string, int, std::string, int, bool, std::string>;
+
+  struct Entry {
+    Entry()
+    : license_key(), loaded(false), busy(false), refreshing(false), refresh_at(0)
+    , fetches(0), fetch_subsystem(errors::Subsystem::Ok), fetch_reason(0), fetch_extra(0)
+    {}
+
+    optional<LicenseKey> license_key;
+    bool loaded; // True once we have tried to load the license key from disk
+    bool busy; // True while a thread loads the license key or waits for the Web API
+    bool refreshing;
+    std::int64_t refresh_at;
+
+    // The outcome of the last call to the Web API made by lookup(), which is
+    // also given to the threads that waited for it
+    std::uint64_t fetches;
+    int fetch_subsystem;
+    int fetch_reason;
+    std::size_t fetch_extra;
+  };
+
+  static Id make_id(Request const& request)
+  {
+    return Id(request.kind, request.token, request.product_id, request.key, request.fields_to_return, request.has_friendly_name, request.friendly_name);
+  }
+
+  static std::int64_t now()
+  {
+    return (std::int64_t)std::time(NULL);
+  }
+
+  optional<LicenseKey>
+  lookup(basic_Error & e, Request const& request)
+  {
+    if (e) { return nullopt; }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Entries are shared with the threads using them, such that clear_cache()
+    // does not pull an entry away from under a load or fetch in progress
+    std::shared_ptr<Entry> & slot = entries_[make_id(request)];
+    if (!slot) { slot = std::make_shared<Entry>(); }
+    std::shared_ptr<Entry> entry = slot;
+    std::uint64_t fetches = entry->fetches;
+
+    for (;;) {
+      while (entry->busy) { changed_.wait(lock); }
+
+      if (!entry->loaded) {
+        entry->loaded = true;
+        if (directory_.empty()) { continue; }
+
+        entry->busy = true;
+        std::string file = path(request);
+        lock.unlock();
+
+        optional<LicenseKey> license_key = load(file, request);
+
+        lock.lock();
+        entry->busy = false;
+        changed_.notify_all();
+
+        if (license_key && !entry->license_key) {
+          // The key is refreshed on first use
+          entry->license_key = std::move(license_key);
+          entry->refresh_at = 0;
+        }
+        continue;
+      }
+
+      break;
+    }
+
+    std::int64_t t = now();
+    if (entry->license_key && t < (std::int64_t)entry->license_key->get_sign_date() + ttl_s_) {
+      hits_ += 1;
+
+      if (t >= entry->refresh_at && !entry->refreshing) {
+        entry->refreshing = true;
+        start_refresh(entry, request);
+      }
+
+      return entry->license_key;
+    }
+
+    // Another thread contacted the Web API while we were waiting
+    if (entry->fetches != fetches) {
+      if (entry->fetch_subsystem == errors::Subsystem::Ok) {
+        hits_ += 1;
+        return entry->license_key;
+      }
+
+      e.set(api::main(), entry->fetch_subsystem, entry->fetch_reason, entry->fetch_extra);
+      return fetch_failed(e, *entry);
+    }
+
+    misses_ += 1;
+    entry->busy = true;
+    lock.unlock();
+
+    optional<LicenseKey> license_key = fetch(e, request);
+
+    lock.lock();
+    entry->busy = false;
+    entry->fetches += 1;
+    entry->fetch_subsystem = e.get_subsystem(api::main());
+    entry->fetch_reason = e.get_reason(api::main());
+    entry->fetch_extra = e.get_extra(api::main());
+    changed_.notify_all();
+
+    if (e) { return fetch_failed(e, *entry); }
+
+    std::string saved = store(*entry, license_key);
+    std::string file = saved.empty() ? std::string() : path(request);
+    lock.unlock();
+
+    save(file, saved);
+
+    return license_key;
+  }
+
+  // Assumes mutex_ is held. Returns the stale license key instead of the error
+  // if the Web API could not be reached and the grace period has not passed.
+  optional<LicenseKey> fetch_failed(basic_Error & e, Entry const& entry)
+  {
+    if (e.get_subsystem(api::main()) == errors::Subsystem::RequestHandler &&
+        entry.license_key &&
+        now() < (std::int64_t)entry.license_key->get_sign_date() + ttl_s_ + grace_s_)
+    {
+      e.reset(api::main());
+      return entry.license_key;
+    }
+
+    return nullopt;
+  }
+
+  // Assumes mutex_ is held
+  void start_refresh(std::shared_ptr<Entry> const& entry, Request const& request)
+  {
+    std::vector<std::future<void>> running;
+    for (std::future<void> & f : refreshes_) {
+      if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        running.push_back(std::move(f));
+      }
+    }
+    refreshes_.swap(running);
+
+    refreshes_.push_back(std::async(std::launch::async, [this, entry, request]() { this->refresh(entry, request); }));
+  }
+
+  void refresh(std::shared_ptr<Entry> const& entry, Request const& request)
+  {
+    Error e;
+    optional<LicenseKey> license_key = fetch(e, request);
+
+    std::string saved;
+    std::string file;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      entry->refreshing = false;
+
+      if (e) {
+        // Try again a little later rather than on the next call
+        entry->refresh_at = now() + REFRESH_RETRY_S;
+        return;
+      }
+
+      saved = store(*entry, license_key);
+      if (!saved.empty()) { file = path(request); }
+    }
+
+    save(file, saved);
+  }
+
+  optional<LicenseKey>
+  fetch(basic_Error & e, Request const& request)
+  {
+    if (request.kind == ACTIVATE) {
+      return cryptolens_.activate
+        ( e
+        , request.token
+        , request.product_id
+        , request.key
+        , request.fields_to_return
+        , request.has_friendly_name ? request.friendly_name.c_str() : NULL
+        );
+    } else {
+      return cryptolens_.get_key(e, request.token, request.product_id, request.key, request.fields_to_return);
+    }
+  }
+
+  // Assumes mutex_ is held. Returns the string to save to disk, if any.
+  std::string store(Entry & entry, optional<LicenseKey> const& license_key)
+  {
+    std::int64_t jitter = 0;
+    if (jitter_s_ > 0) {
+      jitter = std::uniform_int_distribution<long>(0, jitter_s_)(random_);
+    }
+
+    entry.license_key = license_key;
+    entry.refresh_at = (std::int64_t)license_key->get_sign_date() + ttl_s_ - refresh_ahead_s_ - jitter;
+
+    return directory_.empty() ? std::string() : license_key->to_string();
+  }
+
+  // Reads a saved license key and checks it in the same way as a response
+  // from the Web API, returning nullopt if this fails
+  optional<LicenseKey> load(std::string const& file, Request const& request)
+  {
+    std::ifstream f(file, std::ios_base::in | std::ios_base::binary);
+    if (!f) { return nullopt; }
+
+    std::ostringstream s;
+    s << f.rdbuf();
+
+    Error e;
+    optional<LicenseKey> license_key = cryptolens_.make_license_key(e, s.str());
+    if (e) { return nullopt; }
+
+    if (request.kind == ACTIVATE) {
+      std::string machine_code = cryptolens_.machine_code_computer.get_machine_code(e);
+      typename internal::ActivateEnvironment env(license_key->get_license_key_information(), request.product_id, request.key, machine_code, request.fields_to_return, false);
+      cryptolens_.activate_validator.validate(e, env);
+    } else {
+      typename internal::GetKeyEnvironment env(license_key->get_license_key_information(), request.product_id, request.key, request.fields_to_return);
+      cryptolens_.get_key_validator.validate(e, env);
+    }
+    if (e) { return nullopt; }
+
+    return license_key;
+  }
+
+  void save(std::string const& file, std::string const& s)
+  {
+    if (s.empty()) { return; }
+
+    std::string tmp = file + ".tmp";
+
+    // Only one thread at a time writes to the temporary file
+    std::lock_guard<std::mutex> lock(disk_mutex_);
+
+    {
+      std::ofstream f(tmp, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+      if (!f) { return; }
+      f << s;
+      f.close();
+      if (!f) { std::remove(tmp.c_str()); return; }
+    }
+
+    if (std::rename(tmp.c_str(), file.c_str()) != 0) {
+      // On Windows rename() does not replace an existing file
+      std::remove(file.c_str());
+      if (std::rename(tmp.c_str(), file.c_str()) != 0) { std::remove(tmp.c_str()); }
+    }
+  }
+
+  // Assumes mutex_ is held
+  std::string path(Request const& request) const
+  {
+    static char const HEX[] = "0123456789abcdef";
+
+    unsigned char digest[internal::Sha256::DIGEST_SIZE];
+    internal::Sha256 h;
+    hash_string(h, request.token);
+    hash_string(h, request.key);
+    std::int64_t fields = request.fields_to_return;
+    h.update(&fields, sizeof(fields));
+    if (request.has_friendly_name) { hash_string(h, request.friendly_name); }
+    h.finish(digest);
+
+    std::ostringstream name;
+    name << directory_ << '/' << (request.kind == ACTIVATE ? "activate-" : "getkey-") << request.product_id << '-';
+    for (std::size_t i = 0; i < sizeof(digest); ++i) {
+      name << HEX[digest[i] >> 4] << HEX[digest[i] & 0xF];
+    }
+    name << ".skm";
+
+    return name.str();
+  }
+
+  static void hash_string(internal::Sha256 & h, std::string const& s)
+  {
+    std::uint64_t len = s.size();
+    h.update(&len, sizeof(len));
+    h.update(s.data(), s.size());
+  }
+
+  static const std::int64_t REFRESH_RETRY_S = 30;
+
+  Cryptolens & cryptolens_;
+  std::mutex disk_mutex_;
+
+  mutable std::mutex mutex_; // Guards all members below
+  std::condition_variable changed_; // Signalled when an entry is no longer busy
+  std::string directory_;
+  long ttl_s_;
+  long refresh_ahead_s_;
+  long jitter_s_;
+  long grace_s_;
+  std::map<Id, std::shared_ptr<Entry>> entries_;
+  std::vector<std::future<void>> refreshes_;
+  std::mt19937 random_;
+  std::uint64_t hits_;
+  std::uint64_t misses_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+template<typename Cryptolens>
+using LicenseKeyCache = ::cryptolens_io::v20190401::LicenseKeyCache<Cryptolens>;
+
+} // namespace latest
+
+} // namespace cryptolens_io
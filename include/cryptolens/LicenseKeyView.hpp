@@ -0,0 +1,378 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "imports/std/optional"
+
+#include "ActivationData.hpp"
+#include "basic_Error.hpp"
+#include "Customer.hpp"
+#include "DataObject.hpp"
+#include "JsonScanner.hpp"
+#include "LicenseKeyInformation.hpp"
+#include "ParseLimits.hpp"
+#include "RawLicenseKey.hpp"
+#include "StringView.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+class ActivationDataView;
+class DataObjectView;
+
+namespace internal {
+
+struct LicenseKeyView_Storage;
+
+void read_view(LicenseKeyView_Storage const& storage, JsonScanner & scanner, ActivationDataView & view);
+void read_view(LicenseKeyView_Storage const& storage, JsonScanner & scanner, DataObjectView & view);
+
+} // namespace internal
+
+/**
+ * Same as ActivationData, except that the strings refer to the buffer
+ * owned by the LicenseKeyView the object was obtained from.
+ */
+class ActivationDataView {
+public:
+  ActivationDataView() : mid_(), ip_(), time_(0), friendly_name_() {}
+  ActivationDataView(StringView mid, StringView ip, std::uint64_t time, optional<StringView> friendly_name)
+  : mid_(mid), ip_(ip), time_(time), friendly_name_(friendly_name)
+  {}
+
+  // Returns the machine id
+  StringView get_mid() const { return mid_; }
+
+  // Returns the IP when the machine was activated the first time
+  StringView get_ip() const { return ip_; }
+
+  // Returns the time the machine was activated the first time
+  std::uint64_t get_time() const { return time_; }
+
+  // Returns an optional with the friendly name for the machine, if any
+  optional<StringView> const& get_friendly_name() const { return friendly_name_; }
+
+  // Returns a copy of the data which does not refer to the LicenseKeyView
+  ActivationData to_activation_data() const;
+
+private:
+  StringView mid_;
+  StringView ip_;
+  std::uint64_t time_;
+  optional<StringView> friendly_name_;
+};
+
+/**
+ * Same as Customer, except that the strings refer to the buffer
+ * owned by the LicenseKeyView the object was obtained from.
+ */
+class CustomerView {
+public:
+  CustomerView() : id_(0), name_(), email_(), company_name_(), created_(0) {}
+  CustomerView(int id, StringView name, StringView email, StringView company_name, std::uint64_t created)
+  : id_(id), name_(name), email_(email), company_name_(company_name), created_(created)
+  {}
+
+  // Returns the id of the customer
+  int get_id() const { return id_; }
+
+  // Returns the name of the customer
+  StringView get_name() const { return name_; }
+
+  // Returns the email of the customer
+  StringView get_email() const { return email_; }
+
+  // Returns the company name of the customer
+  StringView get_company_name() const { return company_name_; }
+
+  // Returns the time when the customer was created
+  std::uint64_t get_created() const { return created_; }
+
+  // Returns a copy of the data which does not refer to the LicenseKeyView
+  Customer to_customer() const;
+
+private:
+  int id_;
+  StringView name_;
+  StringView email_;
+  StringView company_name_;
+  std::uint64_t created_;
+};
+
+/**
+ * Same as DataObject, except that the strings refer to the buffer
+ * owned by the LicenseKeyView the object was obtained from.
+ */
+class DataObjectView {
+public:
+  DataObjectView() : id_(0), name_(), string_value_(), int_value_(0) {}
+  DataObjectView(int id, StringView name, StringView string_value, int int_value)
+  : id_(id), name_(name), string_value_(string_value), int_value_(int_value)
+  {}
+
+  // Returns the id of the data object
+  int get_id() const { return id_; }
+
+  // Returns the name of the data object
+  StringView get_name() const { return name_; }
+
+  // Returns the string value of the data object
+  StringView get_string_value() const { return string_value_; }
+
+  // Returns the int value of the data object
+  int get_int_value() const { return int_value_; }
+
+  // Returns a copy of the data which does not refer to the LicenseKeyView
+  DataObject to_data_object() const;
+
+private:
+  int id_;
+  StringView name_;
+  StringView string_value_;
+  int int_value_;
+};
+
+/**
+ * An array in a LicenseKeyView, e.g. the activated machines.
+ *
+ * The elements are not stored separately, instead they are decoded from the
+ * license key each time the array is iterated over. Use to_vector() to
+ * decode all elements at once.
+ *
+ * The array keeps the buffer of the LicenseKeyView alive, but iterators
+ * must not be used after the array they were obtained from is destroyed.
+ */
+template<typename T>
+class LicenseKeyView_Array {
+public:
+  class const_iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T const*;
+    using reference = T const&;
+
+    const_iterator() : storage_(nullptr), scanner_(), index_(0), size_(0), value_() {}
+
+    reference operator*() const { return value_; }
+    pointer operator->() const { return &value_; }
+
+    const_iterator & operator++()
+    {
+      index_ += 1;
+      read();
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    bool operator==(const_iterator const& o) const { return index_ == o.index_; }
+    bool operator!=(const_iterator const& o) const { return index_ != o.index_; }
+
+  private:
+    friend class LicenseKeyView_Array;
+
+    const_iterator(internal::LicenseKeyView_Storage const* storage, char const* begin, char const* end, std::size_t size)
+    : storage_(storage), scanner_(begin, end), index_(0), size_(size), value_()
+    {
+      scanner_.enter_array();
+      read();
+    }
+
+    const_iterator(std::size_t size)
+    : storage_(nullptr), scanner_(), index_(size), size_(size), value_()
+    {}
+
+    void read()
+    {
+      // The array was validated when the LicenseKeyView was created,
+      // thus there is no need to check for errors here.
+      if (index_ < size_) {
+        scanner_.next_element();
+        internal::read_view(*storage_, scanner_, value_);
+      }
+    }
+
+    internal::LicenseKeyView_Storage const* storage_;
+    internal::JsonScanner scanner_;
+    std::size_t index_;
+    std::size_t size_;
+    T value_;
+  };
+
+  LicenseKeyView_Array
+    ( std::shared_ptr<internal::LicenseKeyView_Storage const> storage
+    , char const* begin
+    , char const* end
+    , std::size_t size
+    )
+  : storage_(std::move(storage)), begin_(begin), end_(end), size_(size)
+  {}
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const { return const_iterator(storage_.get(), begin_, end_, size_); }
+  const_iterator end() const { return const_iterator(size_); }
+
+  std::vector<T> to_vector() const
+  {
+    std::vector<T> v;
+    v.reserve(size_);
+    for (const_iterator it = begin(); it != end(); ++it) { v.push_back(*it); }
+    return v;
+  }
+
+private:
+  std::shared_ptr<internal::LicenseKeyView_Storage const> storage_;
+  char const* begin_;
+  char const* end_;
+  std::size_t size_;
+};
+
+/**
+ * An alternative to LicenseKey which does not copy the information in the
+ * license key into separate objects.
+ *
+ * The object keeps the decoded license key alive, and strings are returned
+ * as StringView objects referring to it. The arrays, i.e. the activated
+ * machines and the data objects, are decoded only when they are iterated
+ * over. This uses much less memory than LicenseKey when many license keys
+ * are kept in memory, or when a license key has many activated machines.
+ *
+ * The StringView objects returned remain valid as long as the LicenseKeyView
+ * or any copy of it exists. Copying a LicenseKeyView is cheap since the
+ * copies share the decoded license key.
+ *
+ * The class is constructed using the static factory make(), e.g.
+ *
+ *     optional<LicenseKeyView> key = LicenseKeyView::make(e, cryptolens_handle.activate_raw(e, ...));
+ *
+ * or using basic_Cryptolens::make_license_key_view().
+ *
+ * The license keys accepted, and the fields extracted from them, are the
+ * same as for ResponseParser_Streaming.
+ */
+class LicenseKeyView {
+public:
+  /**
+   * Creates a LicenseKeyView from a license key whose signature has been
+   * verified.
+   *
+   * Arguments:
+   *   e - Error object.
+   *   raw_license_key - The raw license key, which is consumed.
+   *
+   * Returns:
+   *   An optional with a LicenseKeyView, or an empty optional if the
+   *   license key could not be parsed.
+   */
+  static optional<LicenseKeyView> make(basic_Error & e, RawLicenseKey && raw_license_key);
+  static optional<LicenseKeyView> make(basic_Error & e, optional<RawLicenseKey> && raw_license_key);
+
+  std::string to_string() const;
+
+  /**
+   * Returns a copy of the information in the license key, with all arrays
+   * decoded.
+   */
+  LicenseKeyInformation to_license_key_information() const;
+
+  int           get_product_id() const { return product_id_; }
+  std::uint64_t get_created() const { return created_; }
+  std::uint64_t get_expires() const { return expires_; }
+  int           get_period() const { return period_; }
+  bool          get_block() const { return block_; }
+  bool          get_trial_activation() const { return trial_activation_; }
+  /**
+   * This field represents the time when the license key was signed by the server.
+   * You can use this field in offline environments to ensure that clients need to connect to the internet on a regular basis e.g. once a month.
+   */
+  std::uint64_t get_sign_date() const { return sign_date_; }
+  bool          get_f1() const { return f1_; }
+  bool          get_f2() const { return f2_; }
+  bool          get_f3() const { return f3_; }
+  bool          get_f4() const { return f4_; }
+  bool          get_f5() const { return f5_; }
+  bool          get_f6() const { return f6_; }
+  bool          get_f7() const { return f7_; }
+  bool          get_f8() const { return f8_; }
+
+  optional<int>                                      const& get_id() const { return id_; }
+  optional<StringView>                               const& get_key() const { return key_; }
+  optional<StringView>                               const& get_notes() const { return notes_; }
+  optional<int>                                      const& get_global_id() const { return global_id_; }
+  optional<CustomerView>                             const& get_customer() const { return customer_; }
+  optional<LicenseKeyView_Array<ActivationDataView>> const& get_activated_machines() const { return activated_machines_; }
+  optional<int>                                      const& get_maxnoofmachines() const { return maxnoofmachines_; }
+  optional<StringView>                               const& get_allowed_machines() const { return allowed_machines_; }
+  optional<LicenseKeyView_Array<DataObjectView>>     const& get_data_objects() const { return data_objects_; }
+
+private:
+  LicenseKeyView();
+
+  // Sets reason to the error in the Json subsystem if parsing fails
+  bool parse(std::shared_ptr<internal::LicenseKeyView_Storage> const& storage, int & reason);
+
+  std::shared_ptr<internal::LicenseKeyView_Storage const> storage_;
+
+  int           product_id_;
+  std::uint64_t created_;
+  std::uint64_t expires_;
+  int           period_;
+  bool          block_;
+  bool          trial_activation_;
+  std::uint64_t sign_date_;
+  bool          f1_;
+  bool          f2_;
+  bool          f3_;
+  bool          f4_;
+  bool          f5_;
+  bool          f6_;
+  bool          f7_;
+  bool          f8_;
+
+  optional<int>                                      id_;
+  optional<StringView>                               key_;
+  optional<StringView>                               notes_;
+  optional<int>                                      global_id_;
+  optional<CustomerView>                             customer_;
+  optional<LicenseKeyView_Array<ActivationDataView>> activated_machines_;
+  optional<int>                                      maxnoofmachines_;
+  optional<StringView>                               allowed_machines_;
+  optional<LicenseKeyView_Array<DataObjectView>>     data_objects_;
+};
+
+} // namespace v20190401
+
+namespace v20180502 {
+
+using ActivationDataView = ::cryptolens_io::v20190401::ActivationDataView;
+using CustomerView = ::cryptolens_io::v20190401::CustomerView;
+using DataObjectView = ::cryptolens_io::v20190401::DataObjectView;
+using LicenseKeyView = ::cryptolens_io::v20190401::LicenseKeyView;
+
+} // namespace v20180502
+
+namespace latest {
+
+using ActivationDataView = ::cryptolens_io::v20190401::ActivationDataView;
+using CustomerView = ::cryptolens_io::v20190401::CustomerView;
+using DataObjectView = ::cryptolens_io::v20190401::DataObjectView;
+using LicenseKeyView = ::cryptolens_io::v20190401::LicenseKeyView;
+
+} // namespace latest
+
+} // namespace cryptolens_io
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace internal {
+
+// How deeply objects and arrays may be nested when no limit has been set,
+// which is the default nesting limit of ArduinoJson. All response parsers
+// use it, such that they accept the same responses.
+int constexpr DEFAULT_MAX_DEPTH = 10;
+
+// The limits set using e.g. ResponseParser_Streaming::set_max_depth(), which
+// bound the work done when parsing a response from a misbehaving server.
+struct ParseLimits {
+  ParseLimits() : max_depth(0), max_elements(0), time_budget_us(0) {}
+
+  int max_depth; // 0 means DEFAULT_MAX_DEPTH
+  std::size_t max_elements; // 0 means no limit
+  long time_budget_us; // 0 means no limit
+};
+
+// The point in time at which a single parse has used up its time budget.
+// Since reading the clock is not free, check() only reads it once every
+// CHECK_INTERVAL calls, while expired() always reads it.
+class Deadline {
+public:
+  static int constexpr CHECK_INTERVAL = 64;
+
+  explicit Deadline(long time_budget_us)
+  : enabled_(time_budget_us > 0), expired_(false), countdown_(CHECK_INTERVAL)
+  , deadline_(enabled_ ? std::chrono::steady_clock::now() + std::chrono::microseconds(time_budget_us) : std::chrono::steady_clock::time_point())
+  {}
+
+  bool enabled() const { return enabled_; }
+
+  bool check()
+  {
+    if (!enabled_ || --countdown_ > 0) { return expired_; }
+
+    countdown_ = CHECK_INTERVAL;
+    return expired();
+  }
+
+  bool expired()
+  {
+    if (enabled_ && !expired_) { expired_ = std::chrono::steady_clock::now() >= deadline_; }
+    return expired_;
+  }
+
+private:
+  bool enabled_;
+  bool expired_;
+  int countdown_;
+  std::chrono::steady_clock::time_point deadline_;
+};
+
+} // namespace internal
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "imports/std/optional"
 
@@ -11,6 +14,33 @@ namespace cryptolens_io {
 
 namespace v20190401 {
 
+class LicenseKeyView;
+
+namespace internal {
+
+// Whether the signature verifier can decode the license while verifying it,
+// see e.g. SignatureVerifier_OpenSSL3::verify_message_base64()
+template<typename SignatureVerifier>
+class has_verify_message_base64 {
+  template<typename T>
+  static auto test(int) -> decltype(
+      std::declval<T const&>().verify_message_base64
+        ( std::declval<basic_Error &>()
+        , std::declval<std::string const&>()
+        , std::declval<std::string const&>()
+        , std::declval<std::string &>()
+        )
+    , std::true_type());
+
+  template<typename T>
+  static std::false_type test(...);
+
+public:
+  static constexpr bool value = decltype(test<SignatureVerifier>(0))::value;
+};
+
+} // namespace internal
+
 /**
  * This class represents a raw reply from the Cryptolens Web API with
  * a license key.
@@ -22,6 +52,8 @@ namespace v20190401 {
  *
  */
 class RawLicenseKey {
+  friend class LicenseKeyView;
+
   RawLicenseKey
     ( std::string base64_license
     , std::string signature
@@ -35,25 +67,44 @@ class RawLicenseKey {
   std::string base64_license_;
   std::string signature_;
   std::string license_;
-public:
-  std::string const& get_base64_license() const;
 
-  std::string const& get_signature() const;
+  // The license is decoded directly into the string that is kept, and the
+  // signature verifier hashes it while it is being decoded
+  template<typename SignatureVerifier>
+  static
+  optional<RawLicenseKey>
+  make_
+    ( basic_Error & e
+    , SignatureVerifier const& verifier
+    , std::string base64_license
+    , std::string signature
+    , std::true_type
+    )
+  {
+    std::string decoded;
 
-  std::string const& get_license() const;
+    if (!verifier.verify_message_base64(e, base64_license, signature, decoded)) { return nullopt; }
+
+    return make_optional(
+      RawLicenseKey
+        ( std::move(base64_license)
+        , std::move(signature)
+        , std::move(decoded)
+        )
+      );
+  }
 
   template<typename SignatureVerifier>
   static
   optional<RawLicenseKey>
-  make
+  make_
     ( basic_Error & e
     , SignatureVerifier const& verifier
     , std::string base64_license
     , std::string signature
+    , std::false_type
     )
   {
-    if (e) { return nullopt; }
-
     optional<std::vector<unsigned char>> decoded = ::cryptolens_io::v20190401::internal::b64_decode(base64_license);
 
     if (!decoded) {
@@ -75,6 +126,34 @@ public:
       return nullopt;
     }
   }
+
+public:
+  std::string const& get_base64_license() const;
+
+  std::string const& get_signature() const;
+
+  std::string const& get_license() const;
+
+  template<typename SignatureVerifier>
+  static
+  optional<RawLicenseKey>
+  make
+    ( basic_Error & e
+    , SignatureVerifier const& verifier
+    , std::string base64_license
+    , std::string signature
+    )
+  {
+    if (e) { return nullopt; }
+
+    return make_
+      ( e
+      , verifier
+      , std::move(base64_license)
+      , std::move(signature)
+      , std::integral_constant<bool, internal::has_verify_message_base64<SignatureVerifier>::value>()
+      );
+  }
 };
 
 } // namespace v20190401
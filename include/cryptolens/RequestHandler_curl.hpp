@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 #include "imports/curl/curl.h"
 
@@ -25,6 +27,22 @@ int constexpr SETOPT_VERIFYHOST = 7;
 int constexpr PERFORM = 8;
 int constexpr SETOPT_POSTFIELDS = 9;
 int constexpr SETOPT_TIMEOUT_MS = 10;
+int constexpr SETOPT_SHARE = 11;
+int constexpr SETOPT_SSL_CTX_FUNCTION = 12;
+int constexpr SETOPT_TCP_KEEPALIVE = 13;
+int constexpr SETOPT_MAXAGE_CONN = 14;
+// 15 is reserved, it must not be reused
+int constexpr CACERTS_NOT_EMBEDDED = 16;
+int constexpr CACERT_NOT_FOUND = 17;
+int constexpr CACERTS_STORE_CREATE = 18;
+int constexpr HTTP_STATUS = 22;
+int constexpr SETOPT_RESOLVE = 23;
+int constexpr SETOPT_NOBODY = 24;
+int constexpr TLS_SESSIONS_NOT_SUPPORTED = 25;
+int constexpr SETOPT_HTTP_VERSION = 26;
+int constexpr SETOPT_ACCEPT_ENCODING = 27;
+// 28 is used by RequestHandler_curl_multi
+int constexpr RESPONSE_TOO_LARGE = 29;
 
 } // namespace RequestHandler_curl
 
@@ -32,7 +50,7 @@ int constexpr SETOPT_TIMEOUT_MS = 10;
 
 class RequestHandler_curl_PostBuilder {
 public:
-  RequestHandler_curl_PostBuilder(CURL * curl, char const* host, char const* endpoint, long timeout_ms = 0);
+  RequestHandler_curl_PostBuilder(CURL * curl, char const* host, char const* endpoint, long timeout_ms = 0, int reconnect_attempts = 0, std::size_t max_response_size = 0, bool report_http_status = false);
 
   RequestHandler_curl_PostBuilder &
   add_argument(basic_Error & e, char const* key, char const* value);
@@ -46,6 +64,99 @@ private:
   std::string postfields_;
   std::string url_;
   long timeout_ms_;
+  int reconnect_attempts_;
+  std::size_t max_response_size_;
+  bool report_http_status_;
+};
+
+namespace internal {
+
+// Sets up the options of a curl easy handle that are the same for every
+// request, such that they need not be set again for each request.
+void
+curl_setup_handle(basic_Error & e, CURL * curl, CURLSH * share);
+
+// Creates a share handle for TLS sessions, DNS lookups and, if
+// share_connections is true, connections. Curl does not support easy handles
+// sharing connections being used from several threads at the same time,
+// but apart from that the share handle is safe to use from several threads.
+CURLSH *
+curl_share_create(bool share_connections = true);
+
+void
+curl_share_destroy(CURLSH * share);
+
+// Returns the HTTP status of a response that should be treated as an error,
+// i.e. 429 and 5xx, or 0 if the status does not indicate an error.
+long
+curl_error_status(CURL * curl);
+
+// Makes a HEAD request for the root of the given host, such that a
+// connection is opened and kept for the following requests. The HTTP status
+// of the response is ignored.
+void
+curl_warmup(basic_Error & e, CURL * curl, char const* host, long timeout_ms);
+
+// Selects HTTP/2 over TLS, falling back to HTTP/1.1 if the server does not
+// support it, or HTTP/1.1 only.
+void
+curl_set_http2(basic_Error & e, CURL * curl, bool enabled);
+
+// Selects whether the responses may be compressed using any of the encodings
+// supported by curl, e.g. gzip, br and zstd. Curl decompresses the responses.
+void
+curl_set_compression(basic_Error & e, CURL * curl, bool enabled);
+
+// Passed to the CURLOPT_SSL_CTX_FUNCTION installed by curl_setup_handle()
+// using CURLOPT_SSL_CTX_DATA. A NULL pointer means the defaults are used.
+struct CurlSslCtxData {
+  void *pinned_cacerts; // X509_STORE, only used with CRYPTOLENS_CURL_EMBED_CACERTS
+  void *tls_sessions; // TlsSessionFile, only used with CRYPTOLENS_CURL_TLS_SESSIONS
+};
+
+// Passed to the CURLOPT_WRITEFUNCTION installed by curl_setup_handle() using
+// CURLOPT_WRITEDATA. If max_size is not 0, the transfer is aborted with
+// CURLE_WRITE_ERROR once the body would become larger than max_size bytes.
+struct CurlResponse {
+  explicit CurlResponse(std::size_t max_size = 0) : body(), max_size(max_size), too_large(false) {}
+
+  std::string body;
+  std::size_t max_size;
+  bool too_large;
+
+  // Discards what was received by an earlier attempt at the same request.
+  void reset() { body.clear(); too_large = false; }
+};
+
+// Creates the list of "host:port:address" entries used with CURLOPT_RESOLVE.
+// Returns NULL for an empty list.
+curl_slist *
+curl_resolve_create(basic_Error & e, std::vector<std::string> const& entries);
+
+} // namespace internal
+
+/**
+ * Classifies the errors reported by RequestHandler_curl, RequestHandler_curl_pool
+ * and RequestHandler_curl_multi, for use with RequestHandler_retrying.
+ *
+ * An error is transient if the same request may succeed if it is made again,
+ * e.g. if the connection failed or timed out, or if the server responded with
+ * the HTTP status 429 or 503. Errors such as a failed certificate check or
+ * an invalid option are not transient.
+ *
+ * setup() makes the request handler report responses with the HTTP status
+ * 429 or 5xx as the HTTP_STATUS error, see set_report_http_status().
+ */
+class TransientErrors_curl
+{
+public:
+  static bool is_transient(int reason, std::size_t extra);
+
+  template<typename RequestHandler>
+  static void setup(basic_Error & e, RequestHandler & request_handler)
+  {
+    request_handler.set_report_http_status(e, true);
+  }
 };
 
 /**
@@ -56,6 +167,36 @@ private:
  *
  * No particular initialization is needed in order to use this
  * RequestHandler.
+ *
+ * The same connection to the Web API is reused between requests made
+ * through the same RequestHandler, and TLS sessions are cached such that
+ * a connection that has been dropped can be reestablished using an
+ * abbreviated handshake. The methods set_keep_alive(), set_max_idle_time()
+ * and set_reconnect_attempts() can be used to tune how long connections
+ * are kept open and what happens if a kept connection turns out to have
+ * been closed by the server.
+ *
+ * The body of a response is returned whatever its HTTP status. Responses
+ * with the status 429 or 5xx are usually sent by e.g. a load balancer
+ * rather than the Web API, and set_report_http_status() can be used to
+ * report them as the HTTP_STATUS error instead, such that
+ * RequestHandler_retrying can make such requests again.
+ *
+ * The first request otherwise has to resolve the host name, connect, load
+ * the CA certificates and perform a full TLS handshake. The warmup() method,
+ * which is usually called through basic_Cryptolens::warmup(), does this
+ * ahead of time, and set_resolve() can be used to skip the DNS lookup.
+ * Programs that only make a single request, such as command line tools,
+ * can use set_tls_session_file() to resume the TLS session of an earlier
+ * run of the program instead of performing a full handshake.
+ *
+ * Responses listing many activated machines or data objects are large, and
+ * set_compression() lets the Web API compress them, which mostly matters
+ * on slow networks. set_http2() selects whether HTTP/2 is used.
+ *
+ * Since a misbehaving proxy could send an arbitrarily large response,
+ * set_max_response_size() can be used to abort requests whose responses
+ * are larger than needed for any reply from the Web API.
  */
 class RequestHandler_curl
 {
@@ -78,9 +219,26 @@ public:
   post_request(basic_Error & e, char const* host, char const* endpoint);
 
   void set_timeout(basic_Error & e, long timeout_ms);
+  void set_keep_alive(basic_Error & e, long idle_s, long interval_s);
+  void set_max_idle_time(basic_Error & e, long max_idle_s);
+  void set_reconnect_attempts(basic_Error & e, int reconnect_attempts);
+  void set_pinned_cacerts(basic_Error & e, std::vector<std::string> const& names);
+  void set_resolve(basic_Error & e, std::vector<std::string> const& entries);
+  void set_tls_session_file(basic_Error & e, std::string const& path);
+  void set_http2(basic_Error & e, bool enabled);
+  void set_compression(basic_Error & e, bool enabled);
+  void set_max_response_size(basic_Error & e, std::size_t max_size);
+  void set_report_http_status(basic_Error & e, bool enabled);
+
+  void warmup(basic_Error & e, char const* host);
 private:
   CURL *curl;
+  curl_slist *resolve_;
   long timeout_ms_;
+  int reconnect_attempts_;
+  std::size_t max_response_size_;
+  bool report_http_status_;
+  internal::CurlSslCtxData ssl_ctx_data_;
 };
 
 } // namespace v20190401
@@ -94,6 +252,7 @@ namespace RequestHandler_curl = ::cryptolens_io::v20190401::errors::RequestHandl
 } // namespace errors
 
 using RequestHandler_curl = ::cryptolens_io::v20190401::RequestHandler_curl;
+using TransientErrors_curl = ::cryptolens_io::v20190401::TransientErrors_curl;
 
 } // namespace latest
 
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "imports/curl/curl.h"
+
+#include "basic_Error.hpp"
+#include "RequestHandler_curl.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+namespace RequestHandler_curl_multi {
+
+// Errors that can also occur with RequestHandler_curl use the same values,
+// such that both request handlers can be handled in the same way.
+int constexpr MULTI_NULL = 1;
+int constexpr ESCAPE = 2;
+int constexpr SETOPT_URL = 3;
+int constexpr SETOPT_WRITEDATA = 5;
+int constexpr PERFORM = 8;
+int constexpr SETOPT_POSTFIELDS = 9;
+int constexpr SETOPT_TIMEOUT_MS = 10;
+int constexpr SETOPT_MAX_HOST_CONNECTIONS = 19;
+int constexpr SHUTDOWN = 20;
+int constexpr ADD_HANDLE = 21;
+int constexpr HTTP_STATUS = 22;
+int constexpr SETOPT_HTTP_VERSION = 26;
+int constexpr SETOPT_ACCEPT_ENCODING = 27;
+int constexpr SETOPT_PIPEWAIT = 28;
+int constexpr RESPONSE_TOO_LARGE = 29;
+
+} // namespace RequestHandler_curl_multi
+
+} // namespace errors
+
+/**
+ * The result of a request made through a RequestHandler_curl_multi.
+ */
+class RequestHandler_curl_multi_Response {
+public:
+  RequestHandler_curl_multi_Response() : reason_(0), extra_(0), body_() {}
+  RequestHandler_curl_multi_Response(int reason, std::size_t extra, std::string body)
+  : reason_(reason), extra_(extra), body_(std::move(body))
+  {}
+
+  /**
+   * Returns the body of the response from the Web API. If the request failed,
+   * the error is instead recorded in e and an empty string is returned.
+   * This is the same value that RequestHandler_curl_PostBuilder::make()
+   * would have returned for the request.
+   */
+  std::string const&
+  get(basic_Error & e) const;
+
+  int get_reason() const { return reason_; }
+  std::size_t get_extra() const { return extra_; }
+
+private:
+  int reason_;
+  std::size_t extra_;
+  std::string body_;
+};
+
+class RequestHandler_curl_multi;
+
+class RequestHandler_curl_multi_PostBuilder {
+public:
+  using Callback = std::function<void(RequestHandler_curl_multi_Response)>;
+
+  RequestHandler_curl_multi_PostBuilder(RequestHandler_curl_multi * handler, char const* host, char const* endpoint, long timeout_ms = 0);
+
+  RequestHandler_curl_multi_PostBuilder &
+  add_argument(basic_Error & e, char const* key, char const* value);
+
+  std::string
+  make(basic_Error & e);
+
+  void
+  make_async(basic_Error & e, Callback callback);
+
+  std::future<RequestHandler_curl_multi_Response>
+  make_future(basic_Error & e);
+
+private:
+  RequestHandler_curl_multi *handler_;
+  char separator_;
+  std::string postfields_;
+  std::string url_;
+  long timeout_ms_;
+};
+
+/**
+ * A request handler that is responsible for making the HTTPS requests
+ * to the Cryptolens Web API, similar to RequestHandler_curl. Instead of
+ * performing each request on the calling thread, the requests are handed
+ * to a background thread which drives all outstanding requests at the same
+ * time using the curl multi interface.
+ *
+ * This request handler can be used as the RequestHandler in a Configuration,
+ * in which case methods such as basic_Cryptolens::activate() block until
+ * their request is done, but several threads can have requests in flight
+ * at the same time without each request occupying a connection of its own.
+ *
+ * In order to have many requests outstanding from a single thread, requests
+ * are instead built directly using post_request() and started using either
+ * make_async(), which calls a callback once the request is done, or
+ * make_future(). The response is then handed to handle_activate() as
+ * usual, e.g.:
+ *
+ *     handler.post_request(e, "api.cryptolens.io", "/api/key/Activate")
+ *            .add_argument(e, "token", token)
+ *            ...
+ *            .make_async(e, [&](RequestHandler_curl_multi_Response r) {
+ *              Error e2;
+ *              optional<LicenseKey> license_key =
+ *                handle_activate(e2, response_parser, signature_verifier, r.get(e2));
+ *              ...
+ *            });
+ *
+ * Callbacks are called on the background thread and should thus return
+ * quickly. In particular, a callback must not wait for another request made
+ * through the same handler to finish, since that request cannot make any
+ * progress until the callback has returned. Exceptions thrown by a callback
+ * are caught and ignored, thus a callback that can fail has to record the
+ * failure itself.
+ *
+ * With curl older than 7.68.0, which lacks curl_multi_wakeup(), the background
+ * thread cannot be woken up when a request is submitted. It instead polls for
+ * new requests every 10 ms, which adds up to 10 ms to the latency of each
+ * request and keeps the thread waking up while the handler is idle.
+ *
+ * When the request handler is destroyed, requests that have not yet finished
+ * are aborted and their callbacks are called with the SHUTDOWN error.
+ */
+class RequestHandler_curl_multi
+{
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  RequestHandler_curl_multi(basic_Error & e);
+#ifndef CRYPTOLENS_ENABLE_DANGEROUS_COPY_MOVE_CONSTRUCTOR
+  RequestHandler_curl_multi(RequestHandler_curl_multi const&) = delete;
+  RequestHandler_curl_multi(RequestHandler_curl_multi &&) = delete;
+  void operator=(RequestHandler_curl_multi const&) = delete;
+  void operator=(RequestHandler_curl_multi &&) = delete;
+#endif
+  ~RequestHandler_curl_multi();
+
+  using PostBuilder = RequestHandler_curl_multi_PostBuilder;
+  using Response = RequestHandler_curl_multi_Response;
+
+  PostBuilder
+  post_request(basic_Error & e, char const* host, char const* endpoint);
+
+  void set_timeout(basic_Error & e, long timeout_ms);
+  void set_max_host_connections(basic_Error & e, long max_connections);
+  void set_http2(basic_Error & e, bool enabled);
+  void set_compression(basic_Error & e, bool enabled);
+  void set_max_response_size(basic_Error & e, std::size_t max_size);
+  void set_report_http_status(basic_Error & e, bool enabled);
+
+private:
+  friend class RequestHandler_curl_multi_PostBuilder;
+
+  struct Transfer;
+
+  void submit(std::string url, std::string postfields, long timeout_ms, RequestHandler_curl_multi_PostBuilder::Callback callback);
+  void run();
+  void start(Transfer * transfer);
+  void finish(Transfer * transfer, int reason, std::size_t extra);
+
+  CURLM *multi_;
+  CURLSH *share_;
+  long timeout_ms_;
+  std::atomic<int> http2_; // Negative if curl's default is used, otherwise 0 or 1
+  std::atomic<bool> compression_;
+  std::atomic<std::size_t> max_response_size_;
+  std::atomic<bool> report_http_status_;
+
+  // queue_, max_host_connections_ and stop_ are protected by mutex_,
+  // running_ and idle_handles_ are only used by the background thread.
+  std::mutex mutex_;
+  std::vector<Transfer *> queue_;
+  long max_host_connections_; // Negative if it has been applied already
+  bool stop_;
+
+  std::vector<Transfer *> running_;
+  std::vector<CURL *> idle_handles_;
+
+  std::thread thread_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+namespace errors {
+
+namespace RequestHandler_curl_multi = ::cryptolens_io::v20190401::errors::RequestHandler_curl_multi;
+
+} // namespace errors
+
+using RequestHandler_curl_multi = ::cryptolens_io::v20190401::RequestHandler_curl_multi;
+using RequestHandler_curl_multi_Response = ::cryptolens_io::v20190401::RequestHandler_curl_multi_Response;
+
+} // namespace latest
+
+} // namespace cryptolens_io
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "imports/curl/curl.h"
+
+#include "basic_Error.hpp"
+#include "RequestHandler_curl.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+// Requests are made in the same way as with RequestHandler_curl, and thus
+// errors are reported using the same values.
+namespace RequestHandler_curl_pool = ::cryptolens_io::v20190401::errors::RequestHandler_curl;
+
+} // namespace errors
+
+class RequestHandler_curl_pool;
+
+class RequestHandler_curl_pool_PostBuilder {
+public:
+  RequestHandler_curl_pool_PostBuilder(RequestHandler_curl_pool * pool, CURL * curl, char const* host, char const* endpoint, long timeout_ms, int reconnect_attempts, std::size_t max_response_size, bool report_http_status);
+  RequestHandler_curl_pool_PostBuilder(RequestHandler_curl_pool_PostBuilder && other);
+  RequestHandler_curl_pool_PostBuilder(RequestHandler_curl_pool_PostBuilder const&) = delete;
+  void operator=(RequestHandler_curl_pool_PostBuilder const&) = delete;
+  void operator=(RequestHandler_curl_pool_PostBuilder &&) = delete;
+  ~RequestHandler_curl_pool_PostBuilder();
+
+  RequestHandler_curl_pool_PostBuilder &
+  add_argument(basic_Error & e, char const* key, char const* value);
+
+  std::string
+  make(basic_Error & e);
+
+private:
+  RequestHandler_curl_pool *pool_;
+  CURL *curl_; // Returned to the pool when the builder is destroyed
+  RequestHandler_curl_PostBuilder builder_;
+};
+
+/**
+ * A request handler that makes the HTTPS requests to the Cryptolens Web API
+ * in the same way as RequestHandler_curl, but which can be used from several
+ * threads at the same time.
+ *
+ * Each request borrows a curl handle from a pool for as long as the
+ * PostBuilder returned by post_request() exists, and new handles are only
+ * created when all pooled handles are in use. The pool does not use any
+ * locks, and a thread tends to get back the handle it used for its
+ * previous request, and thus its connection to the Web API. All handles
+ * share TLS sessions and DNS lookups, such that new connections can use an
+ * abbreviated handshake.
+ *
+ * Since the other policy classes included with the library can be used from
+ * several threads at the same time, using this request handler means that
+ * a single basic_Cryptolens object, and thus a single parsed public key,
+ * can be shared by all threads, e.g.
+ *
+ *     struct Configuration_Shared : public Configuration_Unix<MachineCodeComputer_static> {
+ *       using RequestHandler = RequestHandler_curl_pool;
+ *     };
+ *
+ * The setters should be called before the request handler is used from
+ * several threads. The settings apply to requests made after the call.
+ *
+ * Since connections are not shared between handles, warmup() only opens the
+ * connection of the handle that the calling thread would get back, but the
+ * DNS lookup and TLS session are shared with all other handles.
+ */
+class RequestHandler_curl_pool
+{
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  RequestHandler_curl_pool(basic_Error & e);
+#ifndef CRYPTOLENS_ENABLE_DANGEROUS_COPY_MOVE_CONSTRUCTOR
+  RequestHandler_curl_pool(RequestHandler_curl_pool const&) = delete;
+  RequestHandler_curl_pool(RequestHandler_curl_pool &&) = delete;
+  void operator=(RequestHandler_curl_pool const&) = delete;
+  void operator=(RequestHandler_curl_pool &&) = delete;
+#endif
+  ~RequestHandler_curl_pool();
+
+  using PostBuilder = RequestHandler_curl_pool_PostBuilder;
+
+  PostBuilder
+  post_request(basic_Error & e, char const* host, char const* endpoint);
+
+  void set_timeout(basic_Error & e, long timeout_ms);
+  void set_keep_alive(basic_Error & e, long idle_s, long interval_s);
+  void set_max_idle_time(basic_Error & e, long max_idle_s);
+  void set_reconnect_attempts(basic_Error & e, int reconnect_attempts);
+  void set_resolve(basic_Error & e, std::vector<std::string> const& entries);
+  void set_http2(basic_Error & e, bool enabled);
+  void set_compression(basic_Error & e, bool enabled);
+  void set_max_response_size(basic_Error & e, std::size_t max_size);
+  void set_report_http_status(basic_Error & e, bool enabled);
+
+  void warmup(basic_Error & e, char const* host);
+
+private:
+  friend class RequestHandler_curl_pool_PostBuilder;
+
+  CURL * acquire(basic_Error & e);
+  void release(CURL * curl);
+  void setup_handle(basic_Error & e, CURL * curl) const;
+  void drop_idle_handles();
+
+  CURLSH *share_;
+  curl_slist *resolve_;
+  std::vector<std::atomic<CURL *>> idle_; // Slots holding either NULL or an unused handle
+
+  long timeout_ms_;
+  int reconnect_attempts_;
+  std::size_t max_response_size_;
+  bool report_http_status_;
+  long keep_alive_idle_s_; // Negative if keep-alive is not enabled
+  long keep_alive_interval_s_;
+  long max_idle_s_; // Negative if curl's default is used
+  int http2_; // Negative if curl's default is used, otherwise 0 or 1
+  bool compression_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+namespace errors {
+
+namespace RequestHandler_curl_pool = ::cryptolens_io::v20190401::errors::RequestHandler_curl_pool;
+
+} // namespace errors
+
+using RequestHandler_curl_pool = ::cryptolens_io::v20190401::RequestHandler_curl_pool;
+
+} // namespace latest
+
+} // namespace cryptolens_io
@@ -0,0 +1,543 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "basic_Error.hpp"
+#include "Error.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+namespace RequestHandler_hedging {}
+
+} // namespace errors
+
+template<typename RequestHandler>
+class RequestHandler_hedging;
+
+template<typename RequestHandler>
+class RequestHandler_hedging_PostBuilder {
+public:
+  RequestHandler_hedging_PostBuilder(RequestHandler_hedging<RequestHandler> * handler, char const* host, char const* endpoint)
+  : handler_(handler), host_(host), endpoint_(endpoint), arguments_()
+  {}
+
+  RequestHandler_hedging_PostBuilder &
+  add_argument(basic_Error & e, char const* key, char const* value)
+  {
+    if (e) { return *this; }
+
+    arguments_.push_back(std::make_pair(std::string(key), std::string(value)));
+    return *this;
+  }
+
+  std::string
+  make(basic_Error & e)
+  {
+    if (e) { return ""; }
+
+    return handler_->make(e, host_, endpoint_, arguments_);
+  }
+
+private:
+  RequestHandler_hedging<RequestHandler> *handler_;
+  std::string host_;
+  std::string endpoint_;
+  std::vector<std::pair<std::string, std::string>> arguments_;
+};
+
+/**
+ * A request handler that sends requests to one of several deployments of
+ * the Web API, e.g. in different regions, using another request handler.
+ *
+ * The base URLs are given using set_endpoints(), in the same format as for
+ * basic_Cryptolens::set_base_url(), and replace the base URL passed to
+ * post_request(). For each endpoint, an exponentially weighted moving
+ * average of the latency of its requests is kept, and requests are sent to
+ * the endpoint with the lowest average. A failed request counts as a slow
+ * request, and the request is then made again using the next endpoint.
+ * While an endpoint is not used, its average decays towards zero, see
+ * set_latency_decay(), such that an endpoint that was slow or failing
+ * is eventually tried again and can win back the requests once it has
+ * recovered.
+ *
+ * If hedging is enabled using set_hedging(), a second request is also sent
+ * to the next fastest endpoint if the first request has not completed within
+ * the 95th percentile of the recent latencies of its endpoint. The response
+ * that arrives first is used. This cuts the tail latency caused by e.g.
+ * a lost packet or a slow server, at the cost of a small number of extra
+ * requests. In this mode the requests are made by worker threads that are
+ * kept for the lifetime of the request handler, and new threads are only
+ * started when all of them are busy. A request that is no longer needed
+ * runs to completion in the background.
+ *
+ * The underlying request handler must support being used from several
+ * threads at the same time if hedging is enabled, or if this request
+ * handler is used from several threads, e.g.
+ *
+ *     struct Configuration_Hedging : public Configuration_Unix<MachineCodeComputer_static> {
+ *       using RequestHandler = RequestHandler_hedging<RequestHandler_curl_pool>;
+ *     };
+ *
+ * The setters should be called before the request handler is used from
+ * several threads. The destructor waits for requests running in the background.
+ */
+template<typename RequestHandler>
+class RequestHandler_hedging
+{
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  RequestHandler_hedging(basic_Error & e)
+  : inner_(e), endpoints_(), hedging_(false), min_hedge_delay_ms_(0), decay_ms_(60000), background_(0), hedges_(0)
+  , jobs_(), workers_(), idle_workers_(0), stop_(false)
+  {}
+  RequestHandler_hedging(RequestHandler_hedging const&) = delete;
+  RequestHandler_hedging(RequestHandler_hedging &&) = delete;
+  void operator=(RequestHandler_hedging const&) = delete;
+  void operator=(RequestHandler_hedging &&) = delete;
+
+  ~RequestHandler_hedging()
+  {
+    std::vector<std::thread> workers;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      idle_.wait(lock, [this]() { return background_ == 0; });
+
+      stop_ = true;
+      workers.swap(workers_);
+    }
+    work_.notify_all();
+
+    for (std::thread & t : workers) { t.join(); }
+  }
+
+  using PostBuilder = RequestHandler_hedging_PostBuilder<RequestHandler>;
+
+  PostBuilder
+  post_request(basic_Error & e, char const* host, char const* endpoint)
+  {
+    return PostBuilder(this, host, endpoint);
+  }
+
+  RequestHandler & get_request_handler() { return inner_; }
+  RequestHandler const& get_request_handler() const { return inner_; }
+
+  /**
+   * Sets the base URLs of the deployments of the Web API to use. If no
+   * endpoints are set, the base URL passed to post_request() is used.
+   */
+  void set_endpoints(basic_Error & e, std::vector<std::string> const& endpoints)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    endpoints_.clear();
+    for (std::string const& url : endpoints) { endpoints_.push_back(Endpoint(url)); }
+  }
+
+  /**
+   * Enables or disables hedged requests. A second request is sent no sooner
+   * than min_hedge_delay_ms after the first, and this is also the delay used
+   * until enough requests have been made to an endpoint to estimate the 95th
+   * percentile of its latency. Hedging is disabled by default.
+   */
+  void set_hedging(basic_Error & e, bool enabled, long min_hedge_delay_ms)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    hedging_ = enabled;
+    min_hedge_delay_ms_ = min_hedge_delay_ms > 0 ? min_hedge_delay_ms : 0;
+  }
+
+  /**
+   * Sets the time constant, in milliseconds, with which the average latency
+   * of an endpoint decays towards zero while no requests are made to it.
+   * After decay_ms the average has fallen to about a third. 0 disables the
+   * decay. The default is 60000 ms.
+   */
+  void set_latency_decay(basic_Error & e, long decay_ms)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    decay_ms_ = decay_ms > 0 ? decay_ms : 0;
+  }
+
+  /**
+   * Returns the average latency of each endpoint in milliseconds, including
+   * the decay since its last request, in the order given to set_endpoints().
+   */
+  std::vector<double> get_latencies() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::vector<double> latencies;
+    for (Endpoint const& endpoint : endpoints_) { latencies.push_back(decayed_average(endpoint, now)); }
+    return latencies;
+  }
+
+  /**
+   * Connects to each endpoint, or to host if no endpoints are set, using the
+   * underlying request handler. An error is only reported if no endpoint
+   * could be reached. The time taken is not included in the latencies.
+   */
+  void warmup(basic_Error & e, char const* host)
+  {
+    if (e) { return; }
+
+    std::vector<std::string> urls;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (Endpoint const& endpoint : endpoints_) { urls.push_back(endpoint.url); }
+    }
+    if (urls.empty()) { urls.push_back(host); }
+
+    bool reached = false;
+    Error inner_e;
+    for (std::string const& url : urls) {
+      Error url_e;
+      inner_.warmup(url_e, url.c_str());
+      if (!url_e) { reached = true; }
+      else if (!inner_e) { inner_e.set(api::main(), url_e.get_subsystem(), url_e.get_reason(), url_e.get_extra()); }
+    }
+
+    if (!reached) { e.set(api::main(), inner_e.get_subsystem(), inner_e.get_reason(), inner_e.get_extra()); }
+  }
+
+  /**
+   * Returns the number of hedged requests that have been sent.
+   */
+  std::uint64_t get_hedges() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hedges_;
+  }
+
+private:
+  friend class RequestHandler_hedging_PostBuilder<RequestHandler>;
+
+  using Arguments = std::vector<std::pair<std::string, std::string>>;
+
+  static constexpr std::size_t SAMPLES = 64; // Latencies used for the 95th percentile
+  static constexpr std::size_t MIN_SAMPLES = 20;
+  static constexpr double ALPHA = 0.2;
+
+  struct Endpoint {
+    explicit Endpoint(std::string url)
+    : url(std::move(url)), average_ms(0), updated(), samples(), next(0), p95_ms(0)
+    {}
+
+    std::string url;
+    double average_ms; // 0 until the first request has been made
+    std::chrono::steady_clock::time_point updated; // When average_ms was last updated
+    std::vector<double> samples;
+    std::size_t next; // Position in samples to overwrite once it is full
+    double p95_ms;
+  };
+
+  struct Result {
+    Result() : subsystem(errors::Subsystem::Ok), reason(0), extra(0), body() {}
+
+    int subsystem;
+    int reason;
+    std::size_t extra;
+    std::string body;
+  };
+
+  // The state shared by the caller and the threads making the requests for it
+  struct Race {
+    Race(std::string endpoint, Arguments arguments)
+    : endpoint(std::move(endpoint)), arguments(std::move(arguments)), started(0), finished(0), success(false), result()
+    {}
+
+    std::string endpoint;
+    Arguments arguments;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    int started;
+    int finished;
+    bool success;
+    Result result; // The first successful result, or the last error
+  };
+
+  // A request made by a worker thread
+  struct Job {
+    Job(std::shared_ptr<Race> race, std::string url, std::size_t index)
+    : race(std::move(race)), url(std::move(url)), index(index)
+    {}
+
+    std::shared_ptr<Race> race;
+    std::string url;
+    std::size_t index;
+  };
+
+  std::string
+  make(basic_Error & e, std::string const& host, std::string const& endpoint, Arguments const& arguments)
+  {
+    std::vector<std::size_t> order;
+    std::vector<std::string> urls;
+    bool hedging;
+    std::chrono::milliseconds hedge_delay(0);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      std::vector<double> averages;
+      for (std::size_t i = 0; i < endpoints_.size(); ++i) {
+        order.push_back(i);
+        averages.push_back(decayed_average(endpoints_[i], now));
+      }
+      std::stable_sort(order.begin(), order.end(), [&averages](std::size_t a, std::size_t b) { return averages[a] < averages[b]; });
+      for (std::size_t i : order) { urls.push_back(endpoints_[i].url); }
+
+      hedging = hedging_ && order.size() >= 2;
+      if (hedging) {
+        Endpoint const& primary = endpoints_[order[0]];
+        double delay_ms = primary.samples.size() >= MIN_SAMPLES ? primary.p95_ms : 0;
+        if (delay_ms < min_hedge_delay_ms_) { delay_ms = (double)min_hedge_delay_ms_; }
+        hedge_delay = std::chrono::milliseconds((long)delay_ms);
+      }
+    }
+
+    if (urls.empty()) { return attempt(e, host, endpoint, arguments, SIZE_MAX); }
+
+    if (!hedging) {
+      // Fall back to the next endpoint if a request fails
+      std::string response;
+      for (std::size_t i = 0; i < order.size(); ++i) {
+        Error inner_e;
+        response = attempt(inner_e, urls[i], endpoint, arguments, order[i]);
+        if (!inner_e || i + 1 == order.size()) {
+          if (inner_e) { e.set(api::main(), inner_e.get_subsystem(), inner_e.get_reason(), inner_e.get_extra()); }
+          return response;
+        }
+      }
+    }
+
+    std::shared_ptr<Race> race = std::make_shared<Race>(endpoint, arguments);
+
+    std::unique_lock<std::mutex> lock(race->mutex);
+
+    start(race, urls[0], order[0]);
+    race->done.wait_for(lock, hedge_delay, [&race]() { return race->success || race->finished == race->started; });
+
+    // Hedge if the request is slow, or fail over right away if it failed
+    if (!race->success) {
+      {
+        std::lock_guard<std::mutex> lock2(mutex_);
+        hedges_ += 1;
+      }
+      start(race, urls[1], order[1]);
+    }
+
+    race->done.wait(lock, [&race]() { return race->success || race->finished == race->started; });
+
+    Result const& result = race->result;
+    if (!race->success) { e.set(api::main(), result.subsystem, result.reason, result.extra); return ""; }
+
+    return result.body;
+  }
+
+  // Assumes race->mutex is held. Hands the request to an idle worker
+  // thread, or starts a new one if all of them are busy.
+  void
+  start(std::shared_ptr<Race> const& race, std::string const& url, std::size_t index)
+  {
+    race->started += 1;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    background_ += 1;
+    jobs_.push_back(Job(race, url, index));
+
+    if (jobs_.size() <= idle_workers_) {
+      lock.unlock();
+      work_.notify_one();
+      return;
+    }
+
+    try {
+      workers_.push_back(std::thread(&RequestHandler_hedging::work, this));
+    } catch (std::system_error const&) {
+      // The busy workers get to the request eventually. Without any workers
+      // it counts as a failed request in the same way as if the request
+      // handler failed.
+      if (!workers_.empty()) { return; }
+
+      jobs_.pop_back();
+      background_ -= 1;
+
+      race->finished += 1;
+      race->result.subsystem = errors::Subsystem::RequestHandler;
+    }
+  }
+
+  void
+  work()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+      idle_workers_ += 1;
+      work_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+      idle_workers_ -= 1;
+
+      if (jobs_.empty()) { return; }
+
+      Job job = std::move(jobs_.front());
+      jobs_.pop_front();
+      lock.unlock();
+
+      run(job.race, job.url, job.index);
+
+      lock.lock();
+    }
+  }
+
+  void
+  run(std::shared_ptr<Race> const& race, std::string const& url, std::size_t index)
+  {
+    Error e;
+    std::string response = attempt(e, url, race->endpoint, race->arguments, index);
+
+    {
+      std::lock_guard<std::mutex> lock(race->mutex);
+
+      race->finished += 1;
+      if (!race->success) {
+        if (e) {
+          race->result.subsystem = e.get_subsystem();
+          race->result.reason = e.get_reason();
+          race->result.extra = e.get_extra();
+        } else {
+          race->success = true;
+          race->result.body = std::move(response);
+        }
+      }
+      race->done.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    background_ -= 1;
+    if (background_ == 0) { idle_.notify_all(); }
+  }
+
+  // Makes the request using the underlying request handler and records its
+  // latency for the endpoint at the given index, unless it is SIZE_MAX.
+  std::string
+  attempt(basic_Error & e, std::string const& url, std::string const& endpoint, Arguments const& arguments, std::size_t index)
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    auto request = inner_.post_request(e, url.c_str(), endpoint.c_str());
+    for (auto const& argument : arguments) {
+      request.add_argument(e, argument.first.c_str(), argument.second.c_str());
+    }
+    std::string response = request.make(e);
+
+    if (index == SIZE_MAX) { return response; }
+
+    double latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index < endpoints_.size() && endpoints_[index].url == url) {
+      record(endpoints_[index], latency_ms, !e);
+    }
+
+    return response;
+  }
+
+  // Assumes mutex_ is held
+  double
+  decayed_average(Endpoint const& endpoint, std::chrono::steady_clock::time_point now) const
+  {
+    if (decay_ms_ == 0 || endpoint.average_ms == 0) { return endpoint.average_ms; }
+
+    double idle_ms = std::chrono::duration<double, std::milli>(now - endpoint.updated).count();
+    return endpoint.average_ms * std::exp(-idle_ms / decay_ms_);
+  }
+
+  // Assumes mutex_ is held
+  void
+  record(Endpoint & endpoint, double latency_ms, bool success)
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double average_ms = decayed_average(endpoint, now);
+
+    // A failed request counts as a slow one, such that requests move to
+    // another endpoint while this one is failing
+    if (!success) { latency_ms = std::max(latency_ms, 2 * average_ms + 100); }
+
+    endpoint.average_ms = average_ms == 0 ? latency_ms : ALPHA * latency_ms + (1 - ALPHA) * average_ms;
+    endpoint.updated = now;
+
+    if (endpoint.samples.size() < SAMPLES) {
+      endpoint.samples.push_back(latency_ms);
+    } else {
+      endpoint.samples[endpoint.next] = latency_ms;
+      endpoint.next = (endpoint.next + 1) % SAMPLES;
+    }
+
+    std::vector<double> sorted(endpoint.samples);
+    std::size_t k = sorted.size() * 95 / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    endpoint.p95_ms = sorted[k];
+  }
+
+  RequestHandler inner_;
+
+  mutable std::mutex mutex_; // Guards all members below
+  std::condition_variable idle_; // Signalled when background_ becomes 0
+  std::vector<Endpoint> endpoints_;
+  bool hedging_;
+  long min_hedge_delay_ms_;
+  long decay_ms_;
+  std::size_t background_; // Number of requests handed to the worker threads that have not finished
+  std::uint64_t hedges_;
+
+  std::condition_variable work_; // Signalled when a job is added or stop_ is set
+  std::deque<Job> jobs_;
+  std::vector<std::thread> workers_;
+  std::size_t idle_workers_;
+  bool stop_;
+};
+
+template<typename RequestHandler>
+constexpr std::size_t RequestHandler_hedging<RequestHandler>::SAMPLES;
+
+template<typename RequestHandler>
+constexpr std::size_t RequestHandler_hedging<RequestHandler>::MIN_SAMPLES;
+
+template<typename RequestHandler>
+constexpr double RequestHandler_hedging<RequestHandler>::ALPHA;
+
+} // namespace v20190401
+
+namespace latest {
+
+template<typename RequestHandler>
+using RequestHandler_hedging = ::cryptolens_io::v20190401::RequestHandler_hedging<RequestHandler>;
+
+} // namespace latest
+
+} // namespace cryptolens_io
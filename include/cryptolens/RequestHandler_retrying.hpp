@@ -0,0 +1,340 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "basic_Error.hpp"
+#include "Error.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+namespace RequestHandler_retrying {
+
+// Chosen such that it does not overlap with the values used by the request
+// handlers included with the library
+int constexpr CIRCUIT_OPEN = 64;
+
+} // namespace RequestHandler_retrying
+
+} // namespace errors
+
+class TransientErrors_curl;
+
+template<typename RequestHandler, typename TransientErrors>
+class RequestHandler_retrying;
+
+template<typename RequestHandler, typename TransientErrors>
+class RequestHandler_retrying_PostBuilder {
+public:
+  RequestHandler_retrying_PostBuilder(RequestHandler_retrying<RequestHandler, TransientErrors> * handler, char const* host, char const* endpoint)
+  : handler_(handler), host_(host), endpoint_(endpoint), arguments_()
+  {}
+
+  RequestHandler_retrying_PostBuilder &
+  add_argument(basic_Error & e, char const* key, char const* value)
+  {
+    if (e) { return *this; }
+
+    arguments_.push_back(std::make_pair(std::string(key), std::string(value)));
+    return *this;
+  }
+
+  std::string
+  make(basic_Error & e)
+  {
+    if (e) { return ""; }
+
+    return handler_->make(e, host_, endpoint_, arguments_);
+  }
+
+private:
+  RequestHandler_retrying<RequestHandler, TransientErrors> *handler_;
+  std::string host_;
+  std::string endpoint_;
+  std::vector<std::pair<std::string, std::string>> arguments_;
+};
+
+/**
+ * A request handler that forwards requests to another request handler and
+ * makes the request again if it fails with a transient error, such as
+ * a connection that timed out or the HTTP status 503. Which errors are
+ * transient is decided by the TransientErrors class, which by default is
+ * TransientErrors_curl for use with the curl based request handlers, e.g.
+ *
+ *     struct Configuration_Retrying : public Configuration_Unix<MachineCodeComputer_static> {
+ *       using RequestHandler = RequestHandler_retrying<RequestHandler_curl>;
+ *     };
+ *
+ * The constructor calls TransientErrors::setup() with the underlying request
+ * handler, which for TransientErrors_curl turns on set_report_http_status(),
+ * such that responses with e.g. the HTTP status 503 are reported as errors
+ * rather than passed on to the response parser.
+ *
+ * Before a request is made again, the thread waits for an exponentially
+ * increasing delay, between one half and all of min(max, base * 2^n) for the
+ * n-th retry, see set_backoff(). Other errors, as well as the error from the
+ * last attempt, are returned to the caller as usual.
+ *
+ * The request handler also acts as a circuit breaker. After a number of
+ * consecutive requests have failed with transient errors, the circuit opens
+ * and requests immediately fail with the CIRCUIT_OPEN error in the
+ * RequestHandler subsystem, instead of waiting for a timeout while the Web
+ * API cannot be reached. Once the circuit has been open for a while, a single
+ * request is let through, and if it succeeds the circuit closes again.
+ *
+ * If the underlying request handler can be used from several threads at
+ * the same time, so can this request handler. The underlying request handler
+ * is available through get_request_handler().
+ */
+template<typename RequestHandler, typename TransientErrors = TransientErrors_curl>
+class RequestHandler_retrying
+{
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  RequestHandler_retrying(basic_Error & e)
+  : inner_(e), max_retries_(2), base_ms_(200), max_ms_(5000), failure_threshold_(5), open_ms_(30000)
+  , failures_(0), open_until_(), trial_(false), random_(std::random_device()()), retries_(0), rejected_(0)
+  {
+    TransientErrors::setup(e, inner_);
+  }
+  RequestHandler_retrying(RequestHandler_retrying const&) = delete;
+  RequestHandler_retrying(RequestHandler_retrying &&) = delete;
+  void operator=(RequestHandler_retrying const&) = delete;
+  void operator=(RequestHandler_retrying &&) = delete;
+
+  using PostBuilder = RequestHandler_retrying_PostBuilder<RequestHandler, TransientErrors>;
+
+  PostBuilder
+  post_request(basic_Error & e, char const* host, char const* endpoint)
+  {
+    return PostBuilder(this, host, endpoint);
+  }
+
+  RequestHandler & get_request_handler() { return inner_; }
+  RequestHandler const& get_request_handler() const { return inner_; }
+
+  /**
+   * Calls warmup() on the underlying request handler.
+   */
+  void warmup(basic_Error & e, char const* host)
+  {
+    inner_.warmup(e, host);
+  }
+
+  /**
+   * Sets how many times a request is made again after a transient error.
+   * The default is 2.
+   */
+  void set_max_retries(basic_Error & e, int max_retries)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_retries_ = max_retries > 0 ? max_retries : 0;
+  }
+
+  /**
+   * Sets the delay before the first retry and the largest delay between
+   * retries, in milliseconds. The defaults are 200 and 5000 ms.
+   */
+  void set_backoff(basic_Error & e, long base_ms, long max_ms)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    base_ms_ = base_ms > 0 ? base_ms : 0;
+    max_ms_ = max_ms > base_ms_ ? max_ms : base_ms_;
+  }
+
+  /**
+   * Sets after how many consecutive transient errors the circuit opens, and
+   * for how many milliseconds it stays open before a request is let through.
+   * A failure_threshold of 0 disables the circuit breaker. The defaults are
+   * 5 errors and 30000 ms.
+   */
+  void set_circuit_breaker(basic_Error & e, int failure_threshold, long open_ms)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    failure_threshold_ = failure_threshold > 0 ? failure_threshold : 0;
+    open_ms_ = open_ms > 0 ? open_ms : 0;
+    failures_ = 0;
+    trial_ = false;
+  }
+
+  /**
+   * Returns true if requests currently fail without being made.
+   */
+  bool is_circuit_open() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return is_open(std::chrono::steady_clock::now());
+  }
+
+  /**
+   * Returns the number of times a request has been made again.
+   */
+  std::uint64_t get_retries() const { return retries_; }
+
+  /**
+   * Returns the number of requests that failed with CIRCUIT_OPEN.
+   */
+  std::uint64_t get_rejected() const { return rejected_; }
+
+private:
+  friend class RequestHandler_retrying_PostBuilder<RequestHandler, TransientErrors>;
+
+  using Arguments = std::vector<std::pair<std::string, std::string>>;
+
+  std::string
+  make(basic_Error & e, std::string const& host, std::string const& endpoint, Arguments const& arguments)
+  {
+    using namespace errors;
+
+    int subsystem = Subsystem::Ok;
+    int reason = 0;
+    std::size_t extra = 0;
+
+    for (int attempt = 0; ; ++attempt) {
+      bool trial;
+      std::chrono::milliseconds delay;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!admit(trial)) {
+          rejected_ += 1;
+
+          // Report the error that made the circuit open, if there was one
+          if (attempt > 0) { e.set(api::main(), subsystem, reason, extra); }
+          else             { e.set(api::main(), Subsystem::RequestHandler, errors::RequestHandler_retrying::CIRCUIT_OPEN); }
+          return "";
+        }
+
+        delay = backoff(attempt);
+      }
+
+      Error inner_e;
+      auto request = inner_.post_request(inner_e, host.c_str(), endpoint.c_str());
+      for (auto const& argument : arguments) {
+        request.add_argument(inner_e, argument.first.c_str(), argument.second.c_str());
+      }
+      std::string response = request.make(inner_e);
+
+      subsystem = inner_e.get_subsystem();
+      reason = inner_e.get_reason();
+      extra = inner_e.get_extra();
+
+      bool transient = subsystem == Subsystem::RequestHandler && TransientErrors::is_transient(reason, extra);
+
+      int max_retries;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        record(transient, trial);
+        max_retries = max_retries_;
+      }
+
+      if (!inner_e) { return response; }
+
+      if (!transient || attempt >= max_retries) {
+        e.set(api::main(), subsystem, reason, extra);
+        return "";
+      }
+
+      retries_ += 1;
+      std::this_thread::sleep_for(delay);
+    }
+  }
+
+  // Assumes mutex_ is held
+  bool is_open(std::chrono::steady_clock::time_point now) const
+  {
+    return failure_threshold_ > 0 && failures_ >= failure_threshold_ && (now < open_until_ || trial_);
+  }
+
+  // Assumes mutex_ is held. Returns false if the request should fail right
+  // away, otherwise sets trial if this is the request that is let through
+  // after the circuit has been open.
+  bool admit(bool & trial)
+  {
+    trial = false;
+
+    if (failure_threshold_ == 0 || failures_ < failure_threshold_) { return true; }
+    if (is_open(std::chrono::steady_clock::now())) { return false; }
+
+    trial = true;
+    trial_ = true;
+    return true;
+  }
+
+  // Assumes mutex_ is held
+  void record(bool transient, bool trial)
+  {
+    if (trial) { trial_ = false; }
+
+    // Any other outcome means that the Web API could be reached
+    if (!transient) { failures_ = 0; return; }
+
+    failures_ += 1;
+    if (failure_threshold_ > 0 && failures_ >= failure_threshold_) {
+      open_until_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(open_ms_);
+    }
+  }
+
+  // Assumes mutex_ is held
+  std::chrono::milliseconds backoff(int attempt)
+  {
+    long delay = base_ms_;
+    for (int i = 0; i < attempt && delay < max_ms_; ++i) { delay *= 2; }
+    if (delay > max_ms_) { delay = max_ms_; }
+
+    return std::chrono::milliseconds(delay / 2 + std::uniform_int_distribution<long>(0, delay - delay / 2)(random_));
+  }
+
+  RequestHandler inner_;
+
+  mutable std::mutex mutex_; // Guards all members below up to random_
+  int max_retries_;
+  long base_ms_;
+  long max_ms_;
+  int failure_threshold_;
+  long open_ms_;
+  int failures_; // Number of consecutive transient errors
+  std::chrono::steady_clock::time_point open_until_;
+  bool trial_; // True while the request let through after the circuit was open is in progress
+  std::mt19937 random_;
+
+  std::atomic<std::uint64_t> retries_;
+  std::atomic<std::uint64_t> rejected_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+namespace errors {
+
+namespace RequestHandler_retrying = ::cryptolens_io::v20190401::errors::RequestHandler_retrying;
+
+} // namespace errors
+
+template<typename RequestHandler, typename TransientErrors = ::cryptolens_io::v20190401::TransientErrors_curl>
+using RequestHandler_retrying = ::cryptolens_io::v20190401::RequestHandler_retrying<RequestHandler, TransientErrors>;
+
+} // namespace latest
+
+} // namespace cryptolens_io
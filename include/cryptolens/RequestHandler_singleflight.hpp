@@ -0,0 +1,239 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic_Error.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+namespace RequestHandler_singleflight {}
+
+} // namespace errors
+
+template<typename RequestHandler>
+class RequestHandler_singleflight;
+
+template<typename RequestHandler>
+class RequestHandler_singleflight_PostBuilder {
+public:
+  RequestHandler_singleflight_PostBuilder(RequestHandler_singleflight<RequestHandler> * handler, char const* host, char const* endpoint)
+  : handler_(handler), host_(host), endpoint_(endpoint), arguments_()
+  {}
+
+  RequestHandler_singleflight_PostBuilder &
+  add_argument(basic_Error & e, char const* key, char const* value)
+  {
+    if (e) { return *this; }
+
+    arguments_.push_back(std::make_pair(std::string(key), std::string(value)));
+    return *this;
+  }
+
+  std::string
+  make(basic_Error & e)
+  {
+    if (e) { return ""; }
+
+    return handler_->make(e, host_, endpoint_, arguments_);
+  }
+
+private:
+  RequestHandler_singleflight<RequestHandler> *handler_;
+  std::string host_;
+  std::string endpoint_;
+  std::vector<std::pair<std::string, std::string>> arguments_;
+};
+
+/**
+ * A request handler that forwards requests to another request handler, except
+ * that identical requests made at the same time from several threads are
+ * only sent once. The first thread makes the request, and the other threads
+ * wait for it to finish and then receive the same response, or the same error.
+ * Two requests are identical if they are made to the same host and endpoint
+ * with the same arguments in the same order, which is the case when e.g.
+ * basic_Cryptolens::activate() is called with the same token, product id
+ * and license key on the same machine.
+ *
+ * This is useful when many threads of a program check the license at the same
+ * time during startup, which would otherwise result in one request per thread.
+ * Only requests that overlap in time are combined, a request made after
+ * an identical request has finished is sent again. Each thread still parses
+ * the response and verifies its signature on its own.
+ *
+ * Since a single basic_Cryptolens object is shared between the threads, the
+ * underlying request handler must support being used from several threads
+ * at the same time, e.g.
+ *
+ *     struct Configuration_Shared : public Configuration_Unix<MachineCodeComputer_static> {
+ *       using RequestHandler = RequestHandler_singleflight<RequestHandler_curl_pool>;
+ *     };
+ *
+ * The underlying request handler is available through get_request_handler(),
+ * e.g. in order to change its settings.
+ */
+template<typename RequestHandler>
+class RequestHandler_singleflight
+{
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  RequestHandler_singleflight(basic_Error & e)
+  : inner_(e), flights_(), requests_(0), coalesced_(0)
+  {}
+  RequestHandler_singleflight(RequestHandler_singleflight const&) = delete;
+  RequestHandler_singleflight(RequestHandler_singleflight &&) = delete;
+  void operator=(RequestHandler_singleflight const&) = delete;
+  void operator=(RequestHandler_singleflight &&) = delete;
+
+  using PostBuilder = RequestHandler_singleflight_PostBuilder<RequestHandler>;
+
+  PostBuilder
+  post_request(basic_Error & e, char const* host, char const* endpoint)
+  {
+    return PostBuilder(this, host, endpoint);
+  }
+
+  RequestHandler & get_request_handler() { return inner_; }
+  RequestHandler const& get_request_handler() const { return inner_; }
+
+  /**
+   * Calls warmup() on the underlying request handler.
+   */
+  void warmup(basic_Error & e, char const* host)
+  {
+    inner_.warmup(e, host);
+  }
+
+  /**
+   * Returns the number of requests that were sent using the underlying request handler.
+   */
+  std::uint64_t get_requests() const { return requests_; }
+
+  /**
+   * Returns the number of requests that instead waited for an identical request.
+   */
+  std::uint64_t get_coalesced_requests() const { return coalesced_; }
+
+private:
+  friend class RequestHandler_singleflight_PostBuilder<RequestHandler>;
+
+  struct Result {
+    Result() : subsystem(errors::Subsystem::Ok), reason(0), extra(0), body() {}
+
+    int subsystem;
+    int reason;
+    std::size_t extra;
+    std::string body;
+  };
+
+  using Arguments = std::vector<std::pair<std::string, std::string>>;
+  using Flights = std::unordered_map<std::string, std::shared_future<Result>>;
+
+  static void append(std::string & key, std::string const& s)
+  {
+    // Length prefixed such that different arguments cannot give the same key
+    key += std::to_string(s.size());
+    key += ':';
+    key += s;
+  }
+
+  std::string
+  make(basic_Error & e, std::string const& host, std::string const& endpoint, Arguments const& arguments)
+  {
+    std::string key;
+    append(key, host);
+    append(key, endpoint);
+    for (auto const& argument : arguments) {
+      append(key, argument.first);
+      append(key, argument.second);
+    }
+
+    std::promise<Result> promise;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      typename Flights::iterator it = flights_.find(key);
+      if (it != flights_.end()) {
+        std::shared_future<Result> flight = it->second;
+        lock.unlock();
+
+        coalesced_ += 1;
+
+        Result const& result = flight.get();
+        if (result.subsystem != errors::Subsystem::Ok) {
+          e.set(api::main(), result.subsystem, result.reason, result.extra);
+        }
+        return result.body;
+      }
+
+      flights_.insert(std::make_pair(key, promise.get_future().share()));
+    }
+
+    requests_ += 1;
+
+    Result result;
+    try {
+      auto request = inner_.post_request(e, host.c_str(), endpoint.c_str());
+      for (auto const& argument : arguments) {
+        request.add_argument(e, argument.first.c_str(), argument.second.c_str());
+      }
+      result.body = request.make(e);
+    } catch (...) {
+      finish(key);
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+
+    if (e) {
+      result.subsystem = e.get_subsystem(api::main());
+      result.reason = e.get_reason(api::main());
+      result.extra = e.get_extra(api::main());
+    }
+
+    // Requests started after this point are sent again
+    finish(key);
+    promise.set_value(result);
+
+    return std::move(result.body);
+  }
+
+  void
+  finish(std::string const& key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flights_.erase(key);
+  }
+
+  RequestHandler inner_;
+
+  std::mutex mutex_;
+  Flights flights_; // Requests in progress, protected by mutex_
+
+  std::atomic<std::uint64_t> requests_;
+  std::atomic<std::uint64_t> coalesced_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+template<typename RequestHandler>
+using RequestHandler_singleflight = ::cryptolens_io::v20190401::RequestHandler_singleflight<RequestHandler>;
+
+} // namespace latest
+
+} // namespace cryptolens_io
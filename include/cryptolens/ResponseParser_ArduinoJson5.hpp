@@ -15,6 +15,15 @@ namespace cryptolens_io {
 
 namespace v20190401 {
 
+/**
+ * A response parser using version 5 of the ArduinoJson library.
+ *
+ * Unlike ArduinoJson 7, the library is not included in third_party, and this
+ * parser is not built by the CMake project. To use it, place ArduinoJson 5
+ * in third_party/ArduinoJson5, or on the include path if
+ * CRYPTOLENS_SHORT_INCLUDE_PATHS is defined, and compile
+ * src/ResponseParser_ArduinoJson5.cpp together with the application.
+ */
 class ResponseParser_ArduinoJson5 {
 /*
  * Note the API of this class is not considered stable. Please contact us if you would like to create
@@ -26,9 +35,9 @@ public:
 #endif
   ResponseParser_ArduinoJson5(basic_Error & e) {}
 
-  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key) const;
-  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key) const;
-  optional<LicenseKeyInformation> make_license_key_information_unsafe(basic_Error & e, std::string const& license_key) const;
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip = 0) const;
 
   optional<std::pair<std::string, std::string>> parse_activate_response(basic_Error & e, std::string const& server_response) const;
   void parse_deactivate_response(basic_Error & e, std::string const& server_response) const;
@@ -2,16 +2,35 @@
 
 #include "imports/std/optional"
 
+#include <cstddef>
 #include <utility>
 
 #include "basic_Error.hpp"
 #include "LicenseKeyInformation.hpp"
+#include "ParseLimits.hpp"
 #include "RawLicenseKey.hpp"
 
 namespace cryptolens_io {
 
 namespace v20190401 {
 
+/**
+ * A response parser using ArduinoJson 7, which is the default for the
+ * included configurations.
+ *
+ * The JSON documents are allocated from an arena kept by each thread, which
+ * is reset after each response instead of freeing the memory, such that
+ * parsing a response does not call malloc() for the document once the arena
+ * is large enough. The arena grows to the largest document parsed so far, up
+ * to the size set with set_arena_size(), and larger documents use malloc()
+ * for the memory that does not fit.
+ *
+ * The same limits as for ResponseParser_Streaming can be set on the work done
+ * for a single response. Since ArduinoJson builds the whole document before
+ * any value is read, the number of elements and the time budget are checked
+ * once the document has been built, thus the memory used is only bounded by
+ * the size of the response.
+ */
 class ResponseParser_ArduinoJson7 {
 /*
  * Note the API of this class is not considered stable. Please contact us if you would like to create
@@ -19,11 +38,40 @@ class ResponseParser_ArduinoJson7 {
  */
 public:
   explicit
-  ResponseParser_ArduinoJson7(basic_Error & e) {}
+  ResponseParser_ArduinoJson7(basic_Error & e) : arena_size_(65536), limits_() {}
+
+  /**
+   * Sets the largest size in bytes the arena used for the JSON documents may
+   * grow to. The arena is shared by the parsers used by the same thread, and
+   * keeps its size until the thread exits. A size of 0 disables the arena,
+   * such that the documents are allocated with malloc(). The default is 64 KiB.
+   */
+  void set_arena_size(basic_Error & e, std::size_t arena_size);
+
+  /**
+   * Sets how deeply objects and arrays in a response may be nested, see
+   * ResponseParser_Streaming::set_max_depth(). The largest limit supported by
+   * ArduinoJson is 255, and the default is 10.
+   */
+  void set_max_depth(basic_Error & e, int max_depth);
 
-  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key) const;
-  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key) const;
-  optional<LicenseKeyInformation> make_license_key_information_unsafe(basic_Error & e, std::string const& license_key) const;
+  /**
+   * Sets the largest number of activated machines, and of data objects, that
+   * a license key may list, see ResponseParser_Streaming::set_max_elements().
+   */
+  void set_max_elements(basic_Error & e, std::size_t max_elements);
+
+  /**
+   * Sets how many microseconds parsing a single response may take, see
+   * ResponseParser_Streaming::set_time_budget(). ArduinoJson cannot be
+   * interrupted while it builds the document, thus a response which takes
+   * too long is only rejected afterwards.
+   */
+  void set_time_budget(basic_Error & e, long time_budget_us);
+
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip = 0) const;
 
   optional<std::pair<std::string, std::string>> parse_activate_response(basic_Error & e, std::string const& server_response) const;
   void parse_deactivate_response(basic_Error & e, std::string const& server_response) const;
@@ -31,6 +79,10 @@ public:
   std::string parse_last_message_response(basic_Error & e, std::string const& server_response) const;
 
   bool has_template_feature(basic_Error & e, std::string const& features_json, std::string const& feature) const;
+
+private:
+  std::size_t arena_size_;
+  internal::ParseLimits limits_;
 };
 
 } // namespace v20190401
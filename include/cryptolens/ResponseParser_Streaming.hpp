@@ -0,0 +1,103 @@
+#pragma once
+
+#include "imports/std/optional"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic_Error.hpp"
+#include "LicenseKeyInformation.hpp"
+#include "Message.hpp"
+#include "ParseLimits.hpp"
+#include "RawLicenseKey.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+/**
+ * A response parser which extracts the fields used by the library while
+ * reading the responses from the Web API once, instead of first building
+ * a document tree as ResponseParser_ArduinoJson7 does. No memory is
+ * allocated except for the objects returned.
+ *
+ * The responses accepted and the fields extracted from them are the same as
+ * for ResponseParser_ArduinoJson7, and the parser can be used in its place
+ * in a Configuration, e.g.
+ *
+ *     class Configuration_Fast : public Configuration_Unix<MachineCodeComputer_static> {
+ *     public:
+ *       using ResponseParser = ResponseParser_Streaming;
+ *     };
+ *
+ * Like for ResponseParser_ArduinoJson7, a value is only used if it has the
+ * expected type, the last value is used for a key occurring more than once,
+ * and anything after the end of the outermost object is ignored. The only
+ * difference in the responses accepted is that ArduinoJson accepts some
+ * input which is not JSON, e.g. unquoted keys, strings in single quotes and
+ * numbers with leading zeros, which this parser rejects.
+ *
+ * The work done for a single response can be bounded using set_max_depth(),
+ * set_max_elements() and set_time_budget(), which makes parsing stop as soon
+ * as a limit is exceeded.
+ */
+class ResponseParser_Streaming {
+/*
+ * Note the API of this class is not considered stable. Please contact us if you would like to create
+ * a custom ResponseParser.
+ */
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  ResponseParser_Streaming(basic_Error & e) : limits_() {}
+
+  /**
+   * Sets how deeply objects and arrays in a response may be nested. Responses
+   * nested more deeply fail with the MAX_DEPTH_EXCEEDED error in the Json
+   * subsystem. The default is 10, and the largest value accepted is 64.
+   */
+  void set_max_depth(basic_Error & e, int max_depth);
+
+  /**
+   * Sets the largest number of activated machines, and of data objects, that
+   * a license key may list. License keys listing more fail with the
+   * MAX_ELEMENTS_EXCEEDED error in the Json subsystem. The default is 0,
+   * which means there is no limit.
+   */
+  void set_max_elements(basic_Error & e, std::size_t max_elements);
+
+  /**
+   * Sets how many microseconds parsing a single response may take, after
+   * which parsing fails with the TIME_BUDGET_EXCEEDED error in the Json
+   * subsystem. The default is 0, which means there is no limit.
+   */
+  void set_time_budget(basic_Error & e, long time_budget_us);
+
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip = 0) const;
+
+  optional<std::pair<std::string, std::string>> parse_activate_response(basic_Error & e, std::string const& server_response) const;
+  void parse_deactivate_response(basic_Error & e, std::string const& server_response) const;
+  std::string parse_create_trial_key_response(basic_Error & e, std::string const& server_response) const;
+  std::string parse_last_message_response(basic_Error & e, std::string const& server_response) const;
+  std::vector<Message> parse_get_messages_response(basic_Error & e, std::string const& server_response) const;
+
+  bool has_template_feature(basic_Error & e, std::string const& features_json, std::string const& feature) const;
+
+private:
+  internal::ParseLimits limits_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+using ResponseParser_Streaming = ::cryptolens_io::v20190401::ResponseParser_Streaming;
+
+} // namespace latest
+
+} // namespace cryptolens_io
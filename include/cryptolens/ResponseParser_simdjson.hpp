@@ -0,0 +1,103 @@
+#pragma once
+
+#include "imports/std/optional"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic_Error.hpp"
+#include "LicenseKeyInformation.hpp"
+#include "Message.hpp"
+#include "ParseLimits.hpp"
+#include "RawLicenseKey.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+/**
+ * A response parser using the On Demand API of the simdjson library, which
+ * finds the structure of a response using SIMD instructions and only parses
+ * the values that are used. Intended for servers and desktops, where this is
+ * faster than ResponseParser_ArduinoJson7 and ResponseParser_Streaming for
+ * large responses, such as license keys with many activated machines.
+ *
+ * This parser is only available if the library is built with the CMake
+ * option CRYPTOLENS_BUILD_SIMDJSON, which requires simdjson 1.0 or later.
+ * The responses accepted and the fields extracted from them are the same as
+ * for ResponseParser_ArduinoJson7 and ResponseParser_Streaming, and the
+ * parser can be used in their place in a Configuration, e.g.
+ *
+ *     class Configuration_Server : public Configuration_Unix<MachineCodeComputer_static> {
+ *     public:
+ *       using ResponseParser = ResponseParser_simdjson;
+ *     };
+ *
+ * The instructions used by the On Demand API are chosen when compiling,
+ * thus building with e.g. -march=haswell on x86-64 gives the best results.
+ * Each thread keeps its own simdjson parser, such that the memory it uses is
+ * allocated once per thread instead of once per response. Unlike the other
+ * parsers, the values of keys that are not used are skipped without being
+ * validated. The same limits as for ResponseParser_Streaming can be set on
+ * the work done for a single response.
+ */
+class ResponseParser_simdjson {
+/*
+ * Note the API of this class is not considered stable. Please contact us if you would like to create
+ * a custom ResponseParser.
+ */
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  ResponseParser_simdjson(basic_Error & e) : limits_() {}
+
+  /**
+   * Sets how deeply objects and arrays in a response may be nested, see
+   * ResponseParser_Streaming::set_max_depth(). Since simdjson does not limit
+   * the nesting of the values it skips, the nesting is checked while the
+   * response is scanned for the end of the outermost value. The default is 10.
+   */
+  void set_max_depth(basic_Error & e, int max_depth);
+
+  /**
+   * Sets the largest number of activated machines, and of data objects, that
+   * a license key may list, see ResponseParser_Streaming::set_max_elements().
+   */
+  void set_max_elements(basic_Error & e, std::size_t max_elements);
+
+  /**
+   * Sets how many microseconds parsing a single response may take, see
+   * ResponseParser_Streaming::set_time_budget(). The time used to find the
+   * structure of the response, which is done before any value is read, is
+   * counted but cannot be interrupted.
+   */
+  void set_time_budget(basic_Error & e, long time_budget_us);
+
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip = 0) const;
+  optional<LicenseKeyInformation> make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip = 0) const;
+
+  optional<std::pair<std::string, std::string>> parse_activate_response(basic_Error & e, std::string const& server_response) const;
+  void parse_deactivate_response(basic_Error & e, std::string const& server_response) const;
+  std::string parse_create_trial_key_response(basic_Error & e, std::string const& server_response) const;
+  std::string parse_last_message_response(basic_Error & e, std::string const& server_response) const;
+  std::vector<Message> parse_get_messages_response(basic_Error & e, std::string const& server_response) const;
+
+  bool has_template_feature(basic_Error & e, std::string const& features_json, std::string const& feature) const;
+
+private:
+  internal::ParseLimits limits_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+using ResponseParser_simdjson = ::cryptolens_io::v20190401::ResponseParser_simdjson;
+
+} // namespace latest
+
+} // namespace cryptolens_io
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
+#include "imports/openssl/evp.h"
 #include "imports/openssl/rsa.h"
 
 #include "basic_Error.hpp"
@@ -21,6 +23,10 @@ namespace v20190401 {
  * In order for this signature verifier to work the modulus and exponent
  * must be set using the set_modulus_base64() and set_exponent_base64()
  * methods.
+ *
+ * The key and the verification context are prepared once when the public
+ * key is set, and verify_message() can be called from several threads at
+ * the same time.
  */
 class SignatureVerifier_OpenSSL
 {
@@ -44,10 +50,14 @@ public:
   void set_exponent_base64(basic_Error & e, std::string const& exponent_base64);
 
   bool verify_message(basic_Error & e, std::vector<unsigned char> const& message, std::string const& signature_base64) const;
+  bool verify_message_base64(basic_Error & e, std::string const& message_base64, std::string const& signature_base64, std::string & message) const;
 
 private:
-  RSA * rsa;
+  RSA * rsa; // Holds the modulus and exponent set so far
+  EVP_PKEY *pkey_;
+  EVP_MD_CTX *verify_ctx_; // Initialized with EVP_DigestVerifyInit() and copied for each signature
 
+  void prepare_(basic_Error & e);
   void set_modulus_base64_(basic_Error & e, std::string const& modulus_base64);
   void set_exponent_base64_(basic_Error & e, std::string const& exponent_base64);
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <openssl/evp.h>
 #include <openssl/params.h>
@@ -21,6 +22,9 @@ namespace v20190401 {
  *
  * In order for this signature verifier to work the modulus and exponent
  * must be set using the set_public_key_base64() method.
+ *
+ * The verification context is prepared once when the public key is set, and
+ * verify_message() can be called from several threads at the same time.
  */
 class SignatureVerifier_OpenSSL3
 {
@@ -40,9 +44,12 @@ public:
   void set_exponent_base64(basic_Error & e, std::string const& exponent_base64);
 
   bool verify_message(basic_Error & e, std::vector<unsigned char> const& message, std::string const& signature_base64) const;
+  bool verify_message_base64(basic_Error & e, std::string const& message_base64, std::string const& signature_base64, std::string & message) const;
 
 private:
   EVP_PKEY *pkey_;
+  EVP_MD *md_;
+  EVP_MD_CTX *verify_ctx_; // Initialized with EVP_DigestVerifyInit() and copied for each signature
 
   void set_public_key_base64_(basic_Error & e, std::string const& modulus_base64, std::string const& exponent_base64);
 };
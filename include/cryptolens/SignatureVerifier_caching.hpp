@@ -0,0 +1,273 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic_Error.hpp"
+#include "sha256.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace errors {
+
+namespace SignatureVerifier_caching {}
+
+} // namespace errors
+
+/**
+ * A signature verifier which remembers signatures that have already been
+ * verified successfully, and otherwise forwards to another signature verifier.
+ * This is useful when the same license key is checked repeatedly, e.g. when
+ * a license key saved using LicenseKey::to_string() is checked for every
+ * request handled by a server, since a signature that is found in the cache
+ * does not have to be verified again.
+ *
+ * Entries are identified by a SHA-256 digest of the public key, the message
+ * and the signature. Only successful verifications are cached. The cache holds
+ * at most set_cache_size() entries, after which the least recently used entry
+ * is evicted, and entries can optionally expire after set_cache_ttl() seconds.
+ *
+ * The public key is set in the same way as for the underlying signature
+ * verifier. Setting a new public key empties the cache, unless the underlying
+ * signature verifier rejects it, in which case the cache is left as it was.
+ *
+ * verify_message() can be called from several threads at the same time as
+ * long as the underlying signature verifier allows this.
+ */
+template<typename SignatureVerifier>
+class SignatureVerifier_caching
+{
+public:
+#ifndef CRYPTOLENS_20190701_ALLOW_IMPLICIT_CONSTRUCTORS
+  explicit
+#endif
+  SignatureVerifier_caching(basic_Error & e)
+  : verifier_(e), max_entries_(1024), ttl_(0), entries_(), index_(), hits_(0), misses_(0)
+  {
+    set_public_key_digest("", "");
+  }
+  SignatureVerifier_caching(SignatureVerifier_caching const&) = delete;
+  SignatureVerifier_caching(SignatureVerifier_caching &&) = delete;
+  void operator=(SignatureVerifier_caching const&) = delete;
+  void operator=(SignatureVerifier_caching &&) = delete;
+
+  void set_public_key_xml(basic_Error & e, std::string const& key_xml)
+  {
+    if (e) { return; }
+    verifier_.set_public_key_xml(e, key_xml);
+    if (e) { return; }
+
+    set_public_key_digest("xml", key_xml);
+  }
+
+  void set_public_key_base64(basic_Error & e, std::string const& modulus_base64, std::string const& exponent_base64)
+  {
+    if (e) { return; }
+    verifier_.set_public_key_base64(e, modulus_base64, exponent_base64);
+    if (e) { return; }
+
+    modulus_base64_ = modulus_base64;
+    exponent_base64_ = exponent_base64;
+    set_public_key_digest(modulus_base64_, exponent_base64_);
+  }
+
+  void set_modulus_base64(basic_Error & e, std::string const& modulus_base64)
+  {
+    if (e) { return; }
+    verifier_.set_modulus_base64(e, modulus_base64);
+    if (e) { return; }
+
+    modulus_base64_ = modulus_base64;
+    set_public_key_digest(modulus_base64_, exponent_base64_);
+  }
+
+  void set_exponent_base64(basic_Error & e, std::string const& exponent_base64)
+  {
+    if (e) { return; }
+    verifier_.set_exponent_base64(e, exponent_base64);
+    if (e) { return; }
+
+    exponent_base64_ = exponent_base64;
+    set_public_key_digest(modulus_base64_, exponent_base64_);
+  }
+
+  /**
+   * Sets the maximum number of signatures kept in the cache. The default is 1024.
+   */
+  void set_cache_size(basic_Error & e, std::size_t max_entries)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_entries_ = max_entries;
+    evict();
+  }
+
+  /**
+   * Sets the number of seconds a signature is kept in the cache after it has
+   * been verified, or 0 if the signatures should be kept until they are evicted
+   * to make room for other signatures. The default is 0.
+   */
+  void set_cache_ttl(basic_Error & e, long ttl_s)
+  {
+    if (e) { return; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttl_ = std::chrono::seconds(ttl_s > 0 ? ttl_s : 0);
+  }
+
+  /**
+   * Returns the number of calls to verify_message() where the signature was found in the cache.
+   */
+  std::uint64_t get_cache_hits() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+
+  /**
+   * Returns the number of calls to verify_message() where the signature had to be verified.
+   */
+  std::uint64_t get_cache_misses() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+  void clear_cache()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+  }
+
+  /**
+   * This function is used internally by the library and need not be called.
+   */
+  bool verify_message(basic_Error & e, std::vector<unsigned char> const& message, std::string const& signature_base64) const
+  {
+    if (e) { return false; }
+
+    std::string key = entry_key(message, signature_base64);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      typename Index::iterator it = index_.find(key);
+      if (it != index_.end()) {
+        if (it->second->expires > now) {
+          entries_.splice(entries_.begin(), entries_, it->second);
+          hits_ += 1;
+          return true;
+        }
+
+        entries_.erase(it->second);
+        index_.erase(it);
+      }
+
+      misses_ += 1;
+    }
+
+    bool valid = verifier_.verify_message(e, message, signature_base64);
+    if (!valid || e) { return false; }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (max_entries_ == 0 || index_.find(key) != index_.end()) { return true; }
+
+    std::chrono::steady_clock::time_point expires =
+      ttl_.count() > 0 ? now + ttl_ : std::chrono::steady_clock::time_point::max();
+
+    entries_.push_front(Entry(key, expires));
+    index_[key] = entries_.begin();
+    evict();
+
+    return true;
+  }
+
+private:
+  struct Entry {
+    Entry(std::string key, std::chrono::steady_clock::time_point expires)
+    : key(std::move(key)), expires(expires)
+    {}
+
+    std::string key;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  using Entries = std::list<Entry>;
+  using Index = std::unordered_map<std::string, typename Entries::iterator>;
+
+  // Assumes mutex_ is held
+  void evict() const
+  {
+    while (entries_.size() > max_entries_) {
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+    }
+  }
+
+  void set_public_key_digest(std::string const& a, std::string const& b)
+  {
+    internal::Sha256 h;
+    std::uint64_t len = a.size();
+    h.update(&len, sizeof(len));
+    h.update(a.data(), a.size());
+    len = b.size();
+    h.update(&len, sizeof(len));
+    h.update(b.data(), b.size());
+    h.finish(public_key_digest_);
+
+    clear_cache();
+  }
+
+  std::string entry_key(std::vector<unsigned char> const& message, std::string const& signature_base64) const
+  {
+    unsigned char digest[internal::Sha256::DIGEST_SIZE];
+
+    internal::Sha256 h;
+    h.update(public_key_digest_, sizeof(public_key_digest_));
+    std::uint64_t len = message.size();
+    h.update(&len, sizeof(len));
+    h.update(message.data(), message.size());
+    h.update(signature_base64.data(), signature_base64.size());
+    h.finish(digest);
+
+    return std::string((char const*)digest, sizeof(digest));
+  }
+
+  SignatureVerifier verifier_;
+
+  std::string modulus_base64_;
+  std::string exponent_base64_;
+  unsigned char public_key_digest_[internal::Sha256::DIGEST_SIZE];
+
+  mutable std::mutex mutex_;
+  std::size_t max_entries_;
+  std::chrono::seconds ttl_;
+  mutable Entries entries_; // Most recently used first
+  mutable Index index_;
+  mutable std::uint64_t hits_;
+  mutable std::uint64_t misses_;
+};
+
+} // namespace v20190401
+
+namespace latest {
+
+template<typename SignatureVerifier>
+using SignatureVerifier_caching = ::cryptolens_io::v20190401::SignatureVerifier_caching<SignatureVerifier>;
+
+} // namespace latest
+
+} // namespace cryptolens_io
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+/**
+ * A non-owning reference to a sequence of characters, similar to
+ * std::string_view which is not available before C++17.
+ *
+ * The referenced characters are not necessarily followed by a NUL
+ * character, thus data() should not be passed to functions expecting
+ * a C string. Use to_string() to obtain a copy of the characters.
+ */
+class StringView {
+public:
+  StringView() : data_(""), size_(0) {}
+  StringView(char const* data, std::size_t size) : data_(data), size_(size) {}
+
+  char const* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  char const* begin() const { return data_; }
+  char const* end() const { return data_ + size_; }
+
+  char operator[](std::size_t i) const { return data_[i]; }
+
+  std::string to_string() const { return std::string(data_, size_); }
+
+#if __cplusplus >= 201703L
+  operator std::string_view() const { return std::string_view(data_, size_); }
+#endif
+
+  friend bool operator==(StringView a, StringView b)
+  {
+    return a.size_ == b.size_ && (a.size_ == 0 || std::memcmp(a.data_, b.data_, a.size_) == 0);
+  }
+
+  friend bool operator!=(StringView a, StringView b) { return !(a == b); }
+
+  friend bool operator==(StringView a, char const* b) { return a == StringView(b, std::strlen(b)); }
+  friend bool operator!=(StringView a, char const* b) { return !(a == b); }
+
+  friend bool operator==(StringView a, std::string const& b) { return a == StringView(b.data(), b.size()); }
+  friend bool operator!=(StringView a, std::string const& b) { return !(a == b); }
+
+private:
+  char const* data_;
+  std::size_t size_;
+};
+
+} // namespace v20190401
+
+namespace v20180502 {
+
+using StringView = ::cryptolens_io::v20190401::StringView;
+
+} // namespace v20180502
+
+namespace latest {
+
+using StringView = ::cryptolens_io::v20190401::StringView;
+
+} // namespace latest
+
+} // namespace cryptolens_io
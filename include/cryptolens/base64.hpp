@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -17,9 +18,69 @@ namespace internal {
 int
 b64_pton(char const *src, unsigned char *target, size_t targsize);
 
+// Decodes srclen characters of base64 into target, using SIMD instructions
+// where the CPU supports them. Accepts exactly the same input as b64_pton().
+// Returns the number of bytes written, or -1 if the input is not valid
+// base64 or does not fit in targsize bytes.
+//
+// As with b64_pton(), padded input whose unused trailing bits are not zero,
+// e.g. "QR==" instead of "QQ==", is rejected if targsize leaves room for the
+// byte holding those bits, which is the case with b64_decoded_size_max().
+int
+b64_decode_into(char const *src, std::size_t srclen, unsigned char *target, std::size_t targsize);
+
+// Receives the bytes written by b64_decode_into() in order, in parts of at
+// most B64_CHUNK_SIZE bytes, as soon as each part will no longer change.
+// This allows e.g. computing a digest of the result while it is still in the
+// cache. If the input turns out not to be valid base64, the parts passed so
+// far are not retracted.
+typedef void (*B64DecodeCallback)(void *context, unsigned char const* data, std::size_t len);
+
+std::size_t constexpr B64_CHUNK_SIZE = 3072;
+
+int
+b64_decode_into(char const *src, std::size_t srclen, unsigned char *target, std::size_t targsize, B64DecodeCallback callback, void *context);
+
+// Upper bound on the number of bytes srclen characters of base64 decode to.
+inline std::size_t
+b64_decoded_size_max(std::size_t srclen)
+{
+  return (srclen + 3) / 4 * 3;
+}
+
+// Decodes b64, or returns nullopt if it is not valid base64. Input with
+// non-zero trailing bits is rejected, see b64_decode_into(). This is stricter
+// than earlier versions of b64_decode(), which ignored the extra bits, but
+// the Web API always sets them to zero.
 optional<std::vector<unsigned char>>
 b64_decode(std::string const& b64);
 
+// Decodes b64 into out, which is resized to fit, passing the result to
+// callback as well, see B64DecodeCallback. Returns false if the input is not
+// valid base64.
+bool
+b64_decode(std::string const& b64, std::string & out, B64DecodeCallback callback, void *context);
+
+// Holds the result of decoding a short base64 string, such as a signature,
+// without allocating memory on the heap.
+class B64DecodeBuffer {
+public:
+  B64DecodeBuffer() : heap_(), data_(stack_), size_(0) {}
+  B64DecodeBuffer(B64DecodeBuffer const&) = delete;
+  void operator=(B64DecodeBuffer const&) = delete;
+
+  bool decode(std::string const& b64);
+
+  unsigned char const* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  unsigned char stack_[512]; // Enough for the signature of a 4096 bit RSA key
+  std::vector<unsigned char> heap_;
+  unsigned char *data_;
+  std::size_t size_;
+};
+
 } // namespace internal
 
 } // namespace v20190401
@@ -1,17 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <string>
 #include <sstream>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include "imports/std/optional"
 
 #include "ActivateError.hpp"
 #include "api.hpp"
 #include "basic_Error.hpp"
+#include "FieldsToReturn.hpp"
 #include "LicenseKey.hpp"
 #include "LicenseKeyChecker.hpp"
 #include "LicenseKeyInformation.hpp"
+#include "LicenseKeyView.hpp"
 #include "Message.hpp"
 #include "RawLicenseKey.hpp"
 
@@ -34,6 +41,25 @@ handle_activate
   , std::string const& response
   );
 
+template<typename ResponseParser, typename SignatureVerifier>
+optional<RawLicenseKey>
+make_raw_license_key
+  ( basic_Error & e
+  , ResponseParser const& response_parser
+  , SignatureVerifier const& signature_verifier
+  , std::string const& s
+  );
+
+template<typename ResponseParser, typename SignatureVerifier>
+optional<LicenseKey>
+make_license_key
+  ( basic_Error & e
+  , ResponseParser const& response_parser
+  , SignatureVerifier const& signature_verifier
+  , std::string const& s
+  , int fields_to_skip = 0
+  );
+
 int
 activate_parse_server_error_message(char const* server_response);
 
@@ -205,7 +231,7 @@ handle_activate
 
   optional<RawLicenseKey> x = internal::handle_activate(e, response_parser, signature_verifier, response);
   optional<LicenseKeyInformation> y = response_parser.make_license_key_information(e, x);
-  if (e) { e.set_call(api::main(), errors::Call::BASIC_SKM_HANDLE_ACTIVATE); }
+  if (e) { e.set_call(api::main(), errors::Call::BASIC_SKM_HANDLE_ACTIVATE); return nullopt; }
 
   return LicenseKey(std::move(*y), std::move(*x));
 }
@@ -237,6 +263,10 @@ handle_activate
  * requests to the Web API, respectivly. Consult the documentation for the
  * chosen policy classes since in some cases special initialization may be
  * neccessary.
+ *
+ * Once set up, an object of this class can be used from several threads at
+ * the same time if the RequestHandler supports this, as is the case for
+ * RequestHandler_curl_pool and RequestHandler_curl_multi.
  */
 template<typename Configuration>
 class basic_Cryptolens
@@ -247,9 +277,67 @@ public:
 #endif
   basic_Cryptolens(basic_Error & e)
   : response_parser(e), request_handler(e), signature_verifier(e), machine_code_computer(e)
-  , activate_validator(e), get_key_validator(e)
+  , activate_validator(e), get_key_validator(e), base_url_("api.cryptolens.io")
   { }
 
+  /**
+   * Sets where the requests to the Web API are sent. The default is
+   * "api.cryptolens.io", and the endpoint, e.g. "/api/key/Activate", is
+   * appended to this value.
+   *
+   * With the curl based request handlers, the value can also include
+   * a scheme and a path, such as "http://localhost:8080" for a local stand-in
+   * for the Web API, or "https://proxy.example.com/cryptolens" for a caching
+   * proxy. The "https://" scheme is used if none is given. RequestHandler_WinHTTP
+   * only accepts a host name.
+   *
+   * This method should be called before the object is used from several threads.
+   */
+  void
+  set_base_url(basic_Error & e, std::string base_url)
+  {
+    if (e) { return; }
+
+    base_url_ = std::move(base_url);
+  }
+
+  std::string const&
+  get_base_url() const
+  {
+    return base_url_;
+  }
+
+  /**
+   * Performs the work that would otherwise slow down the first request to
+   * the Web API, such that it can be done e.g. on a background thread while
+   * the application starts:
+   *
+   *     std::future<void> warm = std::async(std::launch::async, [&]() { cryptolens_handle.warmup(warmup_error); });
+   *     // ... show the main window
+   *     warm.wait();
+   *     auto license_key = cryptolens_handle.activate(e, ...);
+   *
+   * This computes the machine code, which is cached if e.g. MachineCodeComputer_caching
+   * is used, and calls warmup() on the RequestHandler with the base URL. With the
+   * curl based request handlers, this resolves the host name, loads the CA
+   * certificates and opens a TLS connection that is kept for the following
+   * requests. The public key is prepared for verifying signatures already when
+   * it is set on the SignatureVerifier.
+   *
+   * The object must not be used by other threads until this method returns,
+   * unless the RequestHandler supports being used from several threads at the
+   * same time. An error only means that the work will be done by the first
+   * request instead, and need not be reported to the user.
+   */
+  void
+  warmup(basic_Error & e)
+  {
+    if (e) { return; }
+
+    machine_code_computer.get_machine_code(e);
+    request_handler.warmup(e, base_url_.c_str());
+  }
+
   optional<LicenseKey>
   activate
     ( basic_Error & e
@@ -341,7 +429,29 @@ public:
     );
 
   optional<LicenseKey>
-  make_license_key(basic_Error & e, std::string const& s);
+  make_license_key(basic_Error & e, std::string const& s, int fields_to_skip = 0);
+
+  optional<LicenseKeyView>
+  make_license_key_view(basic_Error & e, std::string const& s);
+
+  template<typename ErrorType>
+  std::vector<optional<LicenseKey>>
+  verify_batch
+    ( basic_Error & e
+    , std::string const* keys
+    , std::size_t count
+    , std::vector<ErrorType> & key_errors
+    , unsigned int threads = 0
+    );
+
+  template<typename ErrorType>
+  std::vector<optional<LicenseKey>>
+  verify_batch
+    ( basic_Error & e
+    , std::vector<std::string> const& keys
+    , std::vector<ErrorType> & key_errors
+    , unsigned int threads = 0
+    );
 
   bool
   license_key_has_template_feature
@@ -360,6 +470,8 @@ public:
   typename Configuration::template GetKeyValidator<internal::GetKeyEnvironment> get_key_validator;
 
 private:
+  std::string base_url_;
+
   optional<RawLicenseKey>
   activate_
     ( basic_Error & e
@@ -462,7 +574,7 @@ basic_Cryptolens<Configuration>::activate
       , fields_to_return
       , friendly_name
       );
-  optional<LicenseKeyInformation> y = response_parser.make_license_key_information(e, x);
+  optional<LicenseKeyInformation> y = response_parser.make_license_key_information(e, x, fields_to_return);
   if (e) { e.set_call(api::main(), errors::Call::BASIC_SKM_ACTIVATE); return nullopt; }
 
   typename internal::ActivateEnvironment env(*y, product_id, key, machine_code, fields_to_return, false);
@@ -594,7 +706,7 @@ basic_Cryptolens<Configuration>::activate_floating
       , fields_to_return
       , friendly_name
       );
-  optional<LicenseKeyInformation> y = response_parser.make_license_key_information(e, x);
+  optional<LicenseKeyInformation> y = response_parser.make_license_key_information(e, x, fields_to_return);
   if (e) { e.set_call(api::main(), errors::Call::BASIC_SKM_ACTIVATE_FLOATING); return nullopt; }
 
   typename internal::ActivateEnvironment env(*y, product_id, key, machine_code, fields_to_return, true);
@@ -656,7 +768,7 @@ basic_Cryptolens<Configuration>::activate_
 {
   if (e) { return nullopt; }
 
-  auto request = request_handler.post_request(e, "api.cryptolens.io", "/api/key/Activate");
+  auto request = request_handler.post_request(e, base_url_.c_str(), "/api/key/Activate");
 
   std::ostringstream product_id_; product_id_ << product_id;
   std::ostringstream fields_to_return_; fields_to_return_ << fields_to_return;
@@ -693,7 +805,7 @@ basic_Cryptolens<Configuration>::deactivate_
 {
   if (e) { return; }
 
-  auto request = request_handler.post_request(e, "api.cryptolens.io", "/api/key/Deactivate");
+  auto request = request_handler.post_request(e, base_url_.c_str(), "/api/key/Deactivate");
 
   std::ostringstream product_id_; product_id_ << product_id;
   std::ostringstream floating_; floating_ << (floating ? "true" : "false");
@@ -725,7 +837,7 @@ basic_Cryptolens<Configuration>::activate_floating_
 {
   if (e) { return nullopt; }
 
-  auto request = request_handler.post_request(e, "api.cryptolens.io", "/api/key/Activate");
+  auto request = request_handler.post_request(e, base_url_.c_str(), "/api/key/Activate");
 
   std::ostringstream product_id_; product_id_ << product_id;
   std::ostringstream fields_to_return_; fields_to_return_ << fields_to_return;
@@ -830,7 +942,7 @@ basic_Cryptolens<Configuration>::create_trial_key_
 
   std::string machine_code = machine_code_computer.get_machine_code(e);
 
-  auto request = request_handler.post_request(e, "api.cryptolens.io", "/api/Key/CreateTrialKey");
+  auto request = request_handler.post_request(e, base_url_.c_str(), "/api/Key/CreateTrialKey");
 
   std::ostringstream product_id_; product_id_ << product_id;
 
@@ -876,7 +988,7 @@ basic_Cryptolens<Configuration>::get_key_
 {
   if (e) { return nullopt; }
 
-  auto request = request_handler.post_request(e, "api.cryptolens.io", "/api/key/GetKey");
+  auto request = request_handler.post_request(e, base_url_.c_str(), "/api/key/GetKey");
 
   std::ostringstream product_id_; product_id_ << product_id;
   std::ostringstream fields_to_return_; fields_to_return_ << fields_to_return;
@@ -892,7 +1004,7 @@ basic_Cryptolens<Configuration>::get_key_
            .make(e);
 
   optional<RawLicenseKey> raw_license_key = handle_activate_raw(e, this->response_parser, this->signature_verifier, response);
-  optional<LicenseKeyInformation> y = response_parser.make_license_key_information(e, raw_license_key);
+  optional<LicenseKeyInformation> y = response_parser.make_license_key_information(e, raw_license_key, fields_to_return);
   if (e) { return nullopt; }
 
   typename internal::GetKeyEnvironment env(*y, product_id, key, fields_to_return);
@@ -914,7 +1026,7 @@ basic_Cryptolens<Configuration>::get_messages_
 {
   if (e) { return std::vector<Message>(); }
 
-  auto request = request_handler.post_request(e, "api.cryptolens.io", "/api/message/GetMessages");
+  auto request = request_handler.post_request(e, base_url_.c_str(), "/api/message/GetMessages");
 
   std::ostringstream stm; stm << since_unix_timestamp;
 
@@ -940,7 +1052,7 @@ basic_Cryptolens<Configuration>::last_message_
 {
   if (e) { return ""; }
 
-  auto request = request_handler.post_request(e, "api.cryptolens.io", "/api/message/GetMessages");
+  auto request = request_handler.post_request(e, base_url_.c_str(), "/api/message/GetMessages");
 
   std::ostringstream stm; stm << since_unix_timestamp;
 
@@ -955,45 +1067,158 @@ basic_Cryptolens<Configuration>::last_message_
   return response_parser.parse_last_message_response(e, response);
 }
 
+/**
+ * Recreates a license key from a string produced by LicenseKey::to_string()
+ * or from a response from the Web API, after checking its signature.
+ *
+ * The string is only treated as a response from the Web API if its first
+ * character other than whitespace is '{'. Any other string is read in the
+ * format of LicenseKey::to_string(), thus e.g. a response with a byte order
+ * mark in front of it is not accepted.
+ *
+ * Fields of the license key which are not needed can be skipped using the
+ * values in FieldsToReturn, e.g. FieldsToReturn::ACTIVATED_MACHINES for
+ * license keys with many activated machines if only the expiry date and
+ * the features are checked. Skipped fields are not copied and are empty in
+ * the LicenseKey, as if they had been excluded using fields_to_return when
+ * activating. They are still covered by the signature, which is checked on
+ * the license key as a whole.
+ *
+ * Warning: do not skip FieldsToReturn::ACTIVATED_MACHINES if the machine
+ * code is checked. Without the activated machines, e.g.
+ *
+ *     make_license_key(e, s, FieldsToReturn::ACTIVATED_MACHINES)->check().is_on_right_machine(machine_code)
+ *
+ * is always false.
+ */
 template<typename Configuration>
 optional<LicenseKey>
-basic_Cryptolens<Configuration>::make_license_key(basic_Error & e, std::string const& s)
+basic_Cryptolens<Configuration>::make_license_key(basic_Error & e, std::string const& s, int fields_to_skip)
 {
   if (e) { return nullopt; }
 
-  optional<RawLicenseKey> raw_license_key;
+  optional<LicenseKey> license_key =
+    ::cryptolens_io::v20190401::internal::make_license_key(e, this->response_parser, this->signature_verifier, s, fields_to_skip);
+  if (e) { e.set_call(api::main(), errors::Call::BASIC_SKM_MAKE_LICENSE_KEY); return nullopt; }
 
-  raw_license_key =
-    ::cryptolens_io::v20190401::internal::handle_activate(e, this->response_parser, this->signature_verifier, s);
+  return license_key;
+}
 
-  if (e) {
-    e.reset(api::main());
+/**
+ * Same as make_license_key(), except that a LicenseKeyView is returned
+ * instead of a LicenseKey.
+ */
+template<typename Configuration>
+optional<LicenseKeyView>
+basic_Cryptolens<Configuration>::make_license_key_view(basic_Error & e, std::string const& s)
+{
+  if (e) { return nullopt; }
 
-    size_t k = s.find('-');
-    if (k == std::string::npos) { e.set(api::main(), errors::Subsystem::Main, errors::Main::UNKNOWN_SERVER_REPLY); return nullopt; }
+  optional<LicenseKeyView> license_key =
+    LicenseKeyView::make(e, ::cryptolens_io::v20190401::internal::make_raw_license_key(e, this->response_parser, this->signature_verifier, s));
+  if (e) { e.set_call(api::main(), errors::Call::BASIC_CRYPTOLENS_MAKE_LICENSE_KEY_VIEW); return nullopt; }
 
-    std::string version = s.substr(0, k);
-    std::string rem = s.substr(k+1, std::string::npos);
-    // NOTE: s.substr(s.size(), _) returns empty string, thus the previous line does never throw
+  return license_key;
+}
 
-    k = rem.find('-');
-    if (k == std::string::npos) { e.set(api::main(), errors::Subsystem::Main, errors::Main::UNKNOWN_SERVER_REPLY); return nullopt; }
+/**
+ * Recreates many license keys at once, as make_license_key() does for a single
+ * license key. This is intended for when a large number of license keys saved
+ * using LicenseKey::to_string() should be checked again, e.g. as part of an audit.
+ *
+ * The work is split between several threads which share the response parser and
+ * the signature verifier of this object. Both must therefore allow their methods
+ * to be called from several threads at the same time. The response parsers of
+ * the library, and SignatureVerifier_OpenSSL, SignatureVerifier_OpenSSL3 and
+ * SignatureVerifier_caching, do. With a custom response parser or signature
+ * verifier that does not, threads must be 1.
+ *
+ * Arguments:
+ *   keys - pointer to the first of the serialized license keys
+ *   count - number of serialized license keys
+ *   key_errors - replaced by one error object per license key, describing
+ *            why the corresponding license key could not be recreated
+ *   threads - number of threads to use, or 0 for one thread per
+ *             hardware thread
+ *
+ * Returns:
+ *   A vector with one element per license key, which is empty if the
+ *   license key could not be recreated. Errors are only reported per
+ *   license key, in key_errors. If fewer threads than requested can be
+ *   started, the license keys are verified using the threads that could.
+ *   If e already holds an error, nothing is done and an empty vector is
+ *   returned.
+ */
+template<typename Configuration>
+template<typename ErrorType>
+std::vector<optional<LicenseKey>>
+basic_Cryptolens<Configuration>::verify_batch
+  ( basic_Error & e
+  , std::string const* keys
+  , std::size_t count
+  , std::vector<ErrorType> & key_errors
+  , unsigned int threads
+  )
+{
+  if (e) { return std::vector<optional<LicenseKey>>(); }
+
+  std::vector<optional<LicenseKey>> license_keys(count);
+  // basic_Error can neither be copied nor moved, thus the vector cannot be resized
+  std::vector<ErrorType>(count).swap(key_errors);
+
+  if (threads == 0) { threads = std::thread::hardware_concurrency(); }
+  if (threads == 0) { threads = 1; }
+
+  // Work is handed out in chunks, such that threads do not compete for
+  // the counter for every license key
+  std::size_t const chunk = 64;
+  std::atomic<std::size_t> next(0);
+
+  auto work = [&]() {
+    for (;;) {
+      std::size_t begin = next.fetch_add(chunk);
+      if (begin >= count) { return; }
+      std::size_t end = std::min(count, begin + chunk);
+
+      for (std::size_t i = begin; i < end; ++i) {
+        license_keys[i] =
+          ::cryptolens_io::v20190401::internal::make_license_key(key_errors[i], this->response_parser, this->signature_verifier, keys[i]);
+        if (key_errors[i]) { key_errors[i].set_call(api::main(), errors::Call::BASIC_CRYPTOLENS_VERIFY_BATCH); }
+      }
+    }
+  };
+
+  std::size_t chunks = (count + chunk - 1) / chunk;
+  if (threads > chunks) { threads = chunks; }
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < threads; ++i) {
+    try {
+      workers.push_back(std::thread(work));
+    } catch (std::system_error const&) {
+      // Fewer threads just means that the remaining ones get more work
+      break;
+    }
+  }
 
-    std::string license = rem.substr(0, k);
-    std::string signature = rem.substr(k+1, std::string::npos); // k+1 is fine, see comment above
+  work();
 
-    raw_license_key =
-        RawLicenseKey::make
-             ( e
-             , signature_verifier
-             , license
-             , signature
-             );
-  }
+  for (std::size_t i = 0; i < workers.size(); ++i) { workers[i].join(); }
 
-  optional<LicenseKeyInformation> license_key_information = response_parser.make_license_key_information(e, raw_license_key);
-  if (e) { e.set_call(api::main(), errors::Call::BASIC_SKM_MAKE_LICENSE_KEY); return nullopt; }
-  return LicenseKey(std::move(*license_key_information), std::move(*raw_license_key));
+  return license_keys;
+}
+
+template<typename Configuration>
+template<typename ErrorType>
+std::vector<optional<LicenseKey>>
+basic_Cryptolens<Configuration>::verify_batch
+  ( basic_Error & e
+  , std::vector<std::string> const& keys
+  , std::vector<ErrorType> & key_errors
+  , unsigned int threads
+  )
+{
+  return verify_batch(e, keys.data(), keys.size(), key_errors, threads);
 }
 
 namespace internal {
@@ -1020,6 +1245,72 @@ handle_activate
            );
 }
 
+template<typename ResponseParser, typename SignatureVerifier>
+optional<RawLicenseKey>
+make_raw_license_key
+  ( basic_Error & e
+  , ResponseParser const& response_parser
+  , SignatureVerifier const& signature_verifier
+  , std::string const& s
+  )
+{
+  if (e) { return nullopt; }
+
+  optional<RawLicenseKey> raw_license_key;
+
+  // Strings produced by LicenseKey::to_string() are never valid JSON, thus only
+  // try to parse the string as a response from the Web API if it might be one.
+  std::size_t first = s.find_first_not_of(" \t\r\n");
+  bool parsed = false;
+  if (first != std::string::npos && s[first] == '{') {
+    raw_license_key = ::cryptolens_io::v20190401::internal::handle_activate(e, response_parser, signature_verifier, s);
+    if (e) { e.reset(api::main()); }
+    else   { parsed = true; }
+  }
+
+  if (!parsed) {
+    size_t k = s.find('-');
+    if (k == std::string::npos) { e.set(api::main(), errors::Subsystem::Main, errors::Main::UNKNOWN_SERVER_REPLY); return nullopt; }
+
+    size_t l = s.find('-', k+1);
+    if (l == std::string::npos) { e.set(api::main(), errors::Subsystem::Main, errors::Main::UNKNOWN_SERVER_REPLY); return nullopt; }
+
+    std::string license = s.substr(k+1, l-k-1);
+    std::string signature = s.substr(l+1, std::string::npos); // l+1 <= s.size(), thus substr() does not throw
+
+    raw_license_key =
+        RawLicenseKey::make
+             ( e
+             , signature_verifier
+             , license
+             , signature
+             );
+  }
+
+  return raw_license_key;
+}
+
+template<typename ResponseParser, typename SignatureVerifier>
+optional<LicenseKey>
+make_license_key
+  ( basic_Error & e
+  , ResponseParser const& response_parser
+  , SignatureVerifier const& signature_verifier
+  , std::string const& s
+  , int fields_to_skip
+  )
+{
+  if (e) { return nullopt; }
+
+  optional<RawLicenseKey> raw_license_key =
+    ::cryptolens_io::v20190401::internal::make_raw_license_key(e, response_parser, signature_verifier, s);
+  if (e) { return nullopt; }
+
+  optional<LicenseKeyInformation> license_key_information = response_parser.make_license_key_information(e, raw_license_key, fields_to_skip);
+  if (e) { return nullopt; }
+  return LicenseKey(std::move(*license_key_information), std::move(*raw_license_key));
+}
+
 } // namespace internal
 
 } // namespace v20190401
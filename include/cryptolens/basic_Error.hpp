@@ -64,6 +64,10 @@ int constexpr BASIC_CRYPTOLENS_GET_KEY = 11;
 
 int constexpr BASIC_CRYPTOLENS_GET_MESSAGES = 12;
 
+int constexpr BASIC_CRYPTOLENS_VERIFY_BATCH = 13;
+
+int constexpr BASIC_CRYPTOLENS_MAKE_LICENSE_KEY_VIEW = 14;
+
 } // namespace Call
 
 // Errors for the Main subsystem
@@ -82,6 +86,16 @@ constexpr int MACHINE_CODE_NOT_ACTIVATED_OR_NO_KEY_ACTIVATION = 10;
 
 } // namespace Main
 
+// Errors for the Json subsystem. Responses that cannot be parsed, or that
+// lack a required field, are reported without a reason.
+namespace Json {
+
+constexpr int MAX_DEPTH_EXCEEDED    = 1;
+constexpr int MAX_ELEMENTS_EXCEEDED = 2;
+constexpr int TIME_BUDGET_EXCEEDED  = 3;
+
+} // namespace Json
+
 } // namespace errors
 
 /**
@@ -155,6 +169,7 @@ namespace errors {
 namespace Subsystem = ::cryptolens_io::v20190401::errors::Subsystem;
 namespace Call = ::cryptolens_io::v20190401::errors::Call;
 namespace Main = ::cryptolens_io::v20190401::errors::Main;
+namespace Json = ::cryptolens_io::v20190401::errors::Json;
 
 } // namespace errors
 
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cryptolens_io {
+
+namespace v20190401  {
+
+namespace internal {
+
+// Internal implementation of SHA-256 used by the library where the result
+// must not depend on which cryptographic library has been chosen, e.g. when
+// computing cache keys.
+class Sha256 {
+public:
+  static constexpr std::size_t DIGEST_SIZE = 32;
+
+  Sha256();
+
+  void update(void const* data, std::size_t len);
+  void finish(unsigned char * digest);
+
+private:
+  void compress(unsigned char const* block);
+
+  std::uint32_t state_[8];
+  std::uint64_t length_;
+  unsigned char buffer_[64];
+  std::size_t buffer_len_;
+};
+
+} // namespace internal
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
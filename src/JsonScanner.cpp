@@ -0,0 +1,416 @@
+#include <limits>
+
+#include "JsonScanner.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace internal {
+
+namespace {
+
+int
+hex_value(char c)
+{
+  if ('0' <= c && c <= '9') { return c - '0'; }
+  if ('a' <= c && c <= 'f') { return c - 'a' + 10; }
+  if ('A' <= c && c <= 'F') { return c - 'A' + 10; }
+  return -1;
+}
+
+unsigned int
+read_hex4(char const* p)
+{
+  unsigned int x = 0;
+  for (int i = 0; i < 4; ++i) { x = (x << 4) | (unsigned int)hex_value(p[i]); }
+  return x;
+}
+
+void
+append_utf8(std::string & out, unsigned int c)
+{
+  if (c < 0x80) {
+    out += (char)c;
+  } else if (c < 0x800) {
+    out += (char)(0xC0 | (c >> 6));
+    out += (char)(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    out += (char)(0xE0 | (c >> 12));
+    out += (char)(0x80 | ((c >> 6) & 0x3F));
+    out += (char)(0x80 | (c & 0x3F));
+  } else {
+    out += (char)(0xF0 | (c >> 18));
+    out += (char)(0x80 | ((c >> 12) & 0x3F));
+    out += (char)(0x80 | ((c >> 6) & 0x3F));
+    out += (char)(0x80 | (c & 0x3F));
+  }
+}
+
+// Set for all characters in strings except control characters, '"' and '\\'
+struct PlainStringChars {
+  bool table[256];
+
+  PlainStringChars()
+  {
+    for (int i = 0; i < 256; ++i) { table[i] = i >= 0x20 && i != '"' && i != '\\'; }
+  }
+
+  bool operator[](unsigned char c) const { return table[c]; }
+};
+
+} // namespace
+
+constexpr int JsonScanner::MAX_DEPTH;
+
+bool
+JsonScanner::fail()
+{
+  failed_ = true;
+  return false;
+}
+
+bool
+JsonScanner::exceed(Limit limit)
+{
+  if (!failed_) { exceeded_ = limit; }
+  return fail();
+}
+
+void
+JsonScanner::skip_whitespace()
+{
+  while (p_ != end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) { ++p_; }
+}
+
+JsonScanner::Type
+JsonScanner::peek()
+{
+  if (failed_) { return TYPE_INVALID; }
+
+  skip_whitespace();
+  if (p_ == end_) { fail(); return TYPE_INVALID; }
+
+  switch (*p_) {
+  case '{': return TYPE_OBJECT;
+  case '[': return TYPE_ARRAY;
+  case '"': return TYPE_STRING;
+  case 't': return TYPE_TRUE;
+  case 'f': return TYPE_FALSE;
+  case 'n': return TYPE_NULL;
+  case '-': return TYPE_NUMBER;
+  default:
+    if ('0' <= *p_ && *p_ <= '9') { return TYPE_NUMBER; }
+    fail();
+    return TYPE_INVALID;
+  }
+}
+
+bool
+JsonScanner::enter_object()
+{
+  if (peek() != TYPE_OBJECT) { return fail(); }
+  if (depth_ >= max_depth_) { return exceed(LIMIT_DEPTH); }
+
+  ++p_;
+  ++depth_;
+  first_ = true;
+  return true;
+}
+
+bool
+JsonScanner::next_key(StringView & key, bool & escaped)
+{
+  if (failed_) { return false; }
+
+  skip_whitespace();
+  if (p_ == end_) { return fail(); }
+
+  if (*p_ == '}') { ++p_; --depth_; first_ = false; return false; }
+
+  if (!first_) {
+    if (*p_ != ',') { return fail(); }
+    ++p_;
+  }
+  first_ = false;
+
+  if (deadline_ && deadline_->check()) { return exceed(LIMIT_TIME); }
+
+  if (peek() != TYPE_STRING) { return fail(); }
+  if (!read_string(key, escaped)) { return false; }
+
+  skip_whitespace();
+  if (p_ == end_ || *p_ != ':') { return fail(); }
+  ++p_;
+
+  return true;
+}
+
+bool
+JsonScanner::enter_array()
+{
+  if (peek() != TYPE_ARRAY) { return fail(); }
+  if (depth_ >= max_depth_) { return exceed(LIMIT_DEPTH); }
+
+  ++p_;
+  ++depth_;
+  first_ = true;
+  return true;
+}
+
+bool
+JsonScanner::next_element()
+{
+  if (failed_) { return false; }
+
+  skip_whitespace();
+  if (p_ == end_) { return fail(); }
+
+  if (*p_ == ']') { ++p_; --depth_; first_ = false; return false; }
+
+  if (!first_) {
+    if (*p_ != ',') { return fail(); }
+    ++p_;
+  }
+  first_ = false;
+
+  if (deadline_ && deadline_->check()) { return exceed(LIMIT_TIME); }
+
+  return true;
+}
+
+bool
+JsonScanner::read_string(StringView & value, bool & escaped)
+{
+  if (peek() != TYPE_STRING) { return fail(); }
+
+  static PlainStringChars const plain;
+
+  char const* begin = ++p_;
+  escaped = false;
+
+  while (p_ != end_) {
+    // Skip characters which need no further checks
+    while (p_ != end_ && plain[(unsigned char)*p_]) { ++p_; }
+    if (p_ == end_) { break; }
+
+    unsigned char c = (unsigned char)*p_;
+
+    if (c == '"') {
+      value = StringView(begin, p_ - begin);
+      ++p_;
+      return true;
+    }
+
+    if (c < 0x20) { return fail(); }
+
+    if (c == '\\') {
+      escaped = true;
+      ++p_;
+      if (p_ == end_) { return fail(); }
+
+      switch (*p_) {
+      case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+        break;
+      case 'u':
+        if (end_ - p_ < 5) { return fail(); }
+        for (int i = 1; i <= 4; ++i) {
+          if (hex_value(p_[i]) < 0) { return fail(); }
+        }
+        p_ += 4;
+        break;
+      default:
+        return fail();
+      }
+    }
+
+    ++p_;
+  }
+
+  return fail();
+}
+
+bool
+JsonScanner::number(std::uint64_t & magnitude, bool & negative, bool & is_integer)
+{
+  if (peek() != TYPE_NUMBER) { return fail(); }
+
+  negative = false;
+  if (*p_ == '-') {
+    negative = true;
+    ++p_;
+  }
+
+  if (p_ == end_ || *p_ < '0' || '9' < *p_) { return fail(); }
+
+  std::uint64_t x = 0;
+  bool overflow = false;
+
+  if (*p_ == '0') {
+    ++p_;
+  } else {
+    for (; p_ != end_ && '0' <= *p_ && *p_ <= '9'; ++p_) {
+      std::uint64_t d = (std::uint64_t)(*p_ - '0');
+      if (x > (std::numeric_limits<std::uint64_t>::max() - d) / 10) { overflow = true; }
+      x = x * 10 + d;
+    }
+  }
+
+  bool integer = true;
+
+  if (p_ != end_ && *p_ == '.') {
+    integer = false;
+    ++p_;
+    if (p_ == end_ || *p_ < '0' || '9' < *p_) { return fail(); }
+    while (p_ != end_ && '0' <= *p_ && *p_ <= '9') { ++p_; }
+  }
+
+  if (p_ != end_ && (*p_ == 'e' || *p_ == 'E')) {
+    integer = false;
+    ++p_;
+    if (p_ != end_ && (*p_ == '+' || *p_ == '-')) { ++p_; }
+    if (p_ == end_ || *p_ < '0' || '9' < *p_) { return fail(); }
+    while (p_ != end_ && '0' <= *p_ && *p_ <= '9') { ++p_; }
+  }
+
+  is_integer = integer && !overflow;
+  magnitude = x;
+
+  return true;
+}
+
+bool
+JsonScanner::read_number(std::uint64_t & value, bool & is_unsigned)
+{
+  std::uint64_t magnitude;
+  bool negative, is_integer;
+  if (!number(magnitude, negative, is_integer)) { return false; }
+
+  is_unsigned = is_integer && !negative;
+  value = is_unsigned ? magnitude : 0;
+
+  return true;
+}
+
+bool
+JsonScanner::read_int(std::int64_t & value, bool & is_integer)
+{
+  std::uint64_t magnitude;
+  bool negative;
+  if (!number(magnitude, negative, is_integer)) { return false; }
+
+  std::uint64_t const max = (std::uint64_t)std::numeric_limits<std::int64_t>::max();
+  if (negative) {
+    is_integer = is_integer && magnitude <= max + 1;
+    value = is_integer ? (std::int64_t)(0 - magnitude) : 0;
+  } else {
+    is_integer = is_integer && magnitude <= max;
+    value = is_integer ? (std::int64_t)magnitude : 0;
+  }
+
+  return true;
+}
+
+bool
+JsonScanner::literal(char const* s, std::size_t n)
+{
+  if ((std::size_t)(end_ - p_) < n) { return fail(); }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    if (p_[i] != s[i]) { return fail(); }
+  }
+
+  p_ += n;
+  return true;
+}
+
+bool
+JsonScanner::read_bool(bool & value)
+{
+  switch (peek()) {
+  case TYPE_TRUE:  value = true;  return literal("true", 4);
+  case TYPE_FALSE: value = false; return literal("false", 5);
+  default:         return fail();
+  }
+}
+
+// The recursion is bounded since enter_object() and enter_array() fail once
+// the maximum depth has been reached
+bool
+JsonScanner::skip_value()
+{
+  StringView s;
+  bool escaped;
+  std::uint64_t x;
+  bool b;
+
+  switch (peek()) {
+  case TYPE_OBJECT:
+    if (!enter_object()) { return false; }
+    while (next_key(s, escaped)) {
+      if (!skip_value()) { return false; }
+    }
+    return !failed_;
+
+  case TYPE_ARRAY:
+    if (!enter_array()) { return false; }
+    while (next_element()) {
+      if (!skip_value()) { return false; }
+    }
+    return !failed_;
+
+  case TYPE_STRING: return read_string(s, escaped);
+  case TYPE_NUMBER: return read_number(x, b);
+  case TYPE_TRUE:   return read_bool(b);
+  case TYPE_FALSE:  return read_bool(b);
+  case TYPE_NULL:   return literal("null", 4);
+  default:          return fail();
+  }
+}
+
+void
+JsonScanner::unescape(StringView raw, std::string & out)
+{
+  char const* p = raw.begin();
+  char const* end = raw.end();
+
+  while (p != end) {
+    char const* q = p;
+    while (q != end && *q != '\\') { ++q; }
+    out.append(p, q - p);
+    if (q == end) { break; }
+
+    // read_string() has already checked that the escape sequences are valid
+    p = q + 1;
+    switch (*p) {
+    case 'b': out += '\b'; ++p; break;
+    case 'f': out += '\f'; ++p; break;
+    case 'n': out += '\n'; ++p; break;
+    case 'r': out += '\r'; ++p; break;
+    case 't': out += '\t'; ++p; break;
+    case 'u': {
+      unsigned int c = read_hex4(p + 1);
+      p += 5;
+
+      if (0xD800 <= c && c < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+        unsigned int d = read_hex4(p + 2);
+        if (0xDC00 <= d && d < 0xE000) {
+          c = 0x10000 + ((c - 0xD800) << 10) + (d - 0xDC00);
+          p += 6;
+        }
+      }
+
+      append_utf8(out, c);
+      break;
+    }
+    default:
+      out += *p; ++p; break;
+    }
+  }
+}
+
+} // namespace internal
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
@@ -183,6 +183,11 @@ LicenseKeyChecker::is_not_blocked()
 /**
  * Check that machine_code is among the allowed machines for the
  * underlying LicenseKey object.
+ *
+ * Note that this check always fails if the activated machines are missing
+ * from the license key, e.g. if they were excluded using fields_to_return
+ * when activating, or skipped using FieldsToReturn::ACTIVATED_MACHINES in
+ * basic_Cryptolens::make_license_key().
  */
 LicenseKeyChecker&
 LicenseKeyChecker::is_on_right_machine(std::string const& machine_code)
@@ -0,0 +1,525 @@
+#include <algorithm>
+#include <utility>
+
+#include "api.hpp"
+#include "LicenseKeyView.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace internal {
+
+struct LicenseKeyView_Storage {
+  std::string base64_license;
+  std::string signature;
+  std::string license;
+
+  // Contents of the strings in the license containing escape sequences,
+  // indexed by where the string starts in the license. Strings without
+  // escape sequences are referred to directly.
+  std::string unescaped;
+  std::vector<std::pair<char const*, StringView>> escaped;
+
+  StringView get(StringView raw, bool is_escaped) const
+  {
+    if (!is_escaped) { return raw; }
+
+    std::vector<std::pair<char const*, StringView>>::const_iterator it =
+      std::lower_bound( escaped.begin(), escaped.end(), raw.data()
+                      , [](std::pair<char const*, StringView> const& x, char const* p) { return x.first < p; });
+
+    return it != escaped.end() && it->first == raw.data() ? it->second : StringView();
+  }
+
+  StringView add(StringView raw, bool is_escaped)
+  {
+    if (!is_escaped) { return raw; }
+
+    // The unescaped strings are never longer than the license, thus reserving
+    // this much up front ensures the views into the buffer remain valid.
+    if (unescaped.capacity() < license.size()) { unescaped.reserve(license.size()); }
+
+    std::size_t offset = unescaped.size();
+    JsonScanner::unescape(raw, unescaped);
+    StringView value(unescaped.data() + offset, unescaped.size() - offset);
+
+    escaped.push_back(std::make_pair(raw.data(), value));
+    return value;
+  }
+};
+
+namespace {
+
+// The reason reported for a license key that could not be parsed
+int
+json_error(JsonScanner const& scanner)
+{
+  return scanner.exceeded() == JsonScanner::LIMIT_DEPTH ? errors::Json::MAX_DEPTH_EXCEEDED : 0;
+}
+
+bool
+key_equals(StringView key, bool escaped, char const* name)
+{
+  if (!escaped) { return key == name; }
+
+  std::string s;
+  JsonScanner::unescape(key, s);
+  return s == name;
+}
+
+// Reads a value which is only used if it has the expected type. Returns false
+// only on syntax errors.
+template<typename Strings>
+bool
+read_string(JsonScanner & scanner, Strings & strings, optional<StringView> & out)
+{
+  if (scanner.peek() != JsonScanner::TYPE_STRING) { return scanner.skip_value(); }
+
+  StringView raw;
+  bool escaped;
+  if (!scanner.read_string(raw, escaped)) { return false; }
+
+  out = strings.add(raw, escaped);
+  return true;
+}
+
+bool
+read_uint(JsonScanner & scanner, optional<std::uint64_t> & out)
+{
+  if (scanner.peek() != JsonScanner::TYPE_NUMBER) { return scanner.skip_value(); }
+
+  std::uint64_t x;
+  bool is_unsigned;
+  if (!scanner.read_number(x, is_unsigned)) { return false; }
+
+  if (is_unsigned) { out = x; }
+  return true;
+}
+
+bool
+read_bool(JsonScanner & scanner, optional<bool> & out)
+{
+  JsonScanner::Type t = scanner.peek();
+  if (t != JsonScanner::TYPE_TRUE && t != JsonScanner::TYPE_FALSE) { return scanner.skip_value(); }
+
+  bool x;
+  if (!scanner.read_bool(x)) { return false; }
+
+  out = x;
+  return true;
+}
+
+// If a key occurs more than once the last value is used, even if it has
+// another type, the way ResponseParser_ArduinoJson7 does
+template<typename T, typename F>
+bool
+read_last(optional<T> & out, F f)
+{
+  out = nullopt;
+  return f(out);
+}
+
+// Strings are added to the storage while the license is parsed in make(),
+// and subsequently looked up when the arrays are iterated over.
+struct AddStrings {
+  LicenseKeyView_Storage & storage;
+  StringView add(StringView raw, bool escaped) { return storage.add(raw, escaped); }
+};
+
+struct GetStrings {
+  LicenseKeyView_Storage const& storage;
+  StringView add(StringView raw, bool escaped) { return storage.get(raw, escaped); }
+};
+
+// The following functions read one element of an array, and return false
+// only on syntax errors. valid is set if the element has the expected type.
+
+template<typename Strings>
+bool
+read_element(JsonScanner & scanner, Strings & strings, ActivationDataView & out, bool & valid)
+{
+  valid = false;
+  if (scanner.peek() != JsonScanner::TYPE_OBJECT) { return scanner.skip_value(); }
+
+  optional<StringView> mid, ip, friendly_name;
+  optional<std::uint64_t> time;
+
+  scanner.enter_object();
+
+  StringView key;
+  bool escaped;
+  while (scanner.next_key(key, escaped)) {
+    bool ok;
+    if (key_equals(key, escaped, "Mid")) {
+      ok = read_last(mid, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else if (key_equals(key, escaped, "IP")) {
+      ok = read_last(ip, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else if (key_equals(key, escaped, "Time")) {
+      ok = read_last(time, [&](optional<std::uint64_t> & x) { return read_uint(scanner, x); });
+    } else if (key_equals(key, escaped, "FriendlyName")) {
+      ok = read_last(friendly_name, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else {
+      ok = scanner.skip_value();
+    }
+
+    if (!ok) { return false; }
+  }
+  if (scanner.failed()) { return false; }
+
+  if (mid && ip && time) {
+    out = ActivationDataView(*mid, *ip, *time, friendly_name);
+    valid = true;
+  }
+
+  return true;
+}
+
+template<typename Strings>
+bool
+read_element(JsonScanner & scanner, Strings & strings, DataObjectView & out, bool & valid)
+{
+  valid = false;
+  if (scanner.peek() != JsonScanner::TYPE_OBJECT) { return scanner.skip_value(); }
+
+  optional<std::uint64_t> id, int_value;
+  optional<StringView> name, string_value;
+
+  scanner.enter_object();
+
+  StringView key;
+  bool escaped;
+  while (scanner.next_key(key, escaped)) {
+    bool ok;
+    if (key_equals(key, escaped, "Id")) {
+      ok = read_last(id, [&](optional<std::uint64_t> & x) { return read_uint(scanner, x); });
+    } else if (key_equals(key, escaped, "Name")) {
+      ok = read_last(name, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else if (key_equals(key, escaped, "StringValue")) {
+      ok = read_last(string_value, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else if (key_equals(key, escaped, "IntValue")) {
+      ok = read_last(int_value, [&](optional<std::uint64_t> & x) { return read_uint(scanner, x); });
+    } else {
+      ok = scanner.skip_value();
+    }
+
+    if (!ok) { return false; }
+  }
+  if (scanner.failed()) { return false; }
+
+  if (id && name && string_value && int_value) {
+    out = DataObjectView((int)*id, *name, *string_value, (int)*int_value);
+    valid = true;
+  }
+
+  return true;
+}
+
+// Validates an array and counts its elements. The array is only used if all
+// elements are valid.
+template<typename T>
+bool
+read_array
+  ( JsonScanner & scanner
+  , std::shared_ptr<LicenseKeyView_Storage> const& storage
+  , optional<LicenseKeyView_Array<T>> & out
+  )
+{
+  out = nullopt;
+  if (scanner.peek() != JsonScanner::TYPE_ARRAY) { return scanner.skip_value(); }
+
+  char const* begin = scanner.position();
+  char const* end = storage->license.data() + storage->license.size();
+  AddStrings strings{*storage};
+
+  bool all_valid = true;
+  std::size_t size = 0;
+
+  scanner.enter_array();
+  while (scanner.next_element()) {
+    T element;
+    bool valid;
+    if (!read_element(scanner, strings, element, valid)) { return false; }
+
+    all_valid = all_valid && valid;
+    size += 1;
+  }
+  if (scanner.failed()) { return false; }
+
+  if (all_valid) { out = LicenseKeyView_Array<T>(storage, begin, end, size); }
+  return true;
+}
+
+template<typename Strings>
+bool
+read_customer(JsonScanner & scanner, Strings & strings, optional<CustomerView> & out)
+{
+  out = nullopt;
+  if (scanner.peek() != JsonScanner::TYPE_OBJECT) { return scanner.skip_value(); }
+
+  optional<std::uint64_t> id, created;
+  optional<StringView> name, email, company_name;
+
+  scanner.enter_object();
+
+  StringView key;
+  bool escaped;
+  while (scanner.next_key(key, escaped)) {
+    bool ok;
+    if (key_equals(key, escaped, "Id")) {
+      ok = read_last(id, [&](optional<std::uint64_t> & x) { return read_uint(scanner, x); });
+    } else if (key_equals(key, escaped, "Name")) {
+      ok = read_last(name, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else if (key_equals(key, escaped, "Email")) {
+      ok = read_last(email, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else if (key_equals(key, escaped, "CompanyName")) {
+      ok = read_last(company_name, [&](optional<StringView> & x) { return read_string(scanner, strings, x); });
+    } else if (key_equals(key, escaped, "Created")) {
+      ok = read_last(created, [&](optional<std::uint64_t> & x) { return read_uint(scanner, x); });
+    } else {
+      ok = scanner.skip_value();
+    }
+
+    if (!ok) { return false; }
+  }
+  if (scanner.failed()) { return false; }
+
+  if (id && created) {
+    out = CustomerView
+            ( (int)*id
+            , name ? *name : StringView()
+            , email ? *email : StringView()
+            , company_name ? *company_name : StringView()
+            , *created
+            );
+  }
+
+  return true;
+}
+
+} // namespace
+
+void
+read_view(LicenseKeyView_Storage const& storage, JsonScanner & scanner, ActivationDataView & view)
+{
+  GetStrings strings{storage};
+  bool valid;
+  read_element(scanner, strings, view, valid);
+}
+
+void
+read_view(LicenseKeyView_Storage const& storage, JsonScanner & scanner, DataObjectView & view)
+{
+  GetStrings strings{storage};
+  bool valid;
+  read_element(scanner, strings, view, valid);
+}
+
+} // namespace internal
+
+ActivationData
+ActivationDataView::to_activation_data() const
+{
+  if (friendly_name_) {
+    return ActivationData(mid_.to_string(), ip_.to_string(), time_, friendly_name_->to_string());
+  } else {
+    return ActivationData(mid_.to_string(), ip_.to_string(), time_);
+  }
+}
+
+Customer
+CustomerView::to_customer() const
+{
+  return Customer(id_, name_.to_string(), email_.to_string(), company_name_.to_string(), created_);
+}
+
+DataObject
+DataObjectView::to_data_object() const
+{
+  return DataObject(id_, name_.to_string(), string_value_.to_string(), int_value_);
+}
+
+LicenseKeyView::LicenseKeyView()
+: product_id_(0), created_(0), expires_(0), period_(0), block_(false), trial_activation_(false), sign_date_(0)
+, f1_(false), f2_(false), f3_(false), f4_(false), f5_(false), f6_(false), f7_(false), f8_(false)
+{ }
+
+optional<LicenseKeyView>
+LicenseKeyView::make(basic_Error & e, RawLicenseKey && raw_license_key)
+{
+  if (e) { return nullopt; }
+
+  std::shared_ptr<internal::LicenseKeyView_Storage> storage = std::make_shared<internal::LicenseKeyView_Storage>();
+  storage->base64_license = std::move(raw_license_key.base64_license_);
+  storage->signature = std::move(raw_license_key.signature_);
+  storage->license = std::move(raw_license_key.license_);
+
+  LicenseKeyView view;
+  int reason = 0;
+  if (!view.parse(storage, reason)) { e.set(api::main(), errors::Subsystem::Json, reason); return nullopt; }
+
+  view.storage_ = std::move(storage);
+  return make_optional(std::move(view));
+}
+
+optional<LicenseKeyView>
+LicenseKeyView::make(basic_Error & e, optional<RawLicenseKey> && raw_license_key)
+{
+  if (e) { return nullopt; }
+
+  if (!raw_license_key) { return nullopt; }
+
+  return LicenseKeyView::make(e, std::move(*raw_license_key));
+}
+
+bool
+LicenseKeyView::parse(std::shared_ptr<internal::LicenseKeyView_Storage> const& storage, int & reason)
+{
+  using internal::JsonScanner;
+
+  std::string const& license = storage->license;
+  JsonScanner scanner(license.data(), license.data() + license.size());
+  scanner.set_max_depth(internal::DEFAULT_MAX_DEPTH);
+  internal::AddStrings strings{*storage};
+
+  optional<std::uint64_t> product_id, created, expires, period, sign_date;
+  optional<bool> block, trial_activation, f1, f2, f3, f4, f5, f6, f7, f8;
+  optional<std::uint64_t> id, global_id, maxnoofmachines;
+
+  if (!scanner.enter_object()) { reason = internal::json_error(scanner); return false; }
+
+  auto u = [&](optional<std::uint64_t> & x) { return internal::read_uint(scanner, x); };
+  auto b = [&](optional<bool> & x) { return internal::read_bool(scanner, x); };
+  auto s = [&](optional<StringView> & x) { return internal::read_string(scanner, strings, x); };
+
+  StringView key;
+  bool escaped;
+  while (scanner.next_key(key, escaped)) {
+    using internal::key_equals;
+    using internal::read_last;
+
+    bool ok;
+    if      (key_equals(key, escaped, "ProductId"))         { ok = read_last(product_id, u); }
+    else if (key_equals(key, escaped, "ID"))                { ok = read_last(id, u); }
+    else if (key_equals(key, escaped, "Key"))               { ok = read_last(key_, s); }
+    else if (key_equals(key, escaped, "Created"))           { ok = read_last(created, u); }
+    else if (key_equals(key, escaped, "Expires"))           { ok = read_last(expires, u); }
+    else if (key_equals(key, escaped, "Period"))            { ok = read_last(period, u); }
+    else if (key_equals(key, escaped, "F1"))                { ok = read_last(f1, b); }
+    else if (key_equals(key, escaped, "F2"))                { ok = read_last(f2, b); }
+    else if (key_equals(key, escaped, "F3"))                { ok = read_last(f3, b); }
+    else if (key_equals(key, escaped, "F4"))                { ok = read_last(f4, b); }
+    else if (key_equals(key, escaped, "F5"))                { ok = read_last(f5, b); }
+    else if (key_equals(key, escaped, "F6"))                { ok = read_last(f6, b); }
+    else if (key_equals(key, escaped, "F7"))                { ok = read_last(f7, b); }
+    else if (key_equals(key, escaped, "F8"))                { ok = read_last(f8, b); }
+    else if (key_equals(key, escaped, "Notes"))             { ok = read_last(notes_, s); }
+    else if (key_equals(key, escaped, "Block"))             { ok = read_last(block, b); }
+    else if (key_equals(key, escaped, "GlobalId"))          { ok = read_last(global_id, u); }
+    else if (key_equals(key, escaped, "Customer"))          { ok = internal::read_customer(scanner, strings, customer_); }
+    else if (key_equals(key, escaped, "ActivatedMachines")) { ok = internal::read_array(scanner, storage, activated_machines_); }
+    else if (key_equals(key, escaped, "TrialActivation"))   { ok = read_last(trial_activation, b); }
+    else if (key_equals(key, escaped, "MaxNoOfMachines"))   { ok = read_last(maxnoofmachines, u); }
+    else if (key_equals(key, escaped, "AllowedMachines"))   { ok = read_last(allowed_machines_, s); }
+    else if (key_equals(key, escaped, "DataObjects"))       { ok = internal::read_array(scanner, storage, data_objects_); }
+    else if (key_equals(key, escaped, "SignDate"))          { ok = read_last(sign_date, u); }
+    else                                                    { ok = scanner.skip_value(); }
+
+    if (!ok) { reason = internal::json_error(scanner); return false; }
+  }
+  if (scanner.failed()) { reason = internal::json_error(scanner); return false; }
+
+  // Same mandatory fields as ResponseParser_ArduinoJson7
+  bool mandatory_missing =
+      !( product_id && created && expires && period && block && trial_activation && sign_date
+      && f1 && f2 && f3 && f4 && f5 && f6 && f7 && f8
+       );
+  if (mandatory_missing) { return false; }
+
+  product_id_ = (int)*product_id;
+  created_ = *created;
+  expires_ = *expires;
+  period_ = (int)*period;
+  block_ = *block;
+  trial_activation_ = *trial_activation;
+  sign_date_ = *sign_date;
+  f1_ = *f1; f2_ = *f2; f3_ = *f3; f4_ = *f4;
+  f5_ = *f5;
+  f6_ = *f6; f7_ = *f7; f8_ = *f8;
+
+  if (id) { id_ = (int)*id; }
+  if (global_id) { global_id_ = (int)*global_id; }
+  if (maxnoofmachines) { maxnoofmachines_ = (int)*maxnoofmachines; }
+
+  return true;
+}
+
+std::string
+LicenseKeyView::to_string() const
+{
+  std::string s;
+
+  s += "v20180502-";
+  s += storage_->base64_license;
+  s += '-';
+  s += storage_->signature;
+
+  return s;
+}
+
+LicenseKeyInformation
+LicenseKeyView::to_license_key_information() const
+{
+  optional<std::string> key;
+  if (key_) { key = key_->to_string(); }
+
+  optional<std::string> notes;
+  if (notes_) { notes = notes_->to_string(); }
+
+  optional<Customer> customer;
+  if (customer_) { customer = customer_->to_customer(); }
+
+  optional<std::vector<ActivationData>> activated_machines;
+  if (activated_machines_) {
+    std::vector<ActivationData> v;
+    v.reserve(activated_machines_->size());
+    for (ActivationDataView const& x : *activated_machines_) { v.push_back(x.to_activation_data()); }
+    activated_machines = std::move(v);
+  }
+
+  optional<std::string> allowed_machines;
+  if (allowed_machines_) { allowed_machines = allowed_machines_->to_string(); }
+
+  optional<std::vector<DataObject>> data_objects;
+  if (data_objects_) {
+    std::vector<DataObject> v;
+    v.reserve(data_objects_->size());
+    for (DataObjectView const& x : *data_objects_) { v.push_back(x.to_data_object()); }
+    data_objects = std::move(v);
+  }
+
+  return LicenseKeyInformation
+    ( api::internal::main()
+    , product_id_
+    , created_
+    , expires_
+    , period_
+    , block_
+    , trial_activation_
+    , sign_date_
+    , f1_, f2_, f3_, f4_, f5_, f6_, f7_, f8_
+    , id_
+    , std::move(key)
+    , std::move(notes)
+    , global_id_
+    , std::move(customer)
+    , std::move(activated_machines)
+    , maxnoofmachines_
+    , std::move(allowed_machines)
+    , std::move(data_objects)
+    );
+}
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
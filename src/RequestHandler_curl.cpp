@@ -1,15 +1,74 @@
+#include <cstring>
+#include <mutex>
+#include <utility>
+
 #ifdef CRYPTOLENS_CURL_EMBED_CACERTS
+#include <utility>
 #include <vector>
 
 #include "imports/openssl/ssl.h"
 #endif /* CRYPTOLENS_CURL_EMBED_CACERTS */
 
+#ifdef CRYPTOLENS_CURL_TLS_SESSIONS
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "imports/openssl/ssl.h"
+#endif /* CRYPTOLENS_CURL_TLS_SESSIONS */
+
 #include "RequestHandler_curl.hpp"
 
 namespace cryptolens_io {
 
 namespace v20190401 {
 
+#ifdef CRYPTOLENS_CURL_TLS_SESSIONS
+
+namespace internal {
+
+/*
+ * Stores TLS sessions in a file, such that a later process can resume the
+ * session instead of performing a full handshake. The file consists of
+ * entries holding the host name, the time the session expires and the DER
+ * encoded session. Readers and writers lock the file using flock(), and
+ * a file that cannot be parsed is treated as empty.
+ */
+class TlsSessionFile {
+public:
+  TlsSessionFile() : path_() {}
+
+  void set_path(std::string const& path);
+  SSL_SESSION * load(char const* host) const;
+  void store(char const* host, SSL_SESSION * session) const;
+
+private:
+  struct Entry {
+    std::string host;
+    std::uint64_t expires;
+    std::string der;
+  };
+
+  static std::size_t const MAX_ENTRIES = 16;
+
+  static std::vector<Entry> read_entries(int fd);
+  static std::string write_entries(std::vector<Entry> const& entries);
+
+  std::string get_path() const;
+
+  mutable std::mutex mutex_;
+  std::string path_; // Empty if no sessions are stored, protected by mutex_
+};
+
+} // namespace internal
+
+#endif /* CRYPTOLENS_CURL_TLS_SESSIONS */
+
 /*
  * RequestHandler_curl
  */
@@ -17,7 +76,26 @@ namespace v20190401 {
 RequestHandler_curl::RequestHandler_curl(basic_Error & e)
 {
   this->curl = curl_easy_init();
+  this->resolve_ = NULL;
   this->timeout_ms_ = 0;
+  this->reconnect_attempts_ = 0;
+  this->max_response_size_ = 0;
+  this->report_http_status_ = false;
+  this->ssl_ctx_data_.pinned_cacerts = NULL;
+  this->ssl_ctx_data_.tls_sessions = NULL;
+
+  if (this->curl) {
+    // If the handle cannot be set up we report this in the same way as
+    // if curl_easy_init() failed, i.e. using CURL_NULL when making a request.
+    basic_Error setup_error;
+    internal::curl_setup_handle(setup_error, this->curl, NULL);
+#if defined(CRYPTOLENS_CURL_EMBED_CACERTS) || defined(CRYPTOLENS_CURL_TLS_SESSIONS)
+    if (!setup_error && curl_easy_setopt(this->curl, CURLOPT_SSL_CTX_DATA, (void *)&this->ssl_ctx_data_) != CURLE_OK) {
+      setup_error.set(api::main(), errors::Subsystem::RequestHandler, errors::RequestHandler_curl::SETOPT_SSL_CTX_FUNCTION);
+    }
+#endif
+    if (setup_error) { curl_easy_cleanup(this->curl); this->curl = NULL; }
+  }
 }
 
 RequestHandler_curl::~RequestHandler_curl()
@@ -25,21 +103,37 @@ RequestHandler_curl::~RequestHandler_curl()
   if (this->curl) {
     curl_easy_cleanup(this->curl);
   }
+
+  // The handle refers to the list, thus it is freed after the handle
+  curl_slist_free_all(this->resolve_);
+
+#ifdef CRYPTOLENS_CURL_EMBED_CACERTS
+  if (this->ssl_ctx_data_.pinned_cacerts) { X509_STORE_free((X509_STORE *)this->ssl_ctx_data_.pinned_cacerts); }
+#endif /* CRYPTOLENS_CURL_EMBED_CACERTS */
+
+#ifdef CRYPTOLENS_CURL_TLS_SESSIONS
+  // Closing the connections kept by the handle can still store sessions
+  delete (internal::TlsSessionFile *)this->ssl_ctx_data_.tls_sessions;
+#endif /* CRYPTOLENS_CURL_TLS_SESSIONS */
 }
 
 RequestHandler_curl::PostBuilder
 RequestHandler_curl::post_request(basic_Error & e, char const* host, char const* endpoint)
 {
-  return RequestHandler_curl_PostBuilder(curl, host, endpoint, this->timeout_ms_);
+  return RequestHandler_curl_PostBuilder(curl, host, endpoint, this->timeout_ms_, this->reconnect_attempts_, this->max_response_size_, this->report_http_status_);
 }
 
 /*
  * RequestHandler_curl_PostBuilder
  */
 
-RequestHandler_curl_PostBuilder::RequestHandler_curl_PostBuilder(CURL * curl, char const* host, char const* endpoint, long timeout_ms)
-: curl_(curl), separator_(' '), postfields_(), url_("https://"), timeout_ms_(timeout_ms)
+RequestHandler_curl_PostBuilder::RequestHandler_curl_PostBuilder(CURL * curl, char const* host, char const* endpoint, long timeout_ms, int reconnect_attempts, std::size_t max_response_size, bool report_http_status)
+: curl_(curl), separator_(' '), postfields_(), url_(), timeout_ms_(timeout_ms), reconnect_attempts_(reconnect_attempts)
+, max_response_size_(max_response_size), report_http_status_(report_http_status)
 {
+  // The host may include the scheme, e.g. "http://127.0.0.1:8080", which is
+  // mostly useful when testing against a local server.
+  if (std::strstr(host, "://") == nullptr) { url_ = "https://"; }
   url_ += host;
   if (url_.size() > 0 && url_.back() != '/' && endpoint != nullptr && *endpoint != '/') { url_ += '/'; }
   url_ += endpoint;
@@ -76,23 +170,128 @@ RequestHandler_curl_PostBuilder::add_argument(basic_Error & e, char const* key,
 size_t
 handle_response(char * ptr, size_t size, size_t nmemb, void *userdata)
 {
-  std::string current{ptr, size*nmemb};
+  internal::CurlResponse *response = (internal::CurlResponse *)userdata;
+  size_t n = size*nmemb;
 
-  std::string *response = (std::string *)userdata;
-  *response += current;
+  // Returning less than n makes curl abort the transfer
+  if (response->max_size != 0 && n > response->max_size - response->body.size()) {
+    response->too_large = true;
+    return 0;
+  }
 
-  return size*nmemb;
+  response->body.append(ptr, n);
+  return n;
 }
 
 #ifdef CRYPTOLENS_CURL_EMBED_CACERTS
 
 namespace cacerts {
 
+#ifdef CRYPTOLENS_CURL_CACERTS_DER
+// Pairs of the name of the CA and the DER encoded certificate, as
+// generated by util/mk-ca-bundle.pl -D
+extern
+std::vector<std::pair<std::string, std::string>> ders;
+#else
 extern
 std::vector<std::string> pems;
+#endif
 
 } // namespace cacerts
 
+namespace {
+
+void
+cacerts_store_up_ref(X509_STORE * store)
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  CRYPTO_add(&store->references, 1, CRYPTO_LOCK_X509_STORE);
+#else
+  X509_STORE_up_ref(store);
+#endif
+}
+
+bool
+cacerts_is_selected(std::vector<std::string> const* names, std::string const& name)
+{
+  if (names == NULL) { return true; }
+
+  for (std::string const& x : *names) {
+    if (x == name) { return true; }
+  }
+
+  return false;
+}
+
+/*
+ * Creates a certificate store with the embedded CA certificates. If names is
+ * not NULL, only the CA certificates with one of the given names are added.
+ *
+ * The number of certificates that were added is returned in found.
+ */
+X509_STORE *
+cacerts_store_create(std::vector<std::string> const* names, size_t & found)
+{
+  found = 0;
+
+  X509_STORE * store = X509_STORE_new();
+  if (store == NULL) { return NULL; }
+
+#ifdef CRYPTOLENS_CURL_CACERTS_DER
+  for (std::pair<std::string, std::string> const& der : cacerts::ders) {
+    if (!cacerts_is_selected(names, der.first)) { continue; }
+
+    unsigned char const* p = (unsigned char const*)der.second.data();
+    X509 *cert = d2i_X509(NULL, &p, (long)der.second.size());
+    if (cert == nullptr) { continue; }
+#else
+  for (std::string const& pem : cacerts::pems) {
+    // Each entry starts with the name of the CA on a line of its own
+    if (!cacerts_is_selected(names, pem.substr(0, pem.find('\n')))) { continue; }
+
+    BIO * bio = BIO_new_mem_buf((void *)pem.data(), (int)pem.size());
+    if (bio == nullptr) { continue; }
+
+    X509 *cert = nullptr;
+    PEM_read_bio_X509(bio, &cert, 0, NULL);
+    BIO_free(bio);
+    if (cert == nullptr) { continue; }
+#endif
+
+    /* NOTE: We do not report partial failure since we are adding all CA
+     *       certs as described at https://curl.haxx.se/docs/caextract.html
+     *
+     *       The vast majority of these certificates are in fact not
+     *       needed to authenticate cryptolens.io, and a failure
+     *       adding most certificates is not a fatal error.
+     */
+    if (X509_STORE_add_cert(store, cert) == 1) { ++found; }
+
+    X509_free(cert);
+  }
+
+  return store;
+}
+
+/*
+ * The store with all embedded CA certificates is created the first time
+ * it is needed and then shared by all TLS contexts in the process. Each
+ * TLS context holds a reference to the store, and the reference held
+ * here keeps it alive for the lifetime of the process.
+ */
+X509_STORE *
+cacerts_shared_store()
+{
+  static std::once_flag once;
+  static X509_STORE * store = NULL;
+
+  std::call_once(once, []() { size_t found; store = cacerts_store_create(NULL, found); });
+
+  return store;
+}
+
+} // namespace
+
 static
 CURLcode
 sslctx_function_setup_cacerts(CURL *curl, void *sslctx, void *parm)
@@ -152,39 +351,523 @@ sslctx_function_setup_cacerts(CURL *curl, void *sslctx, void *parm)
    *
    */
 
-  basic_Error * e = (basic_Error*)parm;
+  // parm is either NULL or points to the settings of a RequestHandler_curl. If
+  // no store has been created by set_pinned_cacerts(), the process wide store
+  // with all embedded certificates is used.
+  internal::CurlSslCtxData const* data = (internal::CurlSslCtxData const*)parm;
+  X509_STORE * store = data != NULL && data->pinned_cacerts != NULL ? (X509_STORE *)data->pinned_cacerts : cacerts_shared_store();
+  if (store == NULL) { return CURLE_OK; }
 
-  for (std::string pem : cacerts::pems) {
-    /* TODO: Currently this function does not report partial failure
-     *       since we are adding all CA certs as described at
-     *       https://curl.haxx.se/docs/caextract.html
-     *
-     *       The vast majority of these certificates are in fact not
-     *       needed to authenticate cryptolens.io, and a failure
-     *       adding most certificates is not a fatal error.
-     */
-    BIO * bio = BIO_new_mem_buf((void *)pem.c_str(), -1);
-    X509 *cert = nullptr;
+  // SSL_CTX_set_cert_store() takes ownership of one reference
+  cacerts_store_up_ref(store);
+  SSL_CTX_set_cert_store((SSL_CTX *)sslctx, store);
 
-    PEM_read_bio_X509(bio, &cert, 0, NULL);
-    if (cert == nullptr) {
-      BIO_free(bio);
-      continue;
+  return CURLE_OK;
+}
+
+#endif /* CRYPTOLENS_CURL_EMBED_CACERTS */
+
+#ifdef CRYPTOLENS_CURL_TLS_SESSIONS
+
+namespace internal {
+
+namespace {
+
+bool
+read_u64(std::string const& s, std::size_t & pos, std::uint64_t & x)
+{
+  if (s.size() - pos < sizeof(x)) { return false; }
+  std::memcpy(&x, s.data() + pos, sizeof(x));
+  pos += sizeof(x);
+  return true;
+}
+
+bool
+read_string(std::string const& s, std::size_t & pos, std::string & x)
+{
+  std::uint64_t size;
+  if (!read_u64(s, pos, size) || s.size() - pos < size) { return false; }
+  x.assign(s, pos, (std::size_t)size);
+  pos += (std::size_t)size;
+  return true;
+}
+
+void
+write_u64(std::string & s, std::uint64_t x)
+{
+  s.append((char const*)&x, sizeof(x));
+}
+
+void
+write_string(std::string & s, std::string const& x)
+{
+  write_u64(s, x.size());
+  s += x;
+}
+
+} // namespace
+
+void
+TlsSessionFile::set_path(std::string const& path)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  path_ = path;
+}
+
+std::string
+TlsSessionFile::get_path() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return path_;
+}
+
+std::vector<TlsSessionFile::Entry>
+TlsSessionFile::read_entries(int fd)
+{
+  std::string contents;
+  char buffer[4096];
+  for (off_t offset = 0; ; ) {
+    ssize_t n = ::pread(fd, buffer, sizeof(buffer), offset);
+    if (n <= 0) { break; }
+    contents.append(buffer, n);
+    offset += n;
+  }
+
+  std::vector<Entry> entries;
+  std::size_t pos = 0;
+  while (pos < contents.size()) {
+    Entry entry;
+    if (!read_string(contents, pos, entry.host) || !read_u64(contents, pos, entry.expires) || !read_string(contents, pos, entry.der)) {
+      return std::vector<Entry>();
     }
+    entries.push_back(std::move(entry));
+  }
 
-    X509_STORE * store = SSL_CTX_get_cert_store((SSL_CTX *)sslctx);
+  return entries;
+}
 
-    if (X509_STORE_add_cert(store, cert) == 0) { /* TODO: Could add error handling */ }
+std::string
+TlsSessionFile::write_entries(std::vector<Entry> const& entries)
+{
+  std::string contents;
+  for (Entry const& entry : entries) {
+    write_string(contents, entry.host);
+    write_u64(contents, entry.expires);
+    write_string(contents, entry.der);
+  }
 
-    X509_free(cert);
-    BIO_free(bio);
+  return contents;
+}
+
+/*
+ * Returns the stored session for host, or NULL if there is none that has not
+ * expired. The caller owns the returned session.
+ */
+SSL_SESSION *
+TlsSessionFile::load(char const* host) const
+{
+  std::string path = get_path();
+  if (path.empty()) { return NULL; }
+
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) { return NULL; }
+
+  std::vector<Entry> entries;
+  if (::flock(fd, LOCK_SH) == 0) { entries = read_entries(fd); }
+  ::close(fd);
+
+  std::uint64_t now = (std::uint64_t)std::time(NULL);
+  for (Entry const& entry : entries) {
+    if (entry.host != host || entry.expires <= now) { continue; }
+
+    unsigned char const* p = (unsigned char const*)entry.der.data();
+    SSL_SESSION * session = d2i_SSL_SESSION(NULL, &p, (long)entry.der.size());
+    if (session != NULL && SSL_SESSION_is_resumable(session)) { return session; }
+    SSL_SESSION_free(session);
   }
 
-  return CURLE_OK;
+  return NULL;
+}
+
+/*
+ * Replaces the stored session for host. Expired sessions are dropped, as are
+ * the oldest sessions if there are more than MAX_ENTRIES hosts.
+ */
+void
+TlsSessionFile::store(char const* host, SSL_SESSION * session) const
+{
+  std::string path = get_path();
+  if (path.empty()) { return; }
+
+  int size = i2d_SSL_SESSION(session, NULL);
+  if (size <= 0) { return; }
+
+  Entry entry;
+  entry.host = host;
+  entry.der.resize(size);
+  unsigned char * p = (unsigned char *)&entry.der[0];
+  if (i2d_SSL_SESSION(session, &p) != size) { return; }
+
+  // TLS 1.3 tickets have a lifetime of their own, which may be shorter
+  std::uint64_t lifetime = (std::uint64_t)SSL_SESSION_get_timeout(session);
+  unsigned long hint = SSL_SESSION_get_ticket_lifetime_hint(session);
+  if (hint > 0 && hint < lifetime) { lifetime = hint; }
+  entry.expires = (std::uint64_t)SSL_SESSION_get_time(session) + lifetime;
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) { return; }
+  if (::flock(fd, LOCK_EX) != 0) { ::close(fd); return; }
+
+  std::uint64_t now = (std::uint64_t)std::time(NULL);
+  std::vector<Entry> entries;
+  for (Entry & old : read_entries(fd)) {
+    if (old.host != entry.host && old.expires > now) { entries.push_back(std::move(old)); }
+  }
+  if (entries.size() >= MAX_ENTRIES) { entries.erase(entries.begin(), entries.end() - (MAX_ENTRIES - 1)); }
+  entries.push_back(std::move(entry));
+
+  std::string contents = write_entries(entries);
+  std::size_t written = 0;
+  while (written < contents.size()) {
+    ssize_t n = ::pwrite(fd, contents.data() + written, contents.size() - written, (off_t)written);
+    if (n <= 0) { break; }
+    written += n;
+  }
+  // Void return type. A partially written file is discarded when it is read
+  if (::ftruncate(fd, (off_t)written) != 0) {}
+
+  ::close(fd);
+}
+
+std::size_t const TlsSessionFile::MAX_ENTRIES;
+
+namespace {
+
+typedef int (*NewSessionCallback)(SSL *, SSL_SESSION *);
+typedef void (*InfoCallback)(SSL const*, int, int);
+
+// Stored as ex_data on each SSL_CTX created for a RequestHandler_curl with
+// a session file, together with the callbacks installed by curl itself.
+struct TlsSessionsCtx {
+  TlsSessionFile const* file;
+  NewSessionCallback new_session;
+  InfoCallback info;
+};
+
+void
+tls_sessions_ctx_free(void * parent, void * ptr, CRYPTO_EX_DATA * ad, int idx, long argl, void * argp)
+{
+  delete (TlsSessionsCtx *)ptr;
+}
+
+int
+tls_sessions_index()
+{
+  static int index = SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, tls_sessions_ctx_free);
+  return index;
+}
+
+TlsSessionsCtx const*
+tls_sessions_ctx(SSL const* ssl)
+{
+  return (TlsSessionsCtx const*)SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), tls_sessions_index());
+}
+
+int
+tls_sessions_new_session(SSL * ssl, SSL_SESSION * session)
+{
+  TlsSessionsCtx const* ctx = tls_sessions_ctx(ssl);
+  if (ctx == NULL) { return 0; }
+
+  char const* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  if (host != NULL && SSL_SESSION_is_resumable(session)) { ctx->file->store(host, session); }
+
+  // Returning 1 means that curl keeps a reference to the session
+  return ctx->new_session != NULL ? ctx->new_session(ssl, session) : 0;
+}
+
+// Called by OpenSSL when the handshake starts, which is after curl has
+// resumed a session from its own cache if it has one, but before the
+// ClientHello is sent.
+void
+tls_sessions_info(SSL const* ssl, int where, int ret)
+{
+  TlsSessionsCtx const* ctx = tls_sessions_ctx(ssl);
+  if (ctx == NULL) { return; }
+
+  if (ctx->info != NULL) { ctx->info(ssl, where, ret); }
+
+  if ((where & SSL_CB_HANDSHAKE_START) == 0 || SSL_get_session(ssl) != NULL) { return; }
+
+  char const* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  if (host == NULL) { return; }
+
+  SSL_SESSION * session = ctx->file->load(host);
+  if (session == NULL) { return; }
+
+  // Void return type. If the session cannot be set a full handshake is made
+  SSL_set_session(const_cast<SSL *>(ssl), session);
+  SSL_SESSION_free(session);
+}
+
+void
+tls_sessions_install(SSL_CTX * sslctx, TlsSessionFile const* file)
+{
+  TlsSessionsCtx * ctx = new TlsSessionsCtx();
+  ctx->file = file;
+  ctx->new_session = SSL_CTX_sess_get_new_cb(sslctx);
+  ctx->info = SSL_CTX_get_info_callback(sslctx);
+  if (SSL_CTX_set_ex_data(sslctx, tls_sessions_index(), ctx) != 1) { delete ctx; return; }
+
+  // The new session callback is only called if the client side session cache
+  // is enabled, which curl does unless CURLOPT_SSL_SESSIONID_CACHE is 0
+  SSL_CTX_set_session_cache_mode(sslctx, SSL_CTX_get_session_cache_mode(sslctx) | SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  // curl disables TLS 1.2 session tickets, in which case a stored session can
+  // only be resumed if the server still has it in its cache. TLS 1.3 always
+  // uses tickets.
+  SSL_CTX_clear_options(sslctx, SSL_OP_NO_TICKET);
+  SSL_CTX_sess_set_new_cb(sslctx, tls_sessions_new_session);
+  SSL_CTX_set_info_callback(sslctx, tls_sessions_info);
 }
 
+} // namespace
+
+} // namespace internal
+
+#endif /* CRYPTOLENS_CURL_TLS_SESSIONS */
+
+#if defined(CRYPTOLENS_CURL_EMBED_CACERTS) || defined(CRYPTOLENS_CURL_TLS_SESSIONS)
+
+static
+CURLcode
+sslctx_function(CURL *curl, void *sslctx, void *parm)
+{
+#ifdef CRYPTOLENS_CURL_EMBED_CACERTS
+  sslctx_function_setup_cacerts(curl, sslctx, parm);
 #endif /* CRYPTOLENS_CURL_EMBED_CACERTS */
 
+#ifdef CRYPTOLENS_CURL_TLS_SESSIONS
+  internal::CurlSslCtxData const* data = (internal::CurlSslCtxData const*)parm;
+  if (data != NULL && data->tls_sessions != NULL) {
+    internal::tls_sessions_install((SSL_CTX *)sslctx, (internal::TlsSessionFile const*)data->tls_sessions);
+  }
+#endif /* CRYPTOLENS_CURL_TLS_SESSIONS */
+
+  return CURLE_OK;
+}
+
+#endif
+
+namespace internal {
+
+namespace {
+
+std::mutex share_locks[CURL_LOCK_DATA_LAST];
+
+void
+share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+  share_locks[data].lock();
+}
+
+void
+share_unlock(CURL *handle, curl_lock_data data, void *userptr)
+{
+  share_locks[data].unlock();
+}
+
+} // namespace
+
+CURLSH *
+curl_share_create(bool share_connections)
+{
+  CURLSH * share = curl_share_init();
+  if (share == NULL) { return NULL; }
+
+  // The share handle is only an optimization, thus if some of the data
+  // types are not supported by the installed version of curl we continue
+  // without sharing them.
+  curl_share_setopt(share, CURLSHOPT_LOCKFUNC, share_lock);
+  curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+  curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+  if (share_connections) { curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT); }
+#endif
+
+  return share;
+}
+
+void
+curl_share_destroy(CURLSH * share)
+{
+  if (share) { curl_share_cleanup(share); }
+}
+
+void
+curl_setup_handle(basic_Error & e, CURL * curl, CURLSH * share)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  CURLcode cc;
+
+  cc = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, handle_response);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_WRITEFUNCTION, cc); return; }
+
+  if (share) {
+    cc = curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_SHARE, cc); return; }
+  }
+
+#if defined(CRYPTOLENS_CURL_EMBED_CACERTS) || defined(CRYPTOLENS_CURL_TLS_SESSIONS)
+  cc = curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, *sslctx_function);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_SSL_CTX_FUNCTION, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, NULL);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_SSL_CTX_FUNCTION, cc); return; }
+#endif
+}
+
+// Responses with these statuses do not come from the Web API itself but
+// e.g. from a load balancer, and their bodies can thus not be parsed.
+long
+curl_error_status(CURL * curl)
+{
+  long status = 0;
+  if (curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status) != CURLE_OK) { return 0; }
+
+  return status == 429 || status >= 500 ? status : 0;
+}
+
+void
+curl_warmup(basic_Error & e, CURL * curl, char const* host, long timeout_ms)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  if (!curl) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return; }
+
+  std::string url;
+  if (std::strstr(host, "://") == nullptr) { url = "https://"; }
+  url += host;
+  if (url.empty() || url.back() != '/') { url += '/'; }
+
+  // CURLOPT_CONNECT_ONLY would also resolve the host and perform the TLS
+  // handshake, but curl does not reuse such connections for later requests.
+  // A HEAD request leaves an ordinary connection in the connection cache.
+  internal::CurlResponse response;
+  CURLcode cc;
+
+  cc = curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_URL, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_WRITEDATA, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TIMEOUT_MS, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_NOBODY, cc); return; }
+
+  cc = curl_easy_perform(curl);
+
+  // Setting CURLOPT_POSTFIELDS in the next request makes it a POST again
+  CURLcode cc_nobody = curl_easy_setopt(curl, CURLOPT_NOBODY, 0L);
+
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, PERFORM, cc); return; }
+  if (cc_nobody != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_NOBODY, cc_nobody); return; }
+}
+
+void
+curl_set_http2(basic_Error & e, CURL * curl, bool enabled)
+{
+  if (e) { return; }
+
+  CURLcode cc = curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, enabled ? (long)CURL_HTTP_VERSION_2TLS : (long)CURL_HTTP_VERSION_1_1);
+  if (cc != CURLE_OK) { e.set(api::main(), errors::Subsystem::RequestHandler, errors::RequestHandler_curl::SETOPT_HTTP_VERSION, cc); return; }
+}
+
+void
+curl_set_compression(basic_Error & e, CURL * curl, bool enabled)
+{
+  if (e) { return; }
+
+  // The empty string lists every encoding curl has been built with support for
+  CURLcode cc = curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, enabled ? "" : NULL);
+  if (cc != CURLE_OK) { e.set(api::main(), errors::Subsystem::RequestHandler, errors::RequestHandler_curl::SETOPT_ACCEPT_ENCODING, cc); return; }
+}
+
+curl_slist *
+curl_resolve_create(basic_Error & e, std::vector<std::string> const& entries)
+{
+  if (e) { return NULL; }
+
+  curl_slist * list = NULL;
+  for (std::string const& entry : entries) {
+    curl_slist * next = curl_slist_append(list, entry.c_str());
+    if (next == NULL) {
+      curl_slist_free_all(list);
+      e.set(api::main(), errors::Subsystem::RequestHandler, errors::RequestHandler_curl::SETOPT_RESOLVE, CURLE_OUT_OF_MEMORY);
+      return NULL;
+    }
+    list = next;
+  }
+
+  return list;
+}
+
+} // namespace internal
+
+namespace {
+
+// Errors which indicate that the server closed a connection we kept
+// open from an earlier request.
+bool
+is_dropped_connection(CURLcode cc)
+{
+  return cc == CURLE_SEND_ERROR
+      || cc == CURLE_RECV_ERROR
+      || cc == CURLE_GOT_NOTHING
+      || cc == CURLE_SSL_CONNECT_ERROR;
+}
+
+} // namespace
+
+bool
+TransientErrors_curl::is_transient(int reason, std::size_t extra)
+{
+  using namespace errors::RequestHandler_curl;
+
+  if (reason == HTTP_STATUS) {
+    return extra == 429 || extra == 502 || extra == 503 || extra == 504;
+  }
+
+  if (reason != PERFORM) { return false; }
+
+  switch ((CURLcode)extra) {
+  case CURLE_COULDNT_RESOLVE_PROXY:
+  case CURLE_COULDNT_RESOLVE_HOST:
+  case CURLE_COULDNT_CONNECT:
+  case CURLE_PARTIAL_FILE:
+  case CURLE_OPERATION_TIMEDOUT:
+  case CURLE_SSL_CONNECT_ERROR:
+  case CURLE_GOT_NOTHING:
+  case CURLE_SEND_ERROR:
+  case CURLE_RECV_ERROR:
+  case CURLE_HTTP2:
+#if LIBCURL_VERSION_NUM >= 0x073100
+  case CURLE_HTTP2_STREAM:
+#endif
+    return true;
+  default:
+    return false;
+  }
+}
+
 std::string
 RequestHandler_curl_PostBuilder::make(basic_Error & e)
 {
@@ -196,13 +879,13 @@ RequestHandler_curl_PostBuilder::make(basic_Error & e)
 
   if (!this->curl_) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return ""; }
 
-  std::string response;
+  internal::CurlResponse response(this->max_response_size_);
   CURLcode cc;
 
+  // Options that are the same for all requests have already been set
+  // up in curl_setup_handle(), thus only request specific options are set here.
   cc = curl_easy_setopt(this->curl_, CURLOPT_URL, url_.c_str());
   if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_URL, cc); return ""; }
-  cc = curl_easy_setopt(this->curl_, CURLOPT_WRITEFUNCTION, handle_response);
-  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_WRITEFUNCTION, cc); return ""; }
   cc = curl_easy_setopt(this->curl_, CURLOPT_WRITEDATA, (void *)&response);
   if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_WRITEDATA, cc); return ""; }
   cc = curl_easy_setopt(this->curl_, CURLOPT_POSTFIELDS, postfields_.c_str());
@@ -210,15 +893,28 @@ RequestHandler_curl_PostBuilder::make(basic_Error & e)
   cc = curl_easy_setopt(this->curl_, CURLOPT_TIMEOUT_MS, this->timeout_ms_);
   if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TIMEOUT_MS, cc); return ""; }
 
-#ifdef CRYPTOLENS_CURL_EMBED_CACERTS
-  curl_easy_setopt(this->curl_, CURLOPT_SSL_CTX_FUNCTION, *sslctx_function_setup_cacerts);
-  curl_easy_setopt(this->curl_, CURLOPT_SSL_CTX_DATA, (void*)&e);
-#endif /* CRYPTOLENS_CURL_EMBED_CACERTS */
-
   cc = curl_easy_perform(this->curl_);
+
+  // Curl closes a connection once a request on it has failed, thus the next
+  // attempt is made on another kept connection, if there is one, or on a new
+  // connection. Only failures on reused connections are retried, since
+  // a request failing on a new connection says nothing about kept ones.
+  for (int i = 0; i < this->reconnect_attempts_ && is_dropped_connection(cc); ++i) {
+    long new_connections = -1;
+    if (curl_easy_getinfo(this->curl_, CURLINFO_NUM_CONNECTS, &new_connections) != CURLE_OK || new_connections != 0) { break; }
+
+    response.reset();
+
+    cc = curl_easy_perform(this->curl_);
+  }
+
+  if (cc == CURLE_WRITE_ERROR && response.too_large) { e.set(api, Subsystem::RequestHandler, RESPONSE_TOO_LARGE, response.max_size); return ""; }
   if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, PERFORM, cc); return ""; }
 
-  return response;
+  long status = this->report_http_status_ ? internal::curl_error_status(this->curl_) : 0;
+  if (status != 0) { e.set(api, Subsystem::RequestHandler, HTTP_STATUS, status); return ""; }
+
+  return std::move(response.body);
 }
 
 void
@@ -227,6 +923,247 @@ RequestHandler_curl::set_timeout(basic_Error & e, long timeout_ms)
   this->timeout_ms_ = timeout_ms;
 }
 
+/**
+ * Enables TCP keep-alive probes on the connection to the Web API.
+ *
+ * Arguments:
+ *   idle_s - number of seconds the connection is idle before the first probe is sent
+ *   interval_s - number of seconds between probes
+ */
+void
+RequestHandler_curl::set_keep_alive(basic_Error & e, long idle_s, long interval_s)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  if (!this->curl) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return; }
+
+  CURLcode cc;
+
+  cc = curl_easy_setopt(this->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TCP_KEEPALIVE, cc); return; }
+  cc = curl_easy_setopt(this->curl, CURLOPT_TCP_KEEPIDLE, idle_s);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TCP_KEEPALIVE, cc); return; }
+  cc = curl_easy_setopt(this->curl, CURLOPT_TCP_KEEPINTVL, interval_s);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TCP_KEEPALIVE, cc); return; }
+}
+
+/**
+ * Sets the maximum number of seconds a connection may have been idle in
+ * order for it to be reused. Connections that have been idle for longer
+ * are closed and a new connection is opened.
+ *
+ * Requires curl 7.65.0 or later.
+ */
+void
+RequestHandler_curl::set_max_idle_time(basic_Error & e, long max_idle_s)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  if (!this->curl) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return; }
+
+#if LIBCURL_VERSION_NUM >= 0x074100
+  CURLcode cc = curl_easy_setopt(this->curl, CURLOPT_MAXAGE_CONN, max_idle_s);
+  if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_MAXAGE_CONN, cc); return; }
+#else
+  e.set(api, Subsystem::RequestHandler, SETOPT_MAXAGE_CONN, CURLE_UNKNOWN_OPTION);
+#endif
+}
+
+/**
+ * Sets how many times a request is retried if it fails because the server
+ * has closed a connection that was kept open from an earlier request.
+ * Each retry discards one such connection, and a request that fails on
+ * a newly opened connection is not retried. Defaults to 0.
+ */
+void
+RequestHandler_curl::set_reconnect_attempts(basic_Error & e, int reconnect_attempts)
+{
+  this->reconnect_attempts_ = reconnect_attempts;
+}
+
+/**
+ * Restricts the CA certificates trusted when connecting to the Web API to
+ * the embedded certificates with the given names, e.g. "ISRG Root X1". The
+ * names are listed on the first line of each certificate in
+ * src/RequestHandler_curl_cacerts.cpp.
+ *
+ * Only available if the library is built with CRYPTOLENS_CURL_EMBED_CACERTS.
+ */
+void
+RequestHandler_curl::set_pinned_cacerts(basic_Error & e, std::vector<std::string> const& names)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  if (!this->curl) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return; }
+
+#ifdef CRYPTOLENS_CURL_EMBED_CACERTS
+  size_t found;
+  X509_STORE * store = cacerts_store_create(&names, found);
+  if (store == NULL) { e.set(api, Subsystem::RequestHandler, CACERTS_STORE_CREATE); return; }
+  if (found != names.size()) { X509_STORE_free(store); e.set(api, Subsystem::RequestHandler, CACERT_NOT_FOUND); return; }
+
+  if (this->ssl_ctx_data_.pinned_cacerts) { X509_STORE_free((X509_STORE *)this->ssl_ctx_data_.pinned_cacerts); }
+  this->ssl_ctx_data_.pinned_cacerts = store;
+#else
+  e.set(api, Subsystem::RequestHandler, CACERTS_NOT_EMBEDDED);
+#endif /* CRYPTOLENS_CURL_EMBED_CACERTS */
+}
+
+/**
+ * Sets the addresses used for host names instead of looking them up, as
+ * entries of the form "api.cryptolens.io:443:203.0.113.7", see
+ * CURLOPT_RESOLVE. An entry can list several comma separated addresses.
+ * An empty list removes the previously set entries from the handle, but
+ * addresses that have already been added to the DNS cache stay there
+ * until they expire.
+ */
+void
+RequestHandler_curl::set_resolve(basic_Error & e, std::vector<std::string> const& entries)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  if (!this->curl) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return; }
+
+  curl_slist * resolve = internal::curl_resolve_create(e, entries);
+  if (e) { return; }
+
+  CURLcode cc = curl_easy_setopt(this->curl, CURLOPT_RESOLVE, resolve);
+  if (cc != CURLE_OK) { curl_slist_free_all(resolve); e.set(api, Subsystem::RequestHandler, SETOPT_RESOLVE, cc); return; }
+
+  curl_slist_free_all(this->resolve_);
+  this->resolve_ = resolve;
+}
+
+/**
+ * Stores the TLS sessions of the connections made by this request handler
+ * in the file at the given path, or stops doing so if the path is empty,
+ * and resumes a stored session when a new
+ * connection is made, also by later runs of the program. This saves a round
+ * trip and most of the work of the TLS handshake for programs that only
+ * make a single request, such as command line tools. The file should be
+ * placed in a directory that only the user can write to, e.g. in
+ * $XDG_CACHE_HOME, since a program able to replace it could make the
+ * request handler resume a session of its own choosing. The responses of
+ * the Web API are still verified using their signatures.
+ *
+ * The file is locked while it is read or written, such that several
+ * processes can use the same file. Sessions are kept until they expire.
+ *
+ * Only available if the library is built with CRYPTOLENS_CURL_TLS_SESSIONS
+ * and curl uses OpenSSL.
+ */
+void
+RequestHandler_curl::set_tls_session_file(basic_Error & e, std::string const& path)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  if (!this->curl) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return; }
+
+#ifdef CRYPTOLENS_CURL_TLS_SESSIONS
+  // Connections that are already open may refer to the object, thus it is
+  // kept until the request handler is destroyed.
+  if (this->ssl_ctx_data_.tls_sessions == NULL) { this->ssl_ctx_data_.tls_sessions = new internal::TlsSessionFile(); }
+  ((internal::TlsSessionFile *)this->ssl_ctx_data_.tls_sessions)->set_path(path);
+#else
+  e.set(api, Subsystem::RequestHandler, TLS_SESSIONS_NOT_SUPPORTED);
+#endif /* CRYPTOLENS_CURL_TLS_SESSIONS */
+}
+
+/**
+ * Selects whether HTTP/2 is used if the server supports it. If disabled,
+ * HTTP/1.1 is used. By default curl decides, and versions of curl since
+ * 7.62.0 that are built with HTTP/2 support use it.
+ *
+ * Since this request handler makes one request at a time, HTTP/2 mostly
+ * saves the bytes of the repeated headers. RequestHandler_curl_multi can
+ * in addition send several requests at the same time over one connection.
+ */
+void
+RequestHandler_curl::set_http2(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+  if (!this->curl) { e.set(api::main(), errors::Subsystem::RequestHandler, errors::RequestHandler_curl::CURL_NULL); return; }
+
+  internal::curl_set_http2(e, this->curl, enabled);
+}
+
+/**
+ * Selects whether the Web API may compress its responses. Curl decompresses
+ * the responses using any of the encodings it has been built with support
+ * for, e.g. gzip. Disabled by default.
+ */
+void
+RequestHandler_curl::set_compression(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+  if (!this->curl) { e.set(api::main(), errors::Subsystem::RequestHandler, errors::RequestHandler_curl::CURL_NULL); return; }
+
+  internal::curl_set_compression(e, this->curl, enabled);
+}
+
+/**
+ * Sets the largest response body, in bytes, that is accepted. Requests whose
+ * response is larger are aborted as soon as the limit is exceeded, and fail
+ * with the RESPONSE_TOO_LARGE error with the limit as the extra value. If
+ * compression is enabled, the limit applies to the decompressed body.
+ * Defaults to 0, which means there is no limit.
+ */
+void
+RequestHandler_curl::set_max_response_size(basic_Error & e, std::size_t max_size)
+{
+  if (e) { return; }
+
+  this->max_response_size_ = max_size;
+}
+
+/**
+ * Selects whether responses with the HTTP status 429 or 5xx fail with the
+ * HTTP_STATUS error, with the status as the extra value, instead of their
+ * body being returned. Such responses usually come from e.g. a load balancer
+ * rather than the Web API, and the error tells them apart from a malformed
+ * reply. TransientErrors_curl considers 429, 502, 503 and 504 transient, so
+ * RequestHandler_retrying makes such requests again. Disabled by default.
+ */
+void
+RequestHandler_curl::set_report_http_status(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+
+  this->report_http_status_ = enabled;
+}
+
+/**
+ * Connects to the given host, which is the same value as the one passed to
+ * post_request(), and keeps the connection open for the following requests.
+ * This resolves the host name, loads the CA certificates and performs the
+ * TLS handshake, such that the first request made afterwards does not need to.
+ */
+void
+RequestHandler_curl::warmup(basic_Error & e, char const* host)
+{
+  internal::curl_warmup(e, this->curl, host, this->timeout_ms_);
+}
+
 } // namespace v20190401
 
 } // namespace cryptolens_io
@@ -0,0 +1,478 @@
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#include "RequestHandler_curl_multi.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+/*
+ * RequestHandler_curl_multi_Response
+ */
+
+std::string const&
+RequestHandler_curl_multi_Response::get(basic_Error & e) const
+{
+  if (e) { return body_; }
+
+  if (reason_ != 0) { e.set(api::main(), errors::Subsystem::RequestHandler, reason_, extra_); }
+
+  return body_;
+}
+
+/*
+ * RequestHandler_curl_multi
+ */
+
+struct RequestHandler_curl_multi::Transfer {
+  std::string url;
+  std::string postfields;
+  long timeout_ms;
+  RequestHandler_curl_multi_PostBuilder::Callback callback;
+
+  internal::CurlResponse response;
+  bool report_http_status;
+  CURL *curl;
+  std::size_t index; // Position in running_
+  bool added;
+};
+
+namespace {
+
+// A callback has no caller to report an exception to, and letting it escape
+// the background thread would terminate the program, thus it is ignored.
+void
+call_callback(RequestHandler_curl_multi_PostBuilder::Callback const& callback, RequestHandler_curl_multi_Response response)
+{
+  try {
+    callback(std::move(response));
+  } catch (...) {
+  }
+}
+
+} // namespace
+
+RequestHandler_curl_multi::RequestHandler_curl_multi(basic_Error & e)
+: multi_(curl_multi_init()), share_(internal::curl_share_create()), timeout_ms_(0)
+, http2_(-1), compression_(false), max_response_size_(0), report_http_status_(false)
+, mutex_(), queue_(), max_host_connections_(-1), stop_(false)
+, running_(), idle_handles_(), thread_()
+{
+  if (this->multi_) {
+    // If the thread cannot be started we report this in the same way as
+    // if curl_multi_init() failed, i.e. using MULTI_NULL when making a request.
+    try {
+      this->thread_ = std::thread(&RequestHandler_curl_multi::run, this);
+    } catch (std::system_error const&) {
+      curl_multi_cleanup(this->multi_);
+      this->multi_ = NULL;
+    }
+  }
+}
+
+RequestHandler_curl_multi::~RequestHandler_curl_multi()
+{
+  if (this->multi_) {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->stop_ = true;
+    }
+#if LIBCURL_VERSION_NUM >= 0x074400
+    // Void return type
+    curl_multi_wakeup(this->multi_);
+#endif
+    this->thread_.join();
+
+    // Void return type
+    curl_multi_cleanup(this->multi_);
+  }
+
+  for (std::size_t i = 0; i < this->idle_handles_.size(); ++i) {
+    curl_easy_cleanup(this->idle_handles_[i]);
+  }
+
+  // The share handle can only be destroyed once no easy handle uses it
+  internal::curl_share_destroy(this->share_);
+}
+
+RequestHandler_curl_multi::PostBuilder
+RequestHandler_curl_multi::post_request(basic_Error & e, char const* host, char const* endpoint)
+{
+  return RequestHandler_curl_multi_PostBuilder(this, host, endpoint, this->timeout_ms_);
+}
+
+void
+RequestHandler_curl_multi::set_timeout(basic_Error & e, long timeout_ms)
+{
+  this->timeout_ms_ = timeout_ms;
+}
+
+/**
+ * Limits the number of connections that are opened to the same host. Requests
+ * that are made when the limit has been reached are queued until one of the
+ * connections is available again. By default there is no limit.
+ *
+ * Arguments:
+ *   max_connections - maximum number of connections per host, or 0 for no limit
+ */
+void
+RequestHandler_curl_multi::set_max_host_connections(basic_Error & e, long max_connections)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl_multi;
+  api::main api;
+
+  if (!this->multi_) { e.set(api, Subsystem::RequestHandler, MULTI_NULL); return; }
+  if (max_connections < 0) { e.set(api, Subsystem::RequestHandler, SETOPT_MAX_HOST_CONNECTIONS, CURLM_BAD_FUNCTION_ARGUMENT); return; }
+
+  // The multi handle may only be used by the background thread, which
+  // applies the new value before it makes any further progress.
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->max_host_connections_ = max_connections;
+  }
+#if LIBCURL_VERSION_NUM >= 0x074400
+  // Void return type
+  curl_multi_wakeup(this->multi_);
+#endif
+}
+
+/**
+ * Selects whether HTTP/2 is used if the server supports it. If enabled,
+ * requests made at the same time share a single connection to the Web API
+ * instead of opening one connection each, and a request waits for the
+ * first connection to be established rather than opening a new connection.
+ * If disabled, HTTP/1.1 is used. By default curl decides.
+ */
+void
+RequestHandler_curl_multi::set_http2(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+
+  this->http2_ = enabled ? 1 : 0;
+}
+
+/**
+ * Selects whether the Web API may compress its responses, see
+ * RequestHandler_curl::set_compression().
+ */
+void
+RequestHandler_curl_multi::set_compression(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+
+  this->compression_ = enabled;
+}
+
+/**
+ * Sets the largest response body that is accepted, see
+ * RequestHandler_curl::set_max_response_size().
+ */
+void
+RequestHandler_curl_multi::set_max_response_size(basic_Error & e, std::size_t max_size)
+{
+  if (e) { return; }
+
+  this->max_response_size_ = max_size;
+}
+
+/**
+ * Selects whether responses with the HTTP status 429 or 5xx fail with the
+ * HTTP_STATUS error, see RequestHandler_curl::set_report_http_status().
+ */
+void
+RequestHandler_curl_multi::set_report_http_status(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+
+  this->report_http_status_ = enabled;
+}
+
+void
+RequestHandler_curl_multi::submit(std::string url, std::string postfields, long timeout_ms, RequestHandler_curl_multi_PostBuilder::Callback callback)
+{
+  Transfer * transfer = new Transfer();
+  transfer->url = std::move(url);
+  transfer->postfields = std::move(postfields);
+  transfer->timeout_ms = timeout_ms;
+  transfer->callback = std::move(callback);
+  transfer->curl = NULL;
+  transfer->report_http_status = false;
+  transfer->index = 0;
+  transfer->added = false;
+
+  bool stopped;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    stopped = this->stop_;
+    if (!stopped) { this->queue_.push_back(transfer); }
+  }
+
+  if (stopped) {
+    call_callback(transfer->callback, RequestHandler_curl_multi_Response(errors::RequestHandler_curl_multi::SHUTDOWN, 0, ""));
+    delete transfer;
+    return;
+  }
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+  // Void return type
+  curl_multi_wakeup(this->multi_);
+#endif
+}
+
+void
+RequestHandler_curl_multi::run()
+{
+  using namespace errors::RequestHandler_curl_multi;
+
+  std::vector<Transfer *> incoming;
+
+  for (;;) {
+    bool stop;
+    long max_host_connections;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      incoming.swap(this->queue_);
+      stop = this->stop_;
+      max_host_connections = this->max_host_connections_;
+      this->max_host_connections_ = -1;
+    }
+
+    if (max_host_connections >= 0) {
+      // Void return type, CURLM_OK is returned for every value accepted by set_max_host_connections()
+      curl_multi_setopt(this->multi_, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+    }
+
+    for (std::size_t i = 0; i < incoming.size(); ++i) {
+      if (stop) { this->finish(incoming[i], SHUTDOWN, 0); }
+      else      { this->start(incoming[i]); }
+    }
+    incoming.clear();
+
+    if (stop) { break; }
+
+    int still_running = 0;
+    CURLMcode mc = curl_multi_perform(this->multi_, &still_running);
+
+    CURLMsg * msg;
+    int msgs_left;
+    while ((msg = curl_multi_info_read(this->multi_, &msgs_left)) != NULL) {
+      if (msg->msg != CURLMSG_DONE) { continue; }
+
+      char * p = NULL;
+      curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &p);
+      CURLcode cc = msg->data.result;
+
+      Transfer * transfer = (Transfer *)p;
+      long status = cc == CURLE_OK && transfer->report_http_status ? internal::curl_error_status(msg->easy_handle) : 0;
+      if      (cc == CURLE_WRITE_ERROR && transfer->response.too_large) { this->finish(transfer, RESPONSE_TOO_LARGE, transfer->response.max_size); }
+      else if (cc != CURLE_OK) { this->finish(transfer, PERFORM, cc); }
+      else if (status != 0)    { this->finish(transfer, HTTP_STATUS, status); }
+      else                     { this->finish(transfer, 0, 0); }
+    }
+
+    if (mc != CURLM_OK) {
+      // The multi handle is in a state where no further progress can be made,
+      // thus all outstanding requests fail.
+      while (!this->running_.empty()) { this->finish(this->running_.back(), PERFORM, CURLE_FAILED_INIT); }
+    }
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+    // Sleeps until there is network activity, a timeout within curl expires,
+    // or submit() wakes us up because there is a new request.
+    curl_multi_poll(this->multi_, NULL, 0, 1000, NULL);
+#else
+    // Without curl_multi_wakeup() new requests are picked up when the wait times out
+    curl_multi_wait(this->multi_, NULL, 0, 10, NULL);
+#endif
+  }
+
+  while (!this->running_.empty()) { this->finish(this->running_.back(), SHUTDOWN, 0); }
+}
+
+void
+RequestHandler_curl_multi::start(Transfer * transfer)
+{
+  using namespace errors::RequestHandler_curl_multi;
+
+  CURL * curl;
+  if (!this->idle_handles_.empty()) {
+    curl = this->idle_handles_.back();
+    this->idle_handles_.pop_back();
+  } else {
+    curl = curl_easy_init();
+    if (curl == NULL) { this->finish(transfer, MULTI_NULL, 0); return; }
+
+    basic_Error setup_error;
+    internal::curl_setup_handle(setup_error, curl, this->share_);
+    if (setup_error) {
+      curl_easy_cleanup(curl);
+      this->finish(transfer, setup_error.get_reason(api::main()), setup_error.get_extra(api::main()));
+      return;
+    }
+  }
+  transfer->curl = curl;
+  transfer->response.max_size = this->max_response_size_;
+  transfer->report_http_status = this->report_http_status_;
+
+  // Options that are the same for all requests have already been set
+  // up in curl_setup_handle(), thus only request specific options are set here.
+  CURLcode cc;
+  cc = curl_easy_setopt(curl, CURLOPT_URL, transfer->url.c_str());
+  if (cc != CURLE_OK) { this->finish(transfer, SETOPT_URL, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&transfer->response);
+  if (cc != CURLE_OK) { this->finish(transfer, SETOPT_WRITEDATA, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer->postfields.c_str());
+  if (cc != CURLE_OK) { this->finish(transfer, SETOPT_POSTFIELDS, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, transfer->timeout_ms);
+  if (cc != CURLE_OK) { this->finish(transfer, SETOPT_TIMEOUT_MS, cc); return; }
+  cc = curl_easy_setopt(curl, CURLOPT_PRIVATE, (void *)transfer);
+  if (cc != CURLE_OK) { this->finish(transfer, ADD_HANDLE, cc); return; }
+
+  long http2 = this->http2_;
+  if (http2 >= 0) {
+    cc = curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, http2 ? (long)CURL_HTTP_VERSION_2TLS : (long)CURL_HTTP_VERSION_1_1);
+    if (cc != CURLE_OK) { this->finish(transfer, SETOPT_HTTP_VERSION, cc); return; }
+    cc = curl_easy_setopt(curl, CURLOPT_PIPEWAIT, http2);
+    if (cc != CURLE_OK) { this->finish(transfer, SETOPT_PIPEWAIT, cc); return; }
+  }
+  cc = curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, this->compression_ ? "" : NULL);
+  if (cc != CURLE_OK) { this->finish(transfer, SETOPT_ACCEPT_ENCODING, cc); return; }
+
+  CURLMcode mc = curl_multi_add_handle(this->multi_, curl);
+  if (mc != CURLM_OK) { this->finish(transfer, ADD_HANDLE, mc); return; }
+
+  transfer->added = true;
+  transfer->index = this->running_.size();
+  this->running_.push_back(transfer);
+}
+
+void
+RequestHandler_curl_multi::finish(Transfer * transfer, int reason, std::size_t extra)
+{
+  if (transfer->added) {
+    // Void return type
+    curl_multi_remove_handle(this->multi_, transfer->curl);
+
+    Transfer * last = this->running_.back();
+    last->index = transfer->index;
+    this->running_[transfer->index] = last;
+    this->running_.pop_back();
+  }
+
+  // The easy handle keeps its connection cache and TLS state, so keep it around
+  // for the next request instead of setting up a new one.
+  if (transfer->curl) { this->idle_handles_.push_back(transfer->curl); }
+
+  if (reason != 0) { transfer->response.body.clear(); }
+
+  call_callback(transfer->callback, RequestHandler_curl_multi_Response(reason, extra, std::move(transfer->response.body)));
+  delete transfer;
+}
+
+/*
+ * RequestHandler_curl_multi_PostBuilder
+ */
+
+RequestHandler_curl_multi_PostBuilder::RequestHandler_curl_multi_PostBuilder(RequestHandler_curl_multi * handler, char const* host, char const* endpoint, long timeout_ms)
+: handler_(handler), separator_(' '), postfields_(), url_(), timeout_ms_(timeout_ms)
+{
+  // The host may include the scheme, e.g. "http://127.0.0.1:8080", which is
+  // mostly useful when testing against a local server.
+  if (std::strstr(host, "://") == nullptr) { url_ = "https://"; }
+  url_ += host;
+  if (url_.size() > 0 && url_.back() != '/' && endpoint != nullptr && *endpoint != '/') { url_ += '/'; }
+  url_ += endpoint;
+}
+
+RequestHandler_curl_multi_PostBuilder &
+RequestHandler_curl_multi_PostBuilder::add_argument(basic_Error & e, char const* key, char const* value) {
+  if (e) { return *this; }
+
+  api::main api;
+  using namespace errors::RequestHandler_curl_multi;
+
+  if (separator_ == ' ') { separator_ = '&'; }
+  else                   { postfields_ += separator_; }
+
+  // curl_easy_escape() only uses the handle for character set conversions,
+  // which are not used for the ASCII arguments sent to the Web API.
+  char* res;
+  res = curl_easy_escape(NULL, key, 0);
+  if (!res) { e.set(api, errors::Subsystem::RequestHandler, ESCAPE); return *this; }
+  postfields_ += res;
+  curl_free(res);
+
+  postfields_ += '=';
+
+  res = curl_easy_escape(NULL, value, 0);
+  if (!res) { e.set(api, errors::Subsystem::RequestHandler, ESCAPE); return *this; }
+  postfields_ += res;
+  curl_free(res);
+
+  return *this;
+}
+
+/**
+ * Makes the request and blocks until it is done. This makes it possible to
+ * use RequestHandler_curl_multi as the RequestHandler of a Configuration.
+ *
+ * This method must not be called from a callback passed to make_async().
+ */
+std::string
+RequestHandler_curl_multi_PostBuilder::make(basic_Error & e)
+{
+  if (e) { return ""; }
+
+  std::future<RequestHandler_curl_multi_Response> response = this->make_future(e);
+  if (e) { return ""; }
+
+  return response.get().get(e);
+}
+
+/**
+ * Starts the request and returns immediately. Once the request is done the
+ * callback is called on the background thread of the RequestHandler_curl_multi
+ * with the response. The callback is called exactly once, also in case
+ * the request fails, unless this method records an error in e.
+ */
+void
+RequestHandler_curl_multi_PostBuilder::make_async(basic_Error & e, Callback callback)
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl_multi;
+  api::main api;
+
+  if (!this->handler_ || !this->handler_->multi_) { e.set(api, Subsystem::RequestHandler, MULTI_NULL); return; }
+
+  this->handler_->submit(this->url_, this->postfields_, this->timeout_ms_, std::move(callback));
+}
+
+/**
+ * Starts the request and returns a future that becomes ready once the request
+ * is done. If an error is recorded in e, the returned future is not valid.
+ */
+std::future<RequestHandler_curl_multi_Response>
+RequestHandler_curl_multi_PostBuilder::make_future(basic_Error & e)
+{
+  if (e) { return std::future<RequestHandler_curl_multi_Response>(); }
+
+  std::shared_ptr<std::promise<RequestHandler_curl_multi_Response>> promise =
+    std::make_shared<std::promise<RequestHandler_curl_multi_Response>>();
+  std::future<RequestHandler_curl_multi_Response> response = promise->get_future();
+
+  this->make_async(e, [promise](RequestHandler_curl_multi_Response r) { promise->set_value(std::move(r)); });
+  if (e) { return std::future<RequestHandler_curl_multi_Response>(); }
+
+  return response;
+}
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
@@ -0,0 +1,336 @@
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "RequestHandler_curl_pool.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+/*
+ * RequestHandler_curl_pool
+ */
+
+namespace {
+
+std::size_t
+pool_size()
+{
+  // Enough slots that every thread of a typical thread pool can keep
+  // its own handle
+  std::size_t n = 2 * std::thread::hardware_concurrency();
+  return n < 8 ? 8 : n;
+}
+
+} // namespace
+
+// The handles are used from several threads at the same time and can thus
+// not share connections, instead each handle keeps its own connections.
+RequestHandler_curl_pool::RequestHandler_curl_pool(basic_Error & e)
+: share_(internal::curl_share_create(false)), resolve_(NULL), idle_(pool_size())
+, timeout_ms_(0), reconnect_attempts_(0), max_response_size_(0), report_http_status_(false)
+, keep_alive_idle_s_(-1), keep_alive_interval_s_(-1), max_idle_s_(-1)
+, http2_(-1), compression_(false)
+{
+  for (std::atomic<CURL *> & slot : this->idle_) { slot.store(NULL); }
+}
+
+RequestHandler_curl_pool::~RequestHandler_curl_pool()
+{
+  drop_idle_handles();
+
+  // The share handle and the list can only be destroyed once no easy handle uses them
+  internal::curl_share_destroy(this->share_);
+  curl_slist_free_all(this->resolve_);
+}
+
+RequestHandler_curl_pool::PostBuilder
+RequestHandler_curl_pool::post_request(basic_Error & e, char const* host, char const* endpoint)
+{
+  CURL * curl = acquire(e);
+
+  return RequestHandler_curl_pool_PostBuilder(this, curl, host, endpoint, this->timeout_ms_, this->reconnect_attempts_, this->max_response_size_, this->report_http_status_);
+}
+
+/*
+ * Takes an unused handle from the pool, or creates a new handle if there
+ * are none. Searching starts at a slot picked based on the calling thread,
+ * such that a thread usually gets back the handle it released last.
+ */
+CURL *
+RequestHandler_curl_pool::acquire(basic_Error & e)
+{
+  if (e) { return NULL; }
+
+  std::size_t n = this->idle_.size();
+  std::size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % n;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    CURL * curl = this->idle_[(start + i) % n].exchange(NULL, std::memory_order_acquire);
+    if (curl) { return curl; }
+  }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  CURL * curl = curl_easy_init();
+  if (!curl) { e.set(api, Subsystem::RequestHandler, CURL_NULL); return NULL; }
+
+  setup_handle(e, curl);
+  if (e) { curl_easy_cleanup(curl); return NULL; }
+
+  return curl;
+}
+
+/*
+ * Puts a handle back into the pool. If all slots are taken, which happens
+ * when more requests than there are slots have been in flight at the same
+ * time, the handle is destroyed instead.
+ */
+void
+RequestHandler_curl_pool::release(CURL * curl)
+{
+  std::size_t n = this->idle_.size();
+  std::size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % n;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    CURL * expected = NULL;
+    if (this->idle_[(start + i) % n].compare_exchange_strong(expected, curl, std::memory_order_release, std::memory_order_relaxed)) {
+      return;
+    }
+  }
+
+  curl_easy_cleanup(curl);
+}
+
+void
+RequestHandler_curl_pool::setup_handle(basic_Error & e, CURL * curl) const
+{
+  if (e) { return; }
+
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+  api::main api;
+
+  internal::curl_setup_handle(e, curl, this->share_);
+  if (e) { return; }
+
+  CURLcode cc;
+
+  if (this->keep_alive_idle_s_ >= 0) {
+    cc = curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TCP_KEEPALIVE, cc); return; }
+    cc = curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, this->keep_alive_idle_s_);
+    if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TCP_KEEPALIVE, cc); return; }
+    cc = curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, this->keep_alive_interval_s_);
+    if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_TCP_KEEPALIVE, cc); return; }
+  }
+
+#if LIBCURL_VERSION_NUM >= 0x074100
+  if (this->max_idle_s_ >= 0) {
+    cc = curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, this->max_idle_s_);
+    if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_MAXAGE_CONN, cc); return; }
+  }
+#endif
+
+  if (this->resolve_) {
+    cc = curl_easy_setopt(curl, CURLOPT_RESOLVE, this->resolve_);
+    if (cc != CURLE_OK) { e.set(api, Subsystem::RequestHandler, SETOPT_RESOLVE, cc); return; }
+  }
+
+  if (this->http2_ >= 0) { internal::curl_set_http2(e, curl, this->http2_ != 0); }
+  if (this->compression_) { internal::curl_set_compression(e, curl, true); }
+}
+
+// Handles are set up with the settings in effect when they are created,
+// thus setters changing the options of the handles drop the idle handles.
+void
+RequestHandler_curl_pool::drop_idle_handles()
+{
+  for (std::atomic<CURL *> & slot : this->idle_) {
+    CURL * curl = slot.exchange(NULL);
+    if (curl) { curl_easy_cleanup(curl); }
+  }
+}
+
+void
+RequestHandler_curl_pool::set_timeout(basic_Error & e, long timeout_ms)
+{
+  this->timeout_ms_ = timeout_ms;
+}
+
+/**
+ * Enables TCP keep-alive probes on the connections to the Web API.
+ *
+ * Arguments:
+ *   idle_s - number of seconds the connection is idle before the first probe is sent
+ *   interval_s - number of seconds between probes
+ */
+void
+RequestHandler_curl_pool::set_keep_alive(basic_Error & e, long idle_s, long interval_s)
+{
+  if (e) { return; }
+
+  this->keep_alive_idle_s_ = idle_s < 0 ? 0 : idle_s;
+  this->keep_alive_interval_s_ = interval_s;
+
+  drop_idle_handles();
+}
+
+/**
+ * Sets the maximum number of seconds a connection may have been idle in
+ * order for it to be reused. Connections that have been idle for longer
+ * are closed and a new connection is opened.
+ *
+ * Requires curl 7.65.0 or later.
+ */
+void
+RequestHandler_curl_pool::set_max_idle_time(basic_Error & e, long max_idle_s)
+{
+  if (e) { return; }
+
+#if LIBCURL_VERSION_NUM >= 0x074100
+  this->max_idle_s_ = max_idle_s < 0 ? 0 : max_idle_s;
+
+  drop_idle_handles();
+#else
+  using namespace errors;
+  using namespace errors::RequestHandler_curl;
+
+  e.set(api::main(), Subsystem::RequestHandler, SETOPT_MAXAGE_CONN, CURLE_UNKNOWN_OPTION);
+#endif
+}
+
+/**
+ * Sets how many times a request is retried on a new connection if it fails
+ * because the server has closed a connection that was kept open from
+ * an earlier request. Defaults to 0.
+ */
+void
+RequestHandler_curl_pool::set_reconnect_attempts(basic_Error & e, int reconnect_attempts)
+{
+  this->reconnect_attempts_ = reconnect_attempts;
+}
+
+/**
+ * Sets the addresses used for host names instead of looking them up, in the
+ * same way as RequestHandler_curl::set_resolve().
+ */
+void
+RequestHandler_curl_pool::set_resolve(basic_Error & e, std::vector<std::string> const& entries)
+{
+  if (e) { return; }
+
+  curl_slist * resolve = internal::curl_resolve_create(e, entries);
+  if (e) { return; }
+
+  drop_idle_handles();
+
+  curl_slist_free_all(this->resolve_);
+  this->resolve_ = resolve;
+}
+
+/**
+ * Selects whether HTTP/2 is used, see RequestHandler_curl::set_http2().
+ */
+void
+RequestHandler_curl_pool::set_http2(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+
+  this->http2_ = enabled ? 1 : 0;
+
+  drop_idle_handles();
+}
+
+/**
+ * Selects whether the Web API may compress its responses, see
+ * RequestHandler_curl::set_compression().
+ */
+void
+RequestHandler_curl_pool::set_compression(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+
+  this->compression_ = enabled;
+
+  drop_idle_handles();
+}
+
+/**
+ * Sets the largest response body that is accepted, see
+ * RequestHandler_curl::set_max_response_size().
+ */
+void
+RequestHandler_curl_pool::set_max_response_size(basic_Error & e, std::size_t max_size)
+{
+  if (e) { return; }
+
+  this->max_response_size_ = max_size;
+}
+
+/**
+ * Selects whether responses with the HTTP status 429 or 5xx fail with the
+ * HTTP_STATUS error, see RequestHandler_curl::set_report_http_status().
+ */
+void
+RequestHandler_curl_pool::set_report_http_status(basic_Error & e, bool enabled)
+{
+  if (e) { return; }
+
+  this->report_http_status_ = enabled;
+}
+
+/**
+ * Connects to the given host using the handle the calling thread would use
+ * for its next request, see RequestHandler_curl::warmup().
+ */
+void
+RequestHandler_curl_pool::warmup(basic_Error & e, char const* host)
+{
+  if (e) { return; }
+
+  CURL * curl = acquire(e);
+  if (e) { return; }
+
+  internal::curl_warmup(e, curl, host, this->timeout_ms_);
+  release(curl);
+}
+
+/*
+ * RequestHandler_curl_pool_PostBuilder
+ */
+
+RequestHandler_curl_pool_PostBuilder::RequestHandler_curl_pool_PostBuilder(RequestHandler_curl_pool * pool, CURL * curl, char const* host, char const* endpoint, long timeout_ms, int reconnect_attempts, std::size_t max_response_size, bool report_http_status)
+: pool_(pool), curl_(curl), builder_(curl, host, endpoint, timeout_ms, reconnect_attempts, max_response_size, report_http_status)
+{}
+
+RequestHandler_curl_pool_PostBuilder::RequestHandler_curl_pool_PostBuilder(RequestHandler_curl_pool_PostBuilder && other)
+: pool_(other.pool_), curl_(other.curl_), builder_(std::move(other.builder_))
+{
+  other.curl_ = NULL;
+}
+
+RequestHandler_curl_pool_PostBuilder::~RequestHandler_curl_pool_PostBuilder()
+{
+  if (this->curl_) { this->pool_->release(this->curl_); }
+}
+
+RequestHandler_curl_pool_PostBuilder &
+RequestHandler_curl_pool_PostBuilder::add_argument(basic_Error & e, char const* key, char const* value)
+{
+  this->builder_.add_argument(e, key, value);
+  return *this;
+}
+
+std::string
+RequestHandler_curl_pool_PostBuilder::make(basic_Error & e)
+{
+  return this->builder_.make(e);
+}
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
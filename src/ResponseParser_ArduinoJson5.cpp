@@ -4,6 +4,7 @@
 
 #include "api.hpp"
 #include "cryptolens_internals.hpp"
+#include "FieldsToReturn.hpp"
 #include "LicenseKeyInformation.hpp"
 #include "Message.hpp"
 #include "ResponseParser_ArduinoJson5.hpp"
@@ -13,25 +14,25 @@ namespace cryptolens_io {
 namespace v20190401 {
 
 optional<LicenseKeyInformation>
-ResponseParser_ArduinoJson5::make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key) const
+ResponseParser_ArduinoJson5::make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip) const
 {
   if (e) { return nullopt; }
 
-  return ResponseParser_ArduinoJson5::make_license_key_information_unsafe(e, raw_license_key.get_license());
+  return ResponseParser_ArduinoJson5::make_license_key_information_unsafe(e, raw_license_key.get_license(), fields_to_skip);
 }
 
 optional<LicenseKeyInformation>
-ResponseParser_ArduinoJson5::make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key) const
+ResponseParser_ArduinoJson5::make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip) const
 {
   if (e) { return nullopt; }
 
   if (!raw_license_key) { return nullopt; }
 
-  return ResponseParser_ArduinoJson5::make_license_key_information(e, *raw_license_key);
+  return ResponseParser_ArduinoJson5::make_license_key_information(e, *raw_license_key, fields_to_skip);
 }
 
 optional<LicenseKeyInformation>
-ResponseParser_ArduinoJson5::make_license_key_information_unsafe(basic_Error & e, std::string const& license_key) const
+ResponseParser_ArduinoJson5::make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip) const
 {
   if (e) { return nullopt; }
 
@@ -73,25 +74,25 @@ ResponseParser_ArduinoJson5::make_license_key_information_unsafe(basic_Error & e
 
   // TODO: Refactor all of these if-blocks to separate functions which takes the
   //       json object by reference and which immediately returns the optional
-  if (j["ID"].is<unsigned long>()) {
+  if (!(fields_to_skip & FieldsToReturn::ID) && j["ID"].is<unsigned long>()) {
     id = j["ID"].as<unsigned long>();
   }
 
-  if (j["Key"].is<const char*>() && j["Key"].as<const char*>() != NULL) {
+  if (!(fields_to_skip & FieldsToReturn::KEY) && j["Key"].is<const char*>() && j["Key"].as<const char*>() != NULL) {
     std::string x(j["Key"].as<const char*>());
     key = std::move(x);
   }
 
-  if (j["Notes"].is<const char*>() && j["Notes"].as<const char*>() != NULL) {
+  if (!(fields_to_skip & FieldsToReturn::NOTES) && j["Notes"].is<const char*>() && j["Notes"].as<const char*>() != NULL) {
     std::string x(j["Notes"].as<const char*>());
     notes = std::move(x);
   }
 
-  if (j["GlobalId"].is<unsigned long>()) {
+  if (!(fields_to_skip & FieldsToReturn::GLOBAL_ID) && j["GlobalId"].is<unsigned long>()) {
     global_id = j["GlobalId"].as<unsigned long>();
   }
 
-  if (j["Customer"].is<const JsonObject&>()) {
+  if (!(fields_to_skip & FieldsToReturn::CUSTOMER) && j["Customer"].is<const JsonObject&>()) {
     JsonObject const& c = j["Customer"].as<const JsonObject&>();
 
     bool valid =
@@ -109,7 +110,7 @@ ResponseParser_ArduinoJson5::make_license_key_information_unsafe(basic_Error & e
     }
   }
 
-  if (j["ActivatedMachines"].is<const JsonArray&>()) {
+  if (!(fields_to_skip & FieldsToReturn::ACTIVATED_MACHINES) && j["ActivatedMachines"].is<const JsonArray&>()) {
     bool valid = true;
     std::vector<ActivationData> v;
     JsonArray const& array = j["ActivatedMachines"].as<const JsonArray&>();
@@ -145,16 +146,16 @@ ResponseParser_ArduinoJson5::make_license_key_information_unsafe(basic_Error & e
     }
   }
 
-  if (j["MaxNoOfMachines"].is<unsigned long>()) {
+  if (!(fields_to_skip & FieldsToReturn::MAX_NO_OF_MACHINES) && j["MaxNoOfMachines"].is<unsigned long>()) {
     maxnoofmachines = j["MaxNoOfMachines"].as<unsigned long>();
   }
 
-  if (j["AllowedMachines"].is<const char*>() && j["AllowedMachines"].as<const char*>() != NULL) {
+  if (!(fields_to_skip & FieldsToReturn::ALLOWED_MACHINES) && j["AllowedMachines"].is<const char*>() && j["AllowedMachines"].as<const char*>() != NULL) {
     std::string x = j["AllowedMachines"].as<const char*>();
     allowed_machines = std::move(x);
   }
 
-  if (j["DataObjects"].is<const JsonArray&>()) {
+  if (!(fields_to_skip & FieldsToReturn::DATA_OBJECTS) && j["DataObjects"].is<const JsonArray&>()) {
     bool valid = true;
     std::vector<DataObject> v;
     JsonArray const& array = j["DataObjects"].as<const JsonArray&>();
@@ -1,9 +1,13 @@
 #include "imports/ArduinoJson7/ArduinoJson.hpp"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 
 #include "api.hpp"
 #include "cryptolens_internals.hpp"
+#include "FieldsToReturn.hpp"
 #include "LicenseKeyInformation.hpp"
 #include "ResponseParser_ArduinoJson7.hpp"
 
@@ -11,34 +15,279 @@ namespace cryptolens_io {
 
 namespace v20190401 {
 
+namespace {
+
+// A bump allocator for the JSON documents. Memory is handed out from a single
+// buffer and only returned when the arena is reset, except that the most
+// recent allocation can be grown or freed in place, which is how ArduinoJson
+// builds strings and shrinks its pools. Allocations which do not fit use
+// malloc(), and the buffer is grown when the arena is reset such that the
+// same document fits the next time.
+class ArenaAllocator : public ArduinoJson::Allocator {
+public:
+  ArenaAllocator() : buffer_(nullptr), capacity_(0), used_(0), needed_(0), in_use_(false) {}
+  ~ArenaAllocator() { std::free(buffer_); }
+
+  ArenaAllocator(ArenaAllocator const&) = delete;
+  void operator=(ArenaAllocator const&) = delete;
+
+  void* allocate(size_t size) override
+  {
+    std::size_t n = HEADER + round_up(size);
+    needed_ += n;
+
+    if (n > capacity_ - used_) { return std::malloc(size); }
+
+    unsigned char *p = buffer_ + used_;
+    std::memcpy(p, &size, sizeof(size));
+    used_ += n;
+    return p + HEADER;
+  }
+
+  void deallocate(void* ptr) override
+  {
+    if (!contains(ptr)) { std::free(ptr); return; }
+
+    if (is_last(ptr)) { used_ -= HEADER + round_up(size_of(ptr)); }
+  }
+
+  void* reallocate(void* ptr, size_t new_size) override
+  {
+    if (ptr == nullptr) { return allocate(new_size); }
+    if (!contains(ptr)) { needed_ += HEADER + round_up(new_size); return std::realloc(ptr, new_size); }
+
+    std::size_t old_size = size_of(ptr);
+    if (is_last(ptr)) {
+      std::size_t start = (unsigned char*)ptr - buffer_;
+      if (round_up(new_size) <= capacity_ - start) {
+        used_ = start + round_up(new_size);
+        if (new_size > old_size) { needed_ += round_up(new_size) - round_up(old_size); }
+        std::memcpy((unsigned char*)ptr - HEADER, &new_size, sizeof(new_size));
+        return ptr;
+      }
+    }
+
+    void *p = allocate(new_size);
+    if (p == nullptr) { return nullptr; }
+
+    std::memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+    deallocate(ptr);
+    return p;
+  }
+
+  // Returns false if the arena is already used by a document on this thread
+  bool begin()
+  {
+    if (in_use_) { return false; }
+
+    in_use_ = true;
+    used_ = 0;
+    needed_ = 0;
+    return true;
+  }
+
+  // Called once the document has been destroyed
+  void end(std::size_t max_size)
+  {
+    in_use_ = false;
+
+    if (needed_ <= capacity_ || capacity_ >= max_size) { return; }
+
+    std::size_t capacity = needed_ < max_size ? needed_ : max_size;
+    unsigned char *buffer = (unsigned char*)std::malloc(capacity);
+    if (buffer == nullptr) { return; }
+
+    std::free(buffer_);
+    buffer_ = buffer;
+    capacity_ = capacity;
+  }
+
+private:
+  static std::size_t constexpr ALIGN = alignof(std::max_align_t);
+  static std::size_t constexpr HEADER = ALIGN; // Holds the size of the allocation
+
+  static std::size_t round_up(std::size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+
+  bool contains(void* ptr) const { return buffer_ <= ptr && ptr < buffer_ + capacity_; }
+
+  bool is_last(void* ptr) const { return (unsigned char*)ptr + round_up(size_of(ptr)) == buffer_ + used_; }
+
+  static std::size_t size_of(void* ptr)
+  {
+    std::size_t size;
+    std::memcpy(&size, (unsigned char*)ptr - HEADER, sizeof(size));
+    return size;
+  }
+
+  unsigned char *buffer_;
+  std::size_t capacity_;
+  std::size_t used_;
+  std::size_t needed_; // Memory that would have been used if everything fit in the buffer
+  bool in_use_;
+};
+
+// Provides the allocator for one JSON document, which must be destroyed first
+class Arena {
+public:
+  explicit Arena(std::size_t max_size)
+  : arena_(local_arena()), max_size_(max_size), active_(max_size > 0 && arena_.begin())
+  {}
+
+  ~Arena() { if (active_) { arena_.end(max_size_); } }
+
+  Arena(Arena const&) = delete;
+  void operator=(Arena const&) = delete;
+
+  ArduinoJson::Allocator * allocator()
+  {
+    return active_ ? &arena_ : ArduinoJson::detail::DefaultAllocator::instance();
+  }
+
+private:
+  static ArenaAllocator & local_arena()
+  {
+    static thread_local ArenaAllocator arena;
+    return arena;
+  }
+
+  ArenaAllocator & arena_;
+  std::size_t max_size_;
+  bool active_;
+};
+
+// The fields of a license key, with the FieldsToReturn value used to skip
+// them, or 0 for the fields which are always read
+struct LicenseField {
+  char const* name;
+  int skip;
+};
+
+LicenseField const LICENSE_FIELDS[] =
+  { { "ProductId",         0 }
+  , { "ID",                FieldsToReturn::ID }
+  , { "Key",               FieldsToReturn::KEY }
+  , { "Created",           0 }
+  , { "Expires",           0 }
+  , { "Period",            0 }
+  , { "F1",                0 }
+  , { "F2",                0 }
+  , { "F3",                0 }
+  , { "F4",                0 }
+  , { "F5",                0 }
+  , { "F6",                0 }
+  , { "F7",                0 }
+  , { "F8",                0 }
+  , { "Notes",             FieldsToReturn::NOTES }
+  , { "Block",             0 }
+  , { "GlobalId",          FieldsToReturn::GLOBAL_ID }
+  , { "Customer",          FieldsToReturn::CUSTOMER }
+  , { "ActivatedMachines", FieldsToReturn::ACTIVATED_MACHINES }
+  , { "TrialActivation",   0 }
+  , { "MaxNoOfMachines",   FieldsToReturn::MAX_NO_OF_MACHINES }
+  , { "AllowedMachines",   FieldsToReturn::ALLOWED_MACHINES }
+  , { "DataObjects",       FieldsToReturn::DATA_OBJECTS }
+  , { "SignDate",          0 }
+  };
+
+// Parses json into the document, using the nesting limit set on the parser
+// and the filter, if any. Since ArduinoJson cannot be interrupted, the time
+// budget is checked once the document has been built. Returns false and sets
+// the reason in the Json subsystem if the response could not be parsed.
+template<typename Input, typename... Filter>
+bool
+parse(ArduinoJson::JsonDocument & j, Input const& json, internal::ParseLimits const& limits, internal::Deadline & deadline, int & reason, Filter... filter)
+{
+  using namespace ArduinoJson;
+
+  int max_depth = limits.max_depth > 0 ? limits.max_depth : internal::DEFAULT_MAX_DEPTH;
+  DeserializationOption::NestingLimit nesting(static_cast<uint8_t>(max_depth < 255 ? max_depth : 255));
+
+  DeserializationError error = deserializeJson(j, json, nesting, filter...);
+  if (error == DeserializationError::TooDeep) { reason = errors::Json::MAX_DEPTH_EXCEEDED; return false; }
+  if (error) { reason = 0; return false; }
+
+  if (deadline.expired()) { reason = errors::Json::TIME_BUDGET_EXCEEDED; return false; }
+
+  return true;
+}
+
+} // namespace
+
+void
+ResponseParser_ArduinoJson7::set_arena_size(basic_Error & e, std::size_t arena_size)
+{
+  if (e) { return; }
+
+  arena_size_ = arena_size;
+}
+
+void
+ResponseParser_ArduinoJson7::set_max_depth(basic_Error & e, int max_depth)
+{
+  if (e) { return; }
+
+  limits_.max_depth = max_depth > 0 ? max_depth : 0;
+}
+
+void
+ResponseParser_ArduinoJson7::set_max_elements(basic_Error & e, std::size_t max_elements)
+{
+  if (e) { return; }
+
+  limits_.max_elements = max_elements;
+}
+
+void
+ResponseParser_ArduinoJson7::set_time_budget(basic_Error & e, long time_budget_us)
+{
+  if (e) { return; }
+
+  limits_.time_budget_us = time_budget_us > 0 ? time_budget_us : 0;
+}
+
 optional<LicenseKeyInformation>
-ResponseParser_ArduinoJson7::make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key) const
+ResponseParser_ArduinoJson7::make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip) const
 {
   if (e) { return nullopt; }
 
-  return ResponseParser_ArduinoJson7::make_license_key_information_unsafe(e, raw_license_key.get_license());
+  return ResponseParser_ArduinoJson7::make_license_key_information_unsafe(e, raw_license_key.get_license(), fields_to_skip);
 }
 
 optional<LicenseKeyInformation>
-ResponseParser_ArduinoJson7::make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key) const
+ResponseParser_ArduinoJson7::make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip) const
 {
   if (e) { return nullopt; }
 
   if (!raw_license_key) { return nullopt; }
 
-  return ResponseParser_ArduinoJson7::make_license_key_information(e, *raw_license_key);
+  return ResponseParser_ArduinoJson7::make_license_key_information(e, *raw_license_key, fields_to_skip);
 }
 
 optional<LicenseKeyInformation>
-ResponseParser_ArduinoJson7::make_license_key_information_unsafe(basic_Error & e, std::string const& license_key) const
+ResponseParser_ArduinoJson7::make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip) const
 {
   if (e) { return nullopt; }
 
   using namespace ArduinoJson;
-  JsonDocument j;
-  DeserializationError jsonError = deserializeJson(j, license_key.c_str()); 
+  Arena arena(arena_size_);
+  JsonDocument j(arena.allocator());
+
+  // Skipped fields are validated but left out of the document, by only
+  // keeping the other fields
+  JsonDocument filter(arena.allocator());
+  internal::Deadline deadline(limits_.time_budget_us);
+  int reason = 0;
+  bool parsed;
+  if (fields_to_skip & FieldsToReturn::SKIPPABLE) {
+    for (LicenseField const& field : LICENSE_FIELDS) {
+      if (!(fields_to_skip & field.skip)) { filter[field.name] = true; }
+    }
+    parsed = parse(j, license_key.c_str(), limits_, deadline, reason, DeserializationOption::Filter(filter));
+  } else {
+    parsed = parse(j, license_key.c_str(), limits_, deadline, reason);
+  }
 
-  if (jsonError) { e.set(api::main(), errors::Subsystem::Json); return nullopt; }
+  if (!parsed) { e.set(api::main(), errors::Subsystem::Json, reason); return nullopt; }
 
   if (!j.is<JsonObject>()) { e.set(api::main(), errors::Subsystem::Json); return nullopt; }
 
@@ -54,7 +303,7 @@ ResponseParser_ArduinoJson7::make_license_key_information_unsafe(basic_Error & e
       && j["F2"].is<bool>()
       && j["F3"].is<bool>()
       && j["F4"].is<bool>()
-      && j["F7"].is<bool>()
+      && j["F5"].is<bool>()
       && j["F6"].is<bool>()
       && j["F7"].is<bool>()
       && j["F8"].is<bool>()
@@ -114,7 +363,17 @@ ResponseParser_ArduinoJson7::make_license_key_information_unsafe(basic_Error & e
     bool valid = true;
     std::vector<ActivationData> v;
     JsonArray array = j["ActivatedMachines"].as<JsonArray>();
+    if (limits_.max_elements != 0 && array.size() > limits_.max_elements) {
+      e.set(api::main(), errors::Subsystem::Json, errors::Json::MAX_ELEMENTS_EXCEEDED);
+      return nullopt;
+    }
+
     for (auto const& x : array) {
+      if (deadline.check()) {
+        e.set(api::main(), errors::Subsystem::Json, errors::Json::TIME_BUDGET_EXCEEDED);
+        return nullopt;
+      }
+
       if (!x.is<JsonObject>()) {
         valid = false;
 	break;
@@ -122,10 +381,19 @@ ResponseParser_ArduinoJson7::make_license_key_information_unsafe(basic_Error & e
 
       JsonObject machine = x.as<JsonObject>();
 
+      char const* friendly_name = NULL;
+      if (machine["FriendlyName"].is<const char*>() && machine["FriendlyName"].as<const char*>() != NULL) {
+        friendly_name = machine["FriendlyName"];
+      }
+
       if (machine["Mid"].is<const char*>() && machine["Mid"].as<const char*>() != NULL &&
           machine["IP"].is<const char*>() && machine["IP"].as<const char*>() != NULL &&
           machine["Time"].is<unsigned long>()) {
-        v.emplace_back(machine["Mid"], machine["IP"], machine["Time"]);
+        if (friendly_name == NULL) {
+          v.emplace_back(machine["Mid"], machine["IP"], machine["Time"]);
+        } else {
+          v.emplace_back(machine["Mid"], machine["IP"], machine["Time"], friendly_name);
+        }
       } else {
         valid = false;
         break;
@@ -150,7 +418,17 @@ ResponseParser_ArduinoJson7::make_license_key_information_unsafe(basic_Error & e
     bool valid = true;
     std::vector<DataObject> v;
     JsonArray array = j["DataObjects"].as<JsonArray>();
+    if (limits_.max_elements != 0 && array.size() > limits_.max_elements) {
+      e.set(api::main(), errors::Subsystem::Json, errors::Json::MAX_ELEMENTS_EXCEEDED);
+      return nullopt;
+    }
+
     for (auto const& x : array) {
+      if (deadline.check()) {
+        e.set(api::main(), errors::Subsystem::Json, errors::Json::TIME_BUDGET_EXCEEDED);
+        return nullopt;
+      }
+
       if (!x.is<JsonObject>()) {
         valid = false;
         break;
@@ -216,10 +494,11 @@ ResponseParser_ArduinoJson7::parse_activate_response(basic_Error & e, std::strin
   api::main api;
 
   using namespace ArduinoJson;
-  JsonDocument j;
-  DeserializationError jsonError = deserializeJson(j, server_response.c_str()); 
-
-  if (jsonError) { e.set(api::main(), errors::Subsystem::Json); return nullopt; }
+  Arena arena(arena_size_);
+  JsonDocument j(arena.allocator());
+  internal::Deadline deadline(limits_.time_budget_us);
+  int json_reason = 0;
+  if (!parse(j, server_response.c_str(), limits_, deadline, json_reason)) { e.set(api::main(), errors::Subsystem::Json, json_reason); return nullopt; }
   if (!j.is<JsonObject>()) { e.set(api::main(), errors::Subsystem::Json); return nullopt; }
 
   if (!j["result"].is<int>() || j["result"].as<int>() != 0) {
@@ -256,10 +535,11 @@ ResponseParser_ArduinoJson7::parse_create_trial_key_response(basic_Error & e, st
   api::main api;
 
   using namespace ArduinoJson;
-  JsonDocument j;
-  DeserializationError jsonError = deserializeJson(j, server_response.c_str()); 
-
-  if (jsonError) { e.set(api::main(), errors::Subsystem::Json); return ""; }
+  Arena arena(arena_size_);
+  JsonDocument j(arena.allocator());
+  internal::Deadline deadline(limits_.time_budget_us);
+  int json_reason = 0;
+  if (!parse(j, server_response.c_str(), limits_, deadline, json_reason)) { e.set(api::main(), errors::Subsystem::Json, json_reason); return ""; }
   if (!j.is<JsonObject>()) { e.set(api::main(), errors::Subsystem::Json); return ""; }
 
   if (!j["result"].is<int>() || j["result"].as<int>() != 0) {
@@ -287,10 +567,11 @@ ResponseParser_ArduinoJson7::parse_deactivate_response(basic_Error & e, std::str
   api::main api;
 
   using namespace ArduinoJson;
-  JsonDocument j;
-  DeserializationError jsonError = deserializeJson(j, server_response.c_str()); 
-
-  if (jsonError) { e.set(api::main(), errors::Subsystem::Json); return; }
+  Arena arena(arena_size_);
+  JsonDocument j(arena.allocator());
+  internal::Deadline deadline(limits_.time_budget_us);
+  int json_reason = 0;
+  if (!parse(j, server_response.c_str(), limits_, deadline, json_reason)) { e.set(api::main(), errors::Subsystem::Json, json_reason); return; }
   if (!j.is<JsonObject>()) { e.set(api::main(), errors::Subsystem::Json); return; }
 
   if (!j["result"].is<int>() || j["result"].as<int>() != 0) {
@@ -314,10 +595,11 @@ ResponseParser_ArduinoJson7::parse_last_message_response(basic_Error & e, std::s
   api::main api;
 
   using namespace ArduinoJson;
-  JsonDocument j;
-  DeserializationError jsonError = deserializeJson(j, server_response.c_str()); 
-
-  if (jsonError) { e.set(api::main(), errors::Subsystem::Json); return ""; }
+  Arena arena(arena_size_);
+  JsonDocument j(arena.allocator());
+  internal::Deadline deadline(limits_.time_budget_us);
+  int json_reason = 0;
+  if (!parse(j, server_response.c_str(), limits_, deadline, json_reason)) { e.set(api::main(), errors::Subsystem::Json, json_reason); return ""; }
   if (!j.is<JsonObject>()) { e.set(api::main(), errors::Subsystem::Json); return ""; }
 
   if (!j["result"].is<int>() || j["result"].as<int>() != 0) {
@@ -331,7 +613,7 @@ ResponseParser_ArduinoJson7::parse_last_message_response(basic_Error & e, std::s
     return "";
   }
 
-  if (!j["messages"].is<const JsonArray&>()) { return ""; }
+  if (!j["messages"].is<JsonArray>()) { return ""; }
 
   JsonArray array = j["messages"].as<JsonArray>();
   bool found = false;
@@ -362,9 +644,11 @@ ResponseParser_ArduinoJson7::has_template_feature(basic_Error & err, std::string
   using namespace ::ArduinoJson;
   api::main api;
 
-  JsonDocument doc;
-  DeserializationError json_error = deserializeJson(doc, features_json);
-  if (json_error) { err.set(api, Subsystem::Json); return false; }
+  Arena arena(arena_size_);
+  JsonDocument doc(arena.allocator());
+  internal::Deadline deadline(limits_.time_budget_us);
+  int json_reason = 0;
+  if (!parse(doc, features_json, limits_, deadline, json_reason)) { err.set(api, Subsystem::Json, json_reason); return false; }
 
   if (!doc.is<JsonArray>()) { err.set(api, Subsystem::Json); return false; }
 
@@ -379,6 +663,8 @@ ResponseParser_ArduinoJson7::has_template_feature(basic_Error & err, std::string
 
     bool found = false;
     for (JsonVariant const elem : j) {
+      if (deadline.check()) { err.set(api, Subsystem::Json, Json::TIME_BUDGET_EXCEEDED); return false; }
+
       char const* cc = nullptr;
       JsonArray jj;
       if (elem.is<char const*>()) {
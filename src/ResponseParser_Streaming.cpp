@@ -0,0 +1,799 @@
+#include <algorithm>
+#include <limits>
+
+#include "api.hpp"
+#include "cryptolens_internals.hpp"
+#include "FieldsToReturn.hpp"
+#include "JsonScanner.hpp"
+#include "LicenseKeyInformation.hpp"
+#include "ResponseParser_Streaming.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace {
+
+using internal::json_key;
+using internal::JsonScanner;
+
+// A string in the response, which may contain escape sequences
+struct RawString {
+  StringView raw;
+  bool escaped;
+
+  std::string to_string() const
+  {
+    if (!escaped) { return raw.to_string(); }
+
+    std::string s;
+    JsonScanner::unescape(raw, s);
+    return s;
+  }
+
+  bool equals(StringView x) const
+  {
+    if (!escaped) { return raw == x; }
+
+    std::string s;
+    JsonScanner::unescape(raw, s);
+    return x == s;
+  }
+};
+
+// The following functions read a value, which is only used if it has the
+// expected type. If a key occurs more than once the last value is used, even
+// if it has another type, the way ResponseParser_ArduinoJson7 does. They
+// return false only on syntax errors.
+
+bool
+read_field(JsonScanner & scanner, optional<std::uint64_t> & out)
+{
+  out = nullopt;
+  if (scanner.peek() != JsonScanner::TYPE_NUMBER) { return scanner.skip_value(); }
+
+  std::uint64_t x;
+  bool is_unsigned;
+  if (!scanner.read_number(x, is_unsigned)) { return false; }
+
+  if (is_unsigned) { out = x; }
+  return true;
+}
+
+bool
+read_field(JsonScanner & scanner, optional<int> & out)
+{
+  out = nullopt;
+  if (scanner.peek() != JsonScanner::TYPE_NUMBER) { return scanner.skip_value(); }
+
+  std::int64_t x;
+  bool is_integer;
+  if (!scanner.read_int(x, is_integer)) { return false; }
+
+  if (is_integer && std::numeric_limits<int>::min() <= x && x <= std::numeric_limits<int>::max()) { out = (int)x; }
+  return true;
+}
+
+bool
+read_field(JsonScanner & scanner, optional<bool> & out)
+{
+  out = nullopt;
+  JsonScanner::Type t = scanner.peek();
+  if (t != JsonScanner::TYPE_TRUE && t != JsonScanner::TYPE_FALSE) { return scanner.skip_value(); }
+
+  bool x;
+  if (!scanner.read_bool(x)) { return false; }
+
+  out = x;
+  return true;
+}
+
+bool
+read_field(JsonScanner & scanner, optional<RawString> & out)
+{
+  out = nullopt;
+  if (scanner.peek() != JsonScanner::TYPE_STRING) { return scanner.skip_value(); }
+
+  RawString x;
+  if (!scanner.read_string(x.raw, x.escaped)) { return false; }
+
+  out = x;
+  return true;
+}
+
+bool
+read_field(JsonScanner & scanner, optional<std::string> & out)
+{
+  out = nullopt;
+
+  optional<RawString> x;
+  if (!read_field(scanner, x)) { return false; }
+
+  if (x) { out = x->to_string(); }
+  return true;
+}
+
+// Calls f(key) for each member of an object, which must consume the value.
+template<typename F>
+bool
+read_object(JsonScanner & scanner, F f)
+{
+  if (!scanner.enter_object()) { return false; }
+
+  std::string unescaped;
+  StringView key;
+  bool escaped;
+  while (scanner.next_key(key, escaped)) {
+    if (escaped) {
+      unescaped.clear();
+      JsonScanner::unescape(key, unescaped);
+      key = StringView(unescaped.data(), unescaped.size());
+    }
+
+    if (!f(key)) { return false; }
+  }
+
+  return !scanner.failed();
+}
+
+// Sets up a scanner for the text between begin and end using the limits set
+// on the parser. The deadline must outlive the scanner.
+JsonScanner
+make_scanner(char const* begin, char const* end, internal::ParseLimits const& limits, internal::Deadline & deadline)
+{
+  JsonScanner scanner(begin, end);
+  scanner.set_max_depth(limits.max_depth > 0 ? limits.max_depth : internal::DEFAULT_MAX_DEPTH);
+  if (deadline.enabled()) { scanner.set_deadline(&deadline); }
+  return scanner;
+}
+
+JsonScanner
+make_scanner(std::string const& s, internal::ParseLimits const& limits, internal::Deadline & deadline)
+{
+  return make_scanner(s.data(), s.data() + s.size(), limits, deadline);
+}
+
+// The reason reported for a response that could not be parsed
+int
+json_error(JsonScanner const& scanner)
+{
+  switch (scanner.exceeded()) {
+  case JsonScanner::LIMIT_DEPTH:    return errors::Json::MAX_DEPTH_EXCEEDED;
+  case JsonScanner::LIMIT_ELEMENTS: return errors::Json::MAX_ELEMENTS_EXCEEDED;
+  case JsonScanner::LIMIT_TIME:     return errors::Json::TIME_BUDGET_EXCEEDED;
+  default:                          return 0;
+  }
+}
+
+// Skips the remaining elements of an array
+bool
+skip_array(JsonScanner & scanner)
+{
+  while (scanner.next_element()) {
+    if (!scanner.skip_value()) { return false; }
+  }
+
+  return !scanner.failed();
+}
+
+// The fields present in all responses from the Web API
+struct Result {
+  optional<int> result;
+  optional<RawString> message;
+
+  bool read(JsonScanner & scanner, StringView key)
+  {
+    switch (json_key(key)) {
+    case json_key("result"):  if (key == "result")  { return read_field(scanner, result); } break;
+    case json_key("message"): if (key == "message") { return read_field(scanner, message); } break;
+    }
+
+    return scanner.skip_value();
+  }
+
+  bool check(basic_Error & e) const
+  {
+    using namespace errors;
+    api::main api;
+
+    if (!result || *result != 0) {
+      if (!message) {
+        e.set(api, Subsystem::Main, Main::UNKNOWN_SERVER_REPLY);
+        return false;
+      }
+
+      int reason = internal::activate_parse_server_error_message(message->to_string().c_str());
+      e.set(api, Subsystem::Main, reason);
+      return false;
+    }
+
+    return true;
+  }
+};
+
+enum LicenseField
+  { LICENSE_UNKNOWN
+  , LICENSE_PRODUCT_ID
+  , LICENSE_ID
+  , LICENSE_KEY
+  , LICENSE_CREATED
+  , LICENSE_EXPIRES
+  , LICENSE_PERIOD
+  , LICENSE_F1
+  , LICENSE_F2
+  , LICENSE_F3
+  , LICENSE_F4
+  , LICENSE_F5
+  , LICENSE_F6
+  , LICENSE_F7
+  , LICENSE_F8
+  , LICENSE_NOTES
+  , LICENSE_BLOCK
+  , LICENSE_GLOBAL_ID
+  , LICENSE_CUSTOMER
+  , LICENSE_ACTIVATED_MACHINES
+  , LICENSE_TRIAL_ACTIVATION
+  , LICENSE_MAX_NO_OF_MACHINES
+  , LICENSE_ALLOWED_MACHINES
+  , LICENSE_DATA_OBJECTS
+  , LICENSE_SIGN_DATE
+  };
+
+LicenseField
+license_field(StringView key)
+{
+  switch (json_key(key)) {
+  case json_key("ProductId"):         return key == "ProductId"         ? LICENSE_PRODUCT_ID         : LICENSE_UNKNOWN;
+  case json_key("ID"):                return key == "ID"                ? LICENSE_ID                 : LICENSE_UNKNOWN;
+  case json_key("Key"):               return key == "Key"               ? LICENSE_KEY                : LICENSE_UNKNOWN;
+  case json_key("Created"):           return key == "Created"           ? LICENSE_CREATED            : LICENSE_UNKNOWN;
+  case json_key("Expires"):           return key == "Expires"           ? LICENSE_EXPIRES            : LICENSE_UNKNOWN;
+  case json_key("Period"):            return key == "Period"            ? LICENSE_PERIOD             : LICENSE_UNKNOWN;
+  case json_key("F1"):                return key == "F1"                ? LICENSE_F1                 : LICENSE_UNKNOWN;
+  case json_key("F2"):                return key == "F2"                ? LICENSE_F2                 : LICENSE_UNKNOWN;
+  case json_key("F3"):                return key == "F3"                ? LICENSE_F3                 : LICENSE_UNKNOWN;
+  case json_key("F4"):                return key == "F4"                ? LICENSE_F4                 : LICENSE_UNKNOWN;
+  case json_key("F5"):                return key == "F5"                ? LICENSE_F5                 : LICENSE_UNKNOWN;
+  case json_key("F6"):                return key == "F6"                ? LICENSE_F6                 : LICENSE_UNKNOWN;
+  case json_key("F7"):                return key == "F7"                ? LICENSE_F7                 : LICENSE_UNKNOWN;
+  case json_key("F8"):                return key == "F8"                ? LICENSE_F8                 : LICENSE_UNKNOWN;
+  case json_key("Notes"):             return key == "Notes"             ? LICENSE_NOTES              : LICENSE_UNKNOWN;
+  case json_key("Block"):             return key == "Block"             ? LICENSE_BLOCK              : LICENSE_UNKNOWN;
+  case json_key("GlobalId"):          return key == "GlobalId"          ? LICENSE_GLOBAL_ID          : LICENSE_UNKNOWN;
+  case json_key("Customer"):          return key == "Customer"          ? LICENSE_CUSTOMER           : LICENSE_UNKNOWN;
+  case json_key("ActivatedMachines"): return key == "ActivatedMachines" ? LICENSE_ACTIVATED_MACHINES : LICENSE_UNKNOWN;
+  case json_key("TrialActivation"):   return key == "TrialActivation"   ? LICENSE_TRIAL_ACTIVATION   : LICENSE_UNKNOWN;
+  case json_key("MaxNoOfMachines"):   return key == "MaxNoOfMachines"   ? LICENSE_MAX_NO_OF_MACHINES : LICENSE_UNKNOWN;
+  case json_key("AllowedMachines"):   return key == "AllowedMachines"   ? LICENSE_ALLOWED_MACHINES   : LICENSE_UNKNOWN;
+  case json_key("DataObjects"):       return key == "DataObjects"       ? LICENSE_DATA_OBJECTS       : LICENSE_UNKNOWN;
+  case json_key("SignDate"):          return key == "SignDate"          ? LICENSE_SIGN_DATE          : LICENSE_UNKNOWN;
+  default:                            return LICENSE_UNKNOWN;
+  }
+}
+
+bool
+read_customer(JsonScanner & scanner, optional<Customer> & out)
+{
+  out = nullopt;
+  if (scanner.peek() != JsonScanner::TYPE_OBJECT) { return scanner.skip_value(); }
+
+  optional<std::uint64_t> id, created;
+  optional<std::string> name, email, company_name;
+
+  bool ok = read_object(scanner, [&](StringView key) {
+    switch (json_key(key)) {
+    case json_key("Id"):          if (key == "Id")          { return read_field(scanner, id); } break;
+    case json_key("Name"):        if (key == "Name")        { return read_field(scanner, name); } break;
+    case json_key("Email"):       if (key == "Email")       { return read_field(scanner, email); } break;
+    case json_key("CompanyName"): if (key == "CompanyName") { return read_field(scanner, company_name); } break;
+    case json_key("Created"):     if (key == "Created")     { return read_field(scanner, created); } break;
+    }
+
+    return scanner.skip_value();
+  });
+  if (!ok) { return false; }
+
+  if (id && created) {
+    out = Customer
+            ( (int)*id
+            , name ? std::move(*name) : ""
+            , email ? std::move(*email) : ""
+            , company_name ? std::move(*company_name) : ""
+            , *created
+            );
+  }
+
+  return true;
+}
+
+// The following functions read one element of an array, and return false
+// only on syntax errors. valid is set if the element has the expected type.
+
+bool
+read_element(JsonScanner & scanner, std::vector<ActivationData> & out, bool & valid)
+{
+  valid = false;
+  if (scanner.peek() != JsonScanner::TYPE_OBJECT) { return scanner.skip_value(); }
+
+  optional<std::string> mid, ip, friendly_name;
+  optional<std::uint64_t> time;
+
+  bool ok = read_object(scanner, [&](StringView key) {
+    switch (json_key(key)) {
+    case json_key("Mid"):          if (key == "Mid")          { return read_field(scanner, mid); } break;
+    case json_key("IP"):           if (key == "IP")           { return read_field(scanner, ip); } break;
+    case json_key("Time"):         if (key == "Time")         { return read_field(scanner, time); } break;
+    case json_key("FriendlyName"): if (key == "FriendlyName") { return read_field(scanner, friendly_name); } break;
+    }
+
+    return scanner.skip_value();
+  });
+  if (!ok) { return false; }
+
+  if (mid && ip && time) {
+    if (friendly_name) {
+      out.emplace_back(std::move(*mid), std::move(*ip), *time, std::move(*friendly_name));
+    } else {
+      out.emplace_back(std::move(*mid), std::move(*ip), *time);
+    }
+    valid = true;
+  }
+
+  return true;
+}
+
+bool
+read_element(JsonScanner & scanner, std::vector<DataObject> & out, bool & valid)
+{
+  valid = false;
+  if (scanner.peek() != JsonScanner::TYPE_OBJECT) { return scanner.skip_value(); }
+
+  optional<std::uint64_t> id, int_value;
+  optional<std::string> name, string_value;
+
+  bool ok = read_object(scanner, [&](StringView key) {
+    switch (json_key(key)) {
+    case json_key("Id"):          if (key == "Id")          { return read_field(scanner, id); } break;
+    case json_key("Name"):        if (key == "Name")        { return read_field(scanner, name); } break;
+    case json_key("StringValue"): if (key == "StringValue") { return read_field(scanner, string_value); } break;
+    case json_key("IntValue"):    if (key == "IntValue")    { return read_field(scanner, int_value); } break;
+    }
+
+    return scanner.skip_value();
+  });
+  if (!ok) { return false; }
+
+  if (id && name && string_value && int_value) {
+    out.emplace_back((int)*id, std::move(*name), std::move(*string_value), (int)*int_value);
+    valid = true;
+  }
+
+  return true;
+}
+
+// The array is only used if all elements are valid. Having more than
+// max_elements elements is an error, unless max_elements is 0, even if the
+// array is not used.
+template<typename T>
+bool
+read_array(JsonScanner & scanner, optional<std::vector<T>> & out, std::size_t max_elements)
+{
+  out = nullopt;
+  if (scanner.peek() != JsonScanner::TYPE_ARRAY) { return scanner.skip_value(); }
+
+  std::vector<T> v;
+  std::size_t size = 0;
+  bool all_valid = true;
+
+  scanner.enter_array();
+  while (scanner.next_element()) {
+    if (max_elements != 0 && size == max_elements) { return scanner.exceed(JsonScanner::LIMIT_ELEMENTS); }
+    ++size;
+
+    // Once an element is invalid the remaining ones are only counted
+    if (!all_valid) {
+      if (!scanner.skip_value()) { return false; }
+      continue;
+    }
+
+    if (!read_element(scanner, v, all_valid)) { return false; }
+  }
+  if (scanner.failed()) { return false; }
+
+  if (all_valid) { out = std::move(v); }
+  return true;
+}
+
+} // namespace
+
+void
+ResponseParser_Streaming::set_max_depth(basic_Error & e, int max_depth)
+{
+  if (e) { return; }
+
+  this->limits_.max_depth = max_depth > 0 ? max_depth : 0;
+}
+
+void
+ResponseParser_Streaming::set_max_elements(basic_Error & e, std::size_t max_elements)
+{
+  if (e) { return; }
+
+  this->limits_.max_elements = max_elements;
+}
+
+void
+ResponseParser_Streaming::set_time_budget(basic_Error & e, long time_budget_us)
+{
+  if (e) { return; }
+
+  this->limits_.time_budget_us = time_budget_us > 0 ? time_budget_us : 0;
+}
+
+optional<LicenseKeyInformation>
+ResponseParser_Streaming::make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip) const
+{
+  if (e) { return nullopt; }
+
+  return ResponseParser_Streaming::make_license_key_information_unsafe(e, raw_license_key.get_license(), fields_to_skip);
+}
+
+optional<LicenseKeyInformation>
+ResponseParser_Streaming::make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip) const
+{
+  if (e) { return nullopt; }
+
+  if (!raw_license_key) { return nullopt; }
+
+  return ResponseParser_Streaming::make_license_key_information(e, *raw_license_key, fields_to_skip);
+}
+
+optional<LicenseKeyInformation>
+ResponseParser_Streaming::make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip) const
+{
+  if (e) { return nullopt; }
+
+  optional<std::uint64_t> product_id, created, expires, period, sign_date;
+  optional<bool> block, trial_activation, f1, f2, f3, f4, f5, f6, f7, f8;
+  optional<std::uint64_t> id, global_id, maxnoofmachines;
+  optional<std::string> key, notes, allowed_machines;
+  optional<Customer> customer;
+  optional<std::vector<ActivationData>> activated_machines;
+  optional<std::vector<DataObject>> data_objects;
+
+  internal::Deadline deadline(limits_.time_budget_us);
+  JsonScanner scanner = make_scanner(license_key, limits_, deadline);
+
+  // Skipped fields are not copied, but must still be valid JSON
+  auto skip = [&](int field) { return (fields_to_skip & field) != 0; };
+
+  bool ok = read_object(scanner, [&](StringView k) {
+    switch (license_field(k)) {
+    case LICENSE_PRODUCT_ID:         return read_field(scanner, product_id);
+    case LICENSE_ID:                 return skip(FieldsToReturn::ID)                 ? scanner.skip_value() : read_field(scanner, id);
+    case LICENSE_KEY:                return skip(FieldsToReturn::KEY)                ? scanner.skip_value() : read_field(scanner, key);
+    case LICENSE_CREATED:            return read_field(scanner, created);
+    case LICENSE_EXPIRES:            return read_field(scanner, expires);
+    case LICENSE_PERIOD:             return read_field(scanner, period);
+    case LICENSE_F1:                 return read_field(scanner, f1);
+    case LICENSE_F2:                 return read_field(scanner, f2);
+    case LICENSE_F3:                 return read_field(scanner, f3);
+    case LICENSE_F4:                 return read_field(scanner, f4);
+    case LICENSE_F5:                 return read_field(scanner, f5);
+    case LICENSE_F6:                 return read_field(scanner, f6);
+    case LICENSE_F7:                 return read_field(scanner, f7);
+    case LICENSE_F8:                 return read_field(scanner, f8);
+    case LICENSE_NOTES:              return skip(FieldsToReturn::NOTES)              ? scanner.skip_value() : read_field(scanner, notes);
+    case LICENSE_BLOCK:              return read_field(scanner, block);
+    case LICENSE_GLOBAL_ID:          return skip(FieldsToReturn::GLOBAL_ID)          ? scanner.skip_value() : read_field(scanner, global_id);
+    case LICENSE_CUSTOMER:           return skip(FieldsToReturn::CUSTOMER)           ? scanner.skip_value() : read_customer(scanner, customer);
+    case LICENSE_ACTIVATED_MACHINES: return skip(FieldsToReturn::ACTIVATED_MACHINES) ? scanner.skip_value() : read_array(scanner, activated_machines, limits_.max_elements);
+    case LICENSE_TRIAL_ACTIVATION:   return read_field(scanner, trial_activation);
+    case LICENSE_MAX_NO_OF_MACHINES: return skip(FieldsToReturn::MAX_NO_OF_MACHINES) ? scanner.skip_value() : read_field(scanner, maxnoofmachines);
+    case LICENSE_ALLOWED_MACHINES:   return skip(FieldsToReturn::ALLOWED_MACHINES)   ? scanner.skip_value() : read_field(scanner, allowed_machines);
+    case LICENSE_DATA_OBJECTS:       return skip(FieldsToReturn::DATA_OBJECTS)       ? scanner.skip_value() : read_array(scanner, data_objects, limits_.max_elements);
+    case LICENSE_SIGN_DATE:          return read_field(scanner, sign_date);
+    default:                         return scanner.skip_value();
+    }
+  });
+
+  if (!ok) { e.set(api::main(), errors::Subsystem::Json, json_error(scanner)); return nullopt; }
+
+  // Same mandatory fields as ResponseParser_ArduinoJson7
+  bool mandatory_missing =
+      !( product_id && created && expires && period && block && trial_activation && sign_date
+      && f1 && f2 && f3 && f4 && f5 && f6 && f7 && f8
+       );
+
+  if (mandatory_missing) { e.set(api::main(), errors::Subsystem::Json); return nullopt; }
+
+  optional<int> id_int, global_id_int, maxnoofmachines_int;
+  if (id) { id_int = (int)*id; }
+  if (global_id) { global_id_int = (int)*global_id; }
+  if (maxnoofmachines) { maxnoofmachines_int = (int)*maxnoofmachines; }
+
+  return make_optional(LicenseKeyInformation(
+    api::internal::main(),
+    (int)*product_id,
+    *created,
+    *expires,
+    (int)*period,
+    *block,
+    *trial_activation,
+    *sign_date,
+    *f1,
+    *f2,
+    *f3,
+    *f4,
+    *f5,
+    *f6,
+    *f7,
+    *f8,
+    std::move(id_int),
+    std::move(key),
+    std::move(notes),
+    std::move(global_id_int),
+    std::move(customer),
+    std::move(activated_machines),
+    std::move(maxnoofmachines_int),
+    std::move(allowed_machines),
+    std::move(data_objects)
+  ));
+}
+
+optional<std::pair<std::string, std::string>>
+ResponseParser_Streaming::parse_activate_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return nullopt; }
+
+  using namespace errors;
+  api::main api;
+
+  Result result;
+  optional<RawString> license_key, signature;
+
+  internal::Deadline deadline(limits_.time_budget_us);
+  JsonScanner scanner = make_scanner(server_response, limits_, deadline);
+
+  bool ok = read_object(scanner, [&](StringView key) {
+    switch (json_key(key)) {
+    case json_key("licenseKey"): if (key == "licenseKey") { return read_field(scanner, license_key); } break;
+    case json_key("signature"):  if (key == "signature")  { return read_field(scanner, signature); } break;
+    }
+
+    return result.read(scanner, key);
+  });
+
+  if (!ok) { e.set(api, Subsystem::Json, json_error(scanner)); return nullopt; }
+
+  if (!result.check(e)) { return nullopt; }
+
+  if (!license_key || !signature) {
+    e.set(api, Subsystem::Main, Main::UNKNOWN_SERVER_REPLY);
+    return nullopt;
+  }
+
+  return make_optional(std::make_pair(license_key->to_string(), signature->to_string()));
+}
+
+std::string
+ResponseParser_Streaming::parse_create_trial_key_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return ""; }
+
+  using namespace errors;
+  api::main api;
+
+  Result result;
+  optional<RawString> key;
+
+  internal::Deadline deadline(limits_.time_budget_us);
+  JsonScanner scanner = make_scanner(server_response, limits_, deadline);
+
+  bool ok = read_object(scanner, [&](StringView k) {
+    switch (json_key(k)) {
+    case json_key("key"): if (k == "key") { return read_field(scanner, key); } break;
+    }
+
+    return result.read(scanner, k);
+  });
+
+  if (!ok) { e.set(api, Subsystem::Json, json_error(scanner)); return ""; }
+
+  if (!result.check(e)) { return ""; }
+
+  if (!key) { e.set(api, Subsystem::Main, Main::UNKNOWN_SERVER_REPLY); return ""; }
+
+  return key->to_string();
+}
+
+void
+ResponseParser_Streaming::parse_deactivate_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return; }
+
+  Result result;
+
+  internal::Deadline deadline(limits_.time_budget_us);
+  JsonScanner scanner = make_scanner(server_response, limits_, deadline);
+
+  bool ok = read_object(scanner, [&](StringView key) { return result.read(scanner, key); });
+
+  if (!ok) { e.set(api::main(), errors::Subsystem::Json, json_error(scanner)); return; }
+
+  result.check(e);
+}
+
+namespace {
+
+// Calls f(content, created) for each valid message in the response to GetMessages
+template<typename F>
+bool
+read_messages(basic_Error & e, std::string const& server_response, internal::ParseLimits const& limits, F f)
+{
+  Result result;
+
+  internal::Deadline deadline(limits.time_budget_us);
+  JsonScanner scanner = make_scanner(server_response, limits, deadline);
+
+  // The messages are only used if the result is successful, which is not
+  // known until the whole response has been read. Thus the messages are
+  // read a second time after this has been checked.
+  char const* messages = nullptr;
+
+  bool ok = read_object(scanner, [&](StringView key) {
+    switch (json_key(key)) {
+    case json_key("messages"):
+      if (key == "messages") {
+        messages = scanner.peek() == JsonScanner::TYPE_ARRAY ? scanner.position() : nullptr;
+        return scanner.skip_value();
+      }
+      break;
+    }
+
+    return result.read(scanner, key);
+  });
+
+  if (!ok) { e.set(api::main(), errors::Subsystem::Json, json_error(scanner)); return false; }
+
+  if (!result.check(e)) { return false; }
+
+  if (messages == nullptr) { return true; }
+
+  JsonScanner array = make_scanner(messages, server_response.data() + server_response.size(), limits, deadline);
+  array.enter_array();
+  while (array.next_element()) {
+    if (array.peek() != JsonScanner::TYPE_OBJECT) { array.skip_value(); continue; }
+
+    optional<int> created;
+    optional<RawString> content;
+
+    read_object(array, [&](StringView key) {
+      switch (json_key(key)) {
+      case json_key("created"): if (key == "created") { return read_field(array, created); } break;
+      case json_key("content"): if (key == "content") { return read_field(array, content); } break;
+      }
+
+      return array.skip_value();
+    });
+
+    if (created && content) { f(*content, *created); }
+  }
+
+  // The messages have already been checked for syntax errors above
+  if (array.exceeded() != JsonScanner::LIMIT_NONE) { e.set(api::main(), errors::Subsystem::Json, json_error(array)); return false; }
+
+  return true;
+}
+
+} // namespace
+
+std::string
+ResponseParser_Streaming::parse_last_message_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return ""; }
+
+  optional<RawString> last;
+  int created_max = -1;
+
+  bool ok = read_messages(e, server_response, limits_, [&](RawString const& content, int created) {
+    if (created > created_max) { last = content; created_max = created; }
+  });
+
+  if (!ok || !last) { return ""; }
+
+  return last->to_string();
+}
+
+std::vector<Message>
+ResponseParser_Streaming::parse_get_messages_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return std::vector<Message>(); }
+
+  std::vector<Message> messages;
+
+  bool ok = read_messages(e, server_response, limits_, [&](RawString const& content, int created) {
+    messages.emplace_back(content.to_string(), created);
+  });
+
+  if (!ok) { return std::vector<Message>(); }
+
+  return messages;
+}
+
+bool
+ResponseParser_Streaming::has_template_feature(basic_Error & err, std::string const& features_json, std::string const& feature) const
+{
+  if (err) { return false; }
+
+  using namespace errors;
+  api::main api;
+
+  internal::Deadline deadline(limits_.time_budget_us);
+  JsonScanner scanner = make_scanner(features_json, limits_, deadline);
+
+  if (!scanner.enter_array()) { err.set(api, Subsystem::Json, json_error(scanner)); return false; }
+
+  // Each element of the array is either the name of a feature, or an array
+  // where the first element is the name of a feature and the second element
+  // is an array with its subfeatures. For each part of the feature name the
+  // scanner descends into the array with the subfeatures, if any.
+  using string_const_iterator = std::string::const_iterator;
+
+  string_const_iterator p = feature.cbegin();
+  string_const_iterator const e = feature.cend();
+  bool in_array = true;
+  while (p != e && in_array) {
+    string_const_iterator q = std::find(p, e, '.');
+    StringView name(feature.data() + (p - feature.cbegin()), q - p);
+
+    bool found = false;
+    while (!found && scanner.next_element()) {
+      JsonScanner::Type t = scanner.peek();
+
+      if (t == JsonScanner::TYPE_STRING) {
+        RawString x;
+        scanner.read_string(x.raw, x.escaped);
+
+        if (x.equals(name)) {
+          found = true;
+          in_array = false;
+        }
+      } else if (t == JsonScanner::TYPE_ARRAY) {
+        scanner.enter_array();
+
+        if (!scanner.next_element()) { continue; }
+
+        if (scanner.peek() != JsonScanner::TYPE_STRING) { scanner.skip_value(); skip_array(scanner); continue; }
+
+        RawString x;
+        scanner.read_string(x.raw, x.escaped);
+
+        if (!scanner.next_element()) { continue; }
+
+        if (scanner.peek() == JsonScanner::TYPE_ARRAY && x.equals(name)) {
+          found = true;
+          scanner.enter_array();
+        } else {
+          scanner.skip_value();
+          skip_array(scanner);
+        }
+      } else {
+        scanner.skip_value();
+      }
+    }
+
+    if (scanner.failed()) { err.set(api, Subsystem::Json, json_error(scanner)); return false; }
+
+    if (!found) { break; }
+
+    if (q != e) { ++q; }
+    p = q;
+  }
+
+  return p == e;
+}
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
@@ -0,0 +1,779 @@
+#include <simdjson.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "api.hpp"
+#include "cryptolens_internals.hpp"
+#include "FieldsToReturn.hpp"
+#include "JsonScanner.hpp"
+#include "LicenseKeyInformation.hpp"
+#include "ResponseParser_simdjson.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace {
+
+namespace ondemand = ::simdjson::ondemand;
+
+using internal::json_key;
+
+// The simdjson parser reuses its buffers between documents, thus each
+// thread keeps one instead of creating a new parser for each response.
+struct ThreadParser {
+  ondemand::parser parser;
+  std::string padded; // Copy of responses without room for the padding
+};
+
+ThreadParser &
+thread_parser()
+{
+  static thread_local ThreadParser p;
+  return p;
+}
+
+// The limits of a single parse, together with the reason for the error if
+// one of them was exceeded.
+struct Budget {
+  explicit Budget(internal::ParseLimits const& limits)
+  : max_depth(limits.max_depth > 0 ? limits.max_depth : internal::DEFAULT_MAX_DEPTH), max_elements(limits.max_elements), deadline(limits.time_budget_us), reason(0)
+  {}
+
+  // Returns false, such that parsing stops
+  bool exceed(int r) { reason = r; return false; }
+
+  int max_depth;
+  std::size_t max_elements;
+  internal::Deadline deadline;
+  int reason;
+};
+
+// simdjson skips values without limiting how deeply they are nested, and
+// rejects documents with anything after the outermost object or array, which
+// the other response parsers ignore. Thus the response is scanned before it
+// is parsed, checking the nesting and finding where the outermost value ends.
+// Returns false if the value is nested more deeply than max_depth.
+bool
+scan_outermost(std::string const& json, int max_depth, std::size_t & size)
+{
+  size = json.size();
+
+  int depth = 0;
+  bool in_string = false;
+  for (std::size_t i = 0; i < json.size(); ++i) {
+    char c = json[i];
+    if (in_string) {
+      if      (c == '\\') { ++i; }
+      else if (c == '"')  { in_string = false; }
+    } else if (c == '"') {
+      in_string = true;
+    } else if (c == '{' || c == '[') {
+      if (++depth > max_depth) { return false; }
+    } else if (c == '}' || c == ']') {
+      if (--depth == 0) { size = i + 1; return true; }
+    }
+  }
+
+  return true;
+}
+
+// simdjson reads up to SIMDJSON_PADDING bytes past the end of the input. The
+// input is only copied if the string has not already allocated room for it.
+// Since the fields of a response are too few for Deadline::check() to read
+// the clock, it is read once the structure of the response has been found.
+bool
+iterate(std::string const& json, Budget & budget, ondemand::document & doc)
+{
+  std::size_t size;
+  if (!scan_outermost(json, budget.max_depth, size)) { return budget.exceed(errors::Json::MAX_DEPTH_EXCEEDED); }
+
+  ThreadParser & p = thread_parser();
+
+  bool ok;
+  if (json.capacity() - size >= simdjson::SIMDJSON_PADDING) {
+    ok = !p.parser.iterate(json.data(), size, json.capacity()).get(doc);
+  } else {
+    p.padded.reserve(size + simdjson::SIMDJSON_PADDING);
+    p.padded.assign(json, 0, size);
+    ok = !p.parser.iterate(p.padded.data(), p.padded.size(), p.padded.capacity()).get(doc);
+  }
+
+  if (ok && budget.deadline.expired()) { return budget.exceed(errors::Json::TIME_BUDGET_EXCEEDED); }
+  return ok;
+}
+
+// Errors returned when a value has another type than expected, in which case
+// the value is ignored the way ResponseParser_ArduinoJson7 does. Any other
+// error means that the response is not valid JSON.
+bool
+is_type_error(simdjson::error_code error)
+{
+  return error == simdjson::INCORRECT_TYPE || error == simdjson::NUMBER_OUT_OF_RANGE;
+}
+
+// The following functions read a value, which is only used if it has the
+// expected type. If a key occurs more than once the last value is used, even
+// if it has another type, the way ResponseParser_ArduinoJson7 does. They
+// return false only on syntax errors. Values that are not read are skipped by
+// simdjson.
+
+bool
+read_field(ondemand::value & value, optional<std::uint64_t> & out)
+{
+  out = nullopt;
+
+  std::uint64_t x;
+  simdjson::error_code error = value.get_uint64().get(x);
+  if (error) { return is_type_error(error); }
+
+  out = x;
+  return true;
+}
+
+bool
+read_field(ondemand::value & value, optional<int> & out)
+{
+  out = nullopt;
+
+  std::int64_t x;
+  simdjson::error_code error = value.get_int64().get(x);
+  if (error) { return is_type_error(error); }
+
+  if (std::numeric_limits<int>::min() <= x && x <= std::numeric_limits<int>::max()) { out = (int)x; }
+  return true;
+}
+
+bool
+read_field(ondemand::value & value, optional<bool> & out)
+{
+  out = nullopt;
+
+  bool x;
+  simdjson::error_code error = value.get_bool().get(x);
+  if (error) { return is_type_error(error); }
+
+  out = x;
+  return true;
+}
+
+bool
+read_field(ondemand::value & value, optional<std::string> & out)
+{
+  out = nullopt;
+
+  std::string_view x;
+  simdjson::error_code error = value.get_string().get(x);
+  if (error) { return is_type_error(error); }
+
+  out = std::string(x.data(), x.size());
+  return true;
+}
+
+bool
+is_type(ondemand::value & value, ondemand::json_type type)
+{
+  ondemand::json_type t;
+  return !value.type().get(t) && t == type;
+}
+
+// Calls f(key, value) for each member of an object. The keys are unescaped.
+template<typename F>
+bool
+read_object(Budget & budget, simdjson::simdjson_result<ondemand::object> result, F f)
+{
+  ondemand::object object;
+  if (std::move(result).get(object)) { return false; }
+
+  for (auto field : object) {
+    if (budget.deadline.check()) { return budget.exceed(errors::Json::TIME_BUDGET_EXCEEDED); }
+
+    std::string_view key;
+    if (field.unescaped_key().get(key)) { return false; }
+
+    ondemand::value value;
+    if (field.value().get(value)) { return false; }
+
+    if (!f(StringView(key.data(), key.size()), value)) { return false; }
+  }
+
+  return true;
+}
+
+// The fields present in all responses from the Web API
+struct Result {
+  optional<int> result;
+  optional<std::string> message;
+
+  bool read(StringView key, ondemand::value & value)
+  {
+    switch (json_key(key)) {
+    case json_key("result"):  if (key == "result")  { return read_field(value, result); } break;
+    case json_key("message"): if (key == "message") { return read_field(value, message); } break;
+    }
+
+    return true;
+  }
+
+  bool check(basic_Error & e) const
+  {
+    using namespace errors;
+    api::main api;
+
+    if (!result || *result != 0) {
+      if (!message) {
+        e.set(api, Subsystem::Main, Main::UNKNOWN_SERVER_REPLY);
+        return false;
+      }
+
+      int reason = internal::activate_parse_server_error_message(message->c_str());
+      e.set(api, Subsystem::Main, reason);
+      return false;
+    }
+
+    return true;
+  }
+};
+
+bool
+read_customer(Budget & budget, ondemand::value & value, optional<Customer> & out)
+{
+  out = nullopt;
+  if (!is_type(value, ondemand::json_type::object)) { return true; }
+
+  optional<std::uint64_t> id, created;
+  optional<std::string> name, email, company_name;
+
+  bool ok = read_object(budget, value.get_object(), [&](StringView key, ondemand::value & v) {
+    switch (json_key(key)) {
+    case json_key("Id"):          if (key == "Id")          { return read_field(v, id); } break;
+    case json_key("Name"):        if (key == "Name")        { return read_field(v, name); } break;
+    case json_key("Email"):       if (key == "Email")       { return read_field(v, email); } break;
+    case json_key("CompanyName"): if (key == "CompanyName") { return read_field(v, company_name); } break;
+    case json_key("Created"):     if (key == "Created")     { return read_field(v, created); } break;
+    }
+
+    return true;
+  });
+  if (!ok) { return false; }
+
+  if (id && created) {
+    out = Customer
+            ( (int)*id
+            , name ? std::move(*name) : ""
+            , email ? std::move(*email) : ""
+            , company_name ? std::move(*company_name) : ""
+            , *created
+            );
+  }
+
+  return true;
+}
+
+// The following functions read one element of an array, and return false
+// only on syntax errors. valid is set if the element has the expected type.
+
+bool
+read_element(Budget & budget, ondemand::value & value, std::vector<ActivationData> & out, bool & valid)
+{
+  valid = false;
+  if (!is_type(value, ondemand::json_type::object)) { return true; }
+
+  optional<std::string> mid, ip, friendly_name;
+  optional<std::uint64_t> time;
+
+  bool ok = read_object(budget, value.get_object(), [&](StringView key, ondemand::value & v) {
+    switch (json_key(key)) {
+    case json_key("Mid"):          if (key == "Mid")          { return read_field(v, mid); } break;
+    case json_key("IP"):           if (key == "IP")           { return read_field(v, ip); } break;
+    case json_key("Time"):         if (key == "Time")         { return read_field(v, time); } break;
+    case json_key("FriendlyName"): if (key == "FriendlyName") { return read_field(v, friendly_name); } break;
+    }
+
+    return true;
+  });
+  if (!ok) { return false; }
+
+  if (mid && ip && time) {
+    if (friendly_name) {
+      out.emplace_back(std::move(*mid), std::move(*ip), *time, std::move(*friendly_name));
+    } else {
+      out.emplace_back(std::move(*mid), std::move(*ip), *time);
+    }
+    valid = true;
+  }
+
+  return true;
+}
+
+bool
+read_element(Budget & budget, ondemand::value & value, std::vector<DataObject> & out, bool & valid)
+{
+  valid = false;
+  if (!is_type(value, ondemand::json_type::object)) { return true; }
+
+  optional<std::uint64_t> id, int_value;
+  optional<std::string> name, string_value;
+
+  bool ok = read_object(budget, value.get_object(), [&](StringView key, ondemand::value & v) {
+    switch (json_key(key)) {
+    case json_key("Id"):          if (key == "Id")          { return read_field(v, id); } break;
+    case json_key("Name"):        if (key == "Name")        { return read_field(v, name); } break;
+    case json_key("StringValue"): if (key == "StringValue") { return read_field(v, string_value); } break;
+    case json_key("IntValue"):    if (key == "IntValue")    { return read_field(v, int_value); } break;
+    }
+
+    return true;
+  });
+  if (!ok) { return false; }
+
+  if (id && name && string_value && int_value) {
+    out.emplace_back((int)*id, std::move(*name), std::move(*string_value), (int)*int_value);
+    valid = true;
+  }
+
+  return true;
+}
+
+// The array is only used if all elements are valid. Having more than
+// max_elements elements is an error, unless max_elements is 0, even if the
+// array is not used.
+template<typename T>
+bool
+read_array(Budget & budget, ondemand::value & value, optional<std::vector<T>> & out)
+{
+  out = nullopt;
+  if (!is_type(value, ondemand::json_type::array)) { return true; }
+
+  ondemand::array array;
+  if (value.get_array().get(array)) { return false; }
+
+  std::vector<T> v;
+  std::size_t size = 0;
+  bool all_valid = true;
+  for (auto element : array) {
+    if (budget.max_elements != 0 && size == budget.max_elements) { return budget.exceed(errors::Json::MAX_ELEMENTS_EXCEEDED); }
+    ++size;
+
+    ondemand::value x;
+    if (element.get(x)) { return false; }
+
+    // Once an element is invalid the remaining ones are only counted, and
+    // skipped by simdjson
+    if (!all_valid) { continue; }
+
+    if (!read_element(budget, x, v, all_valid)) { return false; }
+  }
+
+  if (all_valid) { out = std::move(v); }
+  return true;
+}
+
+} // namespace
+
+void
+ResponseParser_simdjson::set_max_depth(basic_Error & e, int max_depth)
+{
+  if (e) { return; }
+
+  this->limits_.max_depth = max_depth > 0 ? max_depth : 0;
+}
+
+void
+ResponseParser_simdjson::set_max_elements(basic_Error & e, std::size_t max_elements)
+{
+  if (e) { return; }
+
+  this->limits_.max_elements = max_elements;
+}
+
+void
+ResponseParser_simdjson::set_time_budget(basic_Error & e, long time_budget_us)
+{
+  if (e) { return; }
+
+  this->limits_.time_budget_us = time_budget_us > 0 ? time_budget_us : 0;
+}
+
+optional<LicenseKeyInformation>
+ResponseParser_simdjson::make_license_key_information(basic_Error & e, RawLicenseKey const& raw_license_key, int fields_to_skip) const
+{
+  if (e) { return nullopt; }
+
+  return ResponseParser_simdjson::make_license_key_information_unsafe(e, raw_license_key.get_license(), fields_to_skip);
+}
+
+optional<LicenseKeyInformation>
+ResponseParser_simdjson::make_license_key_information(basic_Error & e, optional<RawLicenseKey> const& raw_license_key, int fields_to_skip) const
+{
+  if (e) { return nullopt; }
+
+  if (!raw_license_key) { return nullopt; }
+
+  return ResponseParser_simdjson::make_license_key_information(e, *raw_license_key, fields_to_skip);
+}
+
+optional<LicenseKeyInformation>
+ResponseParser_simdjson::make_license_key_information_unsafe(basic_Error & e, std::string const& license_key, int fields_to_skip) const
+{
+  if (e) { return nullopt; }
+
+  optional<std::uint64_t> product_id, created, expires, period, sign_date;
+  optional<bool> block, trial_activation, f1, f2, f3, f4, f5, f6, f7, f8;
+  optional<std::uint64_t> id, global_id, maxnoofmachines;
+  optional<std::string> key, notes, allowed_machines;
+  optional<Customer> customer;
+  optional<std::vector<ActivationData>> activated_machines;
+  optional<std::vector<DataObject>> data_objects;
+
+  // Values that are not read are skipped by simdjson without being copied
+  auto skip = [&](int field) { return (fields_to_skip & field) != 0; };
+
+  Budget budget(limits_);
+  ondemand::document doc;
+  bool ok = iterate(license_key, budget, doc) && read_object(budget, doc.get_object(), [&](StringView k, ondemand::value & v) {
+    switch (json_key(k)) {
+    case json_key("ProductId"):         if (k == "ProductId")         { return read_field(v, product_id); } break;
+    case json_key("ID"):                if (k == "ID")                { return skip(FieldsToReturn::ID) || read_field(v, id); } break;
+    case json_key("Key"):               if (k == "Key")               { return skip(FieldsToReturn::KEY) || read_field(v, key); } break;
+    case json_key("Created"):           if (k == "Created")           { return read_field(v, created); } break;
+    case json_key("Expires"):           if (k == "Expires")           { return read_field(v, expires); } break;
+    case json_key("Period"):            if (k == "Period")            { return read_field(v, period); } break;
+    case json_key("F1"):                if (k == "F1")                { return read_field(v, f1); } break;
+    case json_key("F2"):                if (k == "F2")                { return read_field(v, f2); } break;
+    case json_key("F3"):                if (k == "F3")                { return read_field(v, f3); } break;
+    case json_key("F4"):                if (k == "F4")                { return read_field(v, f4); } break;
+    case json_key("F5"):                if (k == "F5")                { return read_field(v, f5); } break;
+    case json_key("F6"):                if (k == "F6")                { return read_field(v, f6); } break;
+    case json_key("F7"):                if (k == "F7")                { return read_field(v, f7); } break;
+    case json_key("F8"):                if (k == "F8")                { return read_field(v, f8); } break;
+    case json_key("Notes"):             if (k == "Notes")             { return skip(FieldsToReturn::NOTES) || read_field(v, notes); } break;
+    case json_key("Block"):             if (k == "Block")             { return read_field(v, block); } break;
+    case json_key("GlobalId"):          if (k == "GlobalId")          { return skip(FieldsToReturn::GLOBAL_ID) || read_field(v, global_id); } break;
+    case json_key("Customer"):          if (k == "Customer")          { return skip(FieldsToReturn::CUSTOMER) || read_customer(budget, v, customer); } break;
+    case json_key("ActivatedMachines"): if (k == "ActivatedMachines") { return skip(FieldsToReturn::ACTIVATED_MACHINES) || read_array(budget, v, activated_machines); } break;
+    case json_key("TrialActivation"):   if (k == "TrialActivation")   { return read_field(v, trial_activation); } break;
+    case json_key("MaxNoOfMachines"):   if (k == "MaxNoOfMachines")   { return skip(FieldsToReturn::MAX_NO_OF_MACHINES) || read_field(v, maxnoofmachines); } break;
+    case json_key("AllowedMachines"):   if (k == "AllowedMachines")   { return skip(FieldsToReturn::ALLOWED_MACHINES) || read_field(v, allowed_machines); } break;
+    case json_key("DataObjects"):       if (k == "DataObjects")       { return skip(FieldsToReturn::DATA_OBJECTS) || read_array(budget, v, data_objects); } break;
+    case json_key("SignDate"):          if (k == "SignDate")          { return read_field(v, sign_date); } break;
+    }
+
+    return true;
+  });
+
+  if (!ok) { e.set(api::main(), errors::Subsystem::Json, budget.reason); return nullopt; }
+
+  // Same mandatory fields as ResponseParser_ArduinoJson7
+  bool mandatory_missing =
+      !( product_id && created && expires && period && block && trial_activation && sign_date
+      && f1 && f2 && f3 && f4 && f5 && f6 && f7 && f8
+       );
+
+  if (mandatory_missing) { e.set(api::main(), errors::Subsystem::Json); return nullopt; }
+
+  optional<int> id_int, global_id_int, maxnoofmachines_int;
+  if (id) { id_int = (int)*id; }
+  if (global_id) { global_id_int = (int)*global_id; }
+  if (maxnoofmachines) { maxnoofmachines_int = (int)*maxnoofmachines; }
+
+  return make_optional(LicenseKeyInformation(
+    api::internal::main(),
+    (int)*product_id,
+    *created,
+    *expires,
+    (int)*period,
+    *block,
+    *trial_activation,
+    *sign_date,
+    *f1,
+    *f2,
+    *f3,
+    *f4,
+    *f5,
+    *f6,
+    *f7,
+    *f8,
+    std::move(id_int),
+    std::move(key),
+    std::move(notes),
+    std::move(global_id_int),
+    std::move(customer),
+    std::move(activated_machines),
+    std::move(maxnoofmachines_int),
+    std::move(allowed_machines),
+    std::move(data_objects)
+  ));
+}
+
+optional<std::pair<std::string, std::string>>
+ResponseParser_simdjson::parse_activate_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return nullopt; }
+
+  using namespace errors;
+  api::main api;
+
+  Result result;
+  optional<std::string> license_key, signature;
+
+  Budget budget(limits_);
+  ondemand::document doc;
+  bool ok = iterate(server_response, budget, doc) && read_object(budget, doc.get_object(), [&](StringView key, ondemand::value & value) {
+    switch (json_key(key)) {
+    case json_key("licenseKey"): if (key == "licenseKey") { return read_field(value, license_key); } break;
+    case json_key("signature"):  if (key == "signature")  { return read_field(value, signature); } break;
+    }
+
+    return result.read(key, value);
+  });
+
+  if (!ok) { e.set(api, Subsystem::Json, budget.reason); return nullopt; }
+
+  if (!result.check(e)) { return nullopt; }
+
+  if (!license_key || !signature) {
+    e.set(api, Subsystem::Main, Main::UNKNOWN_SERVER_REPLY);
+    return nullopt;
+  }
+
+  return make_optional(std::make_pair(std::move(*license_key), std::move(*signature)));
+}
+
+std::string
+ResponseParser_simdjson::parse_create_trial_key_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return ""; }
+
+  using namespace errors;
+  api::main api;
+
+  Result result;
+  optional<std::string> key;
+
+  Budget budget(limits_);
+  ondemand::document doc;
+  bool ok = iterate(server_response, budget, doc) && read_object(budget, doc.get_object(), [&](StringView k, ondemand::value & value) {
+    switch (json_key(k)) {
+    case json_key("key"): if (k == "key") { return read_field(value, key); } break;
+    }
+
+    return result.read(k, value);
+  });
+
+  if (!ok) { e.set(api, Subsystem::Json, budget.reason); return ""; }
+
+  if (!result.check(e)) { return ""; }
+
+  if (!key) { e.set(api, Subsystem::Main, Main::UNKNOWN_SERVER_REPLY); return ""; }
+
+  return std::move(*key);
+}
+
+void
+ResponseParser_simdjson::parse_deactivate_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return; }
+
+  Result result;
+
+  Budget budget(limits_);
+  ondemand::document doc;
+  bool ok = iterate(server_response, budget, doc) && read_object(budget, doc.get_object(), [&](StringView key, ondemand::value & value) {
+    return result.read(key, value);
+  });
+
+  if (!ok) { e.set(api::main(), errors::Subsystem::Json, budget.reason); return; }
+
+  result.check(e);
+}
+
+namespace {
+
+// Calls f(content, created) for each valid message in the response to GetMessages
+template<typename F>
+bool
+read_messages(basic_Error & e, std::string const& server_response, internal::ParseLimits const& limits, F f)
+{
+  Result result;
+  Budget budget(limits);
+
+  // The messages are only used if the result is successful, which is not
+  // known until the whole response has been read, thus they are kept until
+  // then. Unlike ResponseParser_Streaming the response is only read once.
+  std::vector<std::pair<std::string, int>> messages;
+
+  ondemand::document doc;
+  bool ok = iterate(server_response, budget, doc) && read_object(budget, doc.get_object(), [&](StringView key, ondemand::value & value) {
+    switch (json_key(key)) {
+    case json_key("messages"):
+      if (key == "messages") {
+        messages.clear();
+        if (!is_type(value, ondemand::json_type::array)) { return true; }
+
+        ondemand::array array;
+        if (value.get_array().get(array)) { return false; }
+
+        for (auto element : array) {
+          ondemand::value x;
+          if (element.get(x)) { return false; }
+
+          if (!is_type(x, ondemand::json_type::object)) { continue; }
+
+          optional<int> created;
+          optional<std::string> content;
+
+          bool valid = read_object(budget, x.get_object(), [&](StringView k, ondemand::value & v) {
+            switch (json_key(k)) {
+            case json_key("created"): if (k == "created") { return read_field(v, created); } break;
+            case json_key("content"): if (k == "content") { return read_field(v, content); } break;
+            }
+
+            return true;
+          });
+          if (!valid) { return false; }
+
+          if (created && content) { messages.emplace_back(std::move(*content), *created); }
+        }
+
+        return true;
+      }
+      break;
+    }
+
+    return result.read(key, value);
+  });
+
+  if (!ok) { e.set(api::main(), errors::Subsystem::Json, budget.reason); return false; }
+
+  if (!result.check(e)) { return false; }
+
+  for (auto & message : messages) { f(message.first, message.second); }
+
+  return true;
+}
+
+} // namespace
+
+std::string
+ResponseParser_simdjson::parse_last_message_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return ""; }
+
+  std::string last;
+  int created_max = -1;
+
+  bool ok = read_messages(e, server_response, limits_, [&](std::string & content, int created) {
+    if (created > created_max) { last = std::move(content); created_max = created; }
+  });
+
+  if (!ok) { return ""; }
+
+  return last;
+}
+
+std::vector<Message>
+ResponseParser_simdjson::parse_get_messages_response(basic_Error & e, std::string const& server_response) const
+{
+  if (e) { return std::vector<Message>(); }
+
+  std::vector<Message> messages;
+
+  bool ok = read_messages(e, server_response, limits_, [&](std::string & content, int created) {
+    messages.emplace_back(std::move(content), created);
+  });
+
+  if (!ok) { return std::vector<Message>(); }
+
+  return messages;
+}
+
+bool
+ResponseParser_simdjson::has_template_feature(basic_Error & err, std::string const& features_json, std::string const& feature) const
+{
+  if (err) { return false; }
+
+  using namespace errors;
+  api::main api;
+
+  Budget budget(limits_);
+  ondemand::document doc;
+  ondemand::array array;
+  if (!iterate(features_json, budget, doc) || doc.get_array().get(array)) { err.set(api, Subsystem::Json, budget.reason); return false; }
+
+  // Each element of the array is either the name of a feature, or an array
+  // where the first element is the name of a feature and the second element
+  // is an array with its subfeatures. For each part of the feature name the
+  // parser descends into the array with the subfeatures, if any.
+  using string_const_iterator = std::string::const_iterator;
+
+  string_const_iterator p = feature.cbegin();
+  string_const_iterator const e = feature.cend();
+  bool in_array = true;
+  while (p != e && in_array) {
+    string_const_iterator q = std::find(p, e, '.');
+    std::string_view name(feature.data() + (p - feature.cbegin()), q - p);
+
+    bool found = false;
+    ondemand::array subfeatures;
+    for (auto element : array) {
+      if (budget.deadline.check()) { err.set(api, Subsystem::Json, Json::TIME_BUDGET_EXCEEDED); return false; }
+
+      ondemand::value x;
+      if (element.get(x)) { err.set(api, Subsystem::Json); return false; }
+
+      ondemand::json_type t;
+      if (x.type().get(t)) { err.set(api, Subsystem::Json); return false; }
+
+      if (t == ondemand::json_type::string) {
+        std::string_view s;
+        if (x.get_string().get(s)) { err.set(api, Subsystem::Json); return false; }
+
+        if (s == name) {
+          found = true;
+          in_array = false;
+          break;
+        }
+      } else if (t == ondemand::json_type::array) {
+        ondemand::array a;
+        if (x.get_array().get(a)) { err.set(api, Subsystem::Json); return false; }
+
+        // Only the first two elements are used, the rest are skipped by simdjson
+        std::size_t i = 0;
+        bool matches = false;
+        for (auto y : a) {
+          ondemand::value v;
+          if (y.get(v)) { err.set(api, Subsystem::Json); return false; }
+
+          if (i == 0) {
+            std::string_view s;
+            simdjson::error_code error = v.get_string().get(s);
+            if (error && !is_type_error(error)) { err.set(api, Subsystem::Json); return false; }
+
+            matches = !error && s == name;
+          } else if (matches && is_type(v, ondemand::json_type::array)) {
+            found = !v.get_array().get(subfeatures);
+          }
+
+          if (++i == 2 || !matches) { break; }
+        }
+
+        if (found) { break; }
+      }
+    }
+
+    if (!found) { break; }
+
+    if (in_array) { array = subfeatures; }
+
+    if (q != e) { ++q; }
+    p = q;
+  }
+
+  return p == e;
+}
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
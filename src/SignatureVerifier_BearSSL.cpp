@@ -1,3 +1,4 @@
+#include <cstring>
 #include <string>
 
 #include "imports/std/optional"
@@ -27,6 +28,29 @@ namespace cryptolens_io {
 
 namespace v20190401 {
 
+namespace {
+
+void
+sha256_update(void * context, unsigned char const* data, std::size_t len)
+{
+  br_sha256_update((br_sha256_context *)context, data, len);
+}
+
+// br_rsa_i62_pkcs1_vrfy() only checks the padding and writes the digest
+// found in the signature to its last argument, which must then be compared
+// with the digest of the message.
+bool
+verify_digest(br_rsa_public_key const* pk, unsigned char const* sig, std::size_t sig_len, unsigned char const* digest)
+{
+  unsigned char signed_digest[br_sha256_SIZE];
+
+  if (!br_rsa_i62_pkcs1_vrfy(sig, sig_len, BR_HASH_OID_SHA256, br_sha256_SIZE, pk, signed_digest)) { return false; }
+
+  return std::memcmp(signed_digest, digest, br_sha256_SIZE) == 0;
+}
+
+} // namespace
+
 SignatureVerifier_BearSSL::SignatureVerifier_BearSSL(basic_Error & e)
 {
   pk_.n = NULL;
@@ -185,15 +209,56 @@ const
 
   if (pk_.n == NULL || pk_.e == NULL) { e.set(api::main(), 7827, 0, 0); return false; }
 
-  optional<std::vector<unsigned char>> sig = ::cryptolens_io::v20190401::internal::b64_decode(signature_base64);
-  if (!sig) { e.set(api::main(), errors::Subsystem::Base64); return false; }
+  ::cryptolens_io::v20190401::internal::B64DecodeBuffer sig;
+  if (!sig.decode(signature_base64)) { e.set(api::main(), errors::Subsystem::Base64); return false; }
 
   br_sha256_init(&hash_context);
   br_sha256_update(&hash_context, message.data(), message.size());
   br_sha256_out(&hash_context, hash_out);
 
-  int r = br_rsa_i62_pkcs1_vrfy(sig->data(), sig->size(), BR_HASH_OID_SHA256, br_sha256_SIZE, &pk_, hash_out);
-  if (!r) {
+  if (!verify_digest(&pk_, sig.data(), sig.size(), hash_out)) {
+    api::main api;
+    e.set(api, 1234, 2345);
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * This function is used internally by the library and need not be called.
+ *
+ * Decodes message_base64 into message and verifies its signature. Each part
+ * of the message is hashed as soon as it has been decoded, such that the
+ * decoded message is only kept in memory once.
+ */
+bool
+SignatureVerifier_BearSSL::verify_message_base64
+  ( basic_Error & e
+  , std::string const& message_base64
+  , std::string const& signature_base64
+  , std::string & message
+  )
+const
+{
+  unsigned char hash_out[br_sha256_SIZE];
+  br_sha256_context hash_context;
+
+  if (e) { return false; }
+
+  if (pk_.n == NULL || pk_.e == NULL) { e.set(api::main(), 7827, 0, 0); return false; }
+
+  ::cryptolens_io::v20190401::internal::B64DecodeBuffer sig;
+  if (!sig.decode(signature_base64)) { e.set(api::main(), errors::Subsystem::Base64); return false; }
+
+  br_sha256_init(&hash_context);
+  if (!::cryptolens_io::v20190401::internal::b64_decode(message_base64, message, sha256_update, &hash_context)) {
+    e.set(api::main(), errors::Subsystem::Base64);
+    return false;
+  }
+  br_sha256_out(&hash_context, hash_out);
+
+  if (!verify_digest(&pk_, sig.data(), sig.size(), hash_out)) {
     api::main api;
     e.set(api, 1234, 2345);
     return false;
@@ -1,4 +1,5 @@
 #include <string>
+#include <vector>
 
 #include "imports/std/optional"
 
@@ -23,6 +24,7 @@ constexpr int DIGEST_VERIFY_FINAL_FAILED = 7;
 constexpr int BN_BIN2BN_FAILED = 8;
 constexpr int BN_NEW_FAILED = 9;
 constexpr int RSA_SET0_KEY_FAILED = 10;
+constexpr int CTX_COPY_FAILED = 12;
 
 } // namespace
 
@@ -30,66 +32,226 @@ namespace cryptolens_io {
 
 namespace v20190401 {
 
+namespace {
+
+EVP_MD_CTX *
+md_ctx_new()
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  return EVP_MD_CTX_create();
+#else
+  return EVP_MD_CTX_new();
+#endif
+}
+
+void
+md_ctx_free(EVP_MD_CTX * ctx)
+{
+  if (ctx == NULL) { return; }
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  EVP_MD_CTX_destroy(ctx);
+#else
+  EVP_MD_CTX_free(ctx);
+#endif
+}
+
+// Each thread keeps one context around which is overwritten by a copy of the
+// prepared context of the signature verifier for every signature, such that
+// verifying a signature does not allocate a new context.
+struct ThreadLocalContext {
+  ThreadLocalContext() : ctx(md_ctx_new()) {}
+  ThreadLocalContext(ThreadLocalContext const&) = delete;
+  void operator=(ThreadLocalContext const&) = delete;
+  ~ThreadLocalContext() { md_ctx_free(ctx); }
+
+  EVP_MD_CTX * ctx;
+};
+
+// Returns the context of this thread, set up for verifying a signature
+EVP_MD_CTX *
+begin_verify(basic_Error & e, EVP_MD_CTX const* verify_ctx)
+{
+  using namespace errors;
+  api::main api;
+
+  if (e) { return NULL; }
+
+  int r;
+  static thread_local ThreadLocalContext scratch;
+  EVP_MD_CTX * ctx = scratch.ctx;
+
+  if (verify_ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, RSA_NULL); return NULL; }
+  if (ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, CTX_CREATE_FAILED); return NULL; }
+
+  // verify_ctx has already been through EVP_DigestVerifyInit() with the
+  // EVP_PKEY built when the public key was set. It is only read from here,
+  // which makes it safe to share between threads.
+  r = EVP_MD_CTX_copy_ex(ctx, verify_ctx);
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, CTX_COPY_FAILED); return NULL; }
+
+  return ctx;
+}
+
+void
+finish_verify(basic_Error & e, EVP_MD_CTX * ctx, unsigned char const* sig, std::size_t sig_len)
+{
+  using namespace errors;
+  api::main api;
+
+  if (e) { return; }
+
+  int r = EVP_DigestVerifyFinal(ctx, (unsigned char*)sig, sig_len);
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_FINAL_FAILED); return; }
+}
+
 void
-verify(basic_Error & e, RSA * rsa, std::vector<unsigned char> const& message, std::vector<unsigned char> const& sig)
+verify(basic_Error & e, EVP_MD_CTX const* verify_ctx, std::vector<unsigned char> const& message, unsigned char const* sig, std::size_t sig_len)
 {
   using namespace errors;
   api::main api;
 
+  EVP_MD_CTX * ctx = begin_verify(e, verify_ctx);
   if (e) { return; }
 
+  int r = EVP_DigestVerifyUpdate(ctx, (unsigned char*)message.data(), message.size());
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_UPDATE_FAILED); return; }
+
+  finish_verify(e, ctx, sig, sig_len);
+}
+
+struct DigestUpdate {
+  EVP_MD_CTX * ctx;
+  bool failed;
+};
+
+void
+digest_update(void * context, unsigned char const* data, std::size_t len)
+{
+  DigestUpdate * update = (DigestUpdate *)context;
+
+  if (!update->failed && EVP_DigestVerifyUpdate(update->ctx, data, len) != 1) { update->failed = true; }
+}
+
+// Like verify(), except that the message is decoded from base64 into message,
+// and each part is passed to EVP_DigestVerifyUpdate() as soon as it has been
+// decoded
+void
+verify_base64(basic_Error & e, EVP_MD_CTX const* verify_ctx, std::string const& message_base64, std::string & message, unsigned char const* sig, std::size_t sig_len)
+{
+  using namespace errors;
+  api::main api;
+
+  EVP_MD_CTX * ctx = begin_verify(e, verify_ctx);
+  if (e) { return; }
+
+  DigestUpdate update = { ctx, false };
+  if (!::cryptolens_io::v20190401::internal::b64_decode(message_base64, message, digest_update, &update)) {
+    e.set(api, Subsystem::Base64);
+    return;
+  }
+  if (update.failed) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_UPDATE_FAILED); return; }
+
+  finish_verify(e, ctx, sig, sig_len);
+}
+
+// Both the modulus and the exponent have been set
+bool
+has_public_key(RSA const* rsa)
+{
+  BIGNUM const* n;
+  BIGNUM const* exp;
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  n = rsa->n;
+  exp = rsa->e;
+#else
+  // void return type
+  RSA_get0_key(rsa, &n, &exp, NULL);
+#endif
+
+  return n != NULL && exp != NULL && !BN_is_zero(n) && !BN_is_zero(exp);
+}
+
+/*
+ * Creates a new RSA object with the public key from rsa, with the Montgomery
+ * context for the modulus already computed, and wraps it in an EVP_PKEY.
+ *
+ * A new RSA object is used each time the key changes since the Montgomery
+ * context is cached in the RSA object and not recomputed if the modulus of
+ * the object is changed.
+ */
+EVP_PKEY *
+create_pkey(basic_Error & e, RSA const* rsa)
+{
+  using namespace errors;
+  api::main api;
+
   int r;
-  EVP_MD_CTX * ctx = NULL;
   EVP_PKEY * pkey = NULL;
 
-  if (rsa == NULL) { e.set(api, Subsystem::SignatureVerifier, RSA_NULL); goto end; }
+  RSA * key = RSAPublicKey_dup((RSA *)rsa);
+  if (key == NULL) { e.set(api, Subsystem::SignatureVerifier, RSA_NULL); return NULL; }
 
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
-  ctx = EVP_MD_CTX_create();
+  key->flags |= RSA_FLAG_CACHE_PUBLIC;
 #else
-  ctx = EVP_MD_CTX_new();
+  RSA_set_flags(key, RSA_FLAG_CACHE_PUBLIC);
 #endif
-  if (ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, CTX_CREATE_FAILED); goto end; }
+
+  // OpenSSL computes the Montgomery context the first time the public key is
+  // used. Doing so here with a dummy operation means the first signature does
+  // not pay for it, and that threads verifying signatures never contend for
+  // the lock protecting the cached context.
+  {
+    std::vector<unsigned char> zero(RSA_size(key)), out(RSA_size(key));
+    // Return value ignored, the result is not used
+    RSA_public_decrypt((int)zero.size(), zero.data(), out.data(), key, RSA_NO_PADDING);
+  }
 
   pkey = EVP_PKEY_new();
   if (pkey == NULL) { e.set(api, Subsystem::SignatureVerifier, PKEY_NEW_FAILED); goto end; }
 
-  r = EVP_PKEY_set1_RSA(pkey, rsa);
-  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, PKEY_SET1_RSA_FAILED); goto end; }
+  r = EVP_PKEY_set1_RSA(pkey, key);
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, PKEY_SET1_RSA_FAILED); EVP_PKEY_free(pkey); pkey = NULL; goto end; }
 
+end:
+  // Void return type. pkey holds its own reference to key
+  RSA_free(key);
 
+  return pkey;
+}
 
-  r = EVP_DigestVerifyInit(ctx, NULL, EVP_sha256(), NULL, pkey);
-  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_INIT_FAILED); goto end; }
+EVP_MD_CTX *
+create_verify_ctx(basic_Error & e, EVP_PKEY * pkey)
+{
+  using namespace errors;
+  api::main api;
 
-  r = EVP_DigestVerifyUpdate(ctx, (unsigned char*)message.data(), message.size());
-  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_UPDATE_FAILED); goto end; }
+  int r;
 
-  r = EVP_DigestVerifyFinal(ctx, (unsigned char*)sig.data(), sig.size());
-  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_FINAL_FAILED); goto end; }
+  EVP_MD_CTX * ctx = md_ctx_new();
+  if (ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, CTX_CREATE_FAILED); return NULL; }
 
-end:
-  // Void return type
-  EVP_PKEY_free(pkey);
+  r = EVP_DigestVerifyInit(ctx, NULL, EVP_sha256(), NULL, pkey);
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_INIT_FAILED); md_ctx_free(ctx); return NULL; }
 
-  // Void return type
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-  EVP_MD_CTX_destroy(ctx);
-#else
-  EVP_MD_CTX_free(ctx);
-#endif
+  return ctx;
 }
 
+} // namespace
+
 SignatureVerifier_OpenSSL::SignatureVerifier_OpenSSL(basic_Error & e)
+: rsa(NULL), pkey_(NULL), verify_ctx_(NULL)
 {
   this->rsa = RSA_new();
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
   if (this->rsa != NULL) {
     this->rsa->n = BN_new();
-    if (this->rsa->n == NULL) { RSA_free(this->rsa); return; }
+    if (this->rsa->n == NULL) { RSA_free(this->rsa); this->rsa = NULL; return; }
 
     this->rsa->e = BN_new();
-    if (this->rsa->e == NULL) { RSA_free(this->rsa); return; }
+    if (this->rsa->e == NULL) { RSA_free(this->rsa); this->rsa = NULL; return; }
   }
 #else
   if (this->rsa != NULL) {
@@ -114,6 +276,9 @@ SignatureVerifier_OpenSSL::SignatureVerifier_OpenSSL(basic_Error & e)
 
 SignatureVerifier_OpenSSL::~SignatureVerifier_OpenSSL()
 {
+  md_ctx_free(this->verify_ctx_);
+  EVP_PKEY_free(this->pkey_);
+
   if (this->rsa != NULL) {
     RSA_free(this->rsa);
   }
@@ -136,6 +301,7 @@ SignatureVerifier_OpenSSL::set_modulus_base64(basic_Error & e, std::string const
 {
   if (e) { return; }
   this->set_modulus_base64_(e, modulus_base64);
+  this->prepare_(e);
   if (e) { e.set_call(api::main(), errors::Call::SIGNATURE_VERIFIER_SET_MODULUS_BASE64); }
 }
 
@@ -156,6 +322,7 @@ SignatureVerifier_OpenSSL::set_exponent_base64(basic_Error & e, std::string cons
 {
   if (e) { return; }
   this->set_exponent_base64_(e, exponent_base64);
+  this->prepare_(e);
   if (e) { e.set_call(api::main(), errors::Call::SIGNATURE_VERIFIER_SET_EXPONENT_BASE64); }
 }
 
@@ -233,6 +400,30 @@ SignatureVerifier_OpenSSL::set_exponent_base64_(basic_Error & e, std::string con
 #endif
 }
 
+/*
+ * Builds the EVP_PKEY and the verification context once both the modulus
+ * and the exponent have been set, such that verify_message() need not do so
+ * for every signature.
+ */
+void
+SignatureVerifier_OpenSSL::prepare_(basic_Error & e)
+{
+  if (e) { return; }
+  if (this->rsa == NULL || !has_public_key(this->rsa)) { return; }
+
+  EVP_PKEY * pkey = create_pkey(e, this->rsa);
+  if (pkey == NULL) { return; }
+
+  EVP_MD_CTX * verify_ctx = create_verify_ctx(e, pkey);
+  if (verify_ctx == NULL) { EVP_PKEY_free(pkey); return; }
+
+  md_ctx_free(this->verify_ctx_);
+  EVP_PKEY_free(this->pkey_);
+
+  this->pkey_ = pkey;
+  this->verify_ctx_ = verify_ctx;
+}
+
 /*
  * TODO Add documentation and fix set_call() at the end
  */
@@ -287,10 +478,38 @@ const
   if (e) { return false; }
   if (this->rsa == NULL) { e.set(api::main(), errors::Subsystem::SignatureVerifier, RSA_NULL); return false; }
 
-  optional<std::vector<unsigned char>> sig = ::cryptolens_io::v20190401::internal::b64_decode(signature_base64);
-  if (!sig) { e.set(api::main(), errors::Subsystem::Base64); return false; }
+  ::cryptolens_io::v20190401::internal::B64DecodeBuffer sig;
+  if (!sig.decode(signature_base64)) { e.set(api::main(), errors::Subsystem::Base64); return false; }
+
+  verify(e, this->verify_ctx_, message, sig.data(), sig.size());
+  if (e) { return false; }
+
+  return true;
+}
+
+/**
+ * This function is used internally by the library and need not be called.
+ *
+ * Decodes message_base64 into message and verifies its signature. Each part
+ * of the message is hashed as soon as it has been decoded, such that the
+ * decoded message is only kept in memory once.
+ */
+bool
+SignatureVerifier_OpenSSL::verify_message_base64
+  ( basic_Error & e
+  , std::string const& message_base64
+  , std::string const& signature_base64
+  , std::string & message
+  )
+const
+{
+  if (e) { return false; }
+  if (this->rsa == NULL) { e.set(api::main(), errors::Subsystem::SignatureVerifier, RSA_NULL); return false; }
+
+  ::cryptolens_io::v20190401::internal::B64DecodeBuffer sig;
+  if (!sig.decode(signature_base64)) { e.set(api::main(), errors::Subsystem::Base64); return false; }
 
-  verify(e, this->rsa, message, *sig);
+  verify_base64(e, this->verify_ctx_, message_base64, message, sig.data(), sig.size());
   if (e) { return false; }
 
   return true;
@@ -4,6 +4,7 @@
 #include "imports/std/optional"
 
 #include "imports/openssl/bn.h"
+#include "imports/openssl/err.h"
 #include "imports/openssl/evp.h"
 #include "imports/openssl/rsa.h"
 
@@ -24,6 +25,8 @@ constexpr int DIGEST_VERIFY_FINAL_FAILED = 7;
 constexpr int BN_BIN2BN_FAILED = 8;
 constexpr int BN_NEW_FAILED = 9;
 constexpr int RSA_SET0_KEY_FAILED = 10;
+constexpr int MD_FETCH_FAILED = 11;
+constexpr int CTX_COPY_FAILED = 12;
 
 } // namespace
 
@@ -33,34 +36,130 @@ namespace v20190401 {
 
 namespace {
 
+// Each thread keeps one context around which is overwritten by a copy of the
+// prepared context of the signature verifier for every signature, such that
+// verifying a signature does not allocate a new context.
+struct ThreadLocalContext {
+  ThreadLocalContext() : ctx(EVP_MD_CTX_new()) {}
+  ThreadLocalContext(ThreadLocalContext const&) = delete;
+  void operator=(ThreadLocalContext const&) = delete;
+  ~ThreadLocalContext() { EVP_MD_CTX_free(ctx); }
+
+  EVP_MD_CTX * ctx;
+};
+
+// Returns the context of this thread, set up for verifying a signature
+EVP_MD_CTX *
+begin_verify(basic_Error & e, EVP_MD_CTX const* verify_ctx)
+{
+  using namespace errors;
+  api::main api;
+
+  if (e) { return NULL; }
+
+  int r;
+  static thread_local ThreadLocalContext scratch;
+  EVP_MD_CTX * ctx = scratch.ctx;
+
+  if (verify_ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, RSA_NULL); return NULL; }
+  if (ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, CTX_CREATE_FAILED); return NULL; }
+
+  // verify_ctx has already been through EVP_DigestVerifyInit(), thus copying it is
+  // much cheaper than initializing a new context since the algorithms need not be
+  // fetched from the provider again. verify_ctx is only read from here, which makes
+  // it safe to share between threads.
+  r = EVP_MD_CTX_copy_ex(ctx, verify_ctx);
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, CTX_COPY_FAILED); return NULL; }
+
+  return ctx;
+}
+
 void
-verify(basic_Error & e, EVP_PKEY * pkey, std::vector<unsigned char> const& message, std::vector<unsigned char> const& sig)
+finish_verify(basic_Error & e, EVP_MD_CTX * ctx, unsigned char const* sig, std::size_t sig_len)
 {
   using namespace errors;
   api::main api;
 
   if (e) { return; }
 
+  int r = EVP_DigestVerifyFinal(ctx, sig, sig_len);
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_FINAL_FAILED); return; }
+}
+
+void
+verify(basic_Error & e, EVP_MD_CTX const* verify_ctx, std::vector<unsigned char> const& message, unsigned char const* sig, std::size_t sig_len)
+{
+  using namespace errors;
+  api::main api;
+
+  EVP_MD_CTX * ctx = begin_verify(e, verify_ctx);
+  if (e) { return; }
+
+  int r = EVP_DigestVerifyUpdate(ctx, message.data(), message.size());
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_UPDATE_FAILED); return; }
+
+  finish_verify(e, ctx, sig, sig_len);
+}
+
+struct DigestUpdate {
+  EVP_MD_CTX * ctx;
+  bool failed;
+};
+
+void
+digest_update(void * context, unsigned char const* data, std::size_t len)
+{
+  DigestUpdate * update = (DigestUpdate *)context;
+
+  if (!update->failed && EVP_DigestVerifyUpdate(update->ctx, data, len) != 1) { update->failed = true; }
+}
+
+// Like verify(), except that the message is decoded from base64 into message,
+// and each part is passed to EVP_DigestVerifyUpdate() as soon as it has been
+// decoded
+void
+verify_base64(basic_Error & e, EVP_MD_CTX const* verify_ctx, std::string const& message_base64, std::string & message, unsigned char const* sig, std::size_t sig_len)
+{
+  using namespace errors;
+  api::main api;
+
+  EVP_MD_CTX * ctx = begin_verify(e, verify_ctx);
+  if (e) { return; }
+
+  DigestUpdate update = { ctx, false };
+  if (!::cryptolens_io::v20190401::internal::b64_decode(message_base64, message, digest_update, &update)) {
+    e.set(api, Subsystem::Base64);
+    return;
+  }
+  if (update.failed) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_UPDATE_FAILED); return; }
+
+  finish_verify(e, ctx, sig, sig_len);
+}
+
+EVP_MD_CTX *
+create_verify_ctx(basic_Error & e, EVP_MD const* md, EVP_PKEY * pkey)
+{
+  using namespace errors;
+  api::main api;
+
   int r;
   EVP_MD_CTX * ctx = NULL;
 
-  if (pkey == NULL) { e.set(api, Subsystem::SignatureVerifier, RSA_NULL); goto end; }
+  if (md == NULL) { e.set(api, Subsystem::SignatureVerifier, MD_FETCH_FAILED); goto error; }
 
   ctx = EVP_MD_CTX_new();
-  if (ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, CTX_CREATE_FAILED); goto end; }
-
-  r = EVP_DigestVerifyInit(ctx, NULL, EVP_sha256(), NULL, pkey);
-  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_INIT_FAILED); goto end; }
+  if (ctx == NULL) { e.set(api, Subsystem::SignatureVerifier, CTX_CREATE_FAILED); goto error; }
 
-  r = EVP_DigestVerifyUpdate(ctx, message.data(), message.size());
-  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_UPDATE_FAILED); goto end; }
+  r = EVP_DigestVerifyInit(ctx, NULL, md, NULL, pkey);
+  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_INIT_FAILED); goto error; }
 
-  r = EVP_DigestVerifyFinal(ctx, sig.data(), sig.size());
-  if (r != 1) { e.set(api, Subsystem::SignatureVerifier, DIGEST_VERIFY_FINAL_FAILED); goto end; }
+  return ctx;
 
-end:
+error:
   // Void return type
   EVP_MD_CTX_free(ctx);
+
+  return NULL;
 }
 
 EVP_PKEY *
@@ -128,11 +227,17 @@ end:
 } // namespace
 
 SignatureVerifier_OpenSSL3::SignatureVerifier_OpenSSL3(basic_Error & e)
-: pkey_(NULL)
-{ }
+: pkey_(NULL), md_(NULL), verify_ctx_(NULL)
+{
+  // Fetching the digest once here avoids the implicit fetch done by EVP_sha256().
+  // If this fails, it is reported when the public key is set.
+  this->md_ = EVP_MD_fetch(NULL, "SHA256", NULL);
+}
 
 SignatureVerifier_OpenSSL3::~SignatureVerifier_OpenSSL3()
 {
+  EVP_MD_CTX_free(this->verify_ctx_);
+  EVP_MD_free(this->md_);
   EVP_PKEY_free(this->pkey_);
 }
 
@@ -190,7 +295,27 @@ SignatureVerifier_OpenSSL3::set_public_key_base64_(basic_Error & e, std::string
   EVP_PKEY * pkey = create_pkey(e, *modulus, *exponent);
   if (pkey == NULL) { return; }
 
-  pkey_ = pkey;
+  EVP_MD_CTX * verify_ctx = create_verify_ctx(e, this->md_, pkey);
+  if (verify_ctx == NULL) { EVP_PKEY_free(pkey); return; }
+
+  // OpenSSL computes the Montgomery context the first time the public key is
+  // used, and the key is shared by all copies of verify_ctx. Verifying a
+  // dummy signature here means the first real signature does not pay for it.
+  // The verification always fails, and the errors it queues are removed such
+  // that the application does not find them in the OpenSSL error queue.
+  {
+    basic_Error ignored;
+    std::vector<unsigned char> message, zero(EVP_PKEY_get_size(pkey));
+    ERR_set_mark();
+    verify(ignored, verify_ctx, message, zero.data(), zero.size());
+    ERR_pop_to_mark();
+  }
+
+  EVP_MD_CTX_free(this->verify_ctx_);
+  EVP_PKEY_free(this->pkey_);
+
+  this->pkey_ = pkey;
+  this->verify_ctx_ = verify_ctx;
 }
 
 /**
@@ -243,12 +368,40 @@ SignatureVerifier_OpenSSL3::verify_message
 const
 {
   if (e) { return false; }
-  if (this->pkey_ == NULL) { e.set(api::main(), errors::Subsystem::SignatureVerifier, RSA_NULL); return false; }
+  if (this->verify_ctx_ == NULL) { e.set(api::main(), errors::Subsystem::SignatureVerifier, RSA_NULL); return false; }
+
+  ::cryptolens_io::v20190401::internal::B64DecodeBuffer sig;
+  if (!sig.decode(signature_base64)) { e.set(api::main(), errors::Subsystem::Base64); return false; }
+
+  verify(e, this->verify_ctx_, message, sig.data(), sig.size());
+  if (e) { return false; }
+
+  return true;
+}
+
+/**
+ * This function is used internally by the library and need not be called.
+ *
+ * Decodes message_base64 into message and verifies its signature. Each part
+ * of the message is hashed as soon as it has been decoded, such that the
+ * decoded message is only kept in memory once.
+ */
+bool
+SignatureVerifier_OpenSSL3::verify_message_base64
+  ( basic_Error & e
+  , std::string const& message_base64
+  , std::string const& signature_base64
+  , std::string & message
+  )
+const
+{
+  if (e) { return false; }
+  if (this->verify_ctx_ == NULL) { e.set(api::main(), errors::Subsystem::SignatureVerifier, RSA_NULL); return false; }
 
-  optional<std::vector<unsigned char>> sig = ::cryptolens_io::v20190401::internal::b64_decode(signature_base64);
-  if (!sig) { e.set(api::main(), errors::Subsystem::Base64); return false; }
+  ::cryptolens_io::v20190401::internal::B64DecodeBuffer sig;
+  if (!sig.decode(signature_base64)) { e.set(api::main(), errors::Subsystem::Base64); return false; }
 
-  verify(e, this->pkey_, message, *sig);
+  verify_base64(e, this->verify_ctx_, message_base64, message, sig.data(), sig.size());
   if (e) { return false; }
 
   return true;
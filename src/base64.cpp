@@ -0,0 +1,435 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "base64.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CRYPTOLENS_B64_X86
+#define CRYPTOLENS_B64_TARGET(x) __attribute__((target(x)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define CRYPTOLENS_B64_X86
+#define CRYPTOLENS_B64_TARGET(x)
+#include <immintrin.h>
+#include <intrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define CRYPTOLENS_B64_NEON
+#include <arm_neon.h>
+#endif
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace internal {
+
+namespace {
+
+unsigned char const B64_WS = 64;
+unsigned char const B64_PAD = 65;
+unsigned char const B64_INVALID = 255;
+
+// Maps each character to its value in the base64 alphabet, or to one of the
+// markers above. The whitespace characters are the same as for isspace() in
+// the "C" locale, which is what b64_pton() skips. The table is constant data,
+// rather than filled in at startup, such that it can be used by constructors
+// of global objects in other translation units.
+#define WS B64_WS
+#define PD B64_PAD
+#define XX B64_INVALID
+unsigned char const DECODE_TABLE[256] = {
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, WS, WS, WS, WS, WS, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  WS, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, 62, XX, XX, XX, 63,
+  52, 53, 54, 55, 56, 57, 58, 59, 60, 61, XX, XX, XX, PD, XX, XX,
+  XX,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+  15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, XX, XX, XX, XX, XX,
+  XX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+  41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX
+};
+#undef WS
+#undef PD
+#undef XX
+
+// The vectorized decoders below translate a whole block of characters at a
+// time and stop at the first block containing anything but characters from
+// the base64 alphabet, e.g. whitespace or padding, which is then left to the
+// scalar decoder. They return the number of characters consumed, which is
+// always a multiple of four, and write three bytes for every four characters.
+//
+// The translation follows the approach described by Wojciech Muła and Daniel
+// Lemire in "Faster Base64 Encoding and Decoding Using AVX2 Instructions":
+// the lower and upper nibble of each character are looked up in two tables
+// whose bitwise and is non-zero exactly for characters outside the alphabet,
+// and the upper nibble then selects the offset that turns the character into
+// its 6-bit value.
+
+typedef std::size_t (*DecodeBlocks)(unsigned char const* src, std::size_t len, unsigned char * target, std::size_t targsize);
+
+std::size_t
+decode_blocks_none(unsigned char const* src, std::size_t len, unsigned char * target, std::size_t targsize)
+{
+  return 0;
+}
+
+#ifdef CRYPTOLENS_B64_X86
+
+CRYPTOLENS_B64_TARGET("ssse3")
+std::size_t
+decode_blocks_ssse3(unsigned char const* src, std::size_t len, unsigned char * target, std::size_t targsize)
+{
+  __m128i const lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  __m128i const lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  __m128i const lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  __m128i const mask_0f = _mm_set1_epi8(0x0f);
+  __m128i const slash = _mm_set1_epi8(0x2f);
+  __m128i const pack_ab_bc = _mm_set1_epi32(0x01400140);
+  __m128i const pack_abcd = _mm_set1_epi32(0x00011000);
+  __m128i const order = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+  std::size_t i = 0, o = 0;
+
+  // Each block writes 16 bytes of which the first 12 are output
+  for (; i + 16 <= len && o + 16 <= targsize; i += 16, o += 12) {
+    __m128i in = _mm_loadu_si128((__m128i const*)(src + i));
+
+    __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_0f);
+    __m128i lo_nibbles = _mm_and_si128(in, mask_0f);
+    __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) { break; }
+
+    __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(in, slash), hi_nibbles));
+    __m128i values = _mm_add_epi8(in, roll);
+
+    __m128i merged = _mm_maddubs_epi16(values, pack_ab_bc);
+    __m128i packed = _mm_madd_epi16(merged, pack_abcd);
+    _mm_storeu_si128((__m128i *)(target + o), _mm_shuffle_epi8(packed, order));
+  }
+
+  return i;
+}
+
+CRYPTOLENS_B64_TARGET("avx2")
+std::size_t
+decode_blocks_avx2(unsigned char const* src, std::size_t len, unsigned char * target, std::size_t targsize)
+{
+  __m256i const lut_lo = _mm256_setr_epi8
+    ( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+    , 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+    );
+  __m256i const lut_hi = _mm256_setr_epi8
+    ( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    , 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    );
+  __m256i const lut_roll = _mm256_setr_epi8
+    ( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+    , 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+    );
+  __m256i const mask_0f = _mm256_set1_epi8(0x0f);
+  __m256i const slash = _mm256_set1_epi8(0x2f);
+  __m256i const pack_ab_bc = _mm256_set1_epi32(0x01400140);
+  __m256i const pack_abcd = _mm256_set1_epi32(0x00011000);
+  __m256i const order = _mm256_setr_epi8
+    ( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+    , 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+    );
+  __m256i const lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+  std::size_t i = 0, o = 0;
+
+  // Each block writes 32 bytes of which the first 24 are output
+  for (; i + 32 <= len && o + 32 <= targsize; i += 32, o += 24) {
+    __m256i in = _mm256_loadu_si256((__m256i const*)(src + i));
+
+    __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_0f);
+    __m256i lo_nibbles = _mm256_and_si256(in, mask_0f);
+    __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    if (!_mm256_testz_si256(lo, hi)) { break; }
+
+    __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(in, slash), hi_nibbles));
+    __m256i values = _mm256_add_epi8(in, roll);
+
+    __m256i merged = _mm256_maddubs_epi16(values, pack_ab_bc);
+    __m256i packed = _mm256_madd_epi16(merged, pack_abcd);
+    packed = _mm256_shuffle_epi8(packed, order);
+    _mm256_storeu_si256((__m256i *)(target + o), _mm256_permutevar8x32_epi32(packed, lanes));
+  }
+
+  // Finish off with 16 byte blocks rather than leaving up to 31 characters to the scalar decoder
+  return i + decode_blocks_ssse3(src + i, len - i, target + o, targsize - o);
+}
+
+#endif /* CRYPTOLENS_B64_X86 */
+
+#ifdef CRYPTOLENS_B64_NEON
+
+inline uint8x16_t
+translate_neon(uint8x16_t in, uint8x16_t & invalid)
+{
+  static uint8_t const lut_lo[16] = { 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A };
+  static uint8_t const lut_hi[16] = { 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 };
+  static uint8_t const lut_roll[16] = { 0, 16, 19, 4, 191, 191, 185, 185, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+  uint8x16_t hi_nibbles = vshrq_n_u8(in, 4);
+  uint8x16_t lo_nibbles = vandq_u8(in, vdupq_n_u8(0x0f));
+  uint8x16_t lo = vqtbl1q_u8(vld1q_u8(lut_lo), lo_nibbles);
+  uint8x16_t hi = vqtbl1q_u8(vld1q_u8(lut_hi), hi_nibbles);
+  invalid = vorrq_u8(invalid, vandq_u8(lo, hi));
+
+  uint8x16_t roll = vqtbl1q_u8(vld1q_u8(lut_roll), vaddq_u8(vceqq_u8(in, vdupq_n_u8(0x2f)), hi_nibbles));
+  return vaddq_u8(in, roll);
+}
+
+std::size_t
+decode_blocks_neon(unsigned char const* src, std::size_t len, unsigned char * target, std::size_t targsize)
+{
+  std::size_t i = 0, o = 0;
+
+  // vld4q_u8 splits 64 characters into the first, second, third and fourth
+  // character of each group of four, and vst3q_u8 interleaves the three
+  // resulting bytes back again, writing exactly 48 bytes.
+  for (; i + 64 <= len && o + 48 <= targsize; i += 64, o += 48) {
+    uint8x16x4_t in = vld4q_u8(src + i);
+
+    uint8x16_t invalid = vdupq_n_u8(0);
+    uint8x16_t a = translate_neon(in.val[0], invalid);
+    uint8x16_t b = translate_neon(in.val[1], invalid);
+    uint8x16_t c = translate_neon(in.val[2], invalid);
+    uint8x16_t d = translate_neon(in.val[3], invalid);
+    if (vmaxvq_u8(invalid) != 0) { break; }
+
+    uint8x16x3_t out;
+    out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+    out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+    vst3q_u8(target + o, out);
+  }
+
+  return i;
+}
+
+#endif /* CRYPTOLENS_B64_NEON */
+
+DecodeBlocks
+select_decode_blocks()
+{
+#if defined(CRYPTOLENS_B64_X86) && defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+
+  __cpuid(info, 0);
+  int max_leaf = info[0];
+
+  __cpuid(info, 1);
+  bool ssse3 = (info[2] & (1 << 9)) != 0;
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx2 = false;
+
+  if (max_leaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+
+  if (avx2) { return decode_blocks_avx2; }
+  if (ssse3) { return decode_blocks_ssse3; }
+#elif defined(CRYPTOLENS_B64_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) { return decode_blocks_avx2; }
+  if (__builtin_cpu_supports("ssse3")) { return decode_blocks_ssse3; }
+#elif defined(CRYPTOLENS_B64_NEON)
+  return decode_blocks_neon;
+#endif
+
+  return decode_blocks_none;
+}
+
+} // namespace
+
+int
+b64_decode_into(char const* src, std::size_t srclen, unsigned char * target, std::size_t targsize)
+{
+  return b64_decode_into(src, srclen, target, targsize, nullptr, nullptr);
+}
+
+int
+b64_decode_into(char const* src, std::size_t srclen, unsigned char * target, std::size_t targsize, B64DecodeCallback callback, void * context)
+{
+  static DecodeBlocks const decode_blocks = select_decode_blocks();
+
+  // This is the same state machine as in b64_pton(), see the comments there,
+  // except that runs of characters from the alphabet are handed to the
+  // vectorized decoder whenever a group of four characters is complete.
+  //
+  // Bytes before tarindex never change once a group is complete, and are
+  // passed to the callback at that point. The vectorized decoder is given at
+  // most one chunk worth of characters at a time so that the parts stay
+  // small.
+
+  unsigned char const* s = (unsigned char const*)src;
+  std::size_t i = 0;
+  std::size_t tarindex = 0;
+  int state = 0;
+  unsigned char ch = 0;
+  unsigned char v;
+  unsigned char nextbyte;
+  std::size_t passed = 0;
+  std::size_t const chunk_chars = B64_CHUNK_SIZE / 3 * 4;
+
+  for (;;) {
+    if (state == 0) {
+      if (callback != nullptr && tarindex - passed >= B64_CHUNK_SIZE) {
+        callback(context, target + passed, B64_CHUNK_SIZE);
+        passed += B64_CHUNK_SIZE;
+      }
+
+      std::size_t len = srclen - i;
+      if (callback != nullptr && len > chunk_chars) { len = chunk_chars; }
+
+      std::size_t n = decode_blocks(s + i, len, target + tarindex, targsize - tarindex);
+      i += n;
+      tarindex += n / 4 * 3;
+    }
+
+    // b64_pton() works on NUL terminated strings, thus stop at a NUL as well
+    if (i == srclen || s[i] == '\0') { ch = '\0'; break; }
+
+    ch = s[i++];
+    v = DECODE_TABLE[ch];
+
+    if (v == B64_WS) { continue; }
+    if (v == B64_PAD) { break; }
+    if (v == B64_INVALID) { return -1; }
+
+    switch (state) {
+    case 0:
+      if (tarindex >= targsize) { return -1; }
+      target[tarindex] = (unsigned char)(v << 2);
+      state = 1;
+      break;
+    case 1:
+      if (tarindex >= targsize) { return -1; }
+      target[tarindex] |= v >> 4;
+      nextbyte = (unsigned char)((v & 0x0f) << 4);
+      if (tarindex + 1 < targsize) { target[tarindex+1] = nextbyte; }
+      else if (nextbyte) { return -1; }
+      tarindex++;
+      state = 2;
+      break;
+    case 2:
+      if (tarindex >= targsize) { return -1; }
+      target[tarindex] |= v >> 2;
+      nextbyte = (unsigned char)((v & 0x03) << 6);
+      if (tarindex + 1 < targsize) { target[tarindex+1] = nextbyte; }
+      else if (nextbyte) { return -1; }
+      tarindex++;
+      state = 3;
+      break;
+    case 3:
+      if (tarindex >= targsize) { return -1; }
+      target[tarindex] |= v;
+      tarindex++;
+      state = 0;
+      break;
+    }
+  }
+
+  if (ch == '=') {
+    switch (state) {
+    case 0:
+    case 1:
+      return -1;
+
+    case 2:
+      for (; i < srclen && s[i] != '\0'; ++i) {
+        if (DECODE_TABLE[s[i]] != B64_WS) { break; }
+      }
+      if (i == srclen || s[i] != '=') { return -1; }
+      ++i;
+      /* FALLTHROUGH */
+
+    case 3:
+      for (; i < srclen && s[i] != '\0'; ++i) {
+        if (DECODE_TABLE[s[i]] != B64_WS) { return -1; }
+      }
+
+      if (tarindex < targsize && target[tarindex] != 0) { return -1; }
+    }
+  } else {
+    if (state != 0) { return -1; }
+  }
+
+  if (callback != nullptr) {
+    for (; tarindex - passed > B64_CHUNK_SIZE; passed += B64_CHUNK_SIZE) {
+      callback(context, target + passed, B64_CHUNK_SIZE);
+    }
+    if (tarindex > passed) { callback(context, target + passed, tarindex - passed); }
+  }
+
+  return (int)tarindex;
+}
+
+optional<std::vector<unsigned char>>
+b64_decode(std::string const& b64)
+{
+  std::vector<unsigned char> v(b64_decoded_size_max(b64.size()));
+
+  int len = b64_decode_into(b64.data(), b64.size(), v.data(), v.size());
+  if (len == -1) {
+    return nullopt;
+  }
+
+  v.resize(len);
+
+  return make_optional(std::move(v));
+}
+
+bool
+b64_decode(std::string const& b64, std::string & out, B64DecodeCallback callback, void * context)
+{
+  out.resize(b64_decoded_size_max(b64.size()));
+
+  int len = b64_decode_into(b64.data(), b64.size(), (unsigned char *)&out[0], out.size(), callback, context);
+  if (len == -1) {
+    out.clear();
+    return false;
+  }
+
+  out.resize(len);
+
+  return true;
+}
+
+bool
+B64DecodeBuffer::decode(std::string const& b64)
+{
+  std::size_t max_size = b64_decoded_size_max(b64.size());
+
+  if (max_size <= sizeof(stack_)) {
+    data_ = stack_;
+  } else {
+    heap_.resize(max_size);
+    data_ = heap_.data();
+  }
+
+  int len = b64_decode_into(b64.data(), b64.size(), data_, max_size);
+  if (len == -1) { size_ = 0; return false; }
+
+  size_ = len;
+  return true;
+}
+
+} // namespace internal
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
@@ -0,0 +1,132 @@
+#include <cstring>
+
+#include "sha256.hpp"
+
+namespace cryptolens_io {
+
+namespace v20190401 {
+
+namespace internal {
+
+// Straightforward implementation of SHA-256 as described in FIPS 180-4.
+
+namespace {
+
+std::uint32_t const K[64] =
+  { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5
+  , 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174
+  , 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da
+  , 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967
+  , 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85
+  , 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070
+  , 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3
+  , 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+inline std::uint32_t
+rotr(std::uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+} // namespace
+
+constexpr std::size_t Sha256::DIGEST_SIZE;
+
+Sha256::Sha256()
+: length_(0), buffer_len_(0)
+{
+  state_[0] = 0x6a09e667; state_[1] = 0xbb67ae85; state_[2] = 0x3c6ef372; state_[3] = 0xa54ff53a;
+  state_[4] = 0x510e527f; state_[5] = 0x9b05688c; state_[6] = 0x1f83d9ab; state_[7] = 0x5be0cd19;
+}
+
+void
+Sha256::compress(unsigned char const* block)
+{
+  std::uint32_t w[64];
+
+  for (int i = 0; i < 16; ++i) {
+    w[i] = (std::uint32_t)block[4*i] << 24 | (std::uint32_t)block[4*i+1] << 16
+         | (std::uint32_t)block[4*i+2] << 8 | (std::uint32_t)block[4*i+3];
+  }
+
+  for (int i = 16; i < 64; ++i) {
+    std::uint32_t s0 = rotr(w[i-15], 7) ^ rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+    std::uint32_t s1 = rotr(w[i-2], 17) ^ rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+    w[i] = w[i-16] + s0 + w[i-7] + s1;
+  }
+
+  std::uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+  std::uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+
+  for (int i = 0; i < 64; ++i) {
+    std::uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+    std::uint32_t ch = (e & f) ^ (~e & g);
+    std::uint32_t t1 = h + S1 + ch + K[i] + w[i];
+    std::uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+    std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    std::uint32_t t2 = S0 + maj;
+
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+
+  state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+  state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+}
+
+void
+Sha256::update(void const* data, std::size_t len)
+{
+  unsigned char const* p = (unsigned char const*)data;
+
+  length_ += len;
+
+  if (buffer_len_ > 0) {
+    std::size_t n = 64 - buffer_len_;
+    if (n > len) { n = len; }
+
+    std::memcpy(buffer_ + buffer_len_, p, n);
+    buffer_len_ += n; p += n; len -= n;
+
+    if (buffer_len_ < 64) { return; }
+
+    compress(buffer_);
+    buffer_len_ = 0;
+  }
+
+  for (; len >= 64; p += 64, len -= 64) { compress(p); }
+
+  if (len > 0) {
+    std::memcpy(buffer_, p, len);
+    buffer_len_ = len;
+  }
+}
+
+void
+Sha256::finish(unsigned char * digest)
+{
+  std::uint64_t bits = length_ * 8;
+
+  unsigned char pad[72];
+  std::size_t pad_len = (buffer_len_ < 56 ? 56 : 120) - buffer_len_;
+
+  std::memset(pad, 0, sizeof(pad));
+  pad[0] = 0x80;
+  for (int i = 0; i < 8; ++i) { pad[pad_len + i] = (unsigned char)(bits >> (56 - 8*i)); }
+
+  update(pad, pad_len + 8);
+
+  for (int i = 0; i < 8; ++i) {
+    digest[4*i]   = (unsigned char)(state_[i] >> 24);
+    digest[4*i+1] = (unsigned char)(state_[i] >> 16);
+    digest[4*i+2] = (unsigned char)(state_[i] >> 8);
+    digest[4*i+3] = (unsigned char)(state_[i]);
+  }
+}
+
+} // namespace internal
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
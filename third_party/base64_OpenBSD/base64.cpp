@@ -325,20 +325,6 @@ b64_pton(char const *src, unsigned char *target, size_t targsize)
 	return (tarindex);
 }
 
-optional<std::vector<unsigned char>>
-b64_decode(std::string const& b64)
-{
-  int len = b64_pton(b64.c_str(), NULL, 0);
-  if (len == -1) {
-    return nullopt;
-  }
-
-  std::vector<unsigned char> v(len, '\0');
-  b64_pton(b64.c_str(), v.data(), len);
-
-  return make_optional(std::move(v));
-}
-
 } // namespace internal
 
 } // namespace v20190401
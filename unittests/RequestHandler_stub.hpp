@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <cryptolens/basic_Error.hpp>
+
+namespace cryptolens_unittests {
+
+class RequestHandler_stub;
+
+class RequestHandler_stub_PostBuilder {
+public:
+  RequestHandler_stub_PostBuilder(RequestHandler_stub * handler, char const* host) : handler_(handler), host_(host), arguments_() {}
+
+  RequestHandler_stub_PostBuilder &
+  add_argument(::cryptolens_io::v20190401::basic_Error & e, char const* key, char const* value)
+  {
+    if (e) { return *this; }
+
+    arguments_ += key;
+    arguments_ += '=';
+    arguments_ += value;
+    arguments_ += '&';
+    return *this;
+  }
+
+  std::string
+  make(::cryptolens_io::v20190401::basic_Error & e);
+
+private:
+  RequestHandler_stub * handler_;
+  std::string host_;
+  std::string arguments_;
+};
+
+// A request handler standing in for the Web API in tests that should not
+// depend on curl or a server. Requests are answered in order with the
+// outcomes given to push_response(), push_error() and push_exception(), and
+// then with the outcome given to set_response() or set_error(). Errors are
+// reported in the RequestHandler subsystem. The delay and error of requests
+// to a given host can be overridden using set_host_delay() and
+// set_host_error(), e.g. to stand in for several deployments of the Web API.
+class RequestHandler_stub {
+public:
+  explicit RequestHandler_stub(::cryptolens_io::v20190401::basic_Error & e)
+  : mutex_(), outcomes_(), default_(), delay_ms_(0), requests_(0), last_arguments_()
+  , host_delays_ms_(), host_errors_(), host_requests_(), threads_()
+  {}
+  RequestHandler_stub(RequestHandler_stub const&) = delete;
+  void operator=(RequestHandler_stub const&) = delete;
+
+  using PostBuilder = RequestHandler_stub_PostBuilder;
+
+  PostBuilder
+  post_request(::cryptolens_io::v20190401::basic_Error & e, char const* host, char const* endpoint)
+  {
+    return PostBuilder(this, host);
+  }
+
+  void set_response(std::string body) { std::lock_guard<std::mutex> lock(mutex_); default_ = Outcome(0, 0, std::move(body)); }
+  void set_error(int reason, std::size_t extra = 0) { std::lock_guard<std::mutex> lock(mutex_); default_ = Outcome(reason, extra, ""); }
+
+  void push_response(std::string body) { std::lock_guard<std::mutex> lock(mutex_); outcomes_.push_back(Outcome(0, 0, std::move(body))); }
+  void push_error(int reason, std::size_t extra = 0) { std::lock_guard<std::mutex> lock(mutex_); outcomes_.push_back(Outcome(reason, extra, "")); }
+  void push_exception() { std::lock_guard<std::mutex> lock(mutex_); outcomes_.push_back(Outcome(THROW, 0, "")); }
+
+  // Each request takes this long before its outcome is returned
+  void set_delay(long delay_ms) { std::lock_guard<std::mutex> lock(mutex_); delay_ms_ = delay_ms; }
+
+  // Requests to host take delay_ms instead of the delay given to set_delay()
+  void set_host_delay(std::string const& host, long delay_ms) { std::lock_guard<std::mutex> lock(mutex_); host_delays_ms_[host] = delay_ms; }
+
+  // Requests to host fail with reason, or use the outcomes above again if reason is 0
+  void set_host_error(std::string const& host, int reason) { std::lock_guard<std::mutex> lock(mutex_); host_errors_[host] = reason; }
+
+  unsigned long get_requests() const { std::lock_guard<std::mutex> lock(mutex_); return requests_; }
+
+  unsigned long get_requests(std::string const& host) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = host_requests_.find(host);
+    return it == host_requests_.end() ? 0 : it->second;
+  }
+
+  // Returns the number of different threads that have made requests
+  std::size_t get_threads() const { std::lock_guard<std::mutex> lock(mutex_); return threads_.size(); }
+
+  // Returns the arguments of the last request as "key=value&key=value&"
+  std::string get_last_arguments() const { std::lock_guard<std::mutex> lock(mutex_); return last_arguments_; }
+
+private:
+  friend class RequestHandler_stub_PostBuilder;
+
+  static int const THROW = -1;
+
+  struct Outcome {
+    Outcome() : reason(0), extra(0), body() {}
+    Outcome(int reason, std::size_t extra, std::string body) : reason(reason), extra(extra), body(std::move(body)) {}
+
+    int reason; // 0 if the request succeeds
+    std::size_t extra;
+    std::string body;
+  };
+
+  std::string
+  make(::cryptolens_io::v20190401::basic_Error & e, std::string const& host, std::string const& arguments)
+  {
+    Outcome outcome;
+    long delay_ms;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      requests_ += 1;
+      host_requests_[host] += 1;
+      threads_.insert(std::this_thread::get_id());
+      last_arguments_ = arguments;
+
+      auto error = host_errors_.find(host);
+      if (error != host_errors_.end() && error->second != 0) {
+        outcome = Outcome(error->second, 0, "");
+      } else if (outcomes_.empty()) {
+        outcome = default_;
+      } else {
+        outcome = std::move(outcomes_.front());
+        outcomes_.pop_front();
+      }
+
+      auto delay = host_delays_ms_.find(host);
+      delay_ms = delay == host_delays_ms_.end() ? delay_ms_ : delay->second;
+    }
+
+    if (delay_ms > 0) { std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms)); }
+
+    if (outcome.reason == THROW) { throw std::runtime_error("RequestHandler_stub"); }
+    if (outcome.reason != 0) {
+      using namespace ::cryptolens_io::v20190401;
+      e.set(api::main(), errors::Subsystem::RequestHandler, outcome.reason, outcome.extra);
+      return "";
+    }
+
+    return outcome.body;
+  }
+
+  mutable std::mutex mutex_;
+  std::deque<Outcome> outcomes_;
+  Outcome default_;
+  long delay_ms_;
+  unsigned long requests_;
+  std::string last_arguments_;
+  std::map<std::string, long> host_delays_ms_;
+  std::map<std::string, int> host_errors_;
+  std::map<std::string, unsigned long> host_requests_;
+  std::set<std::thread::id> threads_;
+};
+
+inline std::string
+RequestHandler_stub_PostBuilder::make(::cryptolens_io::v20190401::basic_Error & e)
+{
+  if (e) { return ""; }
+
+  return handler_->make(e, host_, arguments_);
+}
+
+} // namespace cryptolens_unittests
@@ -0,0 +1,36 @@
+#pragma once
+
+// A stand-in for the parts of BearSSL used by SignatureVerifier_BearSSL, used
+// by the unit tests when BearSSL is not installed. The hash is computed with
+// the SHA-256 implementation of the library.
+
+#include <cstddef>
+
+#include <cryptolens/sha256.hpp>
+
+#define br_sha256_SIZE 32
+
+#define BR_HASH_OID_SHA256 ((unsigned char const*)"\x09\x60\x86\x48\x01\x65\x03\x04\x02\x01")
+
+typedef struct {
+  ::cryptolens_io::v20190401::internal::Sha256 sha256;
+} br_sha256_context;
+
+inline void
+br_sha256_init(br_sha256_context * ctx)
+{
+  ctx->sha256 = ::cryptolens_io::v20190401::internal::Sha256();
+}
+
+inline void
+br_sha256_update(br_sha256_context * ctx, void const* data, std::size_t len)
+{
+  ctx->sha256.update(data, len);
+}
+
+inline void
+br_sha256_out(br_sha256_context const* ctx, void * out)
+{
+  ::cryptolens_io::v20190401::internal::Sha256 copy(ctx->sha256);
+  copy.finish((unsigned char *)out);
+}
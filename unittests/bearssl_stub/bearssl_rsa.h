@@ -0,0 +1,66 @@
+#pragma once
+
+// A stand-in for the parts of BearSSL used by SignatureVerifier_BearSSL, used
+// by the unit tests when BearSSL is not installed. The RSA operation is made
+// with OpenSSL, but the result is returned in the same way as by BearSSL:
+// br_rsa_i62_pkcs1_vrfy() only checks the PKCS #1 v1.5 padding and the hash
+// OID, and writes the hash found in the signature to hash_out. It is up to
+// the caller to compare it with the hash of the message.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <openssl/bn.h>
+
+#include "bearssl_hash.h"
+
+typedef struct {
+  unsigned char *n;
+  std::size_t nlen;
+  unsigned char *e;
+  std::size_t elen;
+} br_rsa_public_key;
+
+inline std::uint32_t
+br_rsa_i62_pkcs1_vrfy(unsigned char const* x, std::size_t xlen, unsigned char const* hash_oid, std::size_t hash_len, br_rsa_public_key const* pk, unsigned char * hash_out)
+{
+  if (xlen != pk->nlen) { return 0; }
+
+  BN_CTX * ctx = BN_CTX_new();
+  BIGNUM * s = BN_bin2bn(x, (int)xlen, NULL);
+  BIGNUM * n = BN_bin2bn(pk->n, (int)pk->nlen, NULL);
+  BIGNUM * e = BN_bin2bn(pk->e, (int)pk->elen, NULL);
+  BIGNUM * m = BN_new();
+
+  std::vector<unsigned char> em(xlen);
+  bool ok = ctx && s && n && e && m
+         && BN_cmp(s, n) < 0
+         && BN_mod_exp(m, s, e, n, ctx)
+         && BN_bn2binpad(m, em.data(), (int)em.size()) == (int)em.size();
+
+  BN_free(m);
+  BN_free(e);
+  BN_free(n);
+  BN_free(s);
+  BN_CTX_free(ctx);
+  if (!ok) { return 0; }
+
+  // 00 01 FF .. FF 00 30 l 30 l 06 l <oid> 05 00 04 l <hash>
+  std::size_t oid_len = hash_oid[0];
+  std::size_t tail_len = 10 + oid_len + hash_len;
+  if (em.size() < tail_len + 11) { return 0; }
+
+  std::size_t pad_end = em.size() - tail_len - 1;
+  if (em[0] != 0x00 || em[1] != 0x01 || em[pad_end] != 0x00) { return 0; }
+  for (std::size_t i = 2; i < pad_end; ++i) { if (em[i] != 0xFF) { return 0; } }
+
+  unsigned char const* t = em.data() + pad_end + 1;
+  if (t[0] != 0x30 || t[1] != tail_len - 2 || t[2] != 0x30 || t[3] != oid_len + 4 || t[4] != 0x06 || t[5] != oid_len
+   || std::memcmp(t + 6, hash_oid + 1, oid_len) != 0 || t[6 + oid_len] != 0x05 || t[7 + oid_len] != 0x00
+   || t[8 + oid_len] != 0x04 || t[9 + oid_len] != hash_len) { return 0; }
+
+  std::memcpy(hash_out, t + 10 + oid_len, hash_len);
+  return 1;
+}
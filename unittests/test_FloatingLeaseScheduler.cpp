@@ -0,0 +1,189 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/basic_Cryptolens.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/FloatingLeaseScheduler.hpp>
+#include <cryptolens/MachineCodeComputer_static.hpp>
+#include <cryptolens/RequestHandler_curl_multi.hpp>
+#include <cryptolens/ResponseParser_ArduinoJson7.hpp>
+#include <cryptolens/validators/AndValidator.hpp>
+#include <cryptolens/validators/CorrectKeyValidator.hpp>
+#include <cryptolens/validators/CorrectProductValidator.hpp>
+
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+#include <cryptolens/SignatureVerifier_OpenSSL3.hpp>
+#else
+#include <cryptolens/SignatureVerifier_OpenSSL.hpp>
+#endif
+
+#include "fixtures.hpp"
+#include "local_server.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+struct Configuration_multi {
+  using ResponseParser = cryptolens::ResponseParser_ArduinoJson7;
+  using RequestHandler = cryptolens::RequestHandler_curl_multi;
+  using MachineCodeComputer = cryptolens::MachineCodeComputer_static;
+
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+  using SignatureVerifier = cryptolens::SignatureVerifier_OpenSSL3;
+#else
+  using SignatureVerifier = cryptolens::SignatureVerifier_OpenSSL;
+#endif
+
+  template<typename Env>
+  using ActivateValidator = cryptolens::AndValidator_<Env, cryptolens::CorrectKeyValidator_<Env>, cryptolens::CorrectProductValidator_<Env>>;
+
+  template<typename Env>
+  using GetKeyValidator = cryptolens::AndValidator_<Env, cryptolens::CorrectKeyValidator_<Env>, cryptolens::CorrectProductValidator_<Env>>;
+};
+
+using Cryptolens = cryptolens::basic_Cryptolens<Configuration_multi>;
+using FloatingLeaseScheduler = cryptolens::FloatingLeaseScheduler<Cryptolens>;
+using LeaseId = FloatingLeaseScheduler::LeaseId;
+
+struct Fixture {
+  explicit Fixture(std::string const& url) : e(), cryptolens_handle(e)
+  {
+    cryptolens_handle.signature_verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+    cryptolens_handle.signature_verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+    cryptolens_handle.machine_code_computer.set_machine_code(e, cryptolens_bench::MACHINE_CODE);
+    cryptolens_handle.set_base_url(e, url);
+  }
+
+  cryptolens::Error e;
+  Cryptolens cryptolens_handle;
+};
+
+// The outcome of the on_lost callback
+struct Lost {
+  Lost() : promise(), subsystem(0), reason(0) {}
+
+  FloatingLeaseScheduler::LeaseLostCallback callback()
+  {
+    return [this](LeaseId, cryptolens::basic_Error & e) {
+      subsystem = e.get_subsystem(cryptolens::api::main());
+      reason = e.get_reason(cryptolens::api::main());
+      promise.set_value(std::chrono::steady_clock::now());
+    };
+  }
+
+  std::promise<std::chrono::steady_clock::time_point> promise;
+  int subsystem;
+  int reason;
+};
+
+} // namespace
+
+TEST_CASE("FloatingLeaseScheduler::shutdown() waits for on_lost to return", "[FloatingLeaseScheduler]")
+{
+  cryptolens_bench::LocalServer server("{\"result\":1,\"message\":\"Unable to find the license key.\"}");
+  Fixture f(server.get_url());
+  REQUIRE_FALSE(f.e);
+
+  std::atomic<bool> returned(false);
+  FloatingLeaseScheduler scheduler(f.e, f.cryptolens_handle);
+  scheduler.add_lease(f.e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY, 60,
+    [&returned](LeaseId, cryptolens::basic_Error & e) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      returned = true;
+    });
+  REQUIRE_FALSE(f.e);
+
+  scheduler.shutdown();
+  CHECK(returned);
+}
+
+TEST_CASE("FloatingLeaseScheduler::remove_lease() deactivates after the activation in flight", "[FloatingLeaseScheduler]")
+{
+  cryptolens_bench::LocalServer server(cryptolens_bench::ACTIVATE_RESPONSE);
+  server.set_slow_requests(1, 300);
+  Fixture f(server.get_url());
+  REQUIRE_FALSE(f.e);
+
+  std::atomic<bool> lost(false);
+  FloatingLeaseScheduler scheduler(f.e, f.cryptolens_handle);
+  LeaseId id = scheduler.add_lease(f.e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY, 60,
+    [&lost](LeaseId, cryptolens::basic_Error &) { lost = true; });
+  REQUIRE_FALSE(f.e);
+
+  scheduler.remove_lease(id);
+  CHECK(scheduler.get_lease_count() == 0);
+  CHECK_FALSE(scheduler.get_license_key(id));
+
+  // Only the activation has been sent while its response is delayed
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  CHECK(server.get_requests() == 1);
+
+  scheduler.shutdown();
+  CHECK(server.get_requests() == 2);
+  CHECK_FALSE(lost);
+}
+
+TEST_CASE("FloatingLeaseScheduler does not retry renewals that cannot succeed", "[FloatingLeaseScheduler]")
+{
+  cryptolens_bench::LocalServer server(cryptolens_bench::ACTIVATE_RESPONSE);
+  Fixture f(server.get_url());
+  REQUIRE_FALSE(f.e);
+
+  Lost lost;
+  std::future<std::chrono::steady_clock::time_point> lost_at = lost.promise.get_future();
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  FloatingLeaseScheduler scheduler(f.e, f.cryptolens_handle);
+  LeaseId id = scheduler.add_lease(f.e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY, 6, lost.callback());
+  REQUIRE_FALSE(f.e);
+
+  for (int i = 0; i < 100 && !scheduler.get_license_key(id); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(scheduler.get_license_key(id));
+
+  // The renewal fails with RESPONSE_TOO_LARGE, which is not transient
+  f.cryptolens_handle.request_handler.set_max_response_size(f.e, 16);
+
+  REQUIRE(lost_at.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  CHECK(lost_at.get() - start < std::chrono::milliseconds(4500));
+  CHECK(lost.subsystem == cryptolens::errors::Subsystem::RequestHandler);
+  CHECK(lost.reason == cryptolens::errors::RequestHandler_curl_multi::RESPONSE_TOO_LARGE);
+  CHECK(server.get_requests() == 2);
+}
+
+TEST_CASE("FloatingLeaseScheduler retries renewals until the lease expires if the Web API cannot be reached", "[FloatingLeaseScheduler]")
+{
+  std::unique_ptr<cryptolens_bench::LocalServer> server(new cryptolens_bench::LocalServer(cryptolens_bench::ACTIVATE_RESPONSE));
+  Fixture f(server->get_url());
+  REQUIRE_FALSE(f.e);
+
+  Lost lost;
+  std::future<std::chrono::steady_clock::time_point> lost_at = lost.promise.get_future();
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  FloatingLeaseScheduler scheduler(f.e, f.cryptolens_handle);
+  LeaseId id = scheduler.add_lease(f.e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY, 6, lost.callback());
+  REQUIRE_FALSE(f.e);
+
+  for (int i = 0; i < 100 && !scheduler.get_license_key(id); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(scheduler.get_license_key(id));
+
+  // Connections are refused from now on
+  server.reset();
+
+  REQUIRE(lost_at.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  CHECK(lost_at.get() - start >= std::chrono::milliseconds(4500));
+  CHECK(lost.subsystem == cryptolens::errors::Subsystem::RequestHandler);
+  CHECK(lost.reason == cryptolens::errors::RequestHandler_curl_multi::PERFORM);
+}
@@ -0,0 +1,269 @@
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/basic_Cryptolens.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/LicenseKeyCache.hpp>
+#include <cryptolens/MachineCodeComputer_static.hpp>
+#include <cryptolens/ResponseParser_ArduinoJson7.hpp>
+#include <cryptolens/validators/AndValidator.hpp>
+#include <cryptolens/validators/CorrectKeyValidator.hpp>
+#include <cryptolens/validators/CorrectProductValidator.hpp>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+#include <cryptolens/SignatureVerifier_OpenSSL3.hpp>
+#else
+#include <cryptolens/SignatureVerifier_OpenSSL.hpp>
+#endif
+
+#include "fixtures.hpp"
+#include "RequestHandler_stub.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+// Any error in the RequestHandler subsystem means the Web API could not be reached
+int const UNREACHABLE = 1;
+
+struct Configuration_stub {
+  using ResponseParser = cryptolens::ResponseParser_ArduinoJson7;
+  using RequestHandler = cryptolens_unittests::RequestHandler_stub;
+  using MachineCodeComputer = cryptolens::MachineCodeComputer_static;
+
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+  using SignatureVerifier = cryptolens::SignatureVerifier_OpenSSL3;
+#else
+  using SignatureVerifier = cryptolens::SignatureVerifier_OpenSSL;
+#endif
+
+  template<typename Env>
+  using ActivateValidator = cryptolens::AndValidator_<Env, cryptolens::CorrectKeyValidator_<Env>, cryptolens::CorrectProductValidator_<Env>>;
+
+  template<typename Env>
+  using GetKeyValidator = cryptolens::AndValidator_<Env, cryptolens::CorrectKeyValidator_<Env>, cryptolens::CorrectProductValidator_<Env>>;
+};
+
+using Cryptolens = cryptolens::basic_Cryptolens<Configuration_stub>;
+using LicenseKeyCache = cryptolens::LicenseKeyCache<Cryptolens>;
+
+struct Fixture {
+  Fixture() : e(), cryptolens_handle(e), sign_date(0)
+  {
+    cryptolens_handle.signature_verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+    cryptolens_handle.signature_verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+    cryptolens_handle.machine_code_computer.set_machine_code(e, cryptolens_bench::MACHINE_CODE);
+    cryptolens_handle.request_handler.set_response(cryptolens_bench::ACTIVATE_RESPONSE);
+
+    cryptolens::optional<cryptolens::LicenseKey> license_key = cryptolens_handle.make_license_key(e, cryptolens_bench::ACTIVATE_RESPONSE);
+    if (license_key) { sign_date = (long)license_key->get_sign_date(); }
+  }
+
+  // A TTL such that the license key of the fixture was signed age_s seconds
+  // before it becomes stale
+  long ttl_stale_in(long age_s) const { return (long)(std::time(NULL) - sign_date) + age_s; }
+
+  cryptolens::optional<cryptolens::LicenseKey> activate(LicenseKeyCache & cache, char const* token = "token")
+  {
+    return cache.activate(e, token, cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+  }
+
+  cryptolens::Error e;
+  Cryptolens cryptolens_handle;
+  long sign_date;
+};
+
+// A temporary directory that is removed together with its files
+struct TemporaryDirectory {
+  TemporaryDirectory() : path()
+  {
+    char name[] = "/tmp/cryptolens-test-XXXXXX";
+    if (mkdtemp(name) != NULL) { path = name; }
+  }
+
+  ~TemporaryDirectory()
+  {
+    if (path.empty()) { return; }
+
+    DIR * dir = opendir(path.c_str());
+    if (dir != NULL) {
+      struct dirent * file;
+      while ((file = readdir(dir)) != NULL) {
+        std::string name = file->d_name;
+        if (name != "." && name != "..") { std::remove((path + "/" + name).c_str()); }
+      }
+      closedir(dir);
+    }
+    rmdir(path.c_str());
+  }
+
+  std::string path;
+};
+
+} // namespace
+
+TEST_CASE("LicenseKeyCache returns fresh license keys without contacting the Web API", "[LicenseKeyCache]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  LicenseKeyCache cache(f.e, f.cryptolens_handle);
+  cache.set_ttl(f.e, f.ttl_stale_in(3600));
+  cache.set_refresh_ahead(f.e, 0, 0);
+
+  for (int i = 0; i < 3; ++i) {
+    cryptolens::optional<cryptolens::LicenseKey> license_key = f.activate(cache);
+    REQUIRE_FALSE(f.e);
+    REQUIRE(license_key);
+    CHECK(*license_key->get_key() == cryptolens_bench::KEY);
+  }
+
+  CHECK(f.cryptolens_handle.request_handler.get_requests() == 1);
+  CHECK(cache.get_cache_misses() == 1);
+  CHECK(cache.get_cache_hits() == 2);
+}
+
+TEST_CASE("LicenseKeyCache uses separate entries for different tokens", "[LicenseKeyCache]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  LicenseKeyCache cache(f.e, f.cryptolens_handle);
+  cache.set_ttl(f.e, f.ttl_stale_in(3600));
+  cache.set_refresh_ahead(f.e, 0, 0);
+
+  f.activate(cache, "token1");
+  f.activate(cache, "token2");
+  f.activate(cache, "token1");
+  CHECK_FALSE(f.e);
+
+  CHECK(f.cryptolens_handle.request_handler.get_requests() == 2);
+}
+
+TEST_CASE("LicenseKeyCache contacts the Web API for stale license keys", "[LicenseKeyCache]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  LicenseKeyCache cache(f.e, f.cryptolens_handle);
+  cache.set_ttl(f.e, f.ttl_stale_in(-3600));
+  cache.set_grace_period(f.e, 7200);
+
+  CHECK(f.activate(cache));
+  CHECK(f.activate(cache));
+  CHECK_FALSE(f.e);
+  CHECK(f.cryptolens_handle.request_handler.get_requests() == 2);
+  CHECK(cache.get_cache_misses() == 2);
+
+  SECTION("and returns them if the Web API cannot be reached during the grace period") {
+    f.cryptolens_handle.request_handler.set_error(UNREACHABLE);
+
+    CHECK(f.activate(cache));
+    CHECK_FALSE(f.e);
+    CHECK(f.cryptolens_handle.request_handler.get_requests() == 3);
+  }
+
+  SECTION("but not after the grace period") {
+    f.cryptolens_handle.request_handler.set_error(UNREACHABLE);
+    cache.set_grace_period(f.e, 0);
+
+    CHECK_FALSE(f.activate(cache));
+    CHECK(f.e.get_subsystem() == cryptolens::errors::Subsystem::RequestHandler);
+  }
+}
+
+TEST_CASE("LicenseKeyCache refreshes license keys in the background before they become stale", "[LicenseKeyCache]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  {
+    LicenseKeyCache cache(f.e, f.cryptolens_handle);
+    cache.set_ttl(f.e, f.ttl_stale_in(3600));
+    cache.set_refresh_ahead(f.e, 7200, 0);
+
+    CHECK(f.activate(cache));
+    CHECK(f.cryptolens_handle.request_handler.get_requests() == 1);
+
+    // Fresh, but within the refresh ahead window
+    f.cryptolens_handle.request_handler.set_delay(100);
+    CHECK(f.activate(cache));
+    CHECK_FALSE(f.e);
+    CHECK(cache.get_cache_hits() == 1);
+    CHECK(cache.get_cache_misses() == 1);
+
+    // The destructor waits for the refresh
+  }
+
+  CHECK(f.cryptolens_handle.request_handler.get_requests() == 2);
+}
+
+TEST_CASE("LicenseKeyCache makes one request when several threads ask for the same license key", "[LicenseKeyCache]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  LicenseKeyCache cache(f.e, f.cryptolens_handle);
+  cache.set_ttl(f.e, f.ttl_stale_in(3600));
+  cache.set_refresh_ahead(f.e, 0, 0);
+  f.cryptolens_handle.request_handler.set_delay(100);
+
+  int const THREADS = 4;
+  std::vector<int> ok(THREADS, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREADS; ++i) {
+    threads.emplace_back([&f, &cache, &ok, i]() {
+      cryptolens::Error e;
+      cryptolens::optional<cryptolens::LicenseKey> license_key = cache.activate(e, "token", cryptolens_bench::PRODUCT_ID, cryptolens_bench::KEY);
+      ok[i] = license_key && !e;
+    });
+  }
+  for (std::thread & t : threads) { t.join(); }
+
+  for (int i = 0; i < THREADS; ++i) { CHECK(ok[i]); }
+  CHECK(f.cryptolens_handle.request_handler.get_requests() == 1);
+}
+
+TEST_CASE("LicenseKeyCache loads saved license keys", "[LicenseKeyCache]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  TemporaryDirectory directory;
+  REQUIRE_FALSE(directory.path.empty());
+
+  {
+    LicenseKeyCache cache(f.e, f.cryptolens_handle);
+    cache.set_ttl(f.e, f.ttl_stale_in(3600));
+    cache.set_refresh_ahead(f.e, 0, 0);
+    cache.set_directory(f.e, directory.path);
+
+    CHECK(f.activate(cache));
+    CHECK(f.cryptolens_handle.request_handler.get_requests() == 1);
+  }
+
+  {
+    LicenseKeyCache cache(f.e, f.cryptolens_handle);
+    cache.set_ttl(f.e, f.ttl_stale_in(3600));
+    cache.set_refresh_ahead(f.e, 0, 0);
+    cache.set_directory(f.e, directory.path);
+
+    f.cryptolens_handle.request_handler.set_error(UNREACHABLE);
+    cryptolens::optional<cryptolens::LicenseKey> license_key = f.activate(cache);
+    CHECK_FALSE(f.e);
+    REQUIRE(license_key);
+    CHECK(*license_key->get_key() == cryptolens_bench::KEY);
+    CHECK(cache.get_cache_hits() == 1);
+  }
+}
@@ -0,0 +1,134 @@
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/Error.hpp>
+#include <cryptolens/RequestHandler_curl.hpp>
+#include <cryptolens/RequestHandler_curl_multi.hpp>
+#include <cryptolens/RequestHandler_curl_pool.hpp>
+#include <cryptolens/RequestHandler_retrying.hpp>
+
+#include "local_server.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+template<typename RequestHandler>
+std::string
+activate(cryptolens::basic_Error & e, RequestHandler & handler, std::string const& url)
+{
+  return handler.post_request(e, url.c_str(), "/api/key/Activate")
+                .add_argument(e, "token", "abc")
+                .make(e);
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("The curl request handlers return the body whatever the HTTP status", "[RequestHandler_curl]",
+  cryptolens::RequestHandler_curl, cryptolens::RequestHandler_curl_pool, cryptolens::RequestHandler_curl_multi)
+{
+  cryptolens_bench::LocalServer server("Service Unavailable", 503);
+  cryptolens::Error e;
+  TestType handler(e);
+
+  CHECK(activate(e, handler, server.get_url()) == "Service Unavailable");
+  CHECK_FALSE(e);
+}
+
+TEMPLATE_TEST_CASE("The curl request handlers report the HTTP status if asked to", "[RequestHandler_curl]",
+  cryptolens::RequestHandler_curl, cryptolens::RequestHandler_curl_pool, cryptolens::RequestHandler_curl_multi)
+{
+  cryptolens::Error e;
+  TestType handler(e);
+  handler.set_report_http_status(e, true);
+  REQUIRE_FALSE(e);
+
+  SECTION("for 429 and 5xx") {
+    cryptolens_bench::LocalServer server("Service Unavailable", 503);
+
+    CHECK(activate(e, handler, server.get_url()) == "");
+    CHECK(e.get_subsystem() == cryptolens::errors::Subsystem::RequestHandler);
+    CHECK(e.get_reason() == cryptolens::errors::RequestHandler_curl::HTTP_STATUS);
+    CHECK(e.get_extra() == 503);
+  }
+
+  SECTION("but not for other statuses") {
+    cryptolens_bench::LocalServer server("{\"result\":1,\"message\":\"Not found\"}", 400);
+
+    CHECK(activate(e, handler, server.get_url()) == "{\"result\":1,\"message\":\"Not found\"}");
+    CHECK_FALSE(e);
+  }
+}
+
+TEMPLATE_TEST_CASE("The curl request handlers limit the size of responses", "[RequestHandler_curl]",
+  cryptolens::RequestHandler_curl, cryptolens::RequestHandler_curl_pool, cryptolens::RequestHandler_curl_multi)
+{
+  std::string const body(5000, 'x');
+  cryptolens_bench::LocalServer server(body);
+  cryptolens::Error e;
+  TestType handler(e);
+
+  SECTION("not at all by default") {
+    CHECK(activate(e, handler, server.get_url()) == body);
+    CHECK_FALSE(e);
+  }
+
+  SECTION("up to the limit") {
+    handler.set_max_response_size(e, 5000);
+    REQUIRE_FALSE(e);
+
+    CHECK(activate(e, handler, server.get_url()) == body);
+    CHECK_FALSE(e);
+  }
+
+  SECTION("but not above it") {
+    handler.set_max_response_size(e, 4999);
+    REQUIRE_FALSE(e);
+
+    CHECK(activate(e, handler, server.get_url()) == "");
+    CHECK(e.get_subsystem() == cryptolens::errors::Subsystem::RequestHandler);
+    CHECK(e.get_reason() == cryptolens::errors::RequestHandler_curl::RESPONSE_TOO_LARGE);
+    CHECK(e.get_extra() == 4999);
+  }
+
+  SECTION("and can be used again after a response that was too large") {
+    handler.set_max_response_size(e, 4999);
+    CHECK(activate(e, handler, server.get_url()) == "");
+    CHECK(e);
+    e.reset();
+
+    handler.set_max_response_size(e, 0);
+    REQUIRE_FALSE(e);
+    CHECK(activate(e, handler, server.get_url()) == body);
+    CHECK_FALSE(e);
+  }
+}
+
+TEST_CASE("TransientErrors_curl considers overloaded servers and failed connections transient", "[RequestHandler_curl]")
+{
+  using namespace cryptolens::errors::RequestHandler_curl;
+
+  CHECK(cryptolens::TransientErrors_curl::is_transient(HTTP_STATUS, 429));
+  CHECK(cryptolens::TransientErrors_curl::is_transient(HTTP_STATUS, 503));
+  CHECK_FALSE(cryptolens::TransientErrors_curl::is_transient(HTTP_STATUS, 500));
+  CHECK(cryptolens::TransientErrors_curl::is_transient(PERFORM, CURLE_COULDNT_CONNECT));
+  CHECK(cryptolens::TransientErrors_curl::is_transient(PERFORM, CURLE_OPERATION_TIMEDOUT));
+  CHECK_FALSE(cryptolens::TransientErrors_curl::is_transient(PERFORM, CURLE_PEER_FAILED_VERIFICATION));
+  CHECK_FALSE(cryptolens::TransientErrors_curl::is_transient(RESPONSE_TOO_LARGE, 16));
+}
+
+TEST_CASE("RequestHandler_retrying makes requests answered with the HTTP status 503 again", "[RequestHandler_curl]")
+{
+  cryptolens_bench::LocalServer server("Service Unavailable", 503);
+  cryptolens::Error e;
+  cryptolens::RequestHandler_retrying<cryptolens::RequestHandler_curl> handler(e);
+  handler.set_backoff(e, 1, 1);
+  handler.set_max_retries(e, 2);
+
+  CHECK(activate(e, handler, server.get_url()) == "");
+  CHECK(e.get_reason() == cryptolens::errors::RequestHandler_curl::HTTP_STATUS);
+  CHECK(e.get_extra() == 503);
+  CHECK(server.get_requests() == 3);
+  CHECK(handler.get_retries() == 2);
+}
@@ -0,0 +1,53 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/Error.hpp>
+#include <cryptolens/RequestHandler_curl_multi.hpp>
+
+#include "local_server.hpp"
+
+namespace cryptolens = ::cryptolens_io::latest;
+
+TEST_CASE("RequestHandler_curl_multi returns the response body", "[RequestHandler_curl_multi]")
+{
+  cryptolens_bench::LocalServer server("{\"result\":0}");
+  cryptolens::Error e;
+  cryptolens::RequestHandler_curl_multi handler(e);
+
+  std::string body = handler.post_request(e, server.get_url().c_str(), "/api/key/Activate")
+                            .add_argument(e, "token", "abc")
+                            .make(e);
+
+  REQUIRE_FALSE(e);
+  CHECK(body == "{\"result\":0}");
+}
+
+TEST_CASE("RequestHandler_curl_multi survives a callback that throws", "[RequestHandler_curl_multi]")
+{
+  cryptolens_bench::LocalServer server("{\"result\":0}");
+  cryptolens::Error e;
+  cryptolens::RequestHandler_curl_multi handler(e);
+
+  std::promise<void> called;
+  handler.post_request(e, server.get_url().c_str(), "/api/key/Activate")
+         .make_async(e, [&called](cryptolens::RequestHandler_curl_multi_Response) {
+           called.set_value();
+           throw std::runtime_error("callback failed");
+         });
+  REQUIRE_FALSE(e);
+  REQUIRE(called.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+
+  // The background thread keeps serving requests
+  std::future<cryptolens::RequestHandler_curl_multi_Response> response =
+    handler.post_request(e, server.get_url().c_str(), "/api/key/Activate").make_future(e);
+  REQUIRE(response.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+
+  cryptolens::Error e2;
+  CHECK(response.get().get(e2) == "{\"result\":0}");
+  CHECK_FALSE(e2);
+}
@@ -0,0 +1,181 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/Error.hpp>
+#include <cryptolens/RequestHandler_hedging.hpp>
+
+#include "RequestHandler_stub.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+using RequestHandler = cryptolens::RequestHandler_hedging<cryptolens_unittests::RequestHandler_stub>;
+
+char const* const EU = "https://eu.example.com";
+char const* const US = "https://us.example.com";
+
+int const UNREACHABLE = 1;
+
+struct Fixture {
+  Fixture()
+  : e(), handler(e)
+  {
+    handler.set_endpoints(e, std::vector<std::string>{EU, US});
+    handler.get_request_handler().set_response("ok");
+  }
+
+  std::string
+  activate()
+  {
+    return handler.post_request(e, "api.cryptolens.io", "/api/key/Activate")
+                  .add_argument(e, "token", "abc")
+                  .add_argument(e, "Key", "ABCD")
+                  .make(e);
+  }
+
+  cryptolens_unittests::RequestHandler_stub & stub() { return handler.get_request_handler(); }
+
+  cryptolens::Error e;
+  RequestHandler handler;
+};
+
+long
+elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+  return (long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+TEST_CASE("RequestHandler_hedging sends requests to the fastest endpoint", "[RequestHandler_hedging]")
+{
+  Fixture f;
+  f.stub().set_host_delay(EU, 30);
+
+  for (int i = 0; i < 6; ++i) {
+    CHECK(f.activate() == "ok");
+    REQUIRE(!f.e);
+  }
+
+  // The first request measures EU, after which US is faster
+  CHECK(f.stub().get_requests(EU) == 1);
+  CHECK(f.stub().get_requests(US) == 5);
+
+  std::vector<double> latencies = f.handler.get_latencies();
+  REQUIRE(latencies.size() == 2);
+  CHECK(latencies[0] > latencies[1]);
+}
+
+TEST_CASE("RequestHandler_hedging falls back to the next endpoint", "[RequestHandler_hedging]")
+{
+  Fixture f;
+  f.stub().set_host_error(EU, UNREACHABLE);
+
+  SECTION("A failed request is made again using the next endpoint") {
+    CHECK(f.activate() == "ok");
+    CHECK(!f.e);
+    CHECK(f.activate() == "ok");
+    CHECK(!f.e);
+
+    // The failure made EU slower than US
+    CHECK(f.stub().get_requests(EU) == 1);
+    CHECK(f.stub().get_requests(US) == 2);
+  }
+
+  SECTION("The error is reported if all endpoints fail") {
+    f.stub().set_host_error(US, UNREACHABLE);
+
+    CHECK(f.activate() == "");
+    CHECK(f.e.get_subsystem() == cryptolens::errors::Subsystem::RequestHandler);
+    CHECK(f.e.get_reason() == UNREACHABLE);
+  }
+}
+
+TEST_CASE("RequestHandler_hedging tries a failing endpoint again once its latency has decayed", "[RequestHandler_hedging]")
+{
+  Fixture f;
+  f.handler.set_latency_decay(f.e, 50);
+  f.stub().set_host_delay(US, 20);
+  f.stub().set_host_error(EU, UNREACHABLE);
+
+  CHECK(f.activate() == "ok");
+  CHECK(f.stub().get_requests(EU) == 1);
+
+  f.stub().set_host_error(EU, 0);
+
+  // Keep using US until the penalty of EU has decayed below the latency of US
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (f.stub().get_requests(EU) == 1 && elapsed_ms(start) < 2000) {
+    CHECK(f.activate() == "ok");
+    REQUIRE(!f.e);
+  }
+  REQUIRE(f.stub().get_requests(EU) == 2);
+  CHECK(f.stub().get_requests(US) >= 2);
+
+  // EU has recovered and is faster than US again
+  unsigned long us_requests = f.stub().get_requests(US);
+  CHECK(f.activate() == "ok");
+  CHECK(f.stub().get_requests(EU) == 3);
+  CHECK(f.stub().get_requests(US) == us_requests);
+}
+
+TEST_CASE("RequestHandler_hedging does not try a failing endpoint again without decay", "[RequestHandler_hedging]")
+{
+  Fixture f;
+  f.handler.set_latency_decay(f.e, 0);
+  f.stub().set_host_delay(US, 20);
+  f.stub().set_host_error(EU, UNREACHABLE);
+
+  CHECK(f.activate() == "ok");
+  f.stub().set_host_error(EU, 0);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (elapsed_ms(start) < 300) {
+    CHECK(f.activate() == "ok");
+    REQUIRE(!f.e);
+  }
+  CHECK(f.stub().get_requests(EU) == 1);
+}
+
+TEST_CASE("RequestHandler_hedging hedges slow requests", "[RequestHandler_hedging]")
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  {
+    Fixture f;
+    f.handler.set_hedging(f.e, true, 50);
+    f.stub().set_host_delay(EU, 500);
+
+    CHECK(f.activate() == "ok");
+    CHECK(!f.e);
+    CHECK(elapsed_ms(start) < 400);
+    CHECK(f.handler.get_hedges() == 1);
+    CHECK(f.stub().get_requests(EU) == 1);
+    CHECK(f.stub().get_requests(US) == 1);
+  }
+
+  // The destructor waits for the request to EU that is no longer needed
+  CHECK(elapsed_ms(start) >= 500);
+}
+
+TEST_CASE("RequestHandler_hedging reuses its worker threads", "[RequestHandler_hedging]")
+{
+  Fixture f;
+  f.handler.set_hedging(f.e, true, 10);
+  f.stub().set_delay(30);
+
+  for (int i = 0; i < 10; ++i) {
+    CHECK(f.activate() == "ok");
+    REQUIRE(!f.e);
+  }
+
+  // Every request is hedged, and a hedge may overlap with the previous one
+  // still running in the background, but no thread is started per request
+  CHECK(f.handler.get_hedges() == 10);
+  CHECK(f.stub().get_requests() == 20);
+  CHECK(f.stub().get_threads() <= 4);
+}
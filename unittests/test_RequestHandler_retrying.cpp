@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/Error.hpp>
+#include <cryptolens/RequestHandler_retrying.hpp>
+
+#include "RequestHandler_stub.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+int const TRANSIENT = 1;
+int const PERMANENT = 2;
+
+struct TransientErrors_stub {
+  static bool is_transient(int reason, std::size_t extra) { return reason == TRANSIENT; }
+
+  template<typename RequestHandler>
+  static void setup(cryptolens::basic_Error & e, RequestHandler & request_handler) { request_handler.set_response("setup"); }
+};
+
+using RequestHandler = cryptolens::RequestHandler_retrying<cryptolens_unittests::RequestHandler_stub, TransientErrors_stub>;
+
+std::string
+activate(cryptolens::basic_Error & e, RequestHandler & handler)
+{
+  return handler.post_request(e, "api.cryptolens.io", "/api/key/Activate")
+                .add_argument(e, "token", "abc")
+                .make(e);
+}
+
+struct Fixture {
+  Fixture() : e(), handler(e)
+  {
+    handler.set_backoff(e, 1, 1);
+  }
+
+  cryptolens_unittests::RequestHandler_stub & stub() { return handler.get_request_handler(); }
+
+  cryptolens::Error e;
+  RequestHandler handler;
+};
+
+} // namespace
+
+TEST_CASE("RequestHandler_retrying calls TransientErrors::setup() with the underlying request handler", "[RequestHandler_retrying]")
+{
+  Fixture f;
+
+  CHECK(activate(f.e, f.handler) == "setup");
+  CHECK_FALSE(f.e);
+}
+
+TEST_CASE("RequestHandler_retrying makes requests again after transient errors", "[RequestHandler_retrying]")
+{
+  Fixture f;
+  f.stub().set_response("{\"result\":0}");
+  f.stub().push_error(TRANSIENT);
+  f.stub().push_error(TRANSIENT);
+
+  CHECK(activate(f.e, f.handler) == "{\"result\":0}");
+  CHECK_FALSE(f.e);
+  CHECK(f.stub().get_requests() == 3);
+  CHECK(f.handler.get_retries() == 2);
+  CHECK(f.stub().get_last_arguments() == "token=abc&");
+}
+
+TEST_CASE("RequestHandler_retrying returns other errors right away", "[RequestHandler_retrying]")
+{
+  Fixture f;
+  f.stub().push_error(PERMANENT, 7);
+
+  CHECK(activate(f.e, f.handler) == "");
+  CHECK(f.e.get_subsystem() == cryptolens::errors::Subsystem::RequestHandler);
+  CHECK(f.e.get_reason() == PERMANENT);
+  CHECK(f.e.get_extra() == 7);
+  CHECK(f.stub().get_requests() == 1);
+}
+
+TEST_CASE("RequestHandler_retrying returns the last error once the retries are used up", "[RequestHandler_retrying]")
+{
+  Fixture f;
+  f.stub().set_error(TRANSIENT, 7);
+  f.handler.set_max_retries(f.e, 3);
+
+  CHECK(activate(f.e, f.handler) == "");
+  CHECK(f.e.get_reason() == TRANSIENT);
+  CHECK(f.e.get_extra() == 7);
+  CHECK(f.stub().get_requests() == 4);
+}
+
+TEST_CASE("RequestHandler_retrying opens the circuit after consecutive transient errors", "[RequestHandler_retrying]")
+{
+  Fixture f;
+  f.handler.set_max_retries(f.e, 0);
+  f.handler.set_circuit_breaker(f.e, 2, 200);
+  f.stub().set_response("{\"result\":0}");
+  f.stub().push_error(TRANSIENT);
+  f.stub().push_error(TRANSIENT);
+
+  for (int i = 0; i < 2; ++i) {
+    cryptolens::Error e;
+    activate(e, f.handler);
+    CHECK(e.get_reason() == TRANSIENT);
+  }
+  CHECK(f.handler.is_circuit_open());
+
+  cryptolens::Error rejected;
+  activate(rejected, f.handler);
+  CHECK(rejected.get_reason() == cryptolens::errors::RequestHandler_retrying::CIRCUIT_OPEN);
+  CHECK(f.stub().get_requests() == 2);
+  CHECK(f.handler.get_rejected() == 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+  SECTION("and closes it if the request let through after a while succeeds") {
+    cryptolens::Error e;
+    CHECK(activate(e, f.handler) == "{\"result\":0}");
+    CHECK_FALSE(e);
+    CHECK(f.stub().get_requests() == 3);
+    CHECK_FALSE(f.handler.is_circuit_open());
+  }
+
+  SECTION("and keeps it open if the request let through after a while fails") {
+    f.stub().push_error(TRANSIENT);
+
+    cryptolens::Error e;
+    activate(e, f.handler);
+    CHECK(e.get_reason() == TRANSIENT);
+    CHECK(f.stub().get_requests() == 3);
+    CHECK(f.handler.is_circuit_open());
+  }
+}
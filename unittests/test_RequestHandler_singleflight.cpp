@@ -0,0 +1,133 @@
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/Error.hpp>
+#include <cryptolens/RequestHandler_singleflight.hpp>
+
+#include "RequestHandler_stub.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+using RequestHandler = cryptolens::RequestHandler_singleflight<cryptolens_unittests::RequestHandler_stub>;
+
+struct Result {
+  Result() : body(), subsystem(0), reason(0), extra(0) {}
+
+  std::string body;
+  int subsystem;
+  int reason;
+  std::size_t extra;
+};
+
+Result
+activate(RequestHandler & handler, char const* key)
+{
+  cryptolens::Error e;
+  Result result;
+  result.body = handler.post_request(e, "api.cryptolens.io", "/api/key/Activate")
+                       .add_argument(e, "token", "abc")
+                       .add_argument(e, "Key", key)
+                       .make(e);
+  result.subsystem = e.get_subsystem();
+  result.reason = e.get_reason();
+  result.extra = e.get_extra();
+  return result;
+}
+
+// Makes the same request from several threads at the same time
+std::vector<Result>
+activate_concurrently(RequestHandler & handler, int threads_count)
+{
+  std::vector<Result> results(threads_count);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_count; ++i) {
+    threads.emplace_back([&handler, &results, i]() { results[i] = activate(handler, "ABCD"); });
+  }
+  for (std::thread & t : threads) { t.join(); }
+
+  return results;
+}
+
+} // namespace
+
+TEST_CASE("RequestHandler_singleflight sends concurrent identical requests once", "[RequestHandler_singleflight]")
+{
+  cryptolens::Error e;
+  RequestHandler handler(e);
+  handler.get_request_handler().set_response("{\"result\":0}");
+  handler.get_request_handler().set_delay(200);
+
+  std::vector<Result> results = activate_concurrently(handler, 4);
+
+  for (Result const& result : results) {
+    CHECK(result.subsystem == cryptolens::errors::Subsystem::Ok);
+    CHECK(result.body == "{\"result\":0}");
+  }
+  CHECK(handler.get_request_handler().get_requests() == 1);
+  CHECK(handler.get_requests() == 1);
+  CHECK(handler.get_coalesced_requests() == 3);
+  CHECK(handler.get_request_handler().get_last_arguments() == "token=abc&Key=ABCD&");
+}
+
+TEST_CASE("RequestHandler_singleflight gives the error to all waiting requests", "[RequestHandler_singleflight]")
+{
+  cryptolens::Error e;
+  RequestHandler handler(e);
+  handler.get_request_handler().set_error(8, 7);
+  handler.get_request_handler().set_delay(200);
+
+  std::vector<Result> results = activate_concurrently(handler, 4);
+
+  for (Result const& result : results) {
+    CHECK(result.subsystem == cryptolens::errors::Subsystem::RequestHandler);
+    CHECK(result.reason == 8);
+    CHECK(result.extra == 7);
+    CHECK(result.body == "");
+  }
+  CHECK(handler.get_request_handler().get_requests() == 1);
+}
+
+TEST_CASE("RequestHandler_singleflight sends different requests separately", "[RequestHandler_singleflight]")
+{
+  cryptolens::Error e;
+  RequestHandler handler(e);
+  handler.get_request_handler().set_response("{\"result\":0}");
+  handler.get_request_handler().set_delay(200);
+
+  std::thread other([&handler]() { activate(handler, "EFGH"); });
+  activate(handler, "ABCD");
+  other.join();
+
+  CHECK(handler.get_request_handler().get_requests() == 2);
+  CHECK(handler.get_coalesced_requests() == 0);
+}
+
+TEST_CASE("RequestHandler_singleflight sends a request again once the identical request is done", "[RequestHandler_singleflight]")
+{
+  cryptolens::Error e;
+  RequestHandler handler(e);
+  handler.get_request_handler().set_response("{\"result\":0}");
+
+  CHECK(activate(handler, "ABCD").body == "{\"result\":0}");
+  CHECK(activate(handler, "ABCD").body == "{\"result\":0}");
+
+  CHECK(handler.get_request_handler().get_requests() == 2);
+  CHECK(handler.get_coalesced_requests() == 0);
+}
+
+TEST_CASE("RequestHandler_singleflight passes on exceptions and keeps working", "[RequestHandler_singleflight]")
+{
+  cryptolens::Error e;
+  RequestHandler handler(e);
+  handler.get_request_handler().set_response("{\"result\":0}");
+  handler.get_request_handler().push_exception();
+
+  CHECK_THROWS_AS(activate(handler, "ABCD"), std::runtime_error);
+  CHECK(activate(handler, "ABCD").body == "{\"result\":0}");
+}
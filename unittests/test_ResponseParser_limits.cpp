@@ -0,0 +1,185 @@
+#include <string>
+#include <tuple>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/Error.hpp>
+#include <cryptolens/ResponseParser_ArduinoJson7.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+#ifdef CRYPTOLENS_UNIT_TESTS_SIMDJSON
+#include <cryptolens/ResponseParser_simdjson.hpp>
+#endif
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+// The limits set on a response parser must make it fail with the reason of
+// the limit that was exceeded, and must not reject responses within them.
+
+namespace {
+
+#ifdef CRYPTOLENS_UNIT_TESTS_SIMDJSON
+using ResponseParsers = std::tuple<cryptolens::ResponseParser_ArduinoJson7, cryptolens::ResponseParser_Streaming, cryptolens::ResponseParser_simdjson>;
+#else
+using ResponseParsers = std::tuple<cryptolens::ResponseParser_ArduinoJson7, cryptolens::ResponseParser_Streaming>;
+#endif
+
+std::string const LICENSE =
+  "{\"ProductId\":3941,\"ID\":1042,\"Key\":\"ICWYD-QLYOS-BXQCA-RZNFE\",\"Created\":1698796800,"
+  "\"Expires\":4102444800,\"Period\":366,\"F1\":true,\"F2\":false,\"F3\":true,\"F4\":false,"
+  "\"F5\":false,\"F6\":false,\"F7\":false,\"F8\":true,\"Notes\":\"Enterprise plan\",\"Block\":false,"
+  "\"GlobalId\":284610,\"Customer\":{\"Id\":7345,\"Name\":\"Jane Doe\",\"Email\":\"jane@example.com\","
+  "\"CompanyName\":\"Example Ltd\",\"Created\":1698796800},\"ActivatedMachines\":[{\"Mid\":\"abc\","
+  "\"IP\":\"203.0.113.1\",\"Time\":1700000000}],\"TrialActivation\":false,\"MaxNoOfMachines\":5,"
+  "\"AllowedMachines\":\"\",\"DataObjects\":[{\"Id\":11,\"Name\":\"usagecount\",\"StringValue\":\"\","
+  "\"IntValue\":42}],\"SignDate\":1700006400,\"Reseller\":null}";
+
+std::string const MACHINE = "{\"Mid\":\"abc\",\"IP\":\"203.0.113.1\",\"Time\":1700000000}";
+std::string const DATA_OBJECT = "{\"Id\":12,\"Name\":\"seats\",\"StringValue\":\"\",\"IntValue\":3}";
+
+// Returns LICENSE with the first occurrence of from replaced by to
+std::string
+license_with(std::string const& from, std::string const& to)
+{
+  std::string s = LICENSE;
+  std::size_t i = s.find(from);
+  REQUIRE(i != std::string::npos);
+  s.replace(i, from.size(), to);
+  return s;
+}
+
+// Returns LICENSE with an extra member added at the end of the object
+std::string
+license_plus(std::string const& member)
+{
+  return LICENSE.substr(0, LICENSE.size() - 1) + "," + member + "}";
+}
+
+// A value nested depth levels deep, counting the outermost array
+std::string
+nested(int depth)
+{
+  return std::string(depth, '[') + std::string(depth, ']');
+}
+
+// Returns the Json error reason, -1 if the license key was accepted, or -2
+// if it failed with another subsystem
+template<typename ResponseParser>
+int
+parse(ResponseParser & parser, std::string const& license)
+{
+  cryptolens::Error e;
+  cryptolens::optional<cryptolens::LicenseKeyInformation> x = parser.make_license_key_information_unsafe(e, license);
+  if (!e) { REQUIRE(x); return -1; }
+
+  return e.get_subsystem() == cryptolens::errors::Subsystem::Json ? e.get_reason() : -2;
+}
+
+int const ACCEPTED = -1;
+
+} // namespace
+
+TEMPLATE_LIST_TEST_CASE("Response parsers limit the nesting depth", "[ResponseParser_limits]", ResponseParsers)
+{
+  cryptolens::Error e;
+  TestType parser(e);
+
+  SECTION("to 10 levels by default") {
+    CHECK(parse(parser, license_plus("\"X\":" + nested(9))) == ACCEPTED);
+    CHECK(parse(parser, license_plus("\"X\":" + nested(10))) == cryptolens::errors::Json::MAX_DEPTH_EXCEEDED);
+  }
+
+  SECTION("to a lower limit") {
+    // ActivatedMachines and DataObjects are 3 levels deep
+    parser.set_max_depth(e, 3);
+    REQUIRE_FALSE(e);
+
+    CHECK(parse(parser, LICENSE) == ACCEPTED);
+    CHECK(parse(parser, license_plus("\"X\":" + nested(2))) == ACCEPTED);
+    CHECK(parse(parser, license_plus("\"X\":" + nested(3))) == cryptolens::errors::Json::MAX_DEPTH_EXCEEDED);
+  }
+
+  SECTION("to a higher limit") {
+    parser.set_max_depth(e, 20);
+    REQUIRE_FALSE(e);
+
+    CHECK(parse(parser, license_plus("\"X\":" + nested(19))) == ACCEPTED);
+    CHECK(parse(parser, license_plus("\"X\":" + nested(20))) == cryptolens::errors::Json::MAX_DEPTH_EXCEEDED);
+  }
+
+  SECTION("also in activation responses") {
+    parser.set_max_depth(e, 3);
+    REQUIRE_FALSE(e);
+
+    cryptolens::Error e1;
+    CHECK(parser.parse_activate_response(e1, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"X\":" + nested(2) + "}"));
+    CHECK_FALSE(e1);
+
+    cryptolens::Error e2;
+    CHECK_FALSE(parser.parse_activate_response(e2, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"X\":" + nested(3) + "}"));
+    CHECK(e2.get_subsystem() == cryptolens::errors::Subsystem::Json);
+    CHECK(e2.get_reason() == cryptolens::errors::Json::MAX_DEPTH_EXCEEDED);
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("Response parsers limit the number of machines and data objects", "[ResponseParser_limits]", ResponseParsers)
+{
+  cryptolens::Error e;
+  TestType parser(e);
+
+  std::string const machines = license_with("\"ActivatedMachines\":[", "\"ActivatedMachines\":[" + MACHINE + "," + MACHINE + ",");
+  std::string const data_objects = license_with("\"DataObjects\":[", "\"DataObjects\":[" + DATA_OBJECT + "," + DATA_OBJECT + ",");
+
+  SECTION("not at all by default") {
+    std::string many = "\"ActivatedMachines\":[";
+    for (int i = 0; i < 1000; ++i) { many += MACHINE + ","; }
+
+    CHECK(parse(parser, license_with("\"ActivatedMachines\":[", many)) == ACCEPTED);
+  }
+
+  SECTION("up to the limit") {
+    parser.set_max_elements(e, 3);
+    REQUIRE_FALSE(e);
+
+    CHECK(parse(parser, machines) == ACCEPTED);
+    CHECK(parse(parser, data_objects) == ACCEPTED);
+  }
+
+  SECTION("but not above it") {
+    parser.set_max_elements(e, 2);
+    REQUIRE_FALSE(e);
+
+    CHECK(parse(parser, LICENSE) == ACCEPTED);
+    CHECK(parse(parser, machines) == cryptolens::errors::Json::MAX_ELEMENTS_EXCEEDED);
+    CHECK(parse(parser, data_objects) == cryptolens::errors::Json::MAX_ELEMENTS_EXCEEDED);
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("Response parsers limit the time spent parsing a response", "[ResponseParser_limits]", ResponseParsers)
+{
+  cryptolens::Error e;
+  TestType parser(e);
+
+  // Large enough to take more than a microsecond to parse with any parser
+  std::string padding = "\"X\":[";
+  for (int i = 0; i < 100000; ++i) { padding += "12345,"; }
+  padding += "0]";
+  std::string const large = license_plus(padding);
+
+  SECTION("not at all by default") {
+    CHECK(parse(parser, large) == ACCEPTED);
+  }
+
+  SECTION("within the budget") {
+    parser.set_time_budget(e, 10 * 1000 * 1000);
+    REQUIRE_FALSE(e);
+
+    CHECK(parse(parser, large) == ACCEPTED);
+  }
+
+  SECTION("beyond the budget") {
+    parser.set_time_budget(e, 1);
+    REQUIRE_FALSE(e);
+
+    CHECK(parse(parser, large) == cryptolens::errors::Json::TIME_BUDGET_EXCEEDED);
+  }
+}
@@ -0,0 +1,409 @@
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/Error.hpp>
+#include <cryptolens/FieldsToReturn.hpp>
+#include <cryptolens/LicenseKeyView.hpp>
+#include <cryptolens/RawLicenseKey.hpp>
+#include <cryptolens/ResponseParser_ArduinoJson7.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+#ifdef CRYPTOLENS_UNIT_TESTS_SIMDJSON
+#include <cryptolens/ResponseParser_simdjson.hpp>
+#endif
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+// The response parsers are interchangeable, thus they must agree on which
+// responses are accepted and on the values extracted from them. Each case is
+// run through every parser, and through LicenseKeyView for license keys, and
+// the results are compared to those of ResponseParser_ArduinoJson7.
+
+namespace {
+
+std::string const LICENSE =
+  "{\"ProductId\":3941,\"ID\":1042,\"Key\":\"ICWYD-QLYOS-BXQCA-RZNFE\",\"Created\":1698796800,"
+  "\"Expires\":4102444800,\"Period\":366,\"F1\":true,\"F2\":false,\"F3\":true,\"F4\":false,"
+  "\"F5\":false,\"F6\":false,\"F7\":false,\"F8\":true,\"Notes\":\"Enterprise plan\",\"Block\":false,"
+  "\"GlobalId\":284610,\"Customer\":{\"Id\":7345,\"Name\":\"Jane Doe\",\"Email\":\"jane@example.com\","
+  "\"CompanyName\":\"Example Ltd\",\"Created\":1698796800},\"ActivatedMachines\":[{\"Mid\":\"abc\","
+  "\"IP\":\"203.0.113.1\",\"Time\":1700000000}],\"TrialActivation\":false,\"MaxNoOfMachines\":5,"
+  "\"AllowedMachines\":\"\",\"DataObjects\":[{\"Id\":11,\"Name\":\"usagecount\",\"StringValue\":\"\","
+  "\"IntValue\":42}],\"SignDate\":1700006400,\"Reseller\":null}";
+
+// Returns LICENSE with the first occurrence of from replaced by to
+std::string
+license_with(std::string const& from, std::string const& to)
+{
+  std::string s = LICENSE;
+  std::size_t i = s.find(from);
+  REQUIRE(i != std::string::npos);
+  s.replace(i, from.size(), to);
+  return s;
+}
+
+// Returns LICENSE with an extra member added at the end of the object
+std::string
+license_plus(std::string const& member)
+{
+  return LICENSE.substr(0, LICENSE.size() - 1) + "," + member + "}";
+}
+
+// A value nested depth levels deep, counting the outermost array
+std::string
+nested(int depth)
+{
+  return std::string(depth, '[') + std::string(depth, ']');
+}
+
+template<typename T>
+std::string
+show(cryptolens::optional<T> const& x)
+{
+  if (!x) { return "-"; }
+  std::ostringstream s; s << *x; return s.str();
+}
+
+std::string
+show_error(cryptolens::Error const& e)
+{
+  std::ostringstream s;
+  s << "error " << e.get_subsystem(cryptolens::api::main()) << "/" << e.get_reason(cryptolens::api::main());
+  return s.str();
+}
+
+std::string
+describe(cryptolens::LicenseKeyInformation const& x)
+{
+  std::ostringstream s;
+  s << x.get_product_id() << " " << x.get_created() << " " << x.get_expires() << " " << x.get_period()
+    << " " << x.get_block() << x.get_trial_activation() << " " << x.get_sign_date()
+    << " F" << x.get_f1() << x.get_f2() << x.get_f3() << x.get_f4() << x.get_f5() << x.get_f6() << x.get_f7() << x.get_f8()
+    << " id=" << show(x.get_id()) << " key=" << show(x.get_key()) << " notes=" << show(x.get_notes())
+    << " global_id=" << show(x.get_global_id()) << " max=" << show(x.get_maxnoofmachines())
+    << " allowed=" << show(x.get_allowed_machines());
+
+  if (x.get_customer()) {
+    cryptolens::Customer const& c = *x.get_customer();
+    s << " customer=" << c.get_id() << "," << c.get_name() << "," << c.get_email() << "," << c.get_company_name() << "," << c.get_created();
+  } else {
+    s << " customer=-";
+  }
+
+  if (x.get_activated_machines()) {
+    s << " machines=";
+    for (cryptolens::ActivationData const& m : *x.get_activated_machines()) {
+      s << "[" << m.get_mid() << "," << m.get_ip() << "," << m.get_time() << "," << show(m.get_friendly_name()) << "]";
+    }
+  } else {
+    s << " machines=-";
+  }
+
+  if (x.get_data_objects()) {
+    s << " data_objects=";
+    for (cryptolens::DataObject const& d : *x.get_data_objects()) {
+      s << "[" << d.get_id() << "," << d.get_name() << "," << d.get_string_value() << "," << d.get_int_value() << "]";
+    }
+  } else {
+    s << " data_objects=-";
+  }
+
+  return s.str();
+}
+
+template<typename ResponseParser>
+std::string
+license_summary(std::string const& license, int fields_to_skip = 0)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  cryptolens::optional<cryptolens::LicenseKeyInformation> x = parser.make_license_key_information_unsafe(e, license, fields_to_skip);
+  if (e) { return show_error(e); }
+  REQUIRE(x);
+
+  return describe(*x);
+}
+
+// Accepts any signature, such that LicenseKeyView can be given any license
+struct SignatureVerifier_accept_all {
+  bool verify_message(cryptolens::basic_Error & e, std::vector<unsigned char> const& message, std::string const& signature_base64) const { return true; }
+};
+
+std::string
+base64(std::string const& s)
+{
+  char const* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  std::string out;
+  for (std::size_t i = 0; i < s.size(); i += 3) {
+    std::size_t n = s.size() - i < 3 ? s.size() - i : 3;
+    unsigned long x = 0;
+    for (std::size_t j = 0; j < 3; ++j) { x = (x << 8) | (j < n ? (unsigned char)s[i + j] : 0); }
+    for (std::size_t j = 0; j < 4; ++j) { out += j <= n ? alphabet[(x >> (18 - 6 * j)) & 63] : '='; }
+  }
+  return out;
+}
+
+std::string
+view_summary(std::string const& license)
+{
+  cryptolens::Error e;
+  cryptolens::optional<cryptolens::LicenseKeyView> x =
+    cryptolens::LicenseKeyView::make(e, cryptolens::RawLicenseKey::make(e, SignatureVerifier_accept_all(), base64(license), "AAAA"));
+  if (e) { return show_error(e); }
+  REQUIRE(x);
+
+  return describe(x->to_license_key_information());
+}
+
+template<typename ResponseParser>
+std::string
+limited_license_summary(std::string const& license, std::size_t max_elements)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  parser.set_max_elements(e, max_elements);
+  cryptolens::optional<cryptolens::LicenseKeyInformation> x = parser.make_license_key_information_unsafe(e, license);
+  if (e) { return show_error(e); }
+  REQUIRE(x);
+
+  return x->get_activated_machines() ? std::to_string(x->get_activated_machines()->size()) : "-";
+}
+
+template<typename ResponseParser>
+std::string
+activate_summary(std::string const& response)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, response);
+  if (e) { return show_error(e); }
+  REQUIRE(x);
+
+  return x->first + " " + x->second;
+}
+
+template<typename ResponseParser>
+std::string
+last_message_summary(std::string const& response)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  std::string message = parser.parse_last_message_response(e, response);
+  if (e) { return show_error(e); }
+
+  return message;
+}
+
+template<typename ResponseParser>
+std::string
+trial_key_summary(std::string const& response)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  std::string key = parser.parse_create_trial_key_response(e, response);
+  if (e) { return show_error(e); }
+
+  return key;
+}
+
+template<typename ResponseParser>
+std::string
+feature_summary(std::string const& features, std::string const& feature)
+{
+  cryptolens::Error e;
+  ResponseParser parser(e);
+  bool found = parser.has_template_feature(e, features, feature);
+  if (e) { return show_error(e); }
+
+  return found ? "found" : "not found";
+}
+
+#ifdef CRYPTOLENS_UNIT_TESTS_SIMDJSON
+#define CHECK_PARITY(f, ...)                                                                  \
+  do {                                                                                        \
+    std::string expected = f<cryptolens::ResponseParser_ArduinoJson7>(__VA_ARGS__);           \
+    CHECK(f<cryptolens::ResponseParser_Streaming>(__VA_ARGS__) == expected);                  \
+    CHECK(f<cryptolens::ResponseParser_simdjson>(__VA_ARGS__) == expected);                   \
+  } while (0)
+#else
+#define CHECK_PARITY(f, ...)                                                                  \
+  do {                                                                                        \
+    std::string expected = f<cryptolens::ResponseParser_ArduinoJson7>(__VA_ARGS__);           \
+    CHECK(f<cryptolens::ResponseParser_Streaming>(__VA_ARGS__) == expected);                  \
+  } while (0)
+#endif
+
+#define CHECK_LICENSE_PARITY(license)                                                         \
+  do {                                                                                        \
+    CHECK_PARITY(license_summary, license);                                                   \
+    CHECK(view_summary(license) == license_summary<cryptolens::ResponseParser_ArduinoJson7>(license)); \
+  } while (0)
+
+} // namespace
+
+TEST_CASE("Response parsers agree on valid license keys", "[ResponseParser]")
+{
+  CHECK(license_summary<cryptolens::ResponseParser_ArduinoJson7>(LICENSE).compare(0, 5, "error") != 0);
+
+  CHECK_LICENSE_PARITY(LICENSE);
+  CHECK_LICENSE_PARITY(license_with("\"Key\":\"ICWYD", "\"Key\":\"\\u0049CWYD"));
+  CHECK_LICENSE_PARITY(license_with("\"F1\"", "\"F\\u0031\""));
+  CHECK_LICENSE_PARITY(license_with("\"Notes\":\"Enterprise plan\"", "\"Notes\":null"));
+  CHECK_LICENSE_PARITY(license_with("\"GlobalId\":284610", "\"GlobalId\":-1"));
+  CHECK_LICENSE_PARITY(license_with("\"MaxNoOfMachines\":5", "\"MaxNoOfMachines\":5.5"));
+  CHECK_LICENSE_PARITY(license_with("\"Customer\":{\"Id\":7345,", "\"Customer\":{"));
+  CHECK_LICENSE_PARITY(license_with("\"ActivatedMachines\":[", "\"ActivatedMachines\":[1,"));
+  CHECK_LICENSE_PARITY(license_with("\"DataObjects\":[{\"Id\":11,", "\"DataObjects\":[{"));
+}
+
+TEST_CASE("Response parsers agree on FieldsToReturn", "[ResponseParser]")
+{
+  CHECK_PARITY(license_summary, LICENSE, cryptolens::FieldsToReturn::ACTIVATED_MACHINES);
+  CHECK_PARITY(license_summary, LICENSE, cryptolens::FieldsToReturn::SKIPPABLE);
+}
+
+TEST_CASE("Response parsers agree on FriendlyName", "[ResponseParser]")
+{
+  CHECK(license_summary<cryptolens::ResponseParser_ArduinoJson7>(license_with("\"Time\":1700000000", "\"Time\":1700000000,\"FriendlyName\":\"workstation-0\"")).find(",workstation-0]") != std::string::npos);
+
+  CHECK_LICENSE_PARITY(license_with("\"Time\":1700000000", "\"Time\":1700000000,\"FriendlyName\":\"workstation-0\""));
+  CHECK_LICENSE_PARITY(license_with("\"Time\":1700000000", "\"Time\":1700000000,\"FriendlyName\":null"));
+}
+
+TEST_CASE("Response parsers agree on the mandatory fields", "[ResponseParser]")
+{
+  CHECK(license_summary<cryptolens::ResponseParser_ArduinoJson7>(license_with("\"F5\":false", "\"F5\":1")) == "error 2/0");
+
+  CHECK_LICENSE_PARITY(license_with("\"F5\":false", "\"F5\":1"));
+  CHECK_LICENSE_PARITY(license_with("\"F5\":false,", ""));
+  CHECK_LICENSE_PARITY(license_with("\"F7\":false,", ""));
+  CHECK_LICENSE_PARITY(license_with("\"ProductId\":3941", "\"ProductId\":\"3941\""));
+  CHECK_LICENSE_PARITY(license_with("\"Expires\":4102444800", "\"Expires\":-1"));
+  CHECK_LICENSE_PARITY(license_with("\"Period\":366", "\"Period\":366.0"));
+}
+
+TEST_CASE("Response parsers agree on duplicate keys", "[ResponseParser]")
+{
+  // The last value is used, even if it has another type
+  CHECK(license_summary<cryptolens::ResponseParser_ArduinoJson7>(license_plus("\"F1\":false")).find(" F0") != std::string::npos);
+  CHECK(license_summary<cryptolens::ResponseParser_ArduinoJson7>(license_plus("\"ProductId\":\"x\"")) == "error 2/0");
+  CHECK(activate_summary<cryptolens::ResponseParser_ArduinoJson7>("{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"licenseKey\":\"c\"}") == "c b");
+
+  CHECK_LICENSE_PARITY(license_plus("\"F1\":false"));
+  CHECK_LICENSE_PARITY(license_plus("\"ProductId\":\"x\""));
+  CHECK_LICENSE_PARITY(license_plus("\"Notes\":\"second\""));
+  CHECK_LICENSE_PARITY(license_plus("\"Notes\":7"));
+  CHECK_LICENSE_PARITY(license_plus("\"Customer\":{\"Id\":1,\"Created\":2}"));
+  CHECK_LICENSE_PARITY(license_plus("\"ActivatedMachines\":[]"));
+  CHECK_LICENSE_PARITY(license_plus("\"DataObjects\":null"));
+
+  CHECK_PARITY(activate_summary, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"licenseKey\":\"c\"}");
+  CHECK_PARITY(activate_summary, "{\"result\":1,\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\"}");
+}
+
+TEST_CASE("Response parsers agree on nesting", "[ResponseParser]")
+{
+  CHECK(activate_summary<cryptolens::ResponseParser_ArduinoJson7>("{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"X\":" + nested(9) + "}") == "a b");
+  CHECK(activate_summary<cryptolens::ResponseParser_ArduinoJson7>("{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"X\":" + nested(10) + "}") == "error 2/1");
+
+  // The license key object itself is the first level
+  CHECK_LICENSE_PARITY(license_plus("\"X\":" + nested(9)));
+  CHECK_LICENSE_PARITY(license_plus("\"X\":" + nested(10)));
+  CHECK_PARITY(activate_summary, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"X\":" + nested(9) + "}");
+  CHECK_PARITY(activate_summary, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\",\"X\":" + nested(10) + "}");
+}
+
+TEST_CASE("Response parsers agree on the number of elements", "[ResponseParser]")
+{
+  std::string const machine = "{\"Mid\":\"abc\",\"IP\":\"203.0.113.1\",\"Time\":1700000000}";
+
+  CHECK_PARITY(limited_license_summary, license_with("\"ActivatedMachines\":[", "\"ActivatedMachines\":[" + machine + ","), 2);
+  CHECK_PARITY(limited_license_summary, license_with("\"ActivatedMachines\":[", "\"ActivatedMachines\":[" + machine + ","), 1);
+  CHECK_PARITY(limited_license_summary, license_with("\"ActivatedMachines\":[", "\"ActivatedMachines\":[1,"), 1);
+  CHECK_PARITY(limited_license_summary, license_with("\"ActivatedMachines\":[", "\"ActivatedMachines\":[1,2,"), 2);
+}
+
+TEST_CASE("Response parsers agree on trailing data", "[ResponseParser]")
+{
+  // Anything after the outermost value is ignored
+  CHECK(activate_summary<cryptolens::ResponseParser_ArduinoJson7>("{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\"} garbage") == "a b");
+
+  CHECK_LICENSE_PARITY(LICENSE + " ");
+  CHECK_LICENSE_PARITY(LICENSE + " garbage");
+  CHECK_LICENSE_PARITY(LICENSE + nested(20));
+  CHECK_LICENSE_PARITY(license_with("\"Notes\":\"Enterprise plan\"", "\"Notes\":\"}\\\"}]\"") + " garbage");
+  CHECK_PARITY(activate_summary, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\"} garbage");
+  CHECK_PARITY(activate_summary, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":\"b\"}{}");
+}
+
+TEST_CASE("Response parsers agree on invalid responses", "[ResponseParser]")
+{
+  CHECK_LICENSE_PARITY("");
+  CHECK_LICENSE_PARITY("[]");
+  CHECK_LICENSE_PARITY(LICENSE.substr(0, LICENSE.size() / 2));
+  CHECK_LICENSE_PARITY(license_with("\"Block\":false,", "\"Block\":false,,"));
+  CHECK_LICENSE_PARITY(license_with("\"Notes\":\"Enterprise plan\"", "\"Notes\":\"a\\q\""));
+
+  CHECK_PARITY(activate_summary, "");
+  CHECK_PARITY(activate_summary, "<html>Bad Gateway</html>");
+  CHECK_PARITY(activate_summary, "{\"result\":1,\"message\":\"Unable to find the license key.\"}");
+  CHECK_PARITY(activate_summary, "{\"result\":1}");
+  CHECK_PARITY(activate_summary, "{\"result\":\"0\",\"licenseKey\":\"a\",\"signature\":\"b\"}");
+  CHECK_PARITY(activate_summary, "{\"result\":0,\"licenseKey\":\"a\"}");
+  CHECK_PARITY(activate_summary, "{\"result\":0,\"licenseKey\":\"a\",\"signature\":null}");
+}
+
+TEST_CASE("Response parsers differ only on invalid JSON in unused values", "[ResponseParser]")
+{
+  auto accepted = [](std::string const& summary) { return summary.compare(0, 5, "error") != 0; };
+
+  // ArduinoJson accepts some input which is not JSON, which
+  // ResponseParser_Streaming rejects
+  std::string const lenient[] = { "\"X\":01", "\"X\":{1:2}", "'X':1" };
+  for (std::string const& member : lenient) {
+    INFO(member);
+    CHECK(accepted(license_summary<cryptolens::ResponseParser_ArduinoJson7>(license_plus(member))));
+    CHECK(license_summary<cryptolens::ResponseParser_Streaming>(license_plus(member)) == "error 2/0");
+  }
+
+#ifdef CRYPTOLENS_UNIT_TESTS_SIMDJSON
+  // simdjson does not validate the values it skips
+  std::string const skipped[] = { "[tru]", "\"\\q\"", "01", "{1:2}" };
+  for (std::string const& value : skipped) {
+    INFO(value);
+    CHECK(accepted(license_summary<cryptolens::ResponseParser_simdjson>(license_plus("\"X\":" + value))));
+  }
+  CHECK(license_summary<cryptolens::ResponseParser_simdjson>(license_plus("'X':1")) == "error 2/0");
+#endif
+}
+
+TEST_CASE("Response parsers agree on other responses", "[ResponseParser]")
+{
+  CHECK_PARITY(last_message_summary, "{\"result\":0,\"messages\":[{\"content\":\"a\",\"created\":1},{\"content\":\"b\",\"created\":3},{\"content\":\"c\",\"created\":2}]}");
+  CHECK_PARITY(last_message_summary, "{\"result\":0,\"messages\":[1,{\"content\":\"a\"},{\"content\":\"b\",\"created\":3}]}");
+  CHECK_PARITY(last_message_summary, "{\"result\":0}");
+  CHECK_PARITY(last_message_summary, "{\"result\":1,\"message\":\"x\",\"messages\":[]}");
+
+  CHECK_PARITY(trial_key_summary, "{\"result\":0,\"key\":\"ABCDE-FGHIJ\"}");
+  CHECK_PARITY(trial_key_summary, "{\"result\":0,\"key\":\"ABCDE-FGHIJ\",\"key\":\"KLMNO-PQRST\"}");
+  CHECK_PARITY(trial_key_summary, "{\"result\":0,\"key\":1}");
+  CHECK_PARITY(trial_key_summary, "{\"result\":0,\"key\":\"ABCDE-FGHIJ\"} trailing");
+}
+
+TEST_CASE("Response parsers agree on template features", "[ResponseParser]")
+{
+  std::string const features = "[\"A\",[\"B\",[\"C\",[\"D\",[\"E\"]]]],[\"F\"],7]";
+
+  CHECK_PARITY(feature_summary, features, "A");
+  CHECK_PARITY(feature_summary, features, "B");
+  CHECK_PARITY(feature_summary, features, "B.C");
+  CHECK_PARITY(feature_summary, features, "B.D");
+  CHECK_PARITY(feature_summary, features, "B.D.E");
+  CHECK_PARITY(feature_summary, features, "F");
+  CHECK_PARITY(feature_summary, features, "G");
+  CHECK_PARITY(feature_summary, "{}", "A");
+}
@@ -0,0 +1,107 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/base64.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+#include <cryptolens/SignatureVerifier_BearSSL.hpp>
+
+#include "fixtures.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+struct Fixture {
+  Fixture() : e(), verifier(e), license(), signature()
+  {
+    cryptolens::ResponseParser_Streaming parser(e);
+    cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, cryptolens_bench::ACTIVATE_RESPONSE);
+    if (x) {
+      license = *cryptolens::internal::b64_decode(x->first);
+      signature = x->second;
+    }
+    verifier.set_public_key_base64(e, cryptolens_bench::MODULUS_BASE64, cryptolens_bench::EXPONENT_BASE64);
+  }
+
+  bool verify(std::vector<unsigned char> const& message, std::string const& signature_base64)
+  {
+    cryptolens::Error e1;
+    bool ok1 = verifier.verify_message(e1, message, signature_base64);
+    CHECK(ok1 == !e1);
+
+    cryptolens::Error e2;
+    std::string decoded;
+    std::string message_base64 = base64(message);
+    bool ok2 = verifier.verify_message_base64(e2, message_base64, signature_base64, decoded);
+    CHECK(ok2 == !e2);
+
+    // Both ways of verifying must agree
+    CHECK(ok1 == ok2);
+    return ok1 && ok2;
+  }
+
+  static std::string base64(std::vector<unsigned char> const& data)
+  {
+    static char const* const ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    for (std::size_t i = 0; i < data.size(); i += 3) {
+      unsigned long v = (unsigned long)data[i] << 16;
+      if (i + 1 < data.size()) { v |= (unsigned long)data[i + 1] << 8; }
+      if (i + 2 < data.size()) { v |= data[i + 2]; }
+
+      out += ALPHABET[(v >> 18) & 63];
+      out += ALPHABET[(v >> 12) & 63];
+      out += i + 1 < data.size() ? ALPHABET[(v >> 6) & 63] : '=';
+      out += i + 2 < data.size() ? ALPHABET[v & 63] : '=';
+    }
+    return out;
+  }
+
+  cryptolens::Error e;
+  cryptolens::SignatureVerifier_BearSSL verifier;
+  std::vector<unsigned char> license;
+  std::string signature;
+};
+
+} // namespace
+
+TEST_CASE("SignatureVerifier_BearSSL accepts a signed license", "[SignatureVerifier_BearSSL]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+  REQUIRE_FALSE(f.license.empty());
+
+  CHECK(f.verify(f.license, f.signature));
+}
+
+// br_rsa_i62_pkcs1_vrfy() only checks the padding of the signature, so a
+// signature that is valid for one message must be rejected for any other
+// message by comparing the digests
+TEST_CASE("SignatureVerifier_BearSSL rejects a signature made for another message", "[SignatureVerifier_BearSSL]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  std::vector<unsigned char> forged = f.license;
+  forged[forged.size() / 2] ^= 1;
+  CHECK_FALSE(f.verify(forged, f.signature));
+
+  std::string const text = "{\"ProductId\":3941,\"Key\":\"FORGED\",\"Block\":false}";
+  CHECK_FALSE(f.verify(std::vector<unsigned char>(text.begin(), text.end()), f.signature));
+}
+
+TEST_CASE("SignatureVerifier_BearSSL rejects a signature with invalid padding", "[SignatureVerifier_BearSSL]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  std::vector<unsigned char> signature = *cryptolens::internal::b64_decode(f.signature);
+  signature[signature.size() / 2] ^= 1;
+
+  CHECK_FALSE(f.verify(f.license, Fixture::base64(signature)));
+}
@@ -0,0 +1,117 @@
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/base64.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+#include <cryptolens/SignatureVerifier_OpenSSL.hpp>
+
+#include "fixtures.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+struct Fixture {
+  Fixture() : e(), verifier(e), license_base64(), license(), signature()
+  {
+    cryptolens::ResponseParser_Streaming parser(e);
+    cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, cryptolens_bench::ACTIVATE_RESPONSE);
+    if (x) {
+      license_base64 = x->first;
+      license = *cryptolens::internal::b64_decode(x->first);
+      signature = x->second;
+    }
+  }
+
+  cryptolens::Error e;
+  cryptolens::SignatureVerifier_OpenSSL verifier;
+  std::string license_base64;
+  std::vector<unsigned char> license;
+  std::string signature;
+};
+
+} // namespace
+
+TEST_CASE("SignatureVerifier_OpenSSL needs both parts of the public key", "[SignatureVerifier_OpenSSL]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  CHECK_FALSE(f.verifier.verify_message(f.e, f.license, f.signature));
+  CHECK(f.e);
+  f.e.reset();
+
+  f.verifier.set_exponent_base64(f.e, cryptolens_bench::EXPONENT_BASE64);
+  CHECK_FALSE(f.verifier.verify_message(f.e, f.license, f.signature));
+  CHECK(f.e);
+  f.e.reset();
+
+  f.verifier.set_modulus_base64(f.e, cryptolens_bench::MODULUS_BASE64);
+  REQUIRE_FALSE(f.e);
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+  CHECK_FALSE(f.e);
+}
+
+TEST_CASE("SignatureVerifier_OpenSSL rejects tampered messages", "[SignatureVerifier_OpenSSL]")
+{
+  Fixture f;
+  f.verifier.set_public_key_base64(f.e, cryptolens_bench::MODULUS_BASE64, cryptolens_bench::EXPONENT_BASE64);
+  REQUIRE_FALSE(f.e);
+
+  std::vector<unsigned char> tampered = f.license;
+  tampered[tampered.size() / 2] ^= 1;
+
+  CHECK_FALSE(f.verifier.verify_message(f.e, tampered, f.signature));
+  CHECK(f.e);
+}
+
+TEST_CASE("SignatureVerifier_OpenSSL verifies with the current key", "[SignatureVerifier_OpenSSL]")
+{
+  Fixture f;
+  f.verifier.set_public_key_base64(f.e, cryptolens_bench::MODULUS_BASE64, cryptolens_bench::EXPONENT_BASE64);
+  REQUIRE_FALSE(f.e);
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+
+  // A different exponent, the signature must no longer verify
+  f.verifier.set_exponent_base64(f.e, "Aw==");
+  REQUIRE_FALSE(f.e);
+  CHECK_FALSE(f.verifier.verify_message(f.e, f.license, f.signature));
+  f.e.reset();
+
+  f.verifier.set_exponent_base64(f.e, cryptolens_bench::EXPONENT_BASE64);
+  REQUIRE_FALSE(f.e);
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+  CHECK_FALSE(f.e);
+}
+
+TEST_CASE("SignatureVerifier_OpenSSL can be used from several threads", "[SignatureVerifier_OpenSSL]")
+{
+  Fixture f;
+  f.verifier.set_public_key_base64(f.e, cryptolens_bench::MODULUS_BASE64, cryptolens_bench::EXPONENT_BASE64);
+  REQUIRE_FALSE(f.e);
+
+  int const THREADS = 4;
+  int const ITERATIONS = 50;
+  std::vector<int> verified(THREADS, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREADS; ++i) {
+    threads.emplace_back([&f, &verified, i, ITERATIONS]() {
+      for (int j = 0; j < ITERATIONS; ++j) {
+        cryptolens::Error e;
+        std::string message;
+        bool ok = j % 2 == 0
+                ? f.verifier.verify_message(e, f.license, f.signature)
+                : f.verifier.verify_message_base64(e, f.license_base64, f.signature, message);
+        if (ok && !e) { verified[i] += 1; }
+      }
+    });
+  }
+  for (std::thread & t : threads) { t.join(); }
+
+  for (int i = 0; i < THREADS; ++i) { CHECK(verified[i] == ITERATIONS); }
+}
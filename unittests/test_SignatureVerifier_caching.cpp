@@ -0,0 +1,108 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/base64.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/ResponseParser_Streaming.hpp>
+#include <cryptolens/SignatureVerifier_caching.hpp>
+
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+#include <cryptolens/SignatureVerifier_OpenSSL3.hpp>
+#else
+#include <cryptolens/SignatureVerifier_OpenSSL.hpp>
+#endif
+
+#include "fixtures.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+using SignatureVerifier = cryptolens::SignatureVerifier_caching<cryptolens::SignatureVerifier_OpenSSL3>;
+#else
+using SignatureVerifier = cryptolens::SignatureVerifier_caching<cryptolens::SignatureVerifier_OpenSSL>;
+#endif
+
+struct Fixture {
+  Fixture() : e(), verifier(e), license(), signature()
+  {
+    verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+    verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+
+    cryptolens::ResponseParser_Streaming parser(e);
+    cryptolens::optional<std::pair<std::string, std::string>> x = parser.parse_activate_response(e, cryptolens_bench::ACTIVATE_RESPONSE);
+    if (x) {
+      license = *cryptolens::internal::b64_decode(x->first);
+      signature = x->second;
+    }
+  }
+
+  cryptolens::Error e;
+  SignatureVerifier verifier;
+  std::vector<unsigned char> license;
+  std::string signature;
+};
+
+} // namespace
+
+TEST_CASE("SignatureVerifier_caching only verifies a signature once", "[SignatureVerifier_caching]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+  CHECK_FALSE(f.e);
+  CHECK(f.verifier.get_cache_misses() == 1);
+  CHECK(f.verifier.get_cache_hits() == 1);
+}
+
+TEST_CASE("SignatureVerifier_caching does not cache invalid signatures", "[SignatureVerifier_caching]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  f.license[0] ^= 1;
+  for (int i = 0; i < 2; ++i) {
+    cryptolens::Error e;
+    CHECK_FALSE(f.verifier.verify_message(e, f.license, f.signature));
+  }
+  CHECK(f.verifier.get_cache_hits() == 0);
+  CHECK(f.verifier.get_cache_misses() == 2);
+}
+
+TEST_CASE("SignatureVerifier_caching empties the cache when the public key changes", "[SignatureVerifier_caching]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+  std::string modulus(cryptolens_bench::MODULUS_BASE64);
+  modulus[1] = modulus[1] == 'A' ? 'B' : 'A';
+  f.verifier.set_modulus_base64(f.e, modulus);
+  REQUIRE_FALSE(f.e);
+
+  cryptolens::Error e;
+  CHECK_FALSE(f.verifier.verify_message(e, f.license, f.signature));
+  CHECK(f.verifier.get_cache_hits() == 0);
+}
+
+TEST_CASE("SignatureVerifier_caching keeps the cache if the public key is rejected", "[SignatureVerifier_caching]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+
+  cryptolens::Error e;
+  f.verifier.set_modulus_base64(e, "not base64!");
+  REQUIRE(e);
+
+  CHECK(f.verifier.verify_message(f.e, f.license, f.signature));
+  CHECK(f.verifier.get_cache_hits() == 1);
+}
@@ -0,0 +1,111 @@
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/base64.hpp>
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+namespace internal = ::cryptolens_io::v20190401::internal;
+
+namespace {
+
+char const* const ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Returns the result of b64_pton(), or "<invalid>" if it rejects the input
+std::string
+reference_decode(std::string const& b64)
+{
+  std::vector<unsigned char> v(internal::b64_decoded_size_max(b64.size()) + 1);
+  int len = internal::b64_pton(b64.c_str(), v.data(), v.size());
+  if (len == -1) { return "<invalid>"; }
+  return std::string((char const*)v.data(), len);
+}
+
+std::string
+decode(std::string const& b64)
+{
+  cryptolens::optional<std::vector<unsigned char>> v = internal::b64_decode(b64);
+  if (!v) { return "<invalid>"; }
+  return std::string(v->begin(), v->end());
+}
+
+// Decoded while global objects are constructed, which may happen before
+// any global object of the library has been constructed
+std::string const DECODED_AT_STARTUP = decode("SGVsbG8sIHdvcmxkIQ==");
+
+void
+collect(void * context, unsigned char const* data, std::size_t len)
+{
+  CHECK(len <= internal::B64_CHUNK_SIZE);
+  ((std::string *)context)->append((char const*)data, len);
+}
+
+} // namespace
+
+TEST_CASE("b64_decode() decodes padded and unpadded input", "[base64]")
+{
+  CHECK(decode("") == "");
+  CHECK(decode("QQ==") == "A");
+  CHECK(decode("QUI=") == "AB");
+  CHECK(decode("QUJD") == "ABC");
+  CHECK(decode(" QU\nJD\t") == "ABC");
+  CHECK(decode("QQ = =") == "A");
+}
+
+TEST_CASE("b64_decode() rejects invalid input", "[base64]")
+{
+  CHECK(decode("Q") == "<invalid>");
+  CHECK(decode("QQ") == "<invalid>");
+  CHECK(decode("QQ=") == "<invalid>");
+  CHECK(decode("=QQQ") == "<invalid>");
+  CHECK(decode("QQ==QQ==") == "<invalid>");
+  CHECK(decode("QU!D") == "<invalid>");
+}
+
+TEST_CASE("b64_decode() rejects non-zero trailing bits", "[base64]")
+{
+  CHECK(decode("QR==") == "<invalid>");
+  CHECK(decode("QUJ=") == "<invalid>");
+}
+
+TEST_CASE("b64_decode_into() agrees with b64_pton()", "[base64]")
+{
+  // Long runs of the alphabet go through the vectorized decoder, if there is
+  // one for this CPU, and the noise sends the rest to the scalar decoder.
+  std::mt19937 rng(1);
+  for (int n = 0; n < 20000; ++n) {
+    std::size_t len = rng() % 300;
+    std::string b64;
+    for (std::size_t i = 0; i < len; ++i) {
+      unsigned int r = rng() % 1000;
+      if      (r < 3) { b64 += ' '; }
+      else if (r < 5) { b64 += '='; }
+      else if (r < 6) { b64 += (char)(1 + rng() % 255); }
+      else            { b64 += ALPHABET[rng() % 64]; }
+    }
+    if (rng() % 4 == 0) { while (b64.size() % 4 != 0) { b64 += '='; } }
+
+    INFO(b64);
+    REQUIRE(decode(b64) == reference_decode(b64));
+  }
+}
+
+TEST_CASE("b64_decode() passes the result to the callback in order", "[base64]")
+{
+  std::mt19937 rng(2);
+  std::string b64;
+  for (std::size_t i = 0; i < 4 * internal::B64_CHUNK_SIZE + 8; ++i) { b64 += ALPHABET[rng() % 64]; }
+
+  std::string out, passed;
+  REQUIRE(internal::b64_decode(b64, out, collect, &passed));
+  CHECK(out == reference_decode(b64));
+  CHECK(passed == out);
+}
+
+TEST_CASE("b64_decode works during the construction of global objects", "[base64]")
+{
+  CHECK(DECODED_AT_STARTUP == "Hello, world!");
+}
@@ -0,0 +1,121 @@
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <cryptolens/basic_Cryptolens.hpp>
+#include <cryptolens/Error.hpp>
+#include <cryptolens/ResponseParser_ArduinoJson7.hpp>
+
+#include <openssl/err.h>
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+#include <cryptolens/SignatureVerifier_OpenSSL3.hpp>
+#else
+#include <cryptolens/SignatureVerifier_OpenSSL.hpp>
+#endif
+
+#include "fixtures.hpp"
+
+namespace cryptolens = ::cryptolens_io::v20190401;
+
+namespace {
+
+#if OPENSSL_VERSION_NUMBER >= 0x030000000
+using SignatureVerifier = cryptolens::SignatureVerifier_OpenSSL3;
+#else
+using SignatureVerifier = cryptolens::SignatureVerifier_OpenSSL;
+#endif
+
+struct Fixture {
+  Fixture() : e(), parser(e), verifier(e)
+  {
+    verifier.set_modulus_base64(e, cryptolens_bench::MODULUS_BASE64);
+    verifier.set_exponent_base64(e, cryptolens_bench::EXPONENT_BASE64);
+  }
+
+  cryptolens::Error e;
+  cryptolens::ResponseParser_ArduinoJson7 parser;
+  SignatureVerifier verifier;
+};
+
+} // namespace
+
+TEST_CASE("handle_activate() returns the license key of a valid response", "[basic_Cryptolens]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  cryptolens::optional<cryptolens::LicenseKey> license_key =
+    cryptolens::handle_activate(f.e, f.parser, f.verifier, cryptolens_bench::ACTIVATE_RESPONSE);
+
+  REQUIRE_FALSE(f.e);
+  REQUIRE(license_key);
+  REQUIRE(license_key->get_key());
+  CHECK(*license_key->get_key() == cryptolens_bench::KEY);
+}
+
+TEST_CASE("handle_activate() returns nullopt if the response is an error", "[basic_Cryptolens]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  cryptolens::optional<cryptolens::LicenseKey> license_key =
+    cryptolens::handle_activate(f.e, f.parser, f.verifier, "{\"result\":1,\"message\":\"Unable to find the license key.\"}");
+
+  CHECK(f.e);
+  CHECK_FALSE(license_key);
+}
+
+TEST_CASE("handle_activate() returns nullopt if the response is not JSON", "[basic_Cryptolens]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  cryptolens::optional<cryptolens::LicenseKey> license_key =
+    cryptolens::handle_activate(f.e, f.parser, f.verifier, "<html>Bad Gateway</html>");
+
+  CHECK(f.e);
+  CHECK_FALSE(license_key);
+}
+
+TEST_CASE("make_license_key() accepts both responses and saved license keys", "[basic_Cryptolens]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  cryptolens::optional<cryptolens::LicenseKey> from_response =
+    cryptolens::internal::make_license_key(f.e, f.parser, f.verifier, std::string(" \r\n") + cryptolens_bench::ACTIVATE_RESPONSE);
+  REQUIRE_FALSE(f.e);
+  REQUIRE(from_response);
+
+  cryptolens::optional<cryptolens::LicenseKey> from_saved =
+    cryptolens::internal::make_license_key(f.e, f.parser, f.verifier, from_response->to_string());
+  REQUIRE_FALSE(f.e);
+  REQUIRE(from_saved);
+  CHECK(from_saved->get_key() == from_response->get_key());
+}
+
+TEST_CASE("make_license_key() only treats strings starting with '{' as responses", "[basic_Cryptolens]")
+{
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+
+  cryptolens::optional<cryptolens::LicenseKey> license_key =
+    cryptolens::internal::make_license_key(f.e, f.parser, f.verifier, std::string("\xEF\xBB\xBF") + cryptolens_bench::ACTIVATE_RESPONSE);
+
+  CHECK(f.e);
+  CHECK_FALSE(license_key);
+}
+
+TEST_CASE("Setting the public key leaves the OpenSSL error queue alone", "[basic_Cryptolens]")
+{
+  ERR_clear_error();
+
+  Fixture f;
+  REQUIRE_FALSE(f.e);
+  CHECK(ERR_peek_error() == 0);
+
+  f.verifier.set_public_key_base64(f.e, cryptolens_bench::MODULUS_BASE64, cryptolens_bench::EXPONENT_BASE64);
+  REQUIRE_FALSE(f.e);
+  CHECK(ERR_peek_error() == 0);
+}
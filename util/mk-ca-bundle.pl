@@ -35,7 +35,7 @@ use Getopt::Std;
 use MIME::Base64;
 use strict;
 use warnings;
-use vars qw($opt_b $opt_d $opt_f $opt_h $opt_i $opt_k $opt_l $opt_m $opt_n $opt_p $opt_q $opt_s $opt_t $opt_u $opt_v $opt_w);
+use vars qw($opt_b $opt_d $opt_D $opt_f $opt_h $opt_i $opt_k $opt_l $opt_m $opt_n $opt_p $opt_q $opt_s $opt_t $opt_u $opt_v $opt_w);
 use List::Util;
 use Text::Wrap;
 use Time::Local;
@@ -110,7 +110,7 @@ my @valid_signature_algorithms = (
 
 $0 =~ s@.*(/|\\)@@;
 $Getopt::Std::STANDARD_HELP_VERSION = 1;
-getopts('bd:fhiklmnp:qs:tuvw:');
+getopts('bd:Dfhiklmnp:qs:tuvw:');
 
 if(!defined($opt_d)) {
     # to make plain "-d" use not cause warnings, and actually still work
@@ -164,11 +164,12 @@ sub warning_message() {
 }
 
 sub HELP_MESSAGE() {
-  print "Usage:\t${0} [-b] [-d<certdata>] [-f] [-i] [-k] [-l] [-n] [-p<purposes:levels>] [-q] [-s<algorithms>] [-t] [-u] [-v] [-w<l>] [<outputfile>]\n";
+  print "Usage:\t${0} [-b] [-d<certdata>] [-D] [-f] [-i] [-k] [-l] [-n] [-p<purposes:levels>] [-q] [-s<algorithms>] [-t] [-u] [-v] [-w<l>] [<outputfile>]\n";
   print "\t-b\tbackup an existing version of ca-bundle.crt\n";
   print "\t-d\tspecify Mozilla tree to pull certdata.txt or custom URL\n";
   print "\t\t  Valid names are:\n";
   print "\t\t    ", join( ", ", map { ( $_ =~ m/$opt_d/ ) ? "$_ (default)" : "$_" } sort keys %urls ), "\n";
+  print "\t-D\toutput precompiled DER blobs instead of PEM strings, see CRYPTOLENS_CURL_CACERTS_DER_FILE\n";
   print "\t-f\tforce rebuild even if certdata.txt is current\n";
   print "\t-i\tprint version info about used modules\n";
   print "\t-k\tallow URLs other than HTTPS, enable HTTP fallback (insecure)\n";
@@ -396,6 +397,7 @@ if( $stdout ) {
 }
 print CRT <<EOT;
 #include <string>
+#include <utility>
 #include <vector>
 
 /*
@@ -422,9 +424,14 @@ namespace v20190401 {
 
 namespace cacerts {
 
-std::vector<std::string> pems {
 EOT
 
+if ($opt_D) {
+  print CRT "std::vector<std::pair<std::string, std::string>> ders {\n";
+} else {
+  print CRT "std::vector<std::string> pems {\n";
+}
+
 report "Processing  '$txt' ...";
 my $caname;
 my $certnum = 0;
@@ -545,6 +552,20 @@ while (<TXT>) {
           # if empty, skip
           next;
       }
+      if ($opt_D) {
+        # Each entry is a pair of the name of the CA and the DER encoding of the
+        # certificate, such that the library can skip PEM decoding when loading it.
+        my $escaped = join('', map { sprintf("\\x%02x", ord($_)) } split(//, $data));
+        $escaped =~ s/(.{1,76})/      "$1"\n/g;
+        print CRT "\n  " . ($certnum ? "," : " ") . " { \"$caname\"\n    , std::string(\n";
+        print CRT $escaped;
+        print CRT "      , " . length($data) . ")\n    }\n";
+        report "Parsing: $caname" if ($opt_v);
+        $certnum ++;
+        $start_of_cert = 0;
+        undef @precert;
+        next;
+      }
       my $encoded = MIME::Base64::encode_base64($data, '');
       $encoded =~ s/(.{1,${opt_w}})/$1\n/g;
       my $skm_encoded = $encoded;
@@ -553,7 +574,7 @@ while (<TXT>) {
       my $pem = "      \"-----BEGIN CERTIFICATE-----\\n\"\n"
               . $skm_encoded
               . "-----END CERTIFICATE-----\\n\"\n";
-      print CRT "\n  , std::string {";
+      print CRT "\n  " . ($certnum ? "," : " ") . " std::string {";
       print CRT "\n      \"$caname\\n\"\n";
       print CRT @precert if($opt_m);
       my $maxStringLength = length(decode('UTF-8', $caname, Encode::FB_CROAK | Encode::LEAVE_SRC));
@@ -604,6 +625,15 @@ while (<TXT>) {
 
 }
 close(TXT) or die "Couldn't close $txt: $!\n";
+print CRT <<EOT;
+};
+
+} // namespace cacerts
+
+} // namespace v20190401
+
+} // namespace cryptolens_io
+EOT
 close(CRT) or die "Couldn't close $crt.~: $!\n";
 unless( $stdout ) {
     if ($opt_b && -e $crt) {